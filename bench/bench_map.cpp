@@ -0,0 +1,161 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+/*
+ * Compares cstl::map against std::map and std::unordered_map on random
+ * insert / find / erase of integer keys.
+ *
+ *   bench-cstl [count] [c]
+ *
+ * With "c" the C cstl_map is measured too. Unless the library is built with
+ * NDEBUG it verifies the whole tree after every update, so keep count small.
+ */
+
+#include "cstl_map.hpp"
+extern "C" {
+#include "c_stl_lib.h"
+}
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double elapsed_ms(bench_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(bench_clock::now() -
+                                                     start)
+        .count();
+}
+
+struct result {
+    double insert_ms;
+    double find_ms;
+    double erase_ms;
+    unsigned long checksum;
+};
+
+template <typename Map>
+static result run(const std::vector<long>& keys,
+                  const std::vector<long>& probes)
+{
+    result r;
+    Map m;
+    bench_clock::time_point t = bench_clock::now();
+    for (long k : keys) {
+        m.insert(std::make_pair(k, k));
+    }
+    r.insert_ms = elapsed_ms(t);
+
+    r.checksum = 0;
+    t = bench_clock::now();
+    for (long k : probes) {
+        typename Map::iterator it = m.find(k);
+        if (it != m.end()) {
+            r.checksum += (unsigned long)it->second;
+        }
+    }
+    r.find_ms = elapsed_ms(t);
+
+    t = bench_clock::now();
+    for (long k : keys) {
+        m.erase(k);
+    }
+    r.erase_ms = elapsed_ms(t);
+    return r;
+}
+
+static int compare_long(const void* a, const void* b)
+{
+    long x = *(const long*)a, y = *(const long*)b;
+    return (x > y) - (x < y);
+}
+
+static result run_c(const std::vector<long>& keys,
+                    const std::vector<long>& probes)
+{
+    result r;
+    struct cstl_map* m = cstl_map_new(compare_long, NULL, NULL);
+    bench_clock::time_point t = bench_clock::now();
+    for (const long& k : keys) {
+        cstl_map_insert(m, &k, sizeof(k), &k, sizeof(k));
+    }
+    r.insert_ms = elapsed_ms(t);
+
+    r.checksum = 0;
+    t = bench_clock::now();
+    for (const long& k : probes) {
+        const void* v = cstl_map_find(m, &k);
+        if (v) {
+            r.checksum += (unsigned long)*(const long*)v;
+        }
+    }
+    r.find_ms = elapsed_ms(t);
+
+    t = bench_clock::now();
+    for (const long& k : keys) {
+        cstl_map_remove(m, &k);
+    }
+    r.erase_ms = elapsed_ms(t);
+    cstl_map_delete(m);
+    return r;
+}
+
+static void report(const char* name, const result& r)
+{
+    printf("%-20s insert %9.2f ms  find %9.2f ms  erase %9.2f ms  (%lu)\n",
+           name, r.insert_ms, r.find_ms, r.erase_ms, r.checksum);
+}
+
+int main(int argc, char** argv)
+{
+    long n = argc > 1 ? atol(argv[1]) : 200000;
+    std::vector<long> keys, probes;
+    std::mt19937_64 rng(12345);
+    long i;
+
+    for (i = 0; i < n; i++) {
+        keys.push_back((long)(rng() >> 1));
+    }
+    for (i = 0; i < n; i++) {
+        /* half hits, half misses */
+        probes.push_back(i & 1 ? keys[rng() % n] : (long)(rng() >> 1));
+    }
+
+    printf("%ld keys\n", n);
+    report("cstl::map", run<cstl::map<long, long> >(keys, probes));
+    report("std::map", run<std::map<long, long> >(keys, probes));
+    report("std::unordered_map",
+           run<std::unordered_map<long, long> >(keys, probes));
+    if (argc > 2 && strcmp(argv[2], "c") == 0) {
+        report("cstl_map (C)", run_c(keys, probes));
+    }
+    return 0;
+}
@@ -45,6 +45,8 @@ extern cstl_error cstl_array_remove_from(struct cstl_array*, size_t pos);
 extern cstl_error cstl_array_delete(struct cstl_array* pArray);
 
 extern struct cstl_iterator* cstl_array_new_iterator(struct cstl_array* pArray);
+extern void cstl_array_iterator_init(struct cstl_iterator* pItr,
+                                     struct cstl_array* pArray);
 extern void cstl_array_delete_iterator(struct cstl_iterator* pItr);
 
 extern void cstl_array_quick_sort(struct cstl_array* pArray);
@@ -0,0 +1,85 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_ART_H__
+#define __C_STL_ART_H__
+
+/*
+ * Adaptive radix tree over fixed-size keys. Inner nodes branch on one key
+ * byte and come in four sizes (4, 16, 48 and 256 children), growing and
+ * shrinking with their fan-out; runs of bytes shared by a whole subtree are
+ * skipped with path compression. A lookup costs at most one node per key
+ * byte and never calls a comparator, yet keys stay ordered, so the tree
+ * also answers lower_bound and iterates in key order.
+ *
+ * Keys of kind CSTL_ART_KEY_BYTES are ordered as by memcmp, which suits
+ * packed big-endian tuples. CSTL_ART_KEY_UINT keys are native unsigned
+ * integers of 1, 2, 4 or 8 bytes, ordered numerically.
+ *
+ * Values are copied, as in cstl_map, and fn_v_d (if any) is called on them
+ * when they are replaced or removed. Pointers returned by cstl_art_find()
+ * stay valid until their key is removed or its value replaced.
+ */
+
+typedef enum {
+    CSTL_ART_KEY_BYTES,
+    CSTL_ART_KEY_UINT
+} cstl_art_key_kind;
+
+struct cstl_art;
+
+extern struct cstl_art* cstl_art_new(size_t key_size, cstl_art_key_kind kind,
+                                     cstl_destroy fn_v_d);
+extern cstl_error cstl_art_delete(struct cstl_art* art);
+extern size_t cstl_art_size(struct cstl_art* art);
+
+extern cstl_error cstl_art_insert(struct cstl_art* art, const void* key,
+                                  const void* value, size_t value_size);
+extern int cstl_art_is_key_exists(struct cstl_art* art, const void* key);
+extern cstl_error cstl_art_replace(struct cstl_art* art, const void* key,
+                                   const void* value, size_t value_size);
+extern cstl_error cstl_art_remove(struct cstl_art* art, const void* key);
+extern const void* cstl_art_find(struct cstl_art* art, const void* key);
+
+/* first stored key not less than key, or NULL; see cstl_art_value() */
+extern const void* cstl_art_lower_bound(struct cstl_art* art,
+                                        const void* key);
+/* value stored with a key pointer returned by the tree */
+extern const void* cstl_art_value(struct cstl_art* art,
+                                  const void* stored_key);
+
+/*
+ * Iterators visit keys in order. Each step looks up the successor of the
+ * current key, so other keys may be inserted or removed while iterating;
+ * only removing the current key invalidates the iterator.
+ */
+extern struct cstl_iterator* cstl_art_new_iterator(struct cstl_art* art);
+extern void cstl_art_iterator_init(struct cstl_iterator* pItr,
+                                   struct cstl_art* art);
+/* makes the next step return the first key not less than key */
+extern void cstl_art_iterator_seek(struct cstl_iterator* pItr,
+                                   const void* key);
+extern void cstl_art_delete_iterator(struct cstl_iterator* pItr);
+
+#endif /* __C_STL_ART_H__ */
@@ -0,0 +1,83 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_BITSET_H__
+#define __C_STL_BITSET_H__
+
+/*
+ * Resizable array of bits, stored in 64-bit words. The bulk operations
+ * (and / or / xor / andnot, popcount) run over whole words and use AVX2 or
+ * SSE2 where the compiler targets them.
+ *
+ * Bits past the size always read as clear: growing the set clears the new
+ * bits, and an operand shorter than the destination counts as all zeros
+ * past its end.
+ */
+
+#include <stdint.h>
+
+#define CSTL_BITSET_NPOS ((size_t)-1)
+
+struct cstl_bitset;
+
+extern struct cstl_bitset* cstl_bitset_new(size_t nbits);
+extern cstl_error cstl_bitset_delete(struct cstl_bitset* bs);
+extern size_t cstl_bitset_size(struct cstl_bitset* bs);
+extern cstl_error cstl_bitset_resize(struct cstl_bitset* bs, size_t nbits);
+
+extern cstl_error cstl_bitset_set(struct cstl_bitset* bs, size_t i);
+extern cstl_error cstl_bitset_clear(struct cstl_bitset* bs, size_t i);
+extern cstl_error cstl_bitset_flip(struct cstl_bitset* bs, size_t i);
+extern int cstl_bitset_test(struct cstl_bitset* bs, size_t i);
+extern void cstl_bitset_clear_all(struct cstl_bitset* bs);
+
+extern size_t cstl_bitset_popcount(struct cstl_bitset* bs);
+/* index of the lowest set bit, or CSTL_BITSET_NPOS if none is set */
+extern size_t cstl_bitset_find_first_set(struct cstl_bitset* bs);
+/* index of the first set (clear) bit at or after i, or CSTL_BITSET_NPOS */
+extern size_t cstl_bitset_find_next_set(struct cstl_bitset* bs, size_t i);
+extern size_t cstl_bitset_find_next_clear(struct cstl_bitset* bs, size_t i);
+
+/* dst = dst op src; dst keeps its size */
+extern cstl_error cstl_bitset_and(struct cstl_bitset* dst,
+                                  struct cstl_bitset* src);
+extern cstl_error cstl_bitset_or(struct cstl_bitset* dst,
+                                 struct cstl_bitset* src);
+extern cstl_error cstl_bitset_xor(struct cstl_bitset* dst,
+                                  struct cstl_bitset* src);
+/* dst = dst & ~src */
+extern cstl_error cstl_bitset_andnot(struct cstl_bitset* dst,
+                                     struct cstl_bitset* src);
+
+/* the word-array kernels behind the above, also used by cstl_roaring */
+extern size_t cstl_bitset_words_popcount(const uint64_t* w, size_t n);
+extern size_t cstl_bitset_words_next_set(const uint64_t* w, size_t n,
+                                         size_t i);
+extern void cstl_bitset_words_and(uint64_t* d, const uint64_t* s, size_t n);
+extern void cstl_bitset_words_or(uint64_t* d, const uint64_t* s, size_t n);
+extern void cstl_bitset_words_xor(uint64_t* d, const uint64_t* s, size_t n);
+extern void cstl_bitset_words_andnot(uint64_t* d, const uint64_t* s,
+                                     size_t n);
+
+#endif /* __C_STL_BITSET_H__ */
@@ -0,0 +1,58 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_BLOOM_H__
+#define __C_STL_BLOOM_H__
+
+#include <stdint.h>
+
+/*
+ * Blocked Bloom filter. A key's hash picks one 64-byte block and sets one
+ * bit in each of its eight words, so adding or testing a key touches a
+ * single cache line. With 10 bits per key about 1% of absent keys test
+ * positive. Keys cannot be taken out; rebuild the filter instead.
+ *
+ * The hashes given to the _hash functions need not be well mixed; the
+ * filter mixes them again.
+ */
+
+struct cstl_bloom;
+
+extern struct cstl_bloom* cstl_bloom_new(size_t expected,
+                                         unsigned int bits_per_key);
+extern cstl_error cstl_bloom_delete(struct cstl_bloom* b);
+extern void cstl_bloom_clear(struct cstl_bloom* b);
+/* the number of keys the filter was sized for */
+extern size_t cstl_bloom_capacity(const struct cstl_bloom* b);
+
+extern void cstl_bloom_add_hash(struct cstl_bloom* b, uint64_t h);
+extern int cstl_bloom_may_contain_hash(const struct cstl_bloom* b,
+                                       uint64_t h);
+/* the same, hashing key_size bytes of key with cstl_hash_bytes */
+extern void cstl_bloom_add(struct cstl_bloom* b, const void* key,
+                           size_t key_size);
+extern int cstl_bloom_may_contain(const struct cstl_bloom* b,
+                                  const void* key, size_t key_size);
+
+#endif /* __C_STL_BLOOM_H__ */
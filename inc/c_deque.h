@@ -45,6 +45,8 @@ extern cstl_error cstl_deque_delete(struct cstl_deque* pDeq);
 extern const void* cstl_deque_element_at(struct cstl_deque* pDeq, size_t index);
 
 extern struct cstl_iterator* cstl_deque_new_iterator(struct cstl_deque* pDeq);
+extern void cstl_deque_iterator_init(struct cstl_iterator* pItr,
+                                     struct cstl_deque* pDeq);
 extern void cstl_deque_delete_iterator(struct cstl_iterator* pItr);
 
 #endif /* __C_STL_DEQUE_H__ */
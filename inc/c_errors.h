@@ -56,7 +56,50 @@ typedef enum {
     CSTL_MAP_NOT_INITIALIZED = -501,
     CSTL_MAP_INVALID_INPUT = -502,
 
-    CSTL_SLIST_INSERT_FAILED = -601
+    CSTL_SLIST_INSERT_FAILED = -601,
+
+    CSTL_PQUEUE_NOT_INITIALIZED = -701,
+    CSTL_PQUEUE_EMPTY = -702,
+    CSTL_PQUEUE_INVALID_HANDLE = -703,
+    CSTL_PQUEUE_INVALID_INPUT = -704,
+
+    CSTL_LRU_NOT_INITIALIZED = -801,
+    CSTL_LRU_INVALID_INPUT = -802,
+
+    CSTL_TTL_MAP_NOT_INITIALIZED = -901,
+    CSTL_TTL_MAP_INVALID_INPUT = -902,
+
+    CSTL_FLAT_MAP_NOT_INITIALIZED = -1001,
+    CSTL_FLAT_MAP_INVALID_INPUT = -1002,
+
+    CSTL_STATIC_INDEX_NOT_INITIALIZED = -1101,
+
+    CSTL_RADIX_TREE_NOT_INITIALIZED = -1201,
+    CSTL_RADIX_TREE_INVALID_INPUT = -1202,
+
+    CSTL_ART_NOT_INITIALIZED = -1301,
+    CSTL_ART_INVALID_INPUT = -1302,
+
+    CSTL_LPM_NOT_INITIALIZED = -1401,
+    CSTL_LPM_INVALID_INPUT = -1402,
+
+    CSTL_BITSET_NOT_INITIALIZED = -1501,
+    CSTL_BITSET_INDEX_OUT_OF_BOUND = -1502,
+
+    CSTL_ROARING_NOT_INITIALIZED = -1601,
+
+    CSTL_BLOOM_NOT_INITIALIZED = -1701,
+
+    CSTL_STRING_POOL_NOT_INITIALIZED = -1801,
+
+    CSTL_SLOT_MAP_NOT_INITIALIZED = -1901,
+    CSTL_SLOT_MAP_INVALID_INPUT = -1902,
+    CSTL_SLOT_MAP_STALE_HANDLE = -1903,
+
+    CSTL_SPARSE_SET_NOT_INITIALIZED = -2001,
+    CSTL_SPARSE_SET_INVALID_INPUT = -2002,
+    CSTL_SPARSE_SET_KEY_DUPLICATE = -2003,
+    CSTL_SPARSE_SET_KEY_NOT_FOUND = -2004
 } cstl_error;
 
 #endif /* __C_STL_ERRORS_H__ */
@@ -0,0 +1,93 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_FLAT_MAP_H__
+#define __C_STL_FLAT_MAP_H__
+
+/*
+ * Sorted containers for tables that are built once and then mostly read.
+ * Keys and values have a fixed size given at creation and live in two
+ * parallel arrays kept in key order, so a lookup touches nothing but those
+ * arrays. Inserting or removing one element is O(n); build and insert_batch
+ * sort their input once and merge it in, for O((n + m) log m) in total.
+ *
+ * Pointers returned by find / key_at / value_at are invalidated by any
+ * modification. Keys already present are left alone by insert and
+ * insert_batch, and input elements that are not stored are not destroyed.
+ */
+
+struct cstl_flat_map;
+struct cstl_flat_set;
+
+extern struct cstl_flat_map* cstl_flat_map_new(size_t key_size,
+                                               size_t value_size,
+                                               cstl_compare fn_c,
+                                               cstl_destroy fn_k_d,
+                                               cstl_destroy fn_v_d);
+extern cstl_error cstl_flat_map_delete(struct cstl_flat_map* map);
+extern void cstl_flat_map_clear(struct cstl_flat_map* map);
+extern size_t cstl_flat_map_size(struct cstl_flat_map* map);
+extern cstl_error cstl_flat_map_reserve(struct cstl_flat_map* map, size_t n);
+
+/* replaces the contents with n unsorted key / value pairs */
+extern cstl_error cstl_flat_map_build(struct cstl_flat_map* map,
+                                      const void* keys, const void* values,
+                                      size_t n);
+extern cstl_error cstl_flat_map_insert_batch(struct cstl_flat_map* map,
+                                             const void* keys,
+                                             const void* values, size_t n);
+extern cstl_error cstl_flat_map_insert(struct cstl_flat_map* map,
+                                       const void* key, const void* value);
+extern cstl_error cstl_flat_map_remove(struct cstl_flat_map* map,
+                                       const void* key);
+extern void* cstl_flat_map_find(struct cstl_flat_map* map, const void* key);
+
+/* index of the first key not less than key, or size() */
+extern size_t cstl_flat_map_lower_bound(struct cstl_flat_map* map,
+                                        const void* key);
+extern const void* cstl_flat_map_key_at(struct cstl_flat_map* map, size_t i);
+extern void* cstl_flat_map_value_at(struct cstl_flat_map* map, size_t i);
+
+extern struct cstl_flat_set* cstl_flat_set_new(size_t key_size,
+                                               cstl_compare fn_c,
+                                               cstl_destroy fn_d);
+extern cstl_error cstl_flat_set_delete(struct cstl_flat_set* set);
+extern void cstl_flat_set_clear(struct cstl_flat_set* set);
+extern size_t cstl_flat_set_size(struct cstl_flat_set* set);
+extern cstl_error cstl_flat_set_reserve(struct cstl_flat_set* set, size_t n);
+extern cstl_error cstl_flat_set_build(struct cstl_flat_set* set,
+                                      const void* keys, size_t n);
+extern cstl_error cstl_flat_set_insert_batch(struct cstl_flat_set* set,
+                                             const void* keys, size_t n);
+extern cstl_error cstl_flat_set_insert(struct cstl_flat_set* set,
+                                       const void* key);
+extern cstl_error cstl_flat_set_remove(struct cstl_flat_set* set,
+                                       const void* key);
+extern const void* cstl_flat_set_find(struct cstl_flat_set* set,
+                                      const void* key);
+extern size_t cstl_flat_set_lower_bound(struct cstl_flat_set* set,
+                                        const void* key);
+extern const void* cstl_flat_set_key_at(struct cstl_flat_set* set, size_t i);
+
+#endif /* __C_STL_FLAT_MAP_H__ */
@@ -0,0 +1,211 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_ILIST_H__
+#define __C_STL_ILIST_H__
+
+/*
+ * Intrusive circular doubly linked list. A struct cstl_ilist_node lives
+ * inside the caller's object and cstl_container_of() gets the object back,
+ * so no operation allocates and every operation but cstl_ilist_size() is
+ * O(1). An object may sit on several lists through several nodes.
+ *
+ * A node that is on no list points at itself, which cstl_ilist_node_init()
+ * and cstl_ilist_unlink() establish. A list head points into itself too, so
+ * it must not be copied or moved while it has members.
+ */
+
+#include <stddef.h>
+
+#include "c_inline.h"
+
+struct cstl_ilist_node {
+    struct cstl_ilist_node* next;
+    struct cstl_ilist_node* prev;
+};
+
+struct cstl_ilist {
+    struct cstl_ilist_node head;
+};
+
+#define cstl_ilist_entry(node, type, member) \
+    cstl_container_of(node, type, member)
+
+/* for (node = first; node != end; node = node->next); do not unlink node */
+#define cstl_ilist_for_each(node, list) \
+    for ((node) = (list)->head.next; (node) != &(list)->head; \
+         (node) = (node)->next)
+
+/* like cstl_ilist_for_each, but node may be unlinked in the body */
+#define cstl_ilist_for_each_safe(node, tmp, list)                      \
+    for ((node) = (list)->head.next, (tmp) = (node)->next;             \
+         (node) != &(list)->head; (node) = (tmp), (tmp) = (node)->next)
+
+CSTL_INLINE void cstl_ilist_node_init(struct cstl_ilist_node* node)
+{
+    node->next = node;
+    node->prev = node;
+}
+
+CSTL_INLINE int cstl_ilist_node_is_linked(const struct cstl_ilist_node* node)
+{
+    return node->next != node;
+}
+
+CSTL_INLINE void cstl_ilist_init(struct cstl_ilist* list)
+{
+    cstl_ilist_node_init(&list->head);
+}
+
+CSTL_INLINE int cstl_ilist_empty(const struct cstl_ilist* list)
+{
+    return list->head.next == &list->head;
+}
+
+CSTL_INLINE void cstl_ilist_link_(struct cstl_ilist_node* prev,
+                                  struct cstl_ilist_node* next,
+                                  struct cstl_ilist_node* node)
+{
+    node->prev = prev;
+    node->next = next;
+    prev->next = node;
+    next->prev = node;
+}
+
+CSTL_INLINE void cstl_ilist_insert_after(struct cstl_ilist_node* pos,
+                                         struct cstl_ilist_node* node)
+{
+    cstl_ilist_link_(pos, pos->next, node);
+}
+
+CSTL_INLINE void cstl_ilist_insert_before(struct cstl_ilist_node* pos,
+                                          struct cstl_ilist_node* node)
+{
+    cstl_ilist_link_(pos->prev, pos, node);
+}
+
+CSTL_INLINE void cstl_ilist_push_front(struct cstl_ilist* list,
+                                       struct cstl_ilist_node* node)
+{
+    cstl_ilist_insert_after(&list->head, node);
+}
+
+CSTL_INLINE void cstl_ilist_push_back(struct cstl_ilist* list,
+                                      struct cstl_ilist_node* node)
+{
+    cstl_ilist_insert_before(&list->head, node);
+}
+
+/* removes node from whatever list holds it; a no-op if it is on none */
+CSTL_INLINE void cstl_ilist_unlink(struct cstl_ilist_node* node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    cstl_ilist_node_init(node);
+}
+
+CSTL_INLINE struct cstl_ilist_node* cstl_ilist_front(struct cstl_ilist* list)
+{
+    return cstl_ilist_empty(list) ? NULL : list->head.next;
+}
+
+CSTL_INLINE struct cstl_ilist_node* cstl_ilist_back(struct cstl_ilist* list)
+{
+    return cstl_ilist_empty(list) ? NULL : list->head.prev;
+}
+
+CSTL_INLINE struct cstl_ilist_node* cstl_ilist_pop_front(
+    struct cstl_ilist* list)
+{
+    struct cstl_ilist_node* node = cstl_ilist_front(list);
+    if (node) {
+        cstl_ilist_unlink(node);
+    }
+    return node;
+}
+
+CSTL_INLINE struct cstl_ilist_node* cstl_ilist_pop_back(
+    struct cstl_ilist* list)
+{
+    struct cstl_ilist_node* node = cstl_ilist_back(list);
+    if (node) {
+        cstl_ilist_unlink(node);
+    }
+    return node;
+}
+
+/* neighbours of node within list, NULL past either end */
+CSTL_INLINE struct cstl_ilist_node* cstl_ilist_next(
+    struct cstl_ilist* list, struct cstl_ilist_node* node)
+{
+    return (node->next != &list->head) ? node->next : NULL;
+}
+
+CSTL_INLINE struct cstl_ilist_node* cstl_ilist_prev(
+    struct cstl_ilist* list, struct cstl_ilist_node* node)
+{
+    return (node->prev != &list->head) ? node->prev : NULL;
+}
+
+/* moves every member of src, in order, in front of pos; src ends up empty */
+CSTL_INLINE void cstl_ilist_splice(struct cstl_ilist_node* pos,
+                                   struct cstl_ilist* src)
+{
+    struct cstl_ilist_node *first, *last;
+    if (cstl_ilist_empty(src)) {
+        return;
+    }
+    first = src->head.next;
+    last = src->head.prev;
+    first->prev = pos->prev;
+    pos->prev->next = first;
+    last->next = pos;
+    pos->prev = last;
+    cstl_ilist_init(src);
+}
+
+CSTL_INLINE void cstl_ilist_splice_back(struct cstl_ilist* dst,
+                                        struct cstl_ilist* src)
+{
+    cstl_ilist_splice(&dst->head, src);
+}
+
+CSTL_INLINE void cstl_ilist_splice_front(struct cstl_ilist* dst,
+                                         struct cstl_ilist* src)
+{
+    cstl_ilist_splice(dst->head.next, src);
+}
+
+/* O(n) */
+CSTL_INLINE size_t cstl_ilist_size(const struct cstl_ilist* list)
+{
+    const struct cstl_ilist_node* node;
+    size_t n = 0;
+    for (node = list->head.next; node != &list->head; node = node->next) {
+        n++;
+    }
+    return n;
+}
+
+#endif /* __C_STL_ILIST_H__ */
@@ -0,0 +1,82 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_INLINE_H__
+#define __C_STL_INLINE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/* storage class for small functions defined in headers */
+#if defined(__GNUC__) || defined(__clang__)
+#define CSTL_INLINE static __inline__ __attribute__((unused))
+#elif defined(_MSC_VER)
+#define CSTL_INLINE static __inline
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define CSTL_INLINE static inline
+#else
+#define CSTL_INLINE static
+#endif
+
+/* hints that the memory at p will be read soon; a no-op where unsupported */
+#if defined(__GNUC__) || defined(__clang__)
+#define cstl_prefetch(p) __builtin_prefetch((p))
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#define cstl_prefetch(p) _mm_prefetch((const char*)(p), _MM_HINT_T0)
+#else
+#define cstl_prefetch(p) ((void)(p))
+#endif
+
+/* index of the lowest set bit of x, which must not be 0 */
+CSTL_INLINE unsigned int cstl_ctz64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned int)__builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return (unsigned int)i;
+#else
+    unsigned int n = 0;
+    if ((x & 0xFFFFFFFFu) == 0) {
+        x >>= 32;
+        n += 32;
+    }
+    while (!(x & 1)) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+#define cstl_container_of(ptr, type, member) \
+    ((type*)((char*)(ptr)-offsetof(type, member)))
+
+#endif /* __C_STL_INLINE_H__ */
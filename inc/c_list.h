@@ -43,6 +43,8 @@ extern const void* cstl_list_element_at(struct cstl_list* pList, size_t pos);
 extern size_t cstl_list_size(struct cstl_list* pList);
 
 extern struct cstl_iterator* cstl_list_new_iterator(struct cstl_list* pSlit);
+extern void cstl_list_iterator_init(struct cstl_iterator* pItr,
+                                    struct cstl_list* pSlit);
 extern void cstl_list_delete_iterator(struct cstl_iterator* pItr);
 
 #endif /* __C_STL_LIST_H__ */
@@ -0,0 +1,92 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_LPM_H__
+#define __C_STL_LPM_H__
+
+/*
+ * Longest-prefix-match table for IPv4 or IPv6 routes. Addresses are bytes
+ * in network order (struct in_addr / in6_addr), prefixes are an address
+ * and a length in bits.
+ *
+ * Lookups index a 65536-entry table with the first 16 bits of the address
+ * and, where longer prefixes exist, 256-entry tables with each further
+ * byte: at most 3 reads for IPv4 and 15 for IPv6, with no comparisons.
+ * Every entry already holds the best route for its range, so inserting or
+ * removing a prefix rewrites only the entries that prefix covers.
+ *
+ * Values are copied, as in cstl_map, and fn_v_d (if any) is called on them
+ * when their prefix is removed. Every route needs a value: inserting a NULL
+ * value or a value_size of 0 fails with CSTL_LPM_INVALID_INPUT, so a NULL
+ * from find or lookup always means no route.
+ */
+
+typedef enum {
+    CSTL_LPM_IPV4,
+    CSTL_LPM_IPV6
+} cstl_lpm_family;
+
+struct cstl_lpm_prefix {
+    unsigned char addr[16]; /* only the first 4 bytes for IPv4 */
+    unsigned char len;
+    const void* value;
+    size_t value_size;
+};
+
+struct cstl_lpm;
+
+extern struct cstl_lpm* cstl_lpm_new(cstl_lpm_family family,
+                                     cstl_destroy fn_v_d);
+extern cstl_error cstl_lpm_delete(struct cstl_lpm* lpm);
+extern size_t cstl_lpm_size(struct cstl_lpm* lpm);
+
+/* address bits past len are ignored */
+extern cstl_error cstl_lpm_insert(struct cstl_lpm* lpm, const void* addr,
+                                  unsigned int len, const void* value,
+                                  size_t value_size);
+/*
+ * Inserts shorter prefixes first; prefixes already present are skipped.
+ * Stops at the first prefix that fails, leaving the earlier ones inserted.
+ */
+extern cstl_error cstl_lpm_insert_batch(struct cstl_lpm* lpm,
+                                        const struct cstl_lpm_prefix* prefixes,
+                                        size_t n);
+extern cstl_error cstl_lpm_remove(struct cstl_lpm* lpm, const void* addr,
+                                  unsigned int len);
+/* value of exactly this prefix */
+extern const void* cstl_lpm_find(struct cstl_lpm* lpm, const void* addr,
+                                 unsigned int len);
+
+/*
+ * Value of the longest prefix containing addr, or NULL. Its length goes to
+ * *prefix_len if not NULL.
+ */
+extern const void* cstl_lpm_lookup(struct cstl_lpm* lpm, const void* addr,
+                                   unsigned int* prefix_len);
+/* looks up n addresses, returns how many matched */
+extern size_t cstl_lpm_lookup_batch(struct cstl_lpm* lpm,
+                                    const void* const addrs[], size_t n,
+                                    const void* out_values[]);
+
+#endif /* __C_STL_LPM_H__ */
@@ -0,0 +1,67 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_LRU_H__
+#define __C_STL_LRU_H__
+
+/*
+ * Least-recently-used cache. Keys and values are copied into a single
+ * allocation per entry that sits both on a hash chain and on a recency
+ * list, so get (which promotes), put and remove are O(1).
+ *
+ * The capacity counts entries, or the bytes of key plus value. A put that
+ * exceeds it evicts from the least recently used end. fn_e, when given, is
+ * called for every entry that leaves the cache: evicted, replaced by a put
+ * of the same key, removed, cleared or deleted with the cache.
+ *
+ * Keys are equal when their sizes match and fn_c returns 0 (memcmp when
+ * fn_c is NULL); fn_h hashes a key (cstl_hash_bytes when NULL).
+ */
+
+typedef enum { CSTL_LRU_ENTRIES = 0, CSTL_LRU_BYTES = 1 } cstl_lru_unit;
+
+typedef void (*cstl_lru_evict)(const void* key, size_t key_size, void* value,
+                               size_t value_size, void* p);
+
+struct cstl_lru;
+
+extern struct cstl_lru* cstl_lru_new(size_t capacity, cstl_lru_unit unit,
+                                     cstl_hash fn_h, cstl_compare fn_c,
+                                     cstl_lru_evict fn_e, void* p);
+extern void cstl_lru_delete(struct cstl_lru* lru);
+extern void cstl_lru_clear(struct cstl_lru* lru);
+extern size_t cstl_lru_size(struct cstl_lru* lru);
+extern size_t cstl_lru_usage(struct cstl_lru* lru);
+
+extern cstl_error cstl_lru_put(struct cstl_lru* lru, const void* key,
+                               size_t key_size, const void* value,
+                               size_t value_size);
+extern void* cstl_lru_get(struct cstl_lru* lru, const void* key,
+                          size_t key_size);
+extern void* cstl_lru_peek(struct cstl_lru* lru, const void* key,
+                           size_t key_size);
+extern cstl_error cstl_lru_remove(struct cstl_lru* lru, const void* key,
+                                  size_t key_size);
+
+#endif /* __C_STL_LRU_H__ */
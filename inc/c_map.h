@@ -25,6 +25,12 @@
 #ifndef __C_STL_MAP_H__
 #define __C_STL_MAP_H__
 
+/*
+ * Maps with at most this many entries keep them in one sorted array instead
+ * of an rb-tree; see cstl_map_small_limit().
+ */
+#define CSTL_MAP_SMALL_LIMIT 8
+
 struct cstl_map;
 
 extern struct cstl_map* cstl_map_new(cstl_compare fn_c_k, cstl_destroy fn_k_d,
@@ -37,9 +43,31 @@ extern cstl_error cstl_map_replace(struct cstl_map* pMap, const void* key,
                                    const void* value, size_t value_size);
 extern cstl_error cstl_map_remove(struct cstl_map* pMap, const void* key);
 extern const void* cstl_map_find(struct cstl_map* pMap, const void* key);
+extern size_t cstl_map_find_batch(struct cstl_map* pMap,
+                                  const void* const keys[], size_t n,
+                                  const void* out_values[]);
 extern cstl_error cstl_map_delete(struct cstl_map* pMap);
 
+/*
+ * Sets how many entries the map keeps in its array before it turns into an
+ * rb-tree; it turns back once it shrinks to half of that. 0 means always a
+ * tree. Pointers returned by cstl_map_find() stay valid either way.
+ */
+extern cstl_error cstl_map_small_limit(struct cstl_map* pMap, size_t limit);
+
+/*
+ * Puts a blocked Bloom filter (see c_bloom.h) in front of lookups, as
+ * cstl_set_bloom() does for sets: every key must be key_size bytes long,
+ * fn_h hashes it (cstl_hash_bytes when NULL) and bits_per_key 0 drops the
+ * filter. Removed keys stay in it until cstl_map_bloom_rebuild().
+ */
+extern cstl_error cstl_map_bloom(struct cstl_map* pMap, size_t key_size,
+                                 cstl_hash fn_h, unsigned int bits_per_key);
+extern cstl_error cstl_map_bloom_rebuild(struct cstl_map* pMap);
+
 extern struct cstl_iterator* cstl_map_new_iterator(struct cstl_map* pMap);
+extern void cstl_map_iterator_init(struct cstl_iterator* pItr,
+                                   struct cstl_map* pMap);
 extern void cstl_map_delete_iterator(struct cstl_iterator* pItr);
 
 typedef void (*map_iter_callback)(struct cstl_map* map, const void* key,
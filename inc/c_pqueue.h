@@ -0,0 +1,79 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_PQUEUE_H__
+#define __C_STL_PQUEUE_H__
+
+/*
+ * Priority queue on a flat d-ary heap. Elements of a fixed size are copied
+ * into the heap array; `fn_c(a, b) < 0` means a leaves the queue before b.
+ *
+ * push() hands out a handle that stays attached to the element while it is
+ * queued, wherever the heap moves it, so the element can later be read,
+ * re-prioritized or erased in O(log_d n) without a search. A handle is
+ * invalid once its element has been popped or erased, and may be reused.
+ *
+ * Elements leaving through pop()/erase() with a non-NULL `out` are copied
+ * there and are not destroyed; otherwise fn_d (if any) is called on them.
+ */
+
+typedef size_t cstl_pqueue_handle;
+
+/* never a valid handle; cstl_pqueue_top_handle() of an empty queue */
+#define CSTL_PQUEUE_HANDLE_NONE ((cstl_pqueue_handle)-1)
+
+#define CSTL_PQUEUE_DEFAULT_ARITY 4
+
+struct cstl_pqueue;
+
+extern struct cstl_pqueue* cstl_pqueue_new(size_t elem_size, size_t arity,
+                                           cstl_compare fn_c,
+                                           cstl_destroy fn_d);
+extern void cstl_pqueue_delete(struct cstl_pqueue* pq);
+extern size_t cstl_pqueue_size(struct cstl_pqueue* pq);
+extern int cstl_pqueue_is_empty(struct cstl_pqueue* pq);
+extern cstl_error cstl_pqueue_reserve(struct cstl_pqueue* pq, size_t n);
+
+extern cstl_error cstl_pqueue_push(struct cstl_pqueue* pq, const void* elem,
+                                   cstl_pqueue_handle* handle);
+extern const void* cstl_pqueue_top(struct cstl_pqueue* pq);
+/* CSTL_PQUEUE_HANDLE_NONE when the queue is empty */
+extern cstl_pqueue_handle cstl_pqueue_top_handle(struct cstl_pqueue* pq);
+extern cstl_error cstl_pqueue_pop(struct cstl_pqueue* pq, void* out);
+
+extern const void* cstl_pqueue_get(struct cstl_pqueue* pq,
+                                   cstl_pqueue_handle handle);
+extern cstl_error cstl_pqueue_update(struct cstl_pqueue* pq,
+                                     cstl_pqueue_handle handle,
+                                     const void* elem);
+extern cstl_error cstl_pqueue_decrease_key(struct cstl_pqueue* pq,
+                                           cstl_pqueue_handle handle,
+                                           const void* elem);
+extern cstl_error cstl_pqueue_increase_key(struct cstl_pqueue* pq,
+                                           cstl_pqueue_handle handle,
+                                           const void* elem);
+extern cstl_error cstl_pqueue_erase(struct cstl_pqueue* pq,
+                                    cstl_pqueue_handle handle, void* out);
+
+#endif /* __C_STL_PQUEUE_H__ */
@@ -0,0 +1,81 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_RADIX_TREE_H__
+#define __C_STL_RADIX_TREE_H__
+
+/*
+ * Path-compressed trie over byte strings. Every edge carries a run of key
+ * bytes, so a lookup reads each byte of the key once and never compares
+ * whole keys. Besides exact lookups it answers longest-prefix queries and
+ * walks every key under a prefix, in byte-wise lexicographic order.
+ *
+ * A tree created with CSTL_RADIX_REVERSED stores its keys back to front, so
+ * the same calls match suffixes instead: with ".example.com" inserted, the
+ * longest "prefix" of ".www.example.com" is ".example.com". Keys are passed
+ * and reported in their normal order either way.
+ *
+ * Values are copied, as in cstl_map, and fn_v_d (if any) is called on them
+ * when they are removed.
+ */
+
+typedef enum {
+    CSTL_RADIX_FORWARD,
+    CSTL_RADIX_REVERSED
+} cstl_radix_order;
+
+typedef void (*cstl_radix_walker)(const void* key, size_t key_len,
+                                  void* value, int* stop, void* p);
+
+struct cstl_radix_tree;
+
+extern struct cstl_radix_tree* cstl_radix_tree_new(cstl_radix_order order,
+                                                   cstl_destroy fn_v_d);
+extern cstl_error cstl_radix_tree_delete(struct cstl_radix_tree* tree);
+extern size_t cstl_radix_tree_size(struct cstl_radix_tree* tree);
+
+extern cstl_error cstl_radix_tree_insert(struct cstl_radix_tree* tree,
+                                         const void* key, size_t key_len,
+                                         const void* value,
+                                         size_t value_size);
+extern cstl_error cstl_radix_tree_remove(struct cstl_radix_tree* tree,
+                                         const void* key, size_t key_len);
+extern void* cstl_radix_tree_find(struct cstl_radix_tree* tree,
+                                  const void* key, size_t key_len);
+
+/*
+ * Value of the longest stored key that is a prefix of key (a suffix, for a
+ * reversed tree), or NULL. Its length goes to *match_len if not NULL.
+ */
+extern void* cstl_radix_tree_longest_prefix(struct cstl_radix_tree* tree,
+                                            const void* key, size_t key_len,
+                                            size_t* match_len);
+
+/* calls fn for every key starting with prefix (ending, if reversed) */
+extern void cstl_radix_tree_walk_prefix(struct cstl_radix_tree* tree,
+                                        const void* prefix,
+                                        size_t prefix_len,
+                                        cstl_radix_walker fn, void* p);
+
+#endif /* __C_STL_RADIX_TREE_H__ */
@@ -0,0 +1,99 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_ROARING_H__
+#define __C_STL_ROARING_H__
+
+#include <stdint.h>
+
+/*
+ * Compressed set of 32-bit integers (a Roaring bitmap). Values are grouped
+ * by their high 16 bits, and each group of up to 65536 low halves is held
+ * in whichever container is smallest for it: a sorted array (up to 4096
+ * values), an 8 KB bitmap, or a list of runs of consecutive values.
+ *
+ * Set operations combine matching containers pairwise and skip groups
+ * present on one side only. Their results use array and bitmap containers;
+ * cstl_roaring_run_optimize() turns containers into runs where that is
+ * smaller.
+ *
+ * cstl_roaring_save() writes the portable Roaring format shared by the
+ * CRoaring, Java and Go implementations, so images can be exchanged with
+ * them.
+ */
+
+struct cstl_roaring;
+
+typedef void (*cstl_roaring_walker)(uint32_t value, int* stop, void* p);
+
+extern struct cstl_roaring* cstl_roaring_new(void);
+extern struct cstl_roaring* cstl_roaring_copy(const struct cstl_roaring* r);
+extern cstl_error cstl_roaring_delete(struct cstl_roaring* r);
+
+extern cstl_error cstl_roaring_add(struct cstl_roaring* r, uint32_t value);
+/* adds every value from first to last, both included */
+extern cstl_error cstl_roaring_add_range(struct cstl_roaring* r,
+                                         uint32_t first, uint32_t last);
+extern cstl_error cstl_roaring_remove(struct cstl_roaring* r,
+                                      uint32_t value);
+extern int cstl_roaring_contains(const struct cstl_roaring* r,
+                                 uint32_t value);
+extern uint64_t cstl_roaring_cardinality(const struct cstl_roaring* r);
+
+/* number of values not greater than value */
+extern uint64_t cstl_roaring_rank(const struct cstl_roaring* r,
+                                  uint32_t value);
+/* the k-th smallest value (from 0) into *value; 0 if there are not k + 1 */
+extern int cstl_roaring_select(const struct cstl_roaring* r, uint64_t k,
+                               uint32_t* value);
+/* the smallest value not less than from into *value; 0 if there is none */
+extern int cstl_roaring_next(const struct cstl_roaring* r, uint32_t from,
+                             uint32_t* value);
+/* calls fn for every value in increasing order */
+extern void cstl_roaring_traverse(const struct cstl_roaring* r,
+                                  cstl_roaring_walker fn, void* p);
+
+/* dst = dst op src; src may be dst */
+extern cstl_error cstl_roaring_or(struct cstl_roaring* dst,
+                                  const struct cstl_roaring* src);
+extern cstl_error cstl_roaring_and(struct cstl_roaring* dst,
+                                   const struct cstl_roaring* src);
+extern cstl_error cstl_roaring_andnot(struct cstl_roaring* dst,
+                                      const struct cstl_roaring* src);
+extern cstl_error cstl_roaring_xor(struct cstl_roaring* dst,
+                                   const struct cstl_roaring* src);
+
+/* converts containers to runs, or from runs, whichever is smallest */
+extern cstl_error cstl_roaring_run_optimize(struct cstl_roaring* r);
+
+/*
+ * Writes the portable image to buf if it holds at least the returned number
+ * of bytes; call with size 0 to query the size. load returns NULL for a
+ * malformed image.
+ */
+extern size_t cstl_roaring_save(const struct cstl_roaring* r, void* buf,
+                                size_t size);
+extern struct cstl_roaring* cstl_roaring_load(const void* buf, size_t size);
+
+#endif /* __C_STL_ROARING_H__ */
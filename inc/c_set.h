@@ -27,6 +27,12 @@
 
 #include "c_stl_lib.h"
 
+/*
+ * Sets with at most this many keys keep them in one sorted array instead of
+ * an rb-tree; see cstl_set_small_limit().
+ */
+#define CSTL_SET_SMALL_LIMIT 8
+
 struct cstl_set;
 
 extern struct cstl_set* cstl_set_new(cstl_compare fn_c, cstl_destroy fn_d);
@@ -35,9 +41,34 @@ extern cstl_error cstl_set_insert(struct cstl_set* pSet, void* key,
 extern int cstl_set_is_key_exists(struct cstl_set* pSet, void* key);
 extern cstl_error cstl_set_remove(struct cstl_set* pSet, void* key);
 extern const void* cstl_set_find(struct cstl_set* pSet, const void* key);
+extern size_t cstl_set_find_batch(struct cstl_set* pSet,
+                                  const void* const keys[], size_t n,
+                                  const void* out_keys[]);
 extern cstl_error cstl_set_delete(struct cstl_set* pSet);
 
+/*
+ * Sets how many keys the set keeps in its array before it turns into an
+ * rb-tree; it turns back once it shrinks to half of that. 0 means always a
+ * tree. Keys stay where they are across either change.
+ */
+extern cstl_error cstl_set_small_limit(struct cstl_set* pSet, size_t limit);
+
+/*
+ * Puts a blocked Bloom filter (see c_bloom.h) in front of lookups, so that
+ * most misses cost one cache line instead of a tree descent. Every key must
+ * be key_size bytes long; fn_h hashes it (cstl_hash_bytes when NULL).
+ * bits_per_key trades memory for fewer false positives, 10 giving about 1%;
+ * 0 drops the filter. Insertions keep the filter up to date and grow it.
+ * Removed keys stay in it, costing only false positives, until
+ * cstl_set_bloom_rebuild().
+ */
+extern cstl_error cstl_set_bloom(struct cstl_set* pSet, size_t key_size,
+                                 cstl_hash fn_h, unsigned int bits_per_key);
+extern cstl_error cstl_set_bloom_rebuild(struct cstl_set* pSet);
+
 extern struct cstl_iterator* cstl_set_new_iterator(struct cstl_set* pSet);
+extern void cstl_set_iterator_init(struct cstl_iterator* pItr,
+                                   struct cstl_set* pSet);
 extern void cstl_set_delete_iterator(struct cstl_iterator* pItr);
 
 typedef void (*fn_cstl_set_iter)(struct cstl_set* set, const void* obj,
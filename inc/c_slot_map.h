@@ -0,0 +1,77 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_SLOT_MAP_H__
+#define __C_STL_SLOT_MAP_H__
+
+#include <stdint.h>
+
+/*
+ * Values of one fixed size, addressed by 64-bit handles. The values are
+ * kept packed in one array, so iterating touches only live ones; a handle
+ * names a slot plus the generation the slot had when the value went in, so
+ * once the value is erased the handle goes stale instead of reaching
+ * whatever reuses the slot. Insert, erase and get are O(1).
+ *
+ * A slot is retired for good after 2^31 values have used it, rather than
+ * letting its generation wrap around, so an old handle never matches a
+ * later value. This costs a few bytes per retired slot.
+ *
+ * Erasing moves the last value into the hole: pointers from get() and
+ * positions in cstl_slot_map_data() last only until the next insert or
+ * erase, while handles last until their own value is erased.
+ */
+
+typedef uint64_t cstl_slot_handle;
+
+/* never returned by insert, and always stale */
+#define CSTL_SLOT_HANDLE_NULL ((cstl_slot_handle)0)
+
+struct cstl_slot_map;
+
+extern struct cstl_slot_map* cstl_slot_map_new(size_t value_size,
+                                               cstl_destroy fn_d);
+extern cstl_error cstl_slot_map_delete(struct cstl_slot_map* sm);
+extern size_t cstl_slot_map_size(struct cstl_slot_map* sm);
+extern cstl_error cstl_slot_map_reserve(struct cstl_slot_map* sm, size_t n);
+extern void cstl_slot_map_clear(struct cstl_slot_map* sm);
+
+/* copies value in and stores its handle in *handle */
+extern cstl_error cstl_slot_map_insert(struct cstl_slot_map* sm,
+                                       const void* value,
+                                       cstl_slot_handle* handle);
+extern cstl_error cstl_slot_map_erase(struct cstl_slot_map* sm,
+                                      cstl_slot_handle handle);
+/* the value of handle, or NULL if the handle is stale */
+extern void* cstl_slot_map_get(struct cstl_slot_map* sm,
+                               cstl_slot_handle handle);
+extern int cstl_slot_map_contains(struct cstl_slot_map* sm,
+                                  cstl_slot_handle handle);
+
+/* the size() values, packed, and the handle of the i-th of them */
+extern void* cstl_slot_map_data(struct cstl_slot_map* sm);
+extern cstl_slot_handle cstl_slot_map_handle_at(struct cstl_slot_map* sm,
+                                                size_t i);
+
+#endif /* __C_STL_SLOT_MAP_H__ */
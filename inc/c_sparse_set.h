@@ -0,0 +1,77 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_SPARSE_SET_H__
+#define __C_STL_SPARSE_SET_H__
+
+#include <stdint.h>
+
+/*
+ * Set of small unsigned integers kept as a sparse array indexed by value
+ * and a dense array of the members. Insert, erase, contains and clear are
+ * O(1), and the members can be walked packed through cstl_sparse_set_data.
+ * The sparse array grows to the largest value inserted, so values should
+ * stay small and dense, like file descriptors.
+ *
+ * cstl_fd_map is the same structure with a fixed-size value stored next to
+ * each member: finding the value of an fd is one index into the sparse
+ * array and one into the values, with no comparisons.
+ *
+ * Erasing moves the last member into the hole, so positions in data() and
+ * pointers to values last only until the next insert or erase.
+ */
+
+struct cstl_sparse_set;
+struct cstl_fd_map;
+
+/* universe is a hint: values below it fit without growing */
+extern struct cstl_sparse_set* cstl_sparse_set_new(size_t universe);
+extern cstl_error cstl_sparse_set_delete(struct cstl_sparse_set* ss);
+extern size_t cstl_sparse_set_size(struct cstl_sparse_set* ss);
+extern cstl_error cstl_sparse_set_insert(struct cstl_sparse_set* ss,
+                                         uint32_t value);
+extern cstl_error cstl_sparse_set_erase(struct cstl_sparse_set* ss,
+                                        uint32_t value);
+extern int cstl_sparse_set_contains(struct cstl_sparse_set* ss,
+                                    uint32_t value);
+extern void cstl_sparse_set_clear(struct cstl_sparse_set* ss);
+/* the size() members, in no particular order */
+extern const uint32_t* cstl_sparse_set_data(struct cstl_sparse_set* ss);
+
+extern struct cstl_fd_map* cstl_fd_map_new(size_t value_size,
+                                           cstl_destroy fn_d);
+extern cstl_error cstl_fd_map_delete(struct cstl_fd_map* fm);
+extern size_t cstl_fd_map_size(struct cstl_fd_map* fm);
+/* copies value in; an fd already present is CSTL_SPARSE_SET_KEY_DUPLICATE */
+extern cstl_error cstl_fd_map_insert(struct cstl_fd_map* fm, int fd,
+                                     const void* value);
+extern cstl_error cstl_fd_map_erase(struct cstl_fd_map* fm, int fd);
+/* the value of fd, or NULL if fd is not present */
+extern void* cstl_fd_map_find(struct cstl_fd_map* fm, int fd);
+extern void cstl_fd_map_clear(struct cstl_fd_map* fm);
+/* the size() values, packed, and the fd of the i-th of them */
+extern void* cstl_fd_map_data(struct cstl_fd_map* fm);
+extern int cstl_fd_map_fd_at(struct cstl_fd_map* fm, size_t i);
+
+#endif /* __C_STL_SPARSE_SET_H__ */
@@ -0,0 +1,73 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_STATIC_INDEX_H__
+#define __C_STL_STATIC_INDEX_H__
+
+/*
+ * Immutable search index over fixed-size keys (and optionally values),
+ * laid out in Eytzinger order: the implicit binary tree with the root at 1
+ * and the children of k at 2k and 2k + 1, stored breadth first. The top
+ * levels of every search share a few cache lines, and the 16 possible
+ * nodes four levels below k are adjacent, so the descent prefetches them
+ * instead of waiting for each level in turn.
+ *
+ * Sources are copied; the index does not track later changes to them and
+ * never destroys keys or values. A set or map source must hold keys (and
+ * values) of exactly key_size (value_size) bytes, ordered by fn_c.
+ */
+
+struct cstl_static_index;
+struct cstl_set;
+struct cstl_map;
+
+/* keys must be sorted by fn_c and free of duplicates; values may be NULL */
+extern struct cstl_static_index* cstl_static_index_from_array(
+    const void* keys, const void* values, size_t n, size_t key_size,
+    size_t value_size, cstl_compare fn_c);
+extern struct cstl_static_index* cstl_static_index_from_set(
+    struct cstl_set* set, size_t key_size, cstl_compare fn_c);
+extern struct cstl_static_index* cstl_static_index_from_map(
+    struct cstl_map* map, size_t key_size, size_t value_size,
+    cstl_compare fn_c);
+extern cstl_error cstl_static_index_delete(struct cstl_static_index* index);
+extern size_t cstl_static_index_size(struct cstl_static_index* index);
+
+/* value stored with key, or the stored key itself if there are no values */
+extern const void* cstl_static_index_find(struct cstl_static_index* index,
+                                          const void* key);
+/* first stored key not less than key, or NULL */
+extern const void* cstl_static_index_lower_bound(
+    struct cstl_static_index* index, const void* key);
+/* value stored with a key pointer returned by the index */
+extern const void* cstl_static_index_value(struct cstl_static_index* index,
+                                           const void* stored_key);
+
+extern struct cstl_iterator* cstl_static_index_new_iterator(
+    struct cstl_static_index* index);
+extern void cstl_static_index_iterator_init(struct cstl_iterator* pItr,
+                                            struct cstl_static_index* index);
+extern void cstl_static_index_delete_iterator(struct cstl_iterator* pItr);
+
+#endif /* __C_STL_STATIC_INDEX_H__ */
@@ -36,6 +36,7 @@
 typedef void (*cstl_destroy)(void*);
 typedef int (*cstl_compare)(const void*, const void*);
 typedef void (*cstl_traversal)(void*);
+typedef size_t (*cstl_hash)(const void* key, size_t key_size);
 
 /* ------------------------------------------------------------------------*/
 /*                            P  A  I   R                                  */
@@ -54,10 +55,26 @@ struct cstl_iterator {
 
 #include "c_algorithms.h"
 #include "c_array.h"
+#include "c_art.h"
+#include "c_bitset.h"
+#include "c_bloom.h"
 #include "c_deque.h"
+#include "c_flat_map.h"
+#include "c_ilist.h"
 #include "c_list.h"
+#include "c_lpm.h"
+#include "c_lru.h"
 #include "c_map.h"
+#include "c_pqueue.h"
+#include "c_radix_tree.h"
+#include "c_roaring.h"
 #include "c_set.h"
+#include "c_slot_map.h"
+#include "c_sparse_set.h"
+#include "c_static_index.h"
+#include "c_string_pool.h"
+#include "c_timer_wheel.h"
+#include "c_ttl_map.h"
 
 /* ------------------------------------------------------------------------*/
 /*            H E L P E R       F U N C T I O N S                          */
@@ -65,6 +82,7 @@ struct cstl_iterator {
 
 extern void cstl_copy(void* destination, void* source, size_t size);
 extern void cstl_get(void* destination, void* source, size_t size);
+extern size_t cstl_hash_bytes(const void* key, size_t key_size);
 
 struct cstl_object;
 
@@ -0,0 +1,67 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_STRING_POOL_H__
+#define __C_STL_STRING_POOL_H__
+
+/*
+ * String interning table. Each distinct string is copied once into an
+ * arena of large blocks and indexed by hash; interning it again returns the
+ * same canonical pointer, which stays valid until the pool is deleted.
+ * Interned strings are NUL-terminated and may contain NULs themselves.
+ *
+ * Two strings from one pool are equal exactly when their pointers are, so
+ * maps and sets can key on the pointer alone: store the const char* by
+ * value and compare with cstl_string_pool_compare.
+ *
+ *   struct cstl_map* m = cstl_map_new(cstl_string_pool_compare, NULL, NULL);
+ *   const char* host = cstl_string_pool_intern(pool, name);
+ *   cstl_map_insert(m, &host, sizeof(host), &v, sizeof(v));
+ *
+ * Such containers order keys by address, not alphabetically.
+ */
+
+struct cstl_string_pool;
+
+extern struct cstl_string_pool* cstl_string_pool_new(void);
+extern cstl_error cstl_string_pool_delete(struct cstl_string_pool* pool);
+/* number of distinct strings, and bytes held by the arena and the index */
+extern size_t cstl_string_pool_size(struct cstl_string_pool* pool);
+extern size_t cstl_string_pool_memory(struct cstl_string_pool* pool);
+
+/* the canonical copy of s, added if new; NULL when out of memory */
+extern const char* cstl_string_pool_intern(struct cstl_string_pool* pool,
+                                           const char* s);
+extern const char* cstl_string_pool_intern_n(struct cstl_string_pool* pool,
+                                             const char* s, size_t len);
+/* the canonical copy of s, or NULL if it was never interned */
+extern const char* cstl_string_pool_find(struct cstl_string_pool* pool,
+                                         const char* s, size_t len);
+/* length of an interned string, found without scanning for the NUL */
+extern size_t cstl_string_pool_length(const char* interned);
+
+/* compares two keys holding interned pointers, by identity */
+extern int cstl_string_pool_compare(const void* left, const void* right);
+
+#endif /* __C_STL_STRING_POOL_H__ */
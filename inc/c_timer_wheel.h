@@ -0,0 +1,73 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_TIMER_WHEEL_H__
+#define __C_STL_TIMER_WHEEL_H__
+
+/*
+ * Hierarchical timing wheel. Time is an unsigned tick count chosen by the
+ * caller (milliseconds, jiffies, ...). A struct cstl_timer is embedded in
+ * the caller's object, so scheduling never allocates; schedule, cancel and
+ * re-arm are O(1). cstl_timer_wheel_advance() fires, in tick order, every
+ * timer whose expiry is not later than `now`.
+ *
+ * Level 0 has one slot per tick, and each further level covers 64 times the
+ * span of the one below. Timers further away than the top level wait on an
+ * overflow list that is re-examined once per top-level turn.
+ *
+ * A callback may cancel or re-arm any timer, including the one it was
+ * called for; a timer re-armed to a tick already reached fires on the
+ * next tick.
+ */
+
+#include <stdint.h>
+
+#include "c_ilist.h"
+
+struct cstl_timer {
+    struct cstl_ilist_node node; /* private */
+    uint64_t expires;            /* read only; set by schedule */
+};
+
+typedef void (*cstl_timer_cb)(struct cstl_timer* timer, void* p);
+
+struct cstl_timer_wheel;
+
+extern struct cstl_timer_wheel* cstl_timer_wheel_new(uint64_t now);
+extern void cstl_timer_wheel_delete(struct cstl_timer_wheel* w);
+extern uint64_t cstl_timer_wheel_now(struct cstl_timer_wheel* w);
+extern size_t cstl_timer_wheel_count(struct cstl_timer_wheel* w);
+
+extern void cstl_timer_init(struct cstl_timer* timer);
+extern int cstl_timer_is_armed(const struct cstl_timer* timer);
+extern void cstl_timer_wheel_schedule(struct cstl_timer_wheel* w,
+                                      struct cstl_timer* timer,
+                                      uint64_t expires);
+extern void cstl_timer_wheel_cancel(struct cstl_timer_wheel* w,
+                                    struct cstl_timer* timer);
+extern size_t cstl_timer_wheel_advance(struct cstl_timer_wheel* w,
+                                       uint64_t now, cstl_timer_cb cb,
+                                       void* p);
+
+#endif /* __C_STL_TIMER_WHEEL_H__ */
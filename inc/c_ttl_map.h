@@ -0,0 +1,71 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_TTL_MAP_H__
+#define __C_STL_TTL_MAP_H__
+
+/*
+ * Ordered map whose entries expire `ttl` ticks after they were inserted or
+ * last touched. Time is a caller-chosen tick count passed to each call.
+ *
+ * Expiry is incremental: insert, find and touch first drop up to
+ * `work_per_op` entries that are due, and cstl_ttl_map_expire() drops up to
+ * `max_work` more on demand. A due entry that has not been dropped yet is
+ * already invisible to find and touch. The deadlines are kept in a heap, so
+ * no call ever scans the whole map.
+ *
+ * Keys and values are copied, as in cstl_map. Dropped entries are passed to
+ * the expiry callback, if set, before fn_k_d / fn_v_d run.
+ */
+
+#include <stdint.h>
+
+typedef void (*cstl_ttl_map_expired)(const void* key, void* value, void* p);
+
+struct cstl_ttl_map;
+
+extern struct cstl_ttl_map* cstl_ttl_map_new(cstl_compare fn_c_k,
+                                             cstl_destroy fn_k_d,
+                                             cstl_destroy fn_v_d,
+                                             size_t work_per_op);
+extern void cstl_ttl_map_on_expire(struct cstl_ttl_map* map,
+                                   cstl_ttl_map_expired fn, void* p);
+extern cstl_error cstl_ttl_map_delete(struct cstl_ttl_map* map);
+extern size_t cstl_ttl_map_size(struct cstl_ttl_map* map);
+
+extern cstl_error cstl_ttl_map_insert(struct cstl_ttl_map* map,
+                                      const void* key, size_t key_size,
+                                      const void* value, size_t value_size,
+                                      uint64_t now, uint64_t ttl);
+extern void* cstl_ttl_map_find(struct cstl_ttl_map* map, const void* key,
+                               uint64_t now);
+extern cstl_error cstl_ttl_map_touch(struct cstl_ttl_map* map,
+                                     const void* key, uint64_t now,
+                                     uint64_t ttl);
+extern cstl_error cstl_ttl_map_remove(struct cstl_ttl_map* map,
+                                      const void* key);
+extern size_t cstl_ttl_map_expire(struct cstl_ttl_map* map, uint64_t now,
+                                  size_t max_work);
+
+#endif /* __C_STL_TTL_MAP_H__ */
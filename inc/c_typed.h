@@ -0,0 +1,413 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __C_STL_TYPED_H__
+#define __C_STL_TYPED_H__
+
+/*
+ * Typed containers generated by macros. Keys and values are stored by value
+ * inside a single allocation per entry and the comparator is expanded in
+ * place, so the compiler can inline it into the tree descent.
+ *
+ *   #define cmp_u64(a, b) ((*(a) > *(b)) - (*(a) < *(b)))
+ *   CSTL_DEFINE_MAP(sess_map, uint64_t, struct session, cmp_u64)
+ *   CSTL_DEFINE_ARRAY(int_array, int)
+ *   CSTL_DEFINE_SMALL_VECTOR(arg_vec, struct arg, 8)
+ *
+ * `cmp` is called with two `const K*` and may be a function or a macro.
+ * K, V and T must be assignable types. The map rebalances through the
+ * rb-tree link interface, so it links against the cstl library.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "c_errors.h"
+#include "c_inline.h"
+#include "rb-tree.h"
+
+#define CSTL_TYPED_FN CSTL_INLINE
+
+/* ------------------------------------------------------------------------*/
+/*                          T Y P E D    M A P                             */
+/* ------------------------------------------------------------------------*/
+
+#define CSTL_DEFINE_MAP(name, K, V, cmp)                                      \
+    struct name##_node {                                                      \
+        struct rbt_link link; /* must stay the first member */               \
+        K key;                                                                \
+        V value;                                                              \
+    };                                                                        \
+    struct name {                                                             \
+        struct rbt_root root;                                                 \
+        struct rbt_link nil;                                                  \
+        size_t size;                                                          \
+    };                                                                        \
+    CSTL_TYPED_FN void name##_init(struct name* m)                            \
+    {                                                                         \
+        rbt_root_init(&m->root, &m->nil);                                     \
+        m->size = 0;                                                          \
+    }                                                                         \
+    CSTL_TYPED_FN void name##_release_node_(struct rbt_link* link, void* p)   \
+    {                                                                         \
+        (void)p;                                                              \
+        free(link);                                                           \
+    }                                                                         \
+    CSTL_TYPED_FN void name##_clear(struct name* m)                           \
+    {                                                                         \
+        rbt_root_clear(&m->root, name##_release_node_, NULL);                 \
+        m->size = 0;                                                          \
+    }                                                                         \
+    CSTL_TYPED_FN struct name* name##_new(void)                               \
+    {                                                                         \
+        struct name* m = (struct name*)malloc(sizeof(struct name));           \
+        if (m) {                                                              \
+            name##_init(m);                                                   \
+        }                                                                     \
+        return m;                                                             \
+    }                                                                         \
+    CSTL_TYPED_FN void name##_delete(struct name* m)                          \
+    {                                                                         \
+        if (m) {                                                              \
+            name##_clear(m);                                                  \
+            free(m);                                                          \
+        }                                                                     \
+    }                                                                         \
+    CSTL_TYPED_FN size_t name##_size(const struct name* m)                    \
+    {                                                                         \
+        return m->size;                                                       \
+    }                                                                         \
+    CSTL_TYPED_FN struct name##_node* name##_find_node(struct name* m, K key) \
+    {                                                                         \
+        struct rbt_link* x = m->root.root;                                    \
+        while (x != m->root.nil) {                                            \
+            struct name##_node* n = (struct name##_node*)x;                   \
+            int c = cmp(&key, &n->key);                                       \
+            if (c == 0) {                                                     \
+                return n;                                                     \
+            }                                                                 \
+            x = (c < 0) ? x->left : x->right;                                 \
+        }                                                                     \
+        return (struct name##_node*)0;                                        \
+    }                                                                         \
+    CSTL_TYPED_FN V* name##_find(struct name* m, K key)                       \
+    {                                                                         \
+        struct name##_node* n = name##_find_node(m, key);                     \
+        return n ? &n->value : (V*)0;                                         \
+    }                                                                         \
+    CSTL_TYPED_FN int name##_contains(struct name* m, K key)                  \
+    {                                                                         \
+        return name##_find_node(m, key) != (struct name##_node*)0;            \
+    }                                                                         \
+    /* returns the value slot of `key`, adding a zeroed one if needed */      \
+    CSTL_TYPED_FN V* name##_emplace(struct name* m, K key, int* inserted)     \
+    {                                                                         \
+        struct rbt_link* parent = m->root.nil;                                \
+        struct rbt_link** where = &m->root.root;                              \
+        struct name##_node* n;                                                \
+        if (inserted) {                                                       \
+            *inserted = 0;                                                    \
+        }                                                                     \
+        while (*where != m->root.nil) {                                       \
+            int c;                                                            \
+            parent = *where;                                                  \
+            n = (struct name##_node*)parent;                                  \
+            c = cmp(&key, &n->key);                                           \
+            if (c == 0) {                                                     \
+                return &n->value;                                             \
+            }                                                                 \
+            where = (c < 0) ? &parent->left : &parent->right;                 \
+        }                                                                     \
+        n = (struct name##_node*)malloc(sizeof(struct name##_node));          \
+        if (n == (struct name##_node*)0) {                                    \
+            return (V*)0;                                                     \
+        }                                                                     \
+        n->key = key;                                                         \
+        memset(&n->value, 0, sizeof(n->value));                               \
+        rbt_link_insert(&m->root, parent, where, &n->link);                   \
+        ++m->size;                                                            \
+        if (inserted) {                                                       \
+            *inserted = 1;                                                    \
+        }                                                                     \
+        return &n->value;                                                     \
+    }                                                                         \
+    CSTL_TYPED_FN cstl_error name##_insert(struct name* m, K key, V value)    \
+    {                                                                         \
+        int inserted;                                                         \
+        V* slot = name##_emplace(m, key, &inserted);                          \
+        if (slot == (V*)0) {                                                  \
+            return CSTL_ERROR_MEMORY;                                         \
+        }                                                                     \
+        if (!inserted) {                                                      \
+            return CSTL_RBTREE_KEY_DUPLICATE;                                 \
+        }                                                                     \
+        *slot = value;                                                        \
+        return CSTL_ERROR_SUCCESS;                                            \
+    }                                                                         \
+    CSTL_TYPED_FN cstl_error name##_remove(struct name* m, K key)             \
+    {                                                                         \
+        struct name##_node* n = name##_find_node(m, key);                     \
+        if (n == (struct name##_node*)0) {                                    \
+            return CSTL_RBTREE_KEY_NOT_FOUND;                                 \
+        }                                                                     \
+        rbt_link_erase(&m->root, &n->link);                                   \
+        free(n);                                                              \
+        --m->size;                                                            \
+        return CSTL_ERROR_SUCCESS;                                            \
+    }                                                                         \
+    CSTL_TYPED_FN struct name##_node* name##_first(struct name* m)            \
+    {                                                                         \
+        return (struct name##_node*)rbt_link_first(&m->root);                 \
+    }                                                                         \
+    CSTL_TYPED_FN struct name##_node* name##_next(struct name* m,             \
+                                                  struct name##_node* n)      \
+    {                                                                         \
+        return (struct name##_node*)rbt_link_next(&m->root, &n->link);        \
+    }                                                                         \
+    CSTL_TYPED_FN struct name##_node* name##_first(struct name* m)
+
+/* ------------------------------------------------------------------------*/
+/*                        T Y P E D    A R R A Y                           */
+/* ------------------------------------------------------------------------*/
+
+#define CSTL_DEFINE_ARRAY(name, T)                                            \
+    struct name {                                                             \
+        T* data;                                                              \
+        size_t size;                                                          \
+        size_t capacity;                                                      \
+    };                                                                        \
+    CSTL_TYPED_FN void name##_init(struct name* a)                            \
+    {                                                                         \
+        a->data = (T*)0;                                                      \
+        a->size = 0;                                                          \
+        a->capacity = 0;                                                      \
+    }                                                                         \
+    CSTL_TYPED_FN void name##_clear(struct name* a)                           \
+    {                                                                         \
+        free(a->data);                                                        \
+        name##_init(a);                                                       \
+    }                                                                         \
+    CSTL_TYPED_FN size_t name##_size(const struct name* a)                    \
+    {                                                                         \
+        return a->size;                                                       \
+    }                                                                         \
+    CSTL_TYPED_FN cstl_error name##_reserve(struct name* a, size_t n)         \
+    {                                                                         \
+        T* tmp;                                                               \
+        if (n <= a->capacity) {                                               \
+            return CSTL_ERROR_SUCCESS;                                        \
+        }                                                                     \
+        tmp = (T*)realloc(a->data, n * sizeof(T));                            \
+        if (tmp == (T*)0) {                                                   \
+            return CSTL_ERROR_MEMORY;                                         \
+        }                                                                     \
+        a->data = tmp;                                                        \
+        a->capacity = n;                                                      \
+        return CSTL_ERROR_SUCCESS;                                            \
+    }                                                                         \
+    CSTL_TYPED_FN cstl_error name##_grow_(struct name* a)                     \
+    {                                                                         \
+        if (a->size < a->capacity) {                                          \
+            return CSTL_ERROR_SUCCESS;                                        \
+        }                                                                     \
+        return name##_reserve(a, a->capacity < 8 ? 8 : 2 * a->capacity);      \
+    }                                                                         \
+    CSTL_TYPED_FN T* name##_at(struct name* a, size_t index)                  \
+    {                                                                         \
+        return (index < a->size) ? &a->data[index] : (T*)0;                   \
+    }                                                                         \
+    CSTL_TYPED_FN cstl_error name##_push_back(struct name* a, T elem)         \
+    {                                                                         \
+        if (name##_grow_(a) != CSTL_ERROR_SUCCESS) {                          \
+            return CSTL_ERROR_MEMORY;                                         \
+        }                                                                     \
+        a->data[a->size++] = elem;                                            \
+        return CSTL_ERROR_SUCCESS;                                            \
+    }                                                                         \
+    CSTL_TYPED_FN cstl_error name##_pop_back(struct name* a)                  \
+    {                                                                         \
+        if (a->size == 0) {                                                   \
+            return CSTL_ARRAY_INDEX_OUT_OF_BOUND;                             \
+        }                                                                     \
+        --a->size;                                                            \
+        return CSTL_ERROR_SUCCESS;                                            \
+    }                                                                         \
+    CSTL_TYPED_FN cstl_error name##_insert_at(struct name* a, size_t index,   \
+                                              T elem)                         \
+    {                                                                         \
+        if (index > a->size) {                                                \
+            return CSTL_ARRAY_INDEX_OUT_OF_BOUND;                             \
+        }                                                                     \
+        if (name##_grow_(a) != CSTL_ERROR_SUCCESS) {                          \
+            return CSTL_ERROR_MEMORY;                                         \
+        }                                                                     \
+        memmove(&a->data[index + 1], &a->data[index],                         \
+                (a->size - index) * sizeof(T));                               \
+        a->data[index] = elem;                                                \
+        ++a->size;                                                            \
+        return CSTL_ERROR_SUCCESS;                                            \
+    }                                                                         \
+    CSTL_TYPED_FN cstl_error name##_remove_at(struct name* a, size_t index)   \
+    {                                                                         \
+        if (index >= a->size) {                                               \
+            return CSTL_ARRAY_INDEX_OUT_OF_BOUND;                             \
+        }                                                                     \
+        memmove(&a->data[index], &a->data[index + 1],                         \
+                (a->size - index - 1) * sizeof(T));                           \
+        --a->size;                                                            \
+        return CSTL_ERROR_SUCCESS;                                            \
+    }                                                                         \
+    CSTL_TYPED_FN void name##_sort(struct name* a,                            \
+                                   int (*fn)(const void*, const void*))       \
+    {                                                                         \
+        if (a->size > 1) {                                                    \
+            qsort(a->data, a->size, sizeof(T), fn);                           \
+        }                                                                     \
+    }                                                                         \
+    CSTL_TYPED_FN size_t name##_size(const struct name* a)
+
+/* ------------------------------------------------------------------------*/
+/*                  T Y P E D    S M A L L    V E C T O R                  */
+/* ------------------------------------------------------------------------*/
+
+/*
+ * An array whose first N elements live inside the struct, so one declared
+ * on the stack or embedded in another struct does not allocate until it
+ * grows past N. Elements move to the heap then, and stay there until
+ * _clear. Pointers into it are invalidated by growth and, while inline, by
+ * moving the struct; copying an inline vector by value copies its elements.
+ */
+#define CSTL_DEFINE_SMALL_VECTOR(name, T, N)                                  \
+    struct name {                                                             \
+        T* heap; /* NULL while the elements are in inline_ */                 \
+        size_t size;                                                          \
+        size_t capacity;                                                      \
+        T inline_[N];                                                         \
+    };                                                                        \
+    CSTL_TYPED_FN void name##_init(struct name* v)                            \
+    {                                                                         \
+        v->heap = (T*)0;                                                      \
+        v->size = 0;                                                          \
+        v->capacity = (N);                                                    \
+    }                                                                         \
+    CSTL_TYPED_FN void name##_clear(struct name* v)                           \
+    {                                                                         \
+        free(v->heap);                                                        \
+        name##_init(v);                                                       \
+    }                                                                         \
+    CSTL_TYPED_FN size_t name##_size(const struct name* v)                    \
+    {                                                                         \
+        return v->size;                                                       \
+    }                                                                         \
+    CSTL_TYPED_FN size_t name##_capacity(const struct name* v)                \
+    {                                                                         \
+        return v->capacity;                                                   \
+    }                                                                         \
+    /* the elements, contiguous; for iteration and bulk access */             \
+    CSTL_TYPED_FN T* name##_data(struct name* v)                              \
+    {                                                                         \
+        return v->heap ? v->heap : v->inline_;                                \
+    }                                                                         \
+    CSTL_TYPED_FN cstl_error name##_reserve(struct name* v, size_t n)         \
+    {                                                                         \
+        T* tmp;                                                               \
+        if (n <= v->capacity) {                                               \
+            return CSTL_ERROR_SUCCESS;                                        \
+        }                                                                     \
+        tmp = (T*)realloc(v->heap, n * sizeof(T));                            \
+        if (tmp == (T*)0) {                                                   \
+            return CSTL_ERROR_MEMORY;                                         \
+        }                                                                     \
+        if (v->heap == (T*)0) {                                               \
+            memcpy(tmp, v->inline_, v->size * sizeof(T));                     \
+        }                                                                     \
+        v->heap = tmp;                                                        \
+        v->capacity = n;                                                      \
+        return CSTL_ERROR_SUCCESS;                                            \
+    }                                                                         \
+    CSTL_TYPED_FN cstl_error name##_grow_(struct name* v)                     \
+    {                                                                         \
+        if (v->size < v->capacity) {                                          \
+            return CSTL_ERROR_SUCCESS;                                        \
+        }                                                                     \
+        return name##_reserve(v, 2 * v->capacity);                            \
+    }                                                                         \
+    CSTL_TYPED_FN T* name##_at(struct name* v, size_t index)                  \
+    {                                                                         \
+        return (index < v->size) ? &name##_data(v)[index] : (T*)0;            \
+    }                                                                         \
+    CSTL_TYPED_FN cstl_error name##_push_back(struct name* v, T elem)         \
+    {                                                                         \
+        if (name##_grow_(v) != CSTL_ERROR_SUCCESS) {                          \
+            return CSTL_ERROR_MEMORY;                                         \
+        }                                                                     \
+        name##_data(v)[v->size++] = elem;                                     \
+        return CSTL_ERROR_SUCCESS;                                            \
+    }                                                                         \
+    CSTL_TYPED_FN cstl_error name##_pop_back(struct name* v)                  \
+    {                                                                         \
+        if (v->size == 0) {                                                   \
+            return CSTL_ARRAY_INDEX_OUT_OF_BOUND;                             \
+        }                                                                     \
+        --v->size;                                                            \
+        return CSTL_ERROR_SUCCESS;                                            \
+    }                                                                         \
+    CSTL_TYPED_FN cstl_error name##_insert_at(struct name* v, size_t index,   \
+                                              T elem)                         \
+    {                                                                         \
+        T* data;                                                              \
+        if (index > v->size) {                                                \
+            return CSTL_ARRAY_INDEX_OUT_OF_BOUND;                             \
+        }                                                                     \
+        if (name##_grow_(v) != CSTL_ERROR_SUCCESS) {                          \
+            return CSTL_ERROR_MEMORY;                                         \
+        }                                                                     \
+        data = name##_data(v);                                                \
+        memmove(&data[index + 1], &data[index],                               \
+                (v->size - index) * sizeof(T));                               \
+        data[index] = elem;                                                   \
+        ++v->size;                                                            \
+        return CSTL_ERROR_SUCCESS;                                            \
+    }                                                                         \
+    CSTL_TYPED_FN cstl_error name##_remove_at(struct name* v, size_t index)   \
+    {                                                                         \
+        T* data = name##_data(v);                                             \
+        if (index >= v->size) {                                               \
+            return CSTL_ARRAY_INDEX_OUT_OF_BOUND;                             \
+        }                                                                     \
+        memmove(&data[index], &data[index + 1],                               \
+                (v->size - index - 1) * sizeof(T));                           \
+        --v->size;                                                            \
+        return CSTL_ERROR_SUCCESS;                                            \
+    }                                                                         \
+    CSTL_TYPED_FN void name##_sort(struct name* v,                            \
+                                   int (*fn)(const void*, const void*))       \
+    {                                                                         \
+        if (v->size > 1) {                                                    \
+            qsort(name##_data(v), v->size, sizeof(T), fn);                    \
+        }                                                                     \
+    }                                                                         \
+    CSTL_TYPED_FN size_t name##_size(const struct name* v)
+
+#endif /* __C_STL_TYPED_H__ */
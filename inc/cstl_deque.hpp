@@ -0,0 +1,395 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __CSTL_DEQUE_HPP__
+#define __CSTL_DEQUE_HPP__
+
+/*
+ * Double-ended queue on a power-of-two ring buffer: O(1) amortized push
+ * and pop at both ends and O(1) indexing. Unlike std::deque, growing the
+ * buffer relocates the elements, so references and iterators are not
+ * stable across push_front/push_back/emplace_*.
+ */
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace cstl
+{
+
+template <typename T>
+class deque
+{
+    template <bool IsConst>
+    class basic_iterator
+    {
+        friend class deque;
+        typedef typename std::conditional<IsConst, const deque*, deque*>::type
+            owner_type;
+
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<IsConst, const T*, T*>::type pointer;
+        typedef typename std::conditional<IsConst, const T&, T&>::type
+            reference;
+
+        basic_iterator() : d_(nullptr), i_(0)
+        {
+        }
+
+        template <bool C,
+                  typename = typename std::enable_if<IsConst && !C>::type>
+        basic_iterator(const basic_iterator<C>& other)
+            : d_(other.d_), i_(other.i_)
+        {
+        }
+
+        reference operator*() const
+        {
+            return (*d_)[i_];
+        }
+
+        pointer operator->() const
+        {
+            return &(*d_)[i_];
+        }
+
+        reference operator[](difference_type n) const
+        {
+            return (*d_)[i_ + n];
+        }
+
+        basic_iterator& operator++()
+        {
+            ++i_;
+            return *this;
+        }
+
+        basic_iterator operator++(int)
+        {
+            basic_iterator tmp(*this);
+            ++i_;
+            return tmp;
+        }
+
+        basic_iterator& operator--()
+        {
+            --i_;
+            return *this;
+        }
+
+        basic_iterator operator--(int)
+        {
+            basic_iterator tmp(*this);
+            --i_;
+            return tmp;
+        }
+
+        basic_iterator& operator+=(difference_type n)
+        {
+            i_ += n;
+            return *this;
+        }
+
+        basic_iterator& operator-=(difference_type n)
+        {
+            i_ -= n;
+            return *this;
+        }
+
+        basic_iterator operator+(difference_type n) const
+        {
+            return basic_iterator(d_, i_ + n);
+        }
+
+        basic_iterator operator-(difference_type n) const
+        {
+            return basic_iterator(d_, i_ - n);
+        }
+
+        difference_type operator-(const basic_iterator& rhs) const
+        {
+            return static_cast<difference_type>(i_) -
+                   static_cast<difference_type>(rhs.i_);
+        }
+
+        bool operator==(const basic_iterator& rhs) const
+        {
+            return i_ == rhs.i_;
+        }
+
+        bool operator!=(const basic_iterator& rhs) const
+        {
+            return i_ != rhs.i_;
+        }
+
+        bool operator<(const basic_iterator& rhs) const
+        {
+            return i_ < rhs.i_;
+        }
+
+    private:
+        basic_iterator(owner_type d, std::size_t i) : d_(d), i_(i)
+        {
+        }
+
+        owner_type d_;
+        std::size_t i_; /* logical index, so begin() is always 0 */
+    };
+
+public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+    typedef basic_iterator<false> iterator;
+    typedef basic_iterator<true> const_iterator;
+
+    deque() : buf_(nullptr), mask_(0), head_(0), size_(0)
+    {
+    }
+
+    deque(const deque& other) : buf_(nullptr), mask_(0), head_(0), size_(0)
+    {
+        for (size_type i = 0; i < other.size_; ++i) {
+            push_back(other[i]);
+        }
+    }
+
+    deque(deque&& other) noexcept : buf_(other.buf_),
+                                    mask_(other.mask_),
+                                    head_(other.head_),
+                                    size_(other.size_)
+    {
+        other.buf_ = nullptr;
+        other.mask_ = other.head_ = other.size_ = 0;
+    }
+
+    deque& operator=(deque other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~deque()
+    {
+        clear();
+        ::operator delete(buf_);
+    }
+
+    void swap(deque& other) noexcept
+    {
+        std::swap(buf_, other.buf_);
+        std::swap(mask_, other.mask_);
+        std::swap(head_, other.head_);
+        std::swap(size_, other.size_);
+    }
+
+    size_type size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    iterator begin()
+    {
+        return iterator(this, 0);
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(this, 0);
+    }
+
+    iterator end()
+    {
+        return iterator(this, size_);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(this, size_);
+    }
+
+    T& operator[](size_type i)
+    {
+        return buf_[(head_ + i) & mask_];
+    }
+
+    const T& operator[](size_type i) const
+    {
+        return buf_[(head_ + i) & mask_];
+    }
+
+    T& at(size_type i)
+    {
+        if (i >= size_) {
+            throw std::out_of_range("cstl::deque::at");
+        }
+        return (*this)[i];
+    }
+
+    const T& at(size_type i) const
+    {
+        return const_cast<deque*>(this)->at(i);
+    }
+
+    T& front()
+    {
+        return buf_[head_];
+    }
+
+    T& back()
+    {
+        return (*this)[size_ - 1];
+    }
+
+    void push_back(const T& v)
+    {
+        emplace_back(v);
+    }
+
+    void push_back(T&& v)
+    {
+        emplace_back(std::move(v));
+    }
+
+    void push_front(const T& v)
+    {
+        emplace_front(v);
+    }
+
+    void push_front(T&& v)
+    {
+        emplace_front(std::move(v));
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        T* slot;
+        if (full()) {
+            T tmp(std::forward<Args>(args)...);
+            grow();
+            slot = &buf_[(head_ + size_) & mask_];
+            new (slot) T(std::move(tmp));
+        }
+        else {
+            slot = &buf_[(head_ + size_) & mask_];
+            new (slot) T(std::forward<Args>(args)...);
+        }
+        ++size_;
+        return *slot;
+    }
+
+    template <typename... Args>
+    T& emplace_front(Args&&... args)
+    {
+        T* slot;
+        if (full()) {
+            T tmp(std::forward<Args>(args)...);
+            grow();
+            slot = &buf_[(head_ - 1) & mask_];
+            new (slot) T(std::move(tmp));
+        }
+        else {
+            slot = &buf_[(head_ - 1) & mask_];
+            new (slot) T(std::forward<Args>(args)...);
+        }
+        head_ = (head_ - 1) & mask_;
+        ++size_;
+        return *slot;
+    }
+
+    void pop_back()
+    {
+        back().~T();
+        --size_;
+    }
+
+    void pop_front()
+    {
+        buf_[head_].~T();
+        head_ = (head_ + 1) & mask_;
+        --size_;
+    }
+
+    void clear()
+    {
+        while (size_) {
+            pop_back();
+        }
+        head_ = 0;
+    }
+
+private:
+    bool full() const
+    {
+        return buf_ == nullptr || size_ == mask_ + 1;
+    }
+
+    /* doubles the ring and unwraps it so that head_ becomes 0 */
+    void grow()
+    {
+        size_type cap = buf_ ? (mask_ + 1) * 2 : 8;
+        T* p = static_cast<T*>(::operator new(cap * sizeof(T)));
+        size_type i = 0;
+        try {
+            for (; i < size_; ++i) {
+                new (p + i) T(std::move_if_noexcept((*this)[i]));
+            }
+        }
+        catch (...) {
+            while (i) {
+                p[--i].~T();
+            }
+            ::operator delete(p);
+            throw;
+        }
+        for (i = 0; i < size_; ++i) {
+            (*this)[i].~T();
+        }
+        ::operator delete(buf_);
+        buf_ = p;
+        mask_ = cap - 1;
+        head_ = 0;
+    }
+
+    T* buf_;
+    size_type mask_;
+    size_type head_;
+    size_type size_;
+};
+
+} /* namespace cstl */
+
+#endif /* __CSTL_DEQUE_HPP__ */
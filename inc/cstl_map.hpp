@@ -0,0 +1,234 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __CSTL_MAP_HPP__
+#define __CSTL_MAP_HPP__
+
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+
+#include "cstl_tree.hpp"
+
+namespace cstl
+{
+
+template <typename K, typename V, typename Compare = std::less<K> >
+class map
+{
+    struct key_of {
+        const K& operator()(const std::pair<const K, V>& v) const
+        {
+            return v.first;
+        }
+    };
+    typedef detail::tree<K, std::pair<const K, V>, key_of, Compare> tree_type;
+
+public:
+    typedef K key_type;
+    typedef V mapped_type;
+    typedef std::pair<const K, V> value_type;
+    typedef Compare key_compare;
+    typedef std::size_t size_type;
+    typedef typename tree_type::iterator iterator;
+    typedef typename tree_type::const_iterator const_iterator;
+
+    map() : t_()
+    {
+    }
+
+    explicit map(const Compare& comp) : t_(comp)
+    {
+    }
+
+    map(std::initializer_list<value_type> init) : t_()
+    {
+        insert(init.begin(), init.end());
+    }
+
+    template <typename InputIt>
+    map(InputIt first, InputIt last) : t_()
+    {
+        insert(first, last);
+    }
+
+    void swap(map& other) noexcept
+    {
+        t_.swap(other.t_);
+    }
+
+    size_type size() const
+    {
+        return t_.size();
+    }
+
+    bool empty() const
+    {
+        return t_.empty();
+    }
+
+    iterator begin()
+    {
+        return t_.begin();
+    }
+
+    const_iterator begin() const
+    {
+        return t_.begin();
+    }
+
+    const_iterator cbegin() const
+    {
+        return t_.begin();
+    }
+
+    iterator end()
+    {
+        return t_.end();
+    }
+
+    const_iterator end() const
+    {
+        return t_.end();
+    }
+
+    const_iterator cend() const
+    {
+        return t_.end();
+    }
+
+    iterator find(const K& key)
+    {
+        return t_.find(key);
+    }
+
+    const_iterator find(const K& key) const
+    {
+        return t_.find(key);
+    }
+
+    size_type count(const K& key) const
+    {
+        return t_.find(key) != t_.end() ? 1 : 0;
+    }
+
+    iterator lower_bound(const K& key)
+    {
+        return t_.lower_bound(key);
+    }
+
+    iterator upper_bound(const K& key)
+    {
+        return t_.upper_bound(key);
+    }
+
+    V& at(const K& key)
+    {
+        iterator it = t_.find(key);
+        if (it == t_.end()) {
+            throw std::out_of_range("cstl::map::at");
+        }
+        return it->second;
+    }
+
+    const V& at(const K& key) const
+    {
+        return const_cast<map*>(this)->at(key);
+    }
+
+    V& operator[](const K& key)
+    {
+        return t_.try_emplace_unique(key).first->second;
+    }
+
+    V& operator[](K&& key)
+    {
+        return t_.try_emplace_unique(std::move(key)).first->second;
+    }
+
+    std::pair<iterator, bool> insert(const value_type& v)
+    {
+        return t_.emplace_unique(v);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& v)
+    {
+        return t_.emplace_unique(std::move(v));
+    }
+
+    template <typename InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first) {
+            t_.emplace_unique(*first);
+        }
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        return t_.emplace_unique(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args)
+    {
+        return t_.try_emplace_unique(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args)
+    {
+        return t_.try_emplace_unique(std::move(key),
+                                     std::forward<Args>(args)...);
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return t_.erase(pos);
+    }
+
+    iterator erase(iterator pos)
+    {
+        return t_.erase(const_iterator(pos));
+    }
+
+    size_type erase(const K& key)
+    {
+        return t_.erase(key);
+    }
+
+    void clear()
+    {
+        t_.clear();
+    }
+
+private:
+    tree_type t_;
+};
+
+} /* namespace cstl */
+
+#endif /* __CSTL_MAP_HPP__ */
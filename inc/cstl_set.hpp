@@ -0,0 +1,176 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __CSTL_SET_HPP__
+#define __CSTL_SET_HPP__
+
+#include <functional>
+#include <initializer_list>
+#include <utility>
+
+#include "cstl_tree.hpp"
+
+namespace cstl
+{
+
+template <typename K, typename Compare = std::less<K> >
+class set
+{
+    struct identity {
+        const K& operator()(const K& v) const
+        {
+            return v;
+        }
+    };
+    typedef detail::tree<K, K, identity, Compare> tree_type;
+
+public:
+    typedef K key_type;
+    typedef K value_type;
+    typedef Compare key_compare;
+    typedef std::size_t size_type;
+    /* elements of a set are immutable, so both iterators are const */
+    typedef typename tree_type::const_iterator iterator;
+    typedef typename tree_type::const_iterator const_iterator;
+
+    set() : t_()
+    {
+    }
+
+    explicit set(const Compare& comp) : t_(comp)
+    {
+    }
+
+    set(std::initializer_list<K> init) : t_()
+    {
+        insert(init.begin(), init.end());
+    }
+
+    template <typename InputIt>
+    set(InputIt first, InputIt last) : t_()
+    {
+        insert(first, last);
+    }
+
+    void swap(set& other) noexcept
+    {
+        t_.swap(other.t_);
+    }
+
+    size_type size() const
+    {
+        return t_.size();
+    }
+
+    bool empty() const
+    {
+        return t_.empty();
+    }
+
+    iterator begin() const
+    {
+        return t_.begin();
+    }
+
+    iterator cbegin() const
+    {
+        return t_.begin();
+    }
+
+    iterator end() const
+    {
+        return t_.end();
+    }
+
+    iterator cend() const
+    {
+        return t_.end();
+    }
+
+    iterator find(const K& key) const
+    {
+        return t_.find(key);
+    }
+
+    size_type count(const K& key) const
+    {
+        return t_.find(key) != t_.end() ? 1 : 0;
+    }
+
+    iterator lower_bound(const K& key) const
+    {
+        return const_cast<tree_type&>(t_).lower_bound(key);
+    }
+
+    iterator upper_bound(const K& key) const
+    {
+        return const_cast<tree_type&>(t_).upper_bound(key);
+    }
+
+    std::pair<iterator, bool> insert(const K& key)
+    {
+        return t_.emplace_unique(key);
+    }
+
+    std::pair<iterator, bool> insert(K&& key)
+    {
+        return t_.emplace_unique(std::move(key));
+    }
+
+    template <typename InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first) {
+            t_.emplace_unique(*first);
+        }
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        return t_.emplace_unique(std::forward<Args>(args)...);
+    }
+
+    iterator erase(iterator pos)
+    {
+        return t_.erase(pos);
+    }
+
+    size_type erase(const K& key)
+    {
+        return t_.erase(key);
+    }
+
+    void clear()
+    {
+        t_.clear();
+    }
+
+private:
+    tree_type t_;
+};
+
+} /* namespace cstl */
+
+#endif /* __CSTL_SET_HPP__ */
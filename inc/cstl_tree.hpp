@@ -0,0 +1,418 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __CSTL_TREE_HPP__
+#define __CSTL_TREE_HPP__
+
+/*
+ * Red-black tree template shared by cstl::map and cstl::set. Nodes embed a
+ * struct rbt_link and are balanced by the C implementation in rb-tree.c;
+ * the search itself is instantiated per Compare, so the comparator inlines.
+ */
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "rb-tree.h"
+
+namespace cstl
+{
+namespace detail
+{
+
+template <typename Value>
+struct tree_node : rbt_link {
+    Value value;
+
+    template <typename... Args>
+    explicit tree_node(Args&&... args) : value(std::forward<Args>(args)...)
+    {
+    }
+};
+
+template <typename Value, bool IsConst>
+class tree_iterator
+{
+    template <typename, typename, typename, typename>
+    friend class tree;
+    template <typename, bool>
+    friend class tree_iterator;
+
+    typedef tree_node<Value> node_type;
+
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Value value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef typename std::conditional<IsConst, const Value*, Value*>::type
+        pointer;
+    typedef typename std::conditional<IsConst, const Value&, Value&>::type
+        reference;
+
+    tree_iterator() : root_(nullptr), link_(nullptr)
+    {
+    }
+
+    /* iterator -> const_iterator */
+    template <bool C, typename = typename std::enable_if<IsConst && !C>::type>
+    tree_iterator(const tree_iterator<Value, C>& other)
+        : root_(other.root_), link_(other.link_)
+    {
+    }
+
+    reference operator*() const
+    {
+        return static_cast<node_type*>(link_)->value;
+    }
+
+    pointer operator->() const
+    {
+        return &static_cast<node_type*>(link_)->value;
+    }
+
+    tree_iterator& operator++()
+    {
+        link_ = rbt_link_next(root_, link_);
+        return *this;
+    }
+
+    tree_iterator operator++(int)
+    {
+        tree_iterator tmp(*this);
+        ++*this;
+        return tmp;
+    }
+
+    tree_iterator& operator--()
+    {
+        link_ = link_ ? rbt_link_prev(root_, link_) : rbt_link_last(root_);
+        return *this;
+    }
+
+    tree_iterator operator--(int)
+    {
+        tree_iterator tmp(*this);
+        --*this;
+        return tmp;
+    }
+
+    template <bool C>
+    bool operator==(const tree_iterator<Value, C>& rhs) const
+    {
+        return link_ == rhs.link_;
+    }
+
+    template <bool C>
+    bool operator!=(const tree_iterator<Value, C>& rhs) const
+    {
+        return link_ != rhs.link_;
+    }
+
+private:
+    tree_iterator(rbt_root* root, rbt_link* link) : root_(root), link_(link)
+    {
+    }
+
+    rbt_root* root_;
+    rbt_link* link_; /* nullptr is end() */
+};
+
+/*
+ * The root and its sentinel live in a separately allocated header, because
+ * every leaf points at the sentinel: keeping it out of the object is what
+ * makes moving a tree O(1). The header is created on the first insertion.
+ */
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+class tree
+{
+    typedef tree_node<Value> node_type;
+
+    struct header {
+        rbt_root root;
+        rbt_link nil;
+    };
+
+public:
+    typedef Key key_type;
+    typedef Value value_type;
+    typedef Compare key_compare;
+    typedef std::size_t size_type;
+    typedef tree_iterator<Value, false> iterator;
+    typedef tree_iterator<Value, true> const_iterator;
+
+    explicit tree(const Compare& comp = Compare())
+        : h_(nullptr), size_(0), comp_(comp)
+    {
+    }
+
+    tree(const tree& other) : h_(nullptr), size_(0), comp_(other.comp_)
+    {
+        for (const_iterator it = other.begin(); it != other.end(); ++it) {
+            emplace_unique(*it);
+        }
+    }
+
+    tree(tree&& other) noexcept : h_(other.h_),
+                                  size_(other.size_),
+                                  comp_(std::move(other.comp_))
+    {
+        other.h_ = nullptr;
+        other.size_ = 0;
+    }
+
+    tree& operator=(tree other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~tree()
+    {
+        clear();
+        delete h_;
+    }
+
+    void swap(tree& other) noexcept
+    {
+        std::swap(h_, other.h_);
+        std::swap(size_, other.size_);
+        std::swap(comp_, other.comp_);
+    }
+
+    size_type size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    iterator begin()
+    {
+        return h_ ? iterator(&h_->root, rbt_link_first(&h_->root)) : end();
+    }
+
+    const_iterator begin() const
+    {
+        return const_cast<tree*>(this)->begin();
+    }
+
+    iterator end()
+    {
+        return iterator(h_ ? &h_->root : nullptr, nullptr);
+    }
+
+    const_iterator end() const
+    {
+        return const_cast<tree*>(this)->end();
+    }
+
+    iterator find(const Key& key)
+    {
+        if (h_) {
+            rbt_link* x = h_->root.root;
+            while (x != h_->root.nil) {
+                const Key& k = KeyOfValue()(to_node(x)->value);
+                if (comp_(key, k)) {
+                    x = x->left;
+                }
+                else if (comp_(k, key)) {
+                    x = x->right;
+                }
+                else {
+                    return iterator(&h_->root, x);
+                }
+            }
+        }
+        return end();
+    }
+
+    const_iterator find(const Key& key) const
+    {
+        return const_cast<tree*>(this)->find(key);
+    }
+
+    iterator lower_bound(const Key& key)
+    {
+        rbt_link* result = nullptr;
+        if (h_) {
+            rbt_link* x = h_->root.root;
+            while (x != h_->root.nil) {
+                if (!comp_(KeyOfValue()(to_node(x)->value), key)) {
+                    result = x;
+                    x = x->left;
+                }
+                else {
+                    x = x->right;
+                }
+            }
+        }
+        return iterator(h_ ? &h_->root : nullptr, result);
+    }
+
+    iterator upper_bound(const Key& key)
+    {
+        rbt_link* result = nullptr;
+        if (h_) {
+            rbt_link* x = h_->root.root;
+            while (x != h_->root.nil) {
+                if (comp_(key, KeyOfValue()(to_node(x)->value))) {
+                    result = x;
+                    x = x->left;
+                }
+                else {
+                    x = x->right;
+                }
+            }
+        }
+        return iterator(h_ ? &h_->root : nullptr, result);
+    }
+
+    /* inserts a node built from args unless its key is already present */
+    template <typename... Args>
+    std::pair<iterator, bool> emplace_unique(Args&&... args)
+    {
+        node_type* z;
+        rbt_link* parent;
+        rbt_link** where;
+        ensure_header();
+        z = new node_type(std::forward<Args>(args)...);
+        if (!locate(KeyOfValue()(z->value), parent, where)) {
+            delete z;
+            return std::make_pair(iterator(&h_->root, parent), false);
+        }
+        return std::make_pair(link(parent, where, z), true);
+    }
+
+    /* like emplace_unique, but builds the node only when key is missing */
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace_unique(K&& key, Args&&... args)
+    {
+        rbt_link* parent;
+        rbt_link** where;
+        if (!locate(key, parent, where)) {
+            return std::make_pair(iterator(&h_->root, parent), false);
+        }
+        node_type* z = new node_type(std::piecewise_construct,
+                                     std::forward_as_tuple(
+                                         std::forward<K>(key)),
+                                     std::forward_as_tuple(
+                                         std::forward<Args>(args)...));
+        return std::make_pair(link(parent, where, z), true);
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        rbt_link* x = pos.link_;
+        iterator next(&h_->root, rbt_link_next(&h_->root, x));
+        rbt_link_erase(&h_->root, x);
+        delete to_node(x);
+        --size_;
+        return next;
+    }
+
+    size_type erase(const Key& key)
+    {
+        iterator it = find(key);
+        if (it == end()) {
+            return 0;
+        }
+        erase(it);
+        return 1;
+    }
+
+    void clear()
+    {
+        if (h_) {
+            rbt_root_clear(&h_->root, release_node, nullptr);
+        }
+        size_ = 0;
+    }
+
+private:
+    static node_type* to_node(rbt_link* x)
+    {
+        return static_cast<node_type*>(x);
+    }
+
+    static void release_node(rbt_link* x, void*)
+    {
+        delete to_node(x);
+    }
+
+    void ensure_header()
+    {
+        if (h_ == nullptr) {
+            h_ = new header;
+            rbt_root_init(&h_->root, &h_->nil);
+        }
+    }
+
+    /*
+     * Finds where key belongs. Returns false, with parent set to the
+     * existing node, if key is already present.
+     */
+    bool locate(const Key& key, rbt_link*& parent, rbt_link**& where)
+    {
+        ensure_header();
+        parent = h_->root.nil;
+        where = &h_->root.root;
+        while (*where != h_->root.nil) {
+            const Key& k = KeyOfValue()(to_node(*where)->value);
+            parent = *where;
+            if (comp_(key, k)) {
+                where = &parent->left;
+            }
+            else if (comp_(k, key)) {
+                where = &parent->right;
+            }
+            else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    iterator link(rbt_link* parent, rbt_link** where, node_type* z)
+    {
+        rbt_link_insert(&h_->root, parent, where, z);
+        ++size_;
+        return iterator(&h_->root, z);
+    }
+
+    header* h_;
+    size_type size_;
+    Compare comp_;
+};
+
+} /* namespace detail */
+} /* namespace cstl */
+
+#endif /* __CSTL_TREE_HPP__ */
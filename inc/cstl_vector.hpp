@@ -0,0 +1,296 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#ifndef __CSTL_VECTOR_HPP__
+#define __CSTL_VECTOR_HPP__
+
+/*
+ * Contiguous array with amortized doubling. Elements are constructed in
+ * place in raw storage; on growth they are moved when the move constructor
+ * is noexcept and copied otherwise.
+ */
+
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace cstl
+{
+
+template <typename T>
+class vector
+{
+public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    vector() : data_(nullptr), size_(0), cap_(0)
+    {
+    }
+
+    vector(std::initializer_list<T> init) : data_(nullptr), size_(0), cap_(0)
+    {
+        reserve(init.size());
+        for (const T& v : init) {
+            push_back(v);
+        }
+    }
+
+    vector(const vector& other) : data_(nullptr), size_(0), cap_(0)
+    {
+        reserve(other.size_);
+        for (size_type i = 0; i < other.size_; ++i) {
+            push_back(other.data_[i]);
+        }
+    }
+
+    vector(vector&& other) noexcept : data_(other.data_),
+                                      size_(other.size_),
+                                      cap_(other.cap_)
+    {
+        other.data_ = nullptr;
+        other.size_ = other.cap_ = 0;
+    }
+
+    vector& operator=(vector other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~vector()
+    {
+        clear();
+        ::operator delete(data_);
+    }
+
+    void swap(vector& other) noexcept
+    {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(cap_, other.cap_);
+    }
+
+    size_type size() const
+    {
+        return size_;
+    }
+
+    size_type capacity() const
+    {
+        return cap_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    T* data()
+    {
+        return data_;
+    }
+
+    const T* data() const
+    {
+        return data_;
+    }
+
+    iterator begin()
+    {
+        return data_;
+    }
+
+    const_iterator begin() const
+    {
+        return data_;
+    }
+
+    iterator end()
+    {
+        return data_ + size_;
+    }
+
+    const_iterator end() const
+    {
+        return data_ + size_;
+    }
+
+    T& operator[](size_type i)
+    {
+        return data_[i];
+    }
+
+    const T& operator[](size_type i) const
+    {
+        return data_[i];
+    }
+
+    T& at(size_type i)
+    {
+        if (i >= size_) {
+            throw std::out_of_range("cstl::vector::at");
+        }
+        return data_[i];
+    }
+
+    const T& at(size_type i) const
+    {
+        return const_cast<vector*>(this)->at(i);
+    }
+
+    T& front()
+    {
+        return data_[0];
+    }
+
+    T& back()
+    {
+        return data_[size_ - 1];
+    }
+
+    void reserve(size_type n)
+    {
+        if (n > cap_) {
+            reallocate(n);
+        }
+    }
+
+    void resize(size_type n)
+    {
+        reserve(n);
+        while (size_ < n) {
+            emplace_back();
+        }
+        while (size_ > n) {
+            pop_back();
+        }
+    }
+
+    void push_back(const T& v)
+    {
+        emplace_back(v);
+    }
+
+    void push_back(T&& v)
+    {
+        emplace_back(std::move(v));
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if (size_ == cap_) {
+            /* build first: args may refer to an element of this vector */
+            T tmp(std::forward<Args>(args)...);
+            reallocate(cap_ ? cap_ * 2 : 4);
+            new (data_ + size_) T(std::move(tmp));
+        }
+        else {
+            new (data_ + size_) T(std::forward<Args>(args)...);
+        }
+        return data_[size_++];
+    }
+
+    void pop_back()
+    {
+        data_[--size_].~T();
+    }
+
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args)
+    {
+        size_type i = pos - data_;
+        T tmp(std::forward<Args>(args)...);
+        emplace_back(std::move(tmp));
+        for (size_type j = size_ - 1; j > i; --j) {
+            std::swap(data_[j], data_[j - 1]);
+        }
+        return data_ + i;
+    }
+
+    iterator insert(const_iterator pos, const T& v)
+    {
+        return emplace(pos, v);
+    }
+
+    iterator insert(const_iterator pos, T&& v)
+    {
+        return emplace(pos, std::move(v));
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        size_type i = pos - data_;
+        for (size_type j = i; j + 1 < size_; ++j) {
+            data_[j] = std::move(data_[j + 1]);
+        }
+        pop_back();
+        return data_ + i;
+    }
+
+    void clear()
+    {
+        while (size_) {
+            pop_back();
+        }
+    }
+
+private:
+    void reallocate(size_type n)
+    {
+        T* p = static_cast<T*>(::operator new(n * sizeof(T)));
+        size_type i = 0;
+        try {
+            for (; i < size_; ++i) {
+                new (p + i) T(std::move_if_noexcept(data_[i]));
+            }
+        }
+        catch (...) {
+            while (i) {
+                p[--i].~T();
+            }
+            ::operator delete(p);
+            throw;
+        }
+        for (i = 0; i < size_; ++i) {
+            data_[i].~T();
+        }
+        ::operator delete(data_);
+        data_ = p;
+        cap_ = n;
+    }
+
+    T* data_;
+    size_type size_;
+    size_type cap_;
+};
+
+} /* namespace cstl */
+
+#endif /* __CSTL_VECTOR_HPP__ */
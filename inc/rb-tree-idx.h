@@ -0,0 +1,64 @@
+#ifndef __RB_TREE_IDX_H__
+#define __RB_TREE_IDX_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rb-tree.h"
+
+/*
+ * Red-black tree whose nodes live in one growable array and are linked by
+ * 32-bit indices, so a link costs 12 bytes instead of 24. Keys have a fixed
+ * size given at creation and are stored by value next to their link.
+ *
+ * Index 0 is the sentinel and doubles as "not found" / "end". Indices stay
+ * valid until their key is removed, but pointers returned by
+ * rbt_idx_tree_key() are invalidated by any insertion that grows the array.
+ *
+ * Since nothing in the array is a pointer, the whole tree can be copied or
+ * saved with one memcpy (rbt_idx_tree_save / rbt_idx_tree_load), provided
+ * the keys themselves hold no pointers. Images use the host byte order.
+ */
+
+typedef uint32_t rbt_idx;
+
+#define RBT_IDX_NIL ((rbt_idx)0)
+#define RBT_IDX_MAX_NODES 0x7FFFFFFEu
+
+struct rbt_idx_tree;
+
+struct rbt_idx_tree* rbt_idx_tree_create(size_t key_size, rbt_node_compare cmp,
+                                         rbt_node_destruct dest);
+void rbt_idx_tree_destroy(struct rbt_idx_tree* tree);
+rbt_status rbt_idx_tree_reserve(struct rbt_idx_tree* tree, size_t n);
+size_t rbt_idx_tree_size(const struct rbt_idx_tree* tree);
+
+rbt_status rbt_idx_tree_insert(struct rbt_idx_tree* tree, const void* key);
+rbt_idx rbt_idx_tree_find(const struct rbt_idx_tree* tree, const void* key);
+rbt_status rbt_idx_tree_remove(struct rbt_idx_tree* tree, const void* key);
+void* rbt_idx_tree_key(const struct rbt_idx_tree* tree, rbt_idx i);
+
+rbt_idx rbt_idx_tree_first(const struct rbt_idx_tree* tree);
+rbt_idx rbt_idx_tree_last(const struct rbt_idx_tree* tree);
+rbt_idx rbt_idx_tree_next(const struct rbt_idx_tree* tree, rbt_idx i);
+rbt_idx rbt_idx_tree_prev(const struct rbt_idx_tree* tree, rbt_idx i);
+
+/*
+ * Writes the tree image to buf if it holds at least the returned number of
+ * bytes; call with size 0 to query the size.
+ */
+size_t rbt_idx_tree_save(const struct rbt_idx_tree* tree, void* buf,
+                         size_t size);
+struct rbt_idx_tree* rbt_idx_tree_load(const void* buf, size_t size,
+                                       rbt_node_compare cmp,
+                                       rbt_node_destruct dest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RB_TREE_IDX_H__ */
@@ -6,6 +6,9 @@ extern "C" {
 #endif
 
 #include <stddef.h>
+#include <stdint.h>
+
+#include "c_inline.h"
 
 typedef enum { rbt_red = 0, rbt_black = 1 } rbt_color;
 
@@ -19,6 +22,74 @@ typedef enum {
 struct rbt_tree;
 struct rbt_node;
 
+/*
+ * Link-level interface. A struct rbt_link is embedded in a caller defined
+ * node; the caller searches the tree itself (typically with an inlined
+ * comparison) and hands the final position to rbt_link_insert(), which only
+ * links and rebalances. Callers may read `left` and `right` to descend,
+ * comparing against `root->nil`; every other field is private.
+ *
+ * The parent pointer carries the color in bit 0 and marks the sentinel in
+ * bit 1, so a link is three words and links must be at least 4-byte aligned.
+ */
+struct rbt_link {
+    struct rbt_link* left;
+    struct rbt_link* right;
+    uintptr_t parent_color;
+};
+
+struct rbt_root {
+    struct rbt_link* root;
+    struct rbt_link* nil;
+};
+
+typedef void (*rbt_link_release)(struct rbt_link* link, void* p);
+
+void rbt_root_init(struct rbt_root* root, struct rbt_link* nil);
+int rbt_root_is_empty(const struct rbt_root* root);
+void rbt_root_clear(struct rbt_root* root, rbt_link_release release, void* p);
+void rbt_link_insert(struct rbt_root* root, struct rbt_link* parent,
+                     struct rbt_link** where, struct rbt_link* link);
+void rbt_link_erase(struct rbt_root* root, struct rbt_link* link);
+struct rbt_link* rbt_link_first(struct rbt_root* root);
+struct rbt_link* rbt_link_last(struct rbt_root* root);
+struct rbt_link* rbt_link_next(struct rbt_root* root, struct rbt_link* link);
+struct rbt_link* rbt_link_prev(struct rbt_root* root, struct rbt_link* link);
+
+/*
+ * Intrusive tree: the caller embeds a struct rbt_link in its own objects,
+ * orders them with a comparator on links and gets an object back from its
+ * link with cstl_container_of(); insert and erase never allocate and erase
+ * needs no search. The tree holds its sentinel, so it must not be moved
+ * once initialized. rbt_intrusive_clear() hands every link to
+ * `release`, which must rbt_link_init() it if the object is to be reused.
+ */
+typedef int (*rbt_link_compare)(const struct rbt_link* a,
+                                const struct rbt_link* b);
+
+struct rbt_intrusive_tree {
+    struct rbt_root base;
+    struct rbt_link nil;
+    rbt_link_compare compare;
+    size_t count;
+    int allow_dup;
+};
+
+void rbt_link_init(struct rbt_link* link);
+int rbt_link_is_linked(const struct rbt_link* link);
+void rbt_intrusive_init(struct rbt_intrusive_tree* tree, rbt_link_compare cmp,
+                        int allow_dup);
+rbt_status rbt_intrusive_insert(struct rbt_intrusive_tree* tree,
+                                struct rbt_link* link);
+void rbt_intrusive_erase(struct rbt_intrusive_tree* tree,
+                         struct rbt_link* link);
+struct rbt_link* rbt_intrusive_find(struct rbt_intrusive_tree* tree,
+                                    const struct rbt_link* probe);
+struct rbt_link* rbt_intrusive_lower_bound(struct rbt_intrusive_tree* tree,
+                                           const struct rbt_link* probe);
+void rbt_intrusive_clear(struct rbt_intrusive_tree* tree,
+                         rbt_link_release release, void* p);
+
 int rbt_node_is_valid(const struct rbt_node* node);
 rbt_color rbt_node_get_color(const struct rbt_node* node);
 struct rbt_node* rbt_node_get_left(const struct rbt_node* node);
@@ -38,6 +109,8 @@ struct rbt_tree* rbt_tree_create(rbt_mem_allocate allocator,
 struct rbt_node* rbt_tree_get_root(struct rbt_tree* tree);
 rbt_status rbt_tree_insert(struct rbt_tree* tree, void* key, size_t size);
 struct rbt_node* rbt_tree_find(struct rbt_tree* tree, const void* key);
+void rbt_tree_find_batch(struct rbt_tree* tree, const void* const keys[],
+                         size_t n, struct rbt_node* out[]);
 rbt_status rbt_tree_remove_node(struct rbt_tree* tree, const void* key);
 rbt_status rbt_tree_destroy(struct rbt_tree* tree);
 int rbt_tree_is_empty(struct rbt_tree* tree);
@@ -48,6 +121,19 @@ struct rbt_node* rbt_tree_successor(struct rbt_tree* tree, struct rbt_node* x);
 typedef void (*rbt_node_walk_cb)(struct rbt_node* x, void* p);
 void rbt_inorder_walk(struct rbt_tree* tree, rbt_node_walk_cb cb, void* p);
 
+/*
+ * Moving nodes in and out of a tree without copying their keys.
+ * rbt_node_create() builds an unlinked node the way rbt_tree_insert() would,
+ * rbt_tree_insert_node() links it (refusing a duplicate unless the tree
+ * allows them) and rbt_tree_dissolve() hands every node to cb in key order,
+ * then frees the tree alone. The caller owns nodes it holds outside a tree
+ * and frees them with the releaser the tree would have used.
+ */
+struct rbt_node* rbt_node_create(rbt_mem_allocate allocator, const void* key,
+                                 size_t size);
+rbt_status rbt_tree_insert_node(struct rbt_tree* tree, struct rbt_node* node);
+void rbt_tree_dissolve(struct rbt_tree* tree, rbt_node_walk_cb cb, void* p);
+
 #ifdef __cplusplus
 }
 #endif
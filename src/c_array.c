@@ -267,15 +267,25 @@ static void cstl_array_replace_value(struct cstl_iterator* pIterator,
     cstl_object_replace_raw(currentElement, elem, elem_size);
 }
 
-struct cstl_iterator* cstl_array_new_iterator(struct cstl_array* pArray)
+void cstl_array_iterator_init(struct cstl_iterator* itr,
+                              struct cstl_array* pArray)
 {
-    struct cstl_iterator* itr =
-        (struct cstl_iterator*)calloc(1, sizeof(struct cstl_iterator));
+    assert(itr);
+    memset(itr, 0, sizeof(*itr));
     itr->next = cstl_array_get_next;
     itr->current_value = cstl_array_get_value;
     itr->replace_current_value = cstl_array_replace_value;
     itr->pContainer = pArray;
     itr->current_index = 0;
+}
+
+struct cstl_iterator* cstl_array_new_iterator(struct cstl_array* pArray)
+{
+    struct cstl_iterator* itr =
+        (struct cstl_iterator*)calloc(1, sizeof(struct cstl_iterator));
+    if (itr) {
+        cstl_array_iterator_init(itr, pArray);
+    }
     return itr;
 }
 
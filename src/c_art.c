@@ -0,0 +1,1073 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "c_stl_lib.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CSTL_ART_SSE2 1
+#endif
+
+/*
+ * Bytes of a compressed path kept in the node. Lookups compare only these
+ * and let the final leaf check catch the rest; updates that need the whole
+ * path read it from any leaf below. 8-byte integer keys never need more.
+ */
+#define CSTL_ART_PREFIX 9
+
+/* widest CSTL_ART_KEY_UINT key */
+#define CSTL_ART_UINT_MAX 8
+
+/* iterators build successor keys up to this size on the stack */
+#define CSTL_ART_STACK_KEY 64
+
+#define CSTL_ART_ALIGN(n) (((n) + 7) & ~(size_t)7)
+
+enum {
+    CSTL_ART_NODE4,
+    CSTL_ART_NODE16,
+    CSTL_ART_NODE48,
+    CSTL_ART_NODE256
+};
+
+struct cstl_art_node {
+    unsigned int prefix_len; /* length of the compressed path */
+    unsigned short nchild;
+    unsigned char type;
+    unsigned char prefix[CSTL_ART_PREFIX]; /* its first bytes */
+};
+
+/* children of Node4 and Node16 are sorted by key byte */
+struct cstl_art_node4 {
+    struct cstl_art_node n;
+    unsigned char keys[4];
+    void* child[4];
+};
+
+struct cstl_art_node16 {
+    struct cstl_art_node n;
+    unsigned char keys[16];
+    void* child[16];
+};
+
+struct cstl_art_node48 {
+    struct cstl_art_node n;
+    unsigned char index[256]; /* slot in child + 1, 0 if absent */
+    void* child[48];
+};
+
+struct cstl_art_node256 {
+    struct cstl_art_node n;
+    void* child[256];
+};
+
+/*
+ * A leaf holds the key as the caller passed it, followed by the value when
+ * it was copied in together with the key. Child slots point at leaves with
+ * the low bit set.
+ */
+struct cstl_art_leaf {
+    void* value;
+    int value_inline;
+};
+
+struct cstl_art {
+    void* root;
+    size_t count;
+    size_t key_size;
+    cstl_art_key_kind kind;
+    cstl_destroy fn_v_d;
+};
+
+#define cstl_art_is_leaf(p) (((uintptr_t)(p)) & 1)
+#define cstl_art_to_leaf(p) ((struct cstl_art_leaf*)((uintptr_t)(p) - 1))
+#define cstl_art_tag(l) ((void*)((uintptr_t)(l) + 1))
+#define cstl_art_leaf_key(l) ((unsigned char*)((l) + 1))
+
+/* iterator states, kept in current_index */
+#define CSTL_ART_ITER_START 0
+#define CSTL_ART_ITER_AT 1
+#define CSTL_ART_ITER_SEEK 2 /* current_element is the next key to report */
+#define CSTL_ART_ITER_END 3
+
+/* the key in memcmp order: the key itself, or buf for integer keys */
+static const unsigned char* _encode(const struct cstl_art* art,
+                                    const void* key, unsigned char* buf)
+{
+    uint64_t v;
+    size_t i;
+    if (art->kind == CSTL_ART_KEY_BYTES || art->key_size == 1) {
+        return (const unsigned char*)key;
+    }
+    if (art->key_size == 2) {
+        uint16_t x;
+        memcpy(&x, key, sizeof(x));
+        v = x;
+    }
+    else if (art->key_size == 4) {
+        uint32_t x;
+        memcpy(&x, key, sizeof(x));
+        v = x;
+    }
+    else {
+        memcpy(&v, key, sizeof(v));
+    }
+    for (i = art->key_size; i-- > 0;) {
+        buf[i] = (unsigned char)(v & 0xFF);
+        v >>= 8;
+    }
+    return buf;
+}
+
+static struct cstl_art_node* _node_new(unsigned char type)
+{
+    static const size_t sizes[] = {
+        sizeof(struct cstl_art_node4), sizeof(struct cstl_art_node16),
+        sizeof(struct cstl_art_node48), sizeof(struct cstl_art_node256)};
+    struct cstl_art_node* n = (struct cstl_art_node*)calloc(1, sizes[type]);
+    if (n) {
+        n->type = type;
+    }
+    return n;
+}
+
+/* copies everything but the type */
+static void _node_copy_header(struct cstl_art_node* dst,
+                              const struct cstl_art_node* src)
+{
+    dst->prefix_len = src->prefix_len;
+    dst->nchild = src->nchild;
+    memcpy(dst->prefix, src->prefix, CSTL_ART_PREFIX);
+}
+
+static struct cstl_art_leaf* _leaf_new(struct cstl_art* art, const void* key,
+                                       const void* value, size_t value_size)
+{
+    struct cstl_art_leaf* leaf;
+    if (!(value && value_size)) {
+        value_size = 0;
+    }
+    leaf = (struct cstl_art_leaf*)malloc(sizeof(struct cstl_art_leaf) +
+                                         CSTL_ART_ALIGN(art->key_size) +
+                                         value_size);
+    if (leaf == (struct cstl_art_leaf*)0) {
+        return leaf;
+    }
+    memcpy(cstl_art_leaf_key(leaf), key, art->key_size);
+    leaf->value = NULL;
+    leaf->value_inline = 0;
+    if (value_size) {
+        leaf->value =
+            cstl_art_leaf_key(leaf) + CSTL_ART_ALIGN(art->key_size);
+        leaf->value_inline = 1;
+        memcpy(leaf->value, value, value_size);
+    }
+    return leaf;
+}
+
+static void _leaf_value_release(struct cstl_art* art,
+                                struct cstl_art_leaf* leaf)
+{
+    if (leaf->value) {
+        if (art->fn_v_d) {
+            art->fn_v_d(leaf->value);
+        }
+        if (!leaf->value_inline) {
+            free(leaf->value);
+        }
+    }
+    leaf->value = NULL;
+    leaf->value_inline = 0;
+}
+
+static cstl_error _leaf_set_value(struct cstl_art* art,
+                                  struct cstl_art_leaf* leaf,
+                                  const void* value, size_t value_size)
+{
+    void* copy = NULL;
+    if (value && value_size) {
+        copy = malloc(value_size);
+        if (copy == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        memcpy(copy, value, value_size);
+    }
+    _leaf_value_release(art, leaf);
+    leaf->value = copy;
+    return CSTL_ERROR_SUCCESS;
+}
+
+static void _free(struct cstl_art* art, void* p)
+{
+    struct cstl_art_node* n;
+    int i;
+    if (p == NULL) {
+        return;
+    }
+    if (cstl_art_is_leaf(p)) {
+        _leaf_value_release(art, cstl_art_to_leaf(p));
+        free(cstl_art_to_leaf(p));
+        return;
+    }
+    n = (struct cstl_art_node*)p;
+    switch (n->type) {
+    case CSTL_ART_NODE4:
+        for (i = 0; i < n->nchild; ++i) {
+            _free(art, ((struct cstl_art_node4*)n)->child[i]);
+        }
+        break;
+    case CSTL_ART_NODE16:
+        for (i = 0; i < n->nchild; ++i) {
+            _free(art, ((struct cstl_art_node16*)n)->child[i]);
+        }
+        break;
+    case CSTL_ART_NODE48:
+        for (i = 0; i < 48; ++i) {
+            _free(art, ((struct cstl_art_node48*)n)->child[i]);
+        }
+        break;
+    default:
+        for (i = 0; i < 256; ++i) {
+            _free(art, ((struct cstl_art_node256*)n)->child[i]);
+        }
+        break;
+    }
+    free(n);
+}
+
+/* slot of the child under byte c, or NULL */
+static void** _find_child(struct cstl_art_node* n, unsigned char c)
+{
+    int i;
+    switch (n->type) {
+    case CSTL_ART_NODE4: {
+        struct cstl_art_node4* p = (struct cstl_art_node4*)n;
+        for (i = 0; i < n->nchild; ++i) {
+            if (p->keys[i] == c) {
+                return &p->child[i];
+            }
+        }
+        break;
+    }
+    case CSTL_ART_NODE16: {
+        struct cstl_art_node16* p = (struct cstl_art_node16*)n;
+#ifdef CSTL_ART_SSE2
+        __m128i eq = _mm_cmpeq_epi8(_mm_set1_epi8((char)c),
+                                    _mm_loadu_si128((const __m128i*)p->keys));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(eq) &
+                            ((1u << n->nchild) - 1);
+        if (mask) {
+            return &p->child[cstl_ctz64(mask)];
+        }
+#else
+        for (i = 0; i < n->nchild; ++i) {
+            if (p->keys[i] == c) {
+                return &p->child[i];
+            }
+        }
+#endif
+        break;
+    }
+    case CSTL_ART_NODE48: {
+        struct cstl_art_node48* p = (struct cstl_art_node48*)n;
+        if (p->index[c]) {
+            return &p->child[p->index[c] - 1];
+        }
+        break;
+    }
+    default: {
+        struct cstl_art_node256* p = (struct cstl_art_node256*)n;
+        if (p->child[c]) {
+            return &p->child[c];
+        }
+        break;
+    }
+    }
+    return NULL;
+}
+
+/* slot of the first child under a byte greater than c, or NULL */
+static void** _child_after(struct cstl_art_node* n, unsigned char c)
+{
+    int i;
+    switch (n->type) {
+    case CSTL_ART_NODE4: {
+        struct cstl_art_node4* p = (struct cstl_art_node4*)n;
+        for (i = 0; i < n->nchild; ++i) {
+            if (p->keys[i] > c) {
+                return &p->child[i];
+            }
+        }
+        break;
+    }
+    case CSTL_ART_NODE16: {
+        struct cstl_art_node16* p = (struct cstl_art_node16*)n;
+        for (i = 0; i < n->nchild; ++i) {
+            if (p->keys[i] > c) {
+                return &p->child[i];
+            }
+        }
+        break;
+    }
+    case CSTL_ART_NODE48: {
+        struct cstl_art_node48* p = (struct cstl_art_node48*)n;
+        for (i = c + 1; i < 256; ++i) {
+            if (p->index[i]) {
+                return &p->child[p->index[i] - 1];
+            }
+        }
+        break;
+    }
+    default: {
+        struct cstl_art_node256* p = (struct cstl_art_node256*)n;
+        for (i = c + 1; i < 256; ++i) {
+            if (p->child[i]) {
+                return &p->child[i];
+            }
+        }
+        break;
+    }
+    }
+    return NULL;
+}
+
+static struct cstl_art_leaf* _minimum(void* p)
+{
+    while (!cstl_art_is_leaf(p)) {
+        struct cstl_art_node* n = (struct cstl_art_node*)p;
+        int i;
+        switch (n->type) {
+        case CSTL_ART_NODE4:
+            p = ((struct cstl_art_node4*)n)->child[0];
+            break;
+        case CSTL_ART_NODE16:
+            p = ((struct cstl_art_node16*)n)->child[0];
+            break;
+        case CSTL_ART_NODE48: {
+            struct cstl_art_node48* q = (struct cstl_art_node48*)n;
+            for (i = 0; !q->index[i]; ++i) {
+            }
+            p = q->child[q->index[i] - 1];
+            break;
+        }
+        default: {
+            struct cstl_art_node256* q = (struct cstl_art_node256*)n;
+            for (i = 0; !q->child[i]; ++i) {
+            }
+            p = q->child[i];
+            break;
+        }
+        }
+    }
+    return cstl_art_to_leaf(p);
+}
+
+/* the whole compressed path of n, which starts at key byte depth */
+static const unsigned char* _prefix_bytes(const struct cstl_art* art,
+                                          struct cstl_art_node* n,
+                                          size_t depth, unsigned char* buf)
+{
+    if (n->prefix_len <= CSTL_ART_PREFIX) {
+        return n->prefix;
+    }
+    return _encode(art, cstl_art_leaf_key(_minimum(n)), buf) + depth;
+}
+
+/* compares the bytes of the path that n stores */
+static int _prefix_matches(const struct cstl_art_node* n,
+                           const unsigned char* k, size_t depth)
+{
+    size_t len = n->prefix_len < CSTL_ART_PREFIX ? n->prefix_len
+                                                 : CSTL_ART_PREFIX;
+    return memcmp(n->prefix, k + depth, len) == 0;
+}
+
+/* adds child under byte c, replacing n (and *ref) by a larger node if full */
+static cstl_error _add_child(void** ref, struct cstl_art_node* n,
+                             unsigned char c, void* child)
+{
+    int i;
+    switch (n->type) {
+    case CSTL_ART_NODE4: {
+        struct cstl_art_node4* p = (struct cstl_art_node4*)n;
+        struct cstl_art_node16* q;
+        if (n->nchild < 4) {
+            for (i = n->nchild; i > 0 && p->keys[i - 1] > c; --i) {
+                p->keys[i] = p->keys[i - 1];
+                p->child[i] = p->child[i - 1];
+            }
+            p->keys[i] = c;
+            p->child[i] = child;
+            n->nchild++;
+            return CSTL_ERROR_SUCCESS;
+        }
+        q = (struct cstl_art_node16*)_node_new(CSTL_ART_NODE16);
+        if (q == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        _node_copy_header(&q->n, n);
+        memcpy(q->keys, p->keys, sizeof(p->keys));
+        memcpy(q->child, p->child, sizeof(p->child));
+        *ref = q;
+        free(n);
+        return _add_child(ref, &q->n, c, child);
+    }
+    case CSTL_ART_NODE16: {
+        struct cstl_art_node16* p = (struct cstl_art_node16*)n;
+        struct cstl_art_node48* q;
+        if (n->nchild < 16) {
+            for (i = n->nchild; i > 0 && p->keys[i - 1] > c; --i) {
+                p->keys[i] = p->keys[i - 1];
+                p->child[i] = p->child[i - 1];
+            }
+            p->keys[i] = c;
+            p->child[i] = child;
+            n->nchild++;
+            return CSTL_ERROR_SUCCESS;
+        }
+        q = (struct cstl_art_node48*)_node_new(CSTL_ART_NODE48);
+        if (q == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        _node_copy_header(&q->n, n);
+        for (i = 0; i < 16; ++i) {
+            q->index[p->keys[i]] = (unsigned char)(i + 1);
+            q->child[i] = p->child[i];
+        }
+        *ref = q;
+        free(n);
+        return _add_child(ref, &q->n, c, child);
+    }
+    case CSTL_ART_NODE48: {
+        struct cstl_art_node48* p = (struct cstl_art_node48*)n;
+        struct cstl_art_node256* q;
+        if (n->nchild < 48) {
+            for (i = 0; p->child[i]; ++i) {
+            }
+            p->index[c] = (unsigned char)(i + 1);
+            p->child[i] = child;
+            n->nchild++;
+            return CSTL_ERROR_SUCCESS;
+        }
+        q = (struct cstl_art_node256*)_node_new(CSTL_ART_NODE256);
+        if (q == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        _node_copy_header(&q->n, n);
+        for (i = 0; i < 256; ++i) {
+            if (p->index[i]) {
+                q->child[i] = p->child[p->index[i] - 1];
+            }
+        }
+        *ref = q;
+        free(n);
+        return _add_child(ref, &q->n, c, child);
+    }
+    default:
+        ((struct cstl_art_node256*)n)->child[c] = child;
+        n->nchild++;
+        return CSTL_ERROR_SUCCESS;
+    }
+}
+
+/*
+ * A Node4 left with one child is replaced by it; a child node then takes
+ * over the path leading to it. Running out of memory while shrinking any
+ * other node just keeps the larger one.
+ */
+static void _collapse(void** ref, struct cstl_art_node4* p)
+{
+    void* only = p->child[0];
+    if (!cstl_art_is_leaf(only)) {
+        struct cstl_art_node* n = &p->n;
+        struct cstl_art_node* child = (struct cstl_art_node*)only;
+        unsigned char path[CSTL_ART_PREFIX];
+        size_t len = 0, j;
+        for (j = 0; j < n->prefix_len && len < CSTL_ART_PREFIX; ++j) {
+            path[len++] = n->prefix[j];
+        }
+        if (len < CSTL_ART_PREFIX) {
+            path[len++] = p->keys[0];
+        }
+        for (j = 0; j < child->prefix_len && len < CSTL_ART_PREFIX; ++j) {
+            path[len++] = child->prefix[j];
+        }
+        memcpy(child->prefix, path, len);
+        child->prefix_len += n->prefix_len + 1;
+    }
+    *ref = only;
+    free(p);
+}
+
+/* removes the child in slot, shrinking n (and replacing *ref) if sparse */
+static void _remove_child(void** ref, struct cstl_art_node* n,
+                          unsigned char c, void** slot)
+{
+    int i, k;
+    switch (n->type) {
+    case CSTL_ART_NODE4: {
+        struct cstl_art_node4* p = (struct cstl_art_node4*)n;
+        for (i = (int)(slot - p->child); i + 1 < n->nchild; ++i) {
+            p->keys[i] = p->keys[i + 1];
+            p->child[i] = p->child[i + 1];
+        }
+        if (--n->nchild == 1) {
+            _collapse(ref, p);
+        }
+        break;
+    }
+    case CSTL_ART_NODE16: {
+        struct cstl_art_node16* p = (struct cstl_art_node16*)n;
+        struct cstl_art_node4* q;
+        for (i = (int)(slot - p->child); i + 1 < n->nchild; ++i) {
+            p->keys[i] = p->keys[i + 1];
+            p->child[i] = p->child[i + 1];
+        }
+        if (--n->nchild == 3) {
+            q = (struct cstl_art_node4*)_node_new(CSTL_ART_NODE4);
+            if (q) {
+                _node_copy_header(&q->n, n);
+                memcpy(q->keys, p->keys, 3);
+                memcpy(q->child, p->child, 3 * sizeof(void*));
+                *ref = q;
+                free(n);
+            }
+        }
+        break;
+    }
+    case CSTL_ART_NODE48: {
+        struct cstl_art_node48* p = (struct cstl_art_node48*)n;
+        struct cstl_art_node16* q;
+        *slot = NULL;
+        p->index[c] = 0;
+        if (--n->nchild == 12) {
+            q = (struct cstl_art_node16*)_node_new(CSTL_ART_NODE16);
+            if (q) {
+                _node_copy_header(&q->n, n);
+                for (i = 0, k = 0; i < 256; ++i) {
+                    if (p->index[i]) {
+                        q->keys[k] = (unsigned char)i;
+                        q->child[k++] = p->child[p->index[i] - 1];
+                    }
+                }
+                *ref = q;
+                free(n);
+            }
+        }
+        break;
+    }
+    default: {
+        struct cstl_art_node256* p = (struct cstl_art_node256*)n;
+        struct cstl_art_node48* q;
+        *slot = NULL;
+        if (--n->nchild == 37) {
+            q = (struct cstl_art_node48*)_node_new(CSTL_ART_NODE48);
+            if (q) {
+                _node_copy_header(&q->n, n);
+                for (i = 0, k = 0; i < 256; ++i) {
+                    if (p->child[i]) {
+                        q->child[k] = p->child[i];
+                        q->index[i] = (unsigned char)++k;
+                    }
+                }
+                *ref = q;
+                free(n);
+            }
+        }
+        break;
+    }
+    }
+}
+
+/* a Node4 whose two children differ first at the byte after its path */
+static struct cstl_art_node* _node_pair(const unsigned char* path,
+                                        size_t len, unsigned char a,
+                                        void* ca, unsigned char b, void* cb)
+{
+    struct cstl_art_node4* q =
+        (struct cstl_art_node4*)_node_new(CSTL_ART_NODE4);
+    if (q == NULL) {
+        return NULL;
+    }
+    q->n.prefix_len = (unsigned int)len;
+    memcpy(q->n.prefix, path, len < CSTL_ART_PREFIX ? len : CSTL_ART_PREFIX);
+    q->n.nchild = 2;
+    q->keys[a < b ? 0 : 1] = a;
+    q->child[a < b ? 0 : 1] = ca;
+    q->keys[a < b ? 1 : 0] = b;
+    q->child[a < b ? 1 : 0] = cb;
+    return &q->n;
+}
+
+static cstl_error _insert(struct cstl_art* art, void** ref,
+                          const unsigned char* k, size_t depth,
+                          const void* key, const void* value,
+                          size_t value_size)
+{
+    unsigned char buf[CSTL_ART_UINT_MAX];
+    struct cstl_art_leaf* leaf;
+    struct cstl_art_node* n;
+    void* p = *ref;
+    void** child;
+    cstl_error rc;
+
+    if (p == NULL) {
+        leaf = _leaf_new(art, key, value, value_size);
+        if (leaf == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        *ref = cstl_art_tag(leaf);
+        return CSTL_ERROR_SUCCESS;
+    }
+    if (cstl_art_is_leaf(p)) {
+        const unsigned char* other =
+            _encode(art, cstl_art_leaf_key(cstl_art_to_leaf(p)), buf);
+        size_t i = depth;
+        while (i < art->key_size && other[i] == k[i]) {
+            ++i;
+        }
+        if (i == art->key_size) {
+            return CSTL_RBTREE_KEY_DUPLICATE;
+        }
+        leaf = _leaf_new(art, key, value, value_size);
+        if (leaf == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        n = _node_pair(k + depth, i - depth, other[i], p, k[i],
+                       cstl_art_tag(leaf));
+        if (n == NULL) {
+            free(leaf);
+            return CSTL_ERROR_MEMORY;
+        }
+        *ref = n;
+        return CSTL_ERROR_SUCCESS;
+    }
+    n = (struct cstl_art_node*)p;
+    if (n->prefix_len) {
+        const unsigned char* path = _prefix_bytes(art, n, depth, buf);
+        size_t i = 0;
+        while (i < n->prefix_len && path[i] == k[depth + i]) {
+            ++i;
+        }
+        if (i < n->prefix_len) {
+            /* the new node takes the shared part of the path */
+            struct cstl_art_node* q;
+            size_t rest = n->prefix_len - i - 1;
+            leaf = _leaf_new(art, key, value, value_size);
+            if (leaf == NULL) {
+                return CSTL_ERROR_MEMORY;
+            }
+            q = _node_pair(path, i, path[i], n, k[depth + i],
+                           cstl_art_tag(leaf));
+            if (q == NULL) {
+                free(leaf);
+                return CSTL_ERROR_MEMORY;
+            }
+            memmove(n->prefix, path + i + 1,
+                    rest < CSTL_ART_PREFIX ? rest : CSTL_ART_PREFIX);
+            n->prefix_len = (unsigned int)rest;
+            *ref = q;
+            return CSTL_ERROR_SUCCESS;
+        }
+        depth += n->prefix_len;
+    }
+    child = _find_child(n, k[depth]);
+    if (child) {
+        return _insert(art, child, k, depth + 1, key, value, value_size);
+    }
+    leaf = _leaf_new(art, key, value, value_size);
+    if (leaf == NULL) {
+        return CSTL_ERROR_MEMORY;
+    }
+    rc = _add_child(ref, n, k[depth], cstl_art_tag(leaf));
+    if (rc != CSTL_ERROR_SUCCESS) {
+        free(leaf);
+    }
+    return rc;
+}
+
+/* returns the removed leaf, or NULL if key is not there */
+static struct cstl_art_leaf* _remove(struct cstl_art* art, void** ref,
+                                     const void* key, const unsigned char* k,
+                                     size_t depth)
+{
+    struct cstl_art_leaf* leaf;
+    struct cstl_art_node* n;
+    void** child;
+    void* p = *ref;
+
+    if (p == NULL) {
+        return NULL;
+    }
+    if (cstl_art_is_leaf(p)) {
+        leaf = cstl_art_to_leaf(p);
+        if (memcmp(cstl_art_leaf_key(leaf), key, art->key_size) != 0) {
+            return NULL;
+        }
+        *ref = NULL;
+        return leaf;
+    }
+    n = (struct cstl_art_node*)p;
+    if (n->prefix_len) {
+        if (!_prefix_matches(n, k, depth)) {
+            return NULL;
+        }
+        depth += n->prefix_len;
+    }
+    child = _find_child(n, k[depth]);
+    if (child == NULL) {
+        return NULL;
+    }
+    if (!cstl_art_is_leaf(*child)) {
+        return _remove(art, child, key, k, depth + 1);
+    }
+    leaf = cstl_art_to_leaf(*child);
+    if (memcmp(cstl_art_leaf_key(leaf), key, art->key_size) != 0) {
+        return NULL;
+    }
+    _remove_child(ref, n, k[depth], child);
+    return leaf;
+}
+
+/* first leaf under p not less than k, given k[0..depth) leads to p */
+static struct cstl_art_leaf* _lower_bound(const struct cstl_art* art, void* p,
+                                          const unsigned char* k,
+                                          size_t depth)
+{
+    unsigned char buf[CSTL_ART_UINT_MAX];
+    struct cstl_art_leaf* leaf;
+    struct cstl_art_node* n;
+    void** child;
+
+    if (cstl_art_is_leaf(p)) {
+        leaf = cstl_art_to_leaf(p);
+        if (memcmp(_encode(art, cstl_art_leaf_key(leaf), buf), k,
+                   art->key_size) >= 0) {
+            return leaf;
+        }
+        return NULL;
+    }
+    n = (struct cstl_art_node*)p;
+    if (n->prefix_len) {
+        int cmp =
+            memcmp(_prefix_bytes(art, n, depth, buf), k + depth,
+                   n->prefix_len);
+        if (cmp > 0) {
+            return _minimum(n);
+        }
+        if (cmp < 0) {
+            return NULL;
+        }
+        depth += n->prefix_len;
+    }
+    child = _find_child(n, k[depth]);
+    if (child) {
+        leaf = _lower_bound(art, *child, k, depth + 1);
+        if (leaf) {
+            return leaf;
+        }
+    }
+    child = _child_after(n, k[depth]);
+    return child ? _minimum(*child) : NULL;
+}
+
+static struct cstl_art_leaf* _find_leaf(struct cstl_art* art,
+                                        const void* key)
+{
+    unsigned char buf[CSTL_ART_UINT_MAX];
+    const unsigned char* k = _encode(art, key, buf);
+    void* p = art->root;
+    size_t depth = 0;
+
+    while (p) {
+        struct cstl_art_node* n;
+        void** child;
+        if (cstl_art_is_leaf(p)) {
+            struct cstl_art_leaf* leaf = cstl_art_to_leaf(p);
+            if (memcmp(cstl_art_leaf_key(leaf), key, art->key_size) == 0) {
+                return leaf;
+            }
+            return NULL;
+        }
+        n = (struct cstl_art_node*)p;
+        if (n->prefix_len) {
+            if (!_prefix_matches(n, k, depth)) {
+                return NULL;
+            }
+            depth += n->prefix_len;
+        }
+        child = _find_child(n, k[depth]);
+        if (child == NULL) {
+            return NULL;
+        }
+        p = *child;
+        ++depth;
+    }
+    return NULL;
+}
+
+struct cstl_art* cstl_art_new(size_t key_size, cstl_art_key_kind kind,
+                              cstl_destroy fn_v_d)
+{
+    struct cstl_art* art;
+    if (key_size == 0) {
+        return (struct cstl_art*)0;
+    }
+    if (kind == CSTL_ART_KEY_UINT && key_size != 1 && key_size != 2 &&
+        key_size != 4 && key_size != 8) {
+        return (struct cstl_art*)0;
+    }
+    art = (struct cstl_art*)calloc(1, sizeof(struct cstl_art));
+    if (art) {
+        art->key_size = key_size;
+        art->kind = kind;
+        art->fn_v_d = fn_v_d;
+    }
+    return art;
+}
+
+cstl_error cstl_art_delete(struct cstl_art* art)
+{
+    if (art == (struct cstl_art*)0) {
+        return CSTL_ART_NOT_INITIALIZED;
+    }
+    _free(art, art->root);
+    free(art);
+    return CSTL_ERROR_SUCCESS;
+}
+
+size_t cstl_art_size(struct cstl_art* art)
+{
+    return art ? art->count : 0;
+}
+
+cstl_error cstl_art_insert(struct cstl_art* art, const void* key,
+                           const void* value, size_t value_size)
+{
+    unsigned char buf[CSTL_ART_UINT_MAX];
+    cstl_error rc;
+    if (art == (struct cstl_art*)0) {
+        return CSTL_ART_NOT_INITIALIZED;
+    }
+    if (key == NULL) {
+        return CSTL_ART_INVALID_INPUT;
+    }
+    rc = _insert(art, &art->root, _encode(art, key, buf), 0, key, value,
+                 value_size);
+    if (rc == CSTL_ERROR_SUCCESS) {
+        art->count++;
+    }
+    return rc;
+}
+
+int cstl_art_is_key_exists(struct cstl_art* art, const void* key)
+{
+    if (art == (struct cstl_art*)0 || key == NULL) {
+        return 0;
+    }
+    return _find_leaf(art, key) != NULL;
+}
+
+cstl_error cstl_art_replace(struct cstl_art* art, const void* key,
+                            const void* value, size_t value_size)
+{
+    struct cstl_art_leaf* leaf;
+    if (art == (struct cstl_art*)0) {
+        return CSTL_ART_NOT_INITIALIZED;
+    }
+    if (key == NULL) {
+        return CSTL_ART_INVALID_INPUT;
+    }
+    leaf = _find_leaf(art, key);
+    if (leaf == NULL) {
+        return CSTL_RBTREE_KEY_NOT_FOUND;
+    }
+    return _leaf_set_value(art, leaf, value, value_size);
+}
+
+cstl_error cstl_art_remove(struct cstl_art* art, const void* key)
+{
+    unsigned char buf[CSTL_ART_UINT_MAX];
+    struct cstl_art_leaf* leaf;
+    if (art == (struct cstl_art*)0) {
+        return CSTL_ART_NOT_INITIALIZED;
+    }
+    if (key == NULL) {
+        return CSTL_ART_INVALID_INPUT;
+    }
+    leaf = _remove(art, &art->root, key, _encode(art, key, buf), 0);
+    if (leaf == NULL) {
+        return CSTL_RBTREE_KEY_NOT_FOUND;
+    }
+    _leaf_value_release(art, leaf);
+    free(leaf);
+    art->count--;
+    return CSTL_ERROR_SUCCESS;
+}
+
+const void* cstl_art_find(struct cstl_art* art, const void* key)
+{
+    struct cstl_art_leaf* leaf;
+    if (art == (struct cstl_art*)0 || key == NULL) {
+        return NULL;
+    }
+    leaf = _find_leaf(art, key);
+    return leaf ? leaf->value : NULL;
+}
+
+const void* cstl_art_lower_bound(struct cstl_art* art, const void* key)
+{
+    unsigned char buf[CSTL_ART_UINT_MAX];
+    struct cstl_art_leaf* leaf;
+    if (art == (struct cstl_art*)0 || key == NULL || art->root == NULL) {
+        return NULL;
+    }
+    leaf = _lower_bound(art, art->root, _encode(art, key, buf), 0);
+    return leaf ? cstl_art_leaf_key(leaf) : NULL;
+}
+
+const void* cstl_art_value(struct cstl_art* art, const void* stored_key)
+{
+    (void)art;
+    if (stored_key == NULL) {
+        return NULL;
+    }
+    return ((const struct cstl_art_leaf*)stored_key - 1)->value;
+}
+
+/* the leaf after the one holding stored_key, or NULL */
+static struct cstl_art_leaf* _successor(struct cstl_art* art,
+                                        const void* stored_key)
+{
+    unsigned char stack[CSTL_ART_STACK_KEY];
+    unsigned char buf[CSTL_ART_UINT_MAX];
+    unsigned char* succ = stack;
+    struct cstl_art_leaf* leaf = NULL;
+    size_t i;
+
+    if (art->key_size > CSTL_ART_STACK_KEY) {
+        succ = (unsigned char*)malloc(art->key_size);
+        if (succ == NULL) {
+            return NULL;
+        }
+    }
+    memcpy(succ, _encode(art, stored_key, buf), art->key_size);
+    for (i = art->key_size; i-- > 0;) {
+        if (++succ[i] != 0) {
+            break;
+        }
+    }
+    /* i wraps around only if stored_key was the largest possible key */
+    if (i < art->key_size && art->root) {
+        leaf = _lower_bound(art, art->root, succ, 0);
+    }
+    if (succ != stack) {
+        free(succ);
+    }
+    return leaf;
+}
+
+/* current_element is the key of the current leaf */
+static const void* cstl_art_iter_get_next(struct cstl_iterator* pItr)
+{
+    struct cstl_art* art = (struct cstl_art*)pItr->pContainer;
+    struct cstl_art_leaf* leaf = NULL;
+
+    switch (pItr->current_index) {
+    case CSTL_ART_ITER_START:
+        leaf = art->root ? _minimum(art->root) : NULL;
+        break;
+    case CSTL_ART_ITER_AT:
+        leaf = _successor(art, pItr->current_element);
+        break;
+    case CSTL_ART_ITER_SEEK:
+        if (pItr->current_element) {
+            leaf = (struct cstl_art_leaf*)pItr->current_element - 1;
+        }
+        break;
+    default:
+        return NULL;
+    }
+    pItr->current_element = leaf ? cstl_art_leaf_key(leaf) : NULL;
+    pItr->current_index = leaf ? CSTL_ART_ITER_AT : CSTL_ART_ITER_END;
+    return pItr->current_element;
+}
+
+static const void* cstl_art_iter_get_key(struct cstl_iterator* pItr)
+{
+    return pItr->current_element;
+}
+
+static const void* cstl_art_iter_get_value(struct cstl_iterator* pItr)
+{
+    return ((struct cstl_art_leaf*)pItr->current_element - 1)->value;
+}
+
+static void cstl_art_iter_replace_value(struct cstl_iterator* pItr,
+                                        void* elem, size_t elem_size)
+{
+    _leaf_set_value((struct cstl_art*)pItr->pContainer,
+                    (struct cstl_art_leaf*)pItr->current_element - 1, elem,
+                    elem_size);
+}
+
+void cstl_art_iterator_init(struct cstl_iterator* itr, struct cstl_art* art)
+{
+    assert(itr);
+    memset(itr, 0, sizeof(*itr));
+    itr->next = cstl_art_iter_get_next;
+    itr->current_key = cstl_art_iter_get_key;
+    itr->current_value = cstl_art_iter_get_value;
+    itr->replace_current_value = cstl_art_iter_replace_value;
+    itr->pContainer = art;
+    itr->current_index = CSTL_ART_ITER_START;
+    itr->current_element = (void*)0;
+}
+
+void cstl_art_iterator_seek(struct cstl_iterator* pItr, const void* key)
+{
+    assert(pItr);
+    pItr->current_element = (void*)cstl_art_lower_bound(
+        (struct cstl_art*)pItr->pContainer, key);
+    pItr->current_index = CSTL_ART_ITER_SEEK;
+}
+
+struct cstl_iterator* cstl_art_new_iterator(struct cstl_art* art)
+{
+    struct cstl_iterator* itr =
+        (struct cstl_iterator*)calloc(1, sizeof(struct cstl_iterator));
+    if (itr) {
+        cstl_art_iterator_init(itr, art);
+    }
+    return itr;
+}
+
+void cstl_art_delete_iterator(struct cstl_iterator* pItr)
+{
+    free(pItr);
+}
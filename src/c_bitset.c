@@ -0,0 +1,413 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "c_stl_lib.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CSTL_BITSET_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CSTL_BITSET_SSE2 1
+#endif
+
+#define CSTL_BITSET_WORD_BITS 64
+#define cstl_bitset_words(nbits) \
+    (((nbits) + CSTL_BITSET_WORD_BITS - 1) / CSTL_BITSET_WORD_BITS)
+
+struct cstl_bitset {
+    uint64_t* words;
+    size_t nbits;
+    size_t capacity; /* in words */
+};
+
+static unsigned int _popcount64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned int)__builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555u);
+    x = (x & 0x3333333333333333u) + ((x >> 2) & 0x3333333333333333u);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Fu;
+    return (unsigned int)((x * 0x0101010101010101u) >> 56);
+#endif
+}
+
+/* clears the bits of the last word past the size */
+static void _trim(struct cstl_bitset* bs)
+{
+    size_t tail = bs->nbits % CSTL_BITSET_WORD_BITS;
+    if (tail) {
+        bs->words[bs->nbits / CSTL_BITSET_WORD_BITS] &=
+            ((uint64_t)1 << tail) - 1;
+    }
+}
+
+struct cstl_bitset* cstl_bitset_new(size_t nbits)
+{
+    struct cstl_bitset* bs =
+        (struct cstl_bitset*)calloc(1, sizeof(struct cstl_bitset));
+    if (bs && cstl_bitset_resize(bs, nbits) != CSTL_ERROR_SUCCESS) {
+        free(bs);
+        bs = (struct cstl_bitset*)0;
+    }
+    return bs;
+}
+
+cstl_error cstl_bitset_delete(struct cstl_bitset* bs)
+{
+    if (bs == (struct cstl_bitset*)0) {
+        return CSTL_BITSET_NOT_INITIALIZED;
+    }
+    free(bs->words);
+    free(bs);
+    return CSTL_ERROR_SUCCESS;
+}
+
+size_t cstl_bitset_size(struct cstl_bitset* bs)
+{
+    return bs ? bs->nbits : 0;
+}
+
+cstl_error cstl_bitset_resize(struct cstl_bitset* bs, size_t nbits)
+{
+    size_t old_words, new_words;
+    if (bs == (struct cstl_bitset*)0) {
+        return CSTL_BITSET_NOT_INITIALIZED;
+    }
+    old_words = cstl_bitset_words(bs->nbits);
+    new_words = cstl_bitset_words(nbits);
+    if (new_words > bs->capacity) {
+        size_t capacity = bs->capacity ? bs->capacity * 2 : 4;
+        uint64_t* words;
+        if (capacity < new_words) {
+            capacity = new_words;
+        }
+        words = (uint64_t*)realloc(bs->words, capacity * sizeof(uint64_t));
+        if (words == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        bs->words = words;
+        bs->capacity = capacity;
+    }
+    if (new_words > old_words) {
+        memset(bs->words + old_words, 0,
+               (new_words - old_words) * sizeof(uint64_t));
+    }
+    else if (new_words < old_words) {
+        /* words past the end must read as zero once the set grows again */
+        memset(bs->words + new_words, 0,
+               (old_words - new_words) * sizeof(uint64_t));
+    }
+    bs->nbits = nbits;
+    _trim(bs);
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_bitset_set(struct cstl_bitset* bs, size_t i)
+{
+    if (bs == (struct cstl_bitset*)0) {
+        return CSTL_BITSET_NOT_INITIALIZED;
+    }
+    if (i >= bs->nbits) {
+        return CSTL_BITSET_INDEX_OUT_OF_BOUND;
+    }
+    bs->words[i / CSTL_BITSET_WORD_BITS] |= (uint64_t)1
+                                            << (i % CSTL_BITSET_WORD_BITS);
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_bitset_clear(struct cstl_bitset* bs, size_t i)
+{
+    if (bs == (struct cstl_bitset*)0) {
+        return CSTL_BITSET_NOT_INITIALIZED;
+    }
+    if (i >= bs->nbits) {
+        return CSTL_BITSET_INDEX_OUT_OF_BOUND;
+    }
+    bs->words[i / CSTL_BITSET_WORD_BITS] &=
+        ~((uint64_t)1 << (i % CSTL_BITSET_WORD_BITS));
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_bitset_flip(struct cstl_bitset* bs, size_t i)
+{
+    if (bs == (struct cstl_bitset*)0) {
+        return CSTL_BITSET_NOT_INITIALIZED;
+    }
+    if (i >= bs->nbits) {
+        return CSTL_BITSET_INDEX_OUT_OF_BOUND;
+    }
+    bs->words[i / CSTL_BITSET_WORD_BITS] ^= (uint64_t)1
+                                            << (i % CSTL_BITSET_WORD_BITS);
+    return CSTL_ERROR_SUCCESS;
+}
+
+int cstl_bitset_test(struct cstl_bitset* bs, size_t i)
+{
+    if (bs == (struct cstl_bitset*)0 || i >= bs->nbits) {
+        return 0;
+    }
+    return (int)((bs->words[i / CSTL_BITSET_WORD_BITS] >>
+                  (i % CSTL_BITSET_WORD_BITS)) &
+                 1);
+}
+
+void cstl_bitset_clear_all(struct cstl_bitset* bs)
+{
+    if (bs && bs->nbits) {
+        memset(bs->words, 0,
+               cstl_bitset_words(bs->nbits) * sizeof(uint64_t));
+    }
+}
+
+size_t cstl_bitset_words_popcount(const uint64_t* w, size_t n)
+{
+    size_t i = 0, total = 0;
+#if defined(CSTL_BITSET_AVX2)
+    {
+        /* bit counts of each nibble, looked up 32 bytes at a time */
+        const __m256i table =
+            _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                             0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i low = _mm256_set1_epi8(0x0F);
+        __m256i acc = _mm256_setzero_si256();
+        uint64_t lanes[4];
+        for (; i + 4 <= n; i += 4) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(w + i));
+            __m256i c = _mm256_add_epi8(
+                _mm256_shuffle_epi8(table, _mm256_and_si256(v, low)),
+                _mm256_shuffle_epi8(
+                    table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+            acc = _mm256_add_epi64(acc,
+                                   _mm256_sad_epu8(c, _mm256_setzero_si256()));
+        }
+        _mm256_storeu_si256((__m256i*)lanes, acc);
+        total = (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    }
+#elif defined(CSTL_BITSET_SSE2)
+    {
+        /* the classic shift-and-mask count, 128 bits at a time */
+        const __m128i m1 = _mm_set1_epi8(0x55);
+        const __m128i m2 = _mm_set1_epi8(0x33);
+        const __m128i m4 = _mm_set1_epi8(0x0F);
+        __m128i acc = _mm_setzero_si128();
+        uint64_t lanes[2];
+        for (; i + 2 <= n; i += 2) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(w + i));
+            v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi64(v, 1), m1));
+            v = _mm_add_epi8(_mm_and_si128(v, m2),
+                             _mm_and_si128(_mm_srli_epi64(v, 2), m2));
+            v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi64(v, 4)), m4);
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(v, _mm_setzero_si128()));
+        }
+        _mm_storeu_si128((__m128i*)lanes, acc);
+        total = (size_t)(lanes[0] + lanes[1]);
+    }
+#endif
+    for (; i < n; ++i) {
+        total += _popcount64(w[i]);
+    }
+    return total;
+}
+
+size_t cstl_bitset_popcount(struct cstl_bitset* bs)
+{
+    if (bs == (struct cstl_bitset*)0) {
+        return 0;
+    }
+    return cstl_bitset_words_popcount(bs->words,
+                                      cstl_bitset_words(bs->nbits));
+}
+
+size_t cstl_bitset_find_first_set(struct cstl_bitset* bs)
+{
+    return cstl_bitset_find_next_set(bs, 0);
+}
+
+size_t cstl_bitset_words_next_set(const uint64_t* w, size_t n, size_t i)
+{
+    size_t k = i / CSTL_BITSET_WORD_BITS;
+    uint64_t word;
+    if (k >= n) {
+        return CSTL_BITSET_NPOS;
+    }
+    word = w[k] & (~(uint64_t)0 << (i % CSTL_BITSET_WORD_BITS));
+    while (word == 0) {
+        if (++k == n) {
+            return CSTL_BITSET_NPOS;
+        }
+        word = w[k];
+    }
+    return k * CSTL_BITSET_WORD_BITS + cstl_ctz64(word);
+}
+
+size_t cstl_bitset_find_next_set(struct cstl_bitset* bs, size_t i)
+{
+    if (bs == (struct cstl_bitset*)0 || i >= bs->nbits) {
+        return CSTL_BITSET_NPOS;
+    }
+    return cstl_bitset_words_next_set(bs->words,
+                                      cstl_bitset_words(bs->nbits), i);
+}
+
+size_t cstl_bitset_find_next_clear(struct cstl_bitset* bs, size_t i)
+{
+    size_t w, n, found;
+    uint64_t word;
+    if (bs == (struct cstl_bitset*)0 || i >= bs->nbits) {
+        return CSTL_BITSET_NPOS;
+    }
+    w = i / CSTL_BITSET_WORD_BITS;
+    n = cstl_bitset_words(bs->nbits);
+    word = ~bs->words[w] & (~(uint64_t)0 << (i % CSTL_BITSET_WORD_BITS));
+    while (word == 0) {
+        if (++w == n) {
+            return CSTL_BITSET_NPOS;
+        }
+        word = ~bs->words[w];
+    }
+    /* the clear bits past the size do not count */
+    found = w * CSTL_BITSET_WORD_BITS + cstl_ctz64(word);
+    return found < bs->nbits ? found : CSTL_BITSET_NPOS;
+}
+
+/*
+ * One function per operation, so the vector body has no branch. VOP and
+ * SOP combine vectors and words a and b into a. d and s may be the same.
+ */
+#if defined(CSTL_BITSET_AVX2)
+#define CSTL_BITSET_COMBINE(name, VOP, SOP)                                 \
+    void name(uint64_t* d, const uint64_t* s, size_t n)                     \
+    {                                                                       \
+        size_t i = 0;                                                       \
+        for (; i + 4 <= n; i += 4) {                                        \
+            __m256i a = _mm256_loadu_si256((const __m256i*)(d + i));        \
+            __m256i b = _mm256_loadu_si256((const __m256i*)(s + i));        \
+            _mm256_storeu_si256((__m256i*)(d + i), VOP(a, b));              \
+        }                                                                   \
+        for (; i < n; ++i) {                                                \
+            d[i] = SOP(d[i], s[i]);                                         \
+        }                                                                   \
+    }
+#define cstl_vand(a, b) _mm256_and_si256(a, b)
+#define cstl_vor(a, b) _mm256_or_si256(a, b)
+#define cstl_vxor(a, b) _mm256_xor_si256(a, b)
+#define cstl_vandnot(a, b) _mm256_andnot_si256(b, a)
+#elif defined(CSTL_BITSET_SSE2)
+#define CSTL_BITSET_COMBINE(name, VOP, SOP)                                 \
+    void name(uint64_t* d, const uint64_t* s, size_t n)                     \
+    {                                                                       \
+        size_t i = 0;                                                       \
+        for (; i + 2 <= n; i += 2) {                                        \
+            __m128i a = _mm_loadu_si128((const __m128i*)(d + i));           \
+            __m128i b = _mm_loadu_si128((const __m128i*)(s + i));           \
+            _mm_storeu_si128((__m128i*)(d + i), VOP(a, b));                 \
+        }                                                                   \
+        for (; i < n; ++i) {                                                \
+            d[i] = SOP(d[i], s[i]);                                         \
+        }                                                                   \
+    }
+#define cstl_vand(a, b) _mm_and_si128(a, b)
+#define cstl_vor(a, b) _mm_or_si128(a, b)
+#define cstl_vxor(a, b) _mm_xor_si128(a, b)
+#define cstl_vandnot(a, b) _mm_andnot_si128(b, a)
+#else
+#define CSTL_BITSET_COMBINE(name, VOP, SOP)                                 \
+    void name(uint64_t* d, const uint64_t* s, size_t n)                     \
+    {                                                                       \
+        size_t i;                                                           \
+        for (i = 0; i < n; ++i) {                                           \
+            d[i] = SOP(d[i], s[i]);                                         \
+        }                                                                   \
+    }
+#endif
+
+#define cstl_sand(a, b) ((a) & (b))
+#define cstl_sor(a, b) ((a) | (b))
+#define cstl_sxor(a, b) ((a) ^ (b))
+#define cstl_sandnot(a, b) ((a) & ~(b))
+
+CSTL_BITSET_COMBINE(cstl_bitset_words_and, cstl_vand, cstl_sand)
+CSTL_BITSET_COMBINE(cstl_bitset_words_or, cstl_vor, cstl_sor)
+CSTL_BITSET_COMBINE(cstl_bitset_words_xor, cstl_vxor, cstl_sxor)
+CSTL_BITSET_COMBINE(cstl_bitset_words_andnot, cstl_vandnot, cstl_sandnot)
+
+/* the words both sets have; src words past its end count as zero */
+static size_t _common_words(struct cstl_bitset* dst, struct cstl_bitset* src)
+{
+    size_t a = cstl_bitset_words(dst->nbits);
+    size_t b = cstl_bitset_words(src->nbits);
+    return a < b ? a : b;
+}
+
+cstl_error cstl_bitset_and(struct cstl_bitset* dst, struct cstl_bitset* src)
+{
+    size_t n;
+    if (dst == (struct cstl_bitset*)0 || src == (struct cstl_bitset*)0) {
+        return CSTL_BITSET_NOT_INITIALIZED;
+    }
+    n = _common_words(dst, src);
+    cstl_bitset_words_and(dst->words, src->words, n);
+    if (cstl_bitset_words(dst->nbits) > n) {
+        memset(dst->words + n, 0,
+               (cstl_bitset_words(dst->nbits) - n) * sizeof(uint64_t));
+    }
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_bitset_or(struct cstl_bitset* dst, struct cstl_bitset* src)
+{
+    if (dst == (struct cstl_bitset*)0 || src == (struct cstl_bitset*)0) {
+        return CSTL_BITSET_NOT_INITIALIZED;
+    }
+    cstl_bitset_words_or(dst->words, src->words, _common_words(dst, src));
+    _trim(dst);
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_bitset_xor(struct cstl_bitset* dst, struct cstl_bitset* src)
+{
+    if (dst == (struct cstl_bitset*)0 || src == (struct cstl_bitset*)0) {
+        return CSTL_BITSET_NOT_INITIALIZED;
+    }
+    cstl_bitset_words_xor(dst->words, src->words, _common_words(dst, src));
+    _trim(dst);
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_bitset_andnot(struct cstl_bitset* dst,
+                              struct cstl_bitset* src)
+{
+    if (dst == (struct cstl_bitset*)0 || src == (struct cstl_bitset*)0) {
+        return CSTL_BITSET_NOT_INITIALIZED;
+    }
+    cstl_bitset_words_andnot(dst->words, src->words,
+                             _common_words(dst, src));
+    return CSTL_ERROR_SUCCESS;
+}
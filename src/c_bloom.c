@@ -0,0 +1,171 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "c_stl_lib.h"
+
+#define CSTL_BLOOM_BLOCK_WORDS 8
+#define CSTL_BLOOM_BLOCK_BITS (CSTL_BLOOM_BLOCK_WORDS * 64)
+#define CSTL_BLOOM_ALIGN 64
+
+/* filters larger than this many blocks would not index with 32 bits */
+#define CSTL_BLOOM_MAX_BLOCKS 0xFFFFFFFFu
+
+struct cstl_bloom {
+    uint64_t* blocks; /* CSTL_BLOOM_ALIGN-aligned, inside raw */
+    void* raw;
+    size_t nblocks;
+    size_t capacity;
+};
+
+/* odd multipliers picking the bit in each word, as in Parquet's filters */
+static const uint32_t _salt[CSTL_BLOOM_BLOCK_WORDS] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+    0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u};
+
+/* the murmur3 finalizer, spelled so that C90 needs no long long */
+static uint64_t _mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= ((uint64_t)0xff51afd7u << 32) | 0xed558ccdu;
+    h ^= h >> 33;
+    h *= ((uint64_t)0xc4ceb9feu << 32) | 0x1a85ec53u;
+    h ^= h >> 33;
+    return h;
+}
+
+/* the high half picks the block; the low half the bits inside it */
+static const uint64_t* _block(const struct cstl_bloom* b, uint64_t h)
+{
+    uint64_t i = ((h >> 32) * (uint64_t)b->nblocks) >> 32;
+    return b->blocks + (size_t)i * CSTL_BLOOM_BLOCK_WORDS;
+}
+
+static uint64_t _bit(uint64_t h, int word)
+{
+    return (uint64_t)1 << ((uint32_t)((uint32_t)h * _salt[word]) >> 26);
+}
+
+struct cstl_bloom* cstl_bloom_new(size_t expected, unsigned int bits_per_key)
+{
+    struct cstl_bloom* b =
+        (struct cstl_bloom*)calloc(1, sizeof(struct cstl_bloom));
+    size_t nblocks;
+    if (b == (struct cstl_bloom*)0) {
+        return (struct cstl_bloom*)0;
+    }
+    if (bits_per_key == 0) {
+        bits_per_key = 1;
+    }
+    nblocks = expected / CSTL_BLOOM_BLOCK_BITS * bits_per_key +
+              (expected % CSTL_BLOOM_BLOCK_BITS * bits_per_key +
+               CSTL_BLOOM_BLOCK_BITS - 1) /
+                  CSTL_BLOOM_BLOCK_BITS;
+    if (nblocks == 0) {
+        nblocks = 1;
+    }
+    if (nblocks > CSTL_BLOOM_MAX_BLOCKS) {
+        nblocks = CSTL_BLOOM_MAX_BLOCKS;
+    }
+    b->raw = calloc(nblocks * CSTL_BLOOM_BLOCK_WORDS + CSTL_BLOOM_ALIGN / 8,
+                    sizeof(uint64_t));
+    if (b->raw == NULL) {
+        free(b);
+        return (struct cstl_bloom*)0;
+    }
+    b->blocks = (uint64_t*)((char*)b->raw +
+                            (CSTL_BLOOM_ALIGN -
+                             (size_t)b->raw % CSTL_BLOOM_ALIGN) %
+                                CSTL_BLOOM_ALIGN);
+    b->nblocks = nblocks;
+    b->capacity = expected;
+    return b;
+}
+
+cstl_error cstl_bloom_delete(struct cstl_bloom* b)
+{
+    if (b == (struct cstl_bloom*)0) {
+        return CSTL_BLOOM_NOT_INITIALIZED;
+    }
+    free(b->raw);
+    free(b);
+    return CSTL_ERROR_SUCCESS;
+}
+
+void cstl_bloom_clear(struct cstl_bloom* b)
+{
+    if (b) {
+        memset(b->blocks, 0,
+               b->nblocks * CSTL_BLOOM_BLOCK_WORDS * sizeof(uint64_t));
+    }
+}
+
+size_t cstl_bloom_capacity(const struct cstl_bloom* b)
+{
+    return b ? b->capacity : 0;
+}
+
+void cstl_bloom_add_hash(struct cstl_bloom* b, uint64_t h)
+{
+    uint64_t* w;
+    int i;
+    if (b == (struct cstl_bloom*)0) {
+        return;
+    }
+    h = _mix(h);
+    w = (uint64_t*)_block(b, h);
+    for (i = 0; i < CSTL_BLOOM_BLOCK_WORDS; ++i) {
+        w[i] |= _bit(h, i);
+    }
+}
+
+int cstl_bloom_may_contain_hash(const struct cstl_bloom* b, uint64_t h)
+{
+    const uint64_t* w;
+    uint64_t missing = 0;
+    int i;
+    if (b == (const struct cstl_bloom*)0) {
+        return 1;
+    }
+    h = _mix(h);
+    w = _block(b, h);
+    /* no early exit: the words share a cache line, and this vectorizes */
+    for (i = 0; i < CSTL_BLOOM_BLOCK_WORDS; ++i) {
+        missing |= _bit(h, i) & ~w[i];
+    }
+    return missing == 0;
+}
+
+void cstl_bloom_add(struct cstl_bloom* b, const void* key, size_t key_size)
+{
+    cstl_bloom_add_hash(b, cstl_hash_bytes(key, key_size));
+}
+
+int cstl_bloom_may_contain(const struct cstl_bloom* b, const void* key,
+                           size_t key_size)
+{
+    return cstl_bloom_may_contain_hash(b, cstl_hash_bytes(key, key_size));
+}
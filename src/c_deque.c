@@ -22,6 +22,7 @@
  *  THE SOFTWARE.
  ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
 
+#include <assert.h>
 #include <string.h>
 #include "c_stl_lib.h"
 
@@ -262,15 +263,25 @@ static void cstl_deque_replace_value(struct cstl_iterator* pIterator,
     cstl_object_replace_raw(currentElement, elem, elem_size);
 }
 
-struct cstl_iterator* cstl_deque_new_iterator(struct cstl_deque* pDeq)
+void cstl_deque_iterator_init(struct cstl_iterator* itr,
+                              struct cstl_deque* pDeq)
 {
-    struct cstl_iterator* itr =
-        (struct cstl_iterator*)calloc(1, sizeof(struct cstl_iterator));
+    assert(itr);
+    memset(itr, 0, sizeof(*itr));
     itr->next = cstl_deque_get_next;
     itr->current_value = cstl_deque_get_value;
     itr->replace_current_value = cstl_deque_replace_value;
     itr->current_index = pDeq->head + 1;
     itr->pContainer = pDeq;
+}
+
+struct cstl_iterator* cstl_deque_new_iterator(struct cstl_deque* pDeq)
+{
+    struct cstl_iterator* itr =
+        (struct cstl_iterator*)calloc(1, sizeof(struct cstl_iterator));
+    if (itr) {
+        cstl_deque_iterator_init(itr, pDeq);
+    }
     return itr;
 }
 
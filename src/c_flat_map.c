@@ -0,0 +1,483 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include <string.h>
+#include "c_stl_lib.h"
+
+struct cstl_flat_map {
+    char* keys;
+    char* values; /* NULL when value_size is 0 */
+    size_t count;
+    size_t capacity;
+    size_t key_size;
+    size_t value_size;
+    cstl_compare fn_c;
+    cstl_destroy fn_k_d;
+    cstl_destroy fn_v_d;
+};
+
+/* a flat set is a flat map without values */
+struct cstl_flat_set {
+    struct cstl_flat_map map;
+};
+
+/*
+ * Bisection stops once the candidates fit in this many bytes of keys; they
+ * are then scanned in order, which the prefetcher handles better than the
+ * last few halvings would.
+ */
+#define CSTL_FLAT_SCAN_BYTES 256
+
+#define cstl_flat_key(m, i) ((m)->keys + (i) * (m)->key_size)
+#define cstl_flat_value(m, i) ((m)->values + (i) * (m)->value_size)
+
+static void _flat_map_init(struct cstl_flat_map* m, size_t key_size,
+                           size_t value_size, cstl_compare fn_c,
+                           cstl_destroy fn_k_d, cstl_destroy fn_v_d)
+{
+    memset(m, 0, sizeof(*m));
+    m->key_size = key_size;
+    m->value_size = value_size;
+    m->fn_c = fn_c;
+    m->fn_k_d = fn_k_d;
+    m->fn_v_d = fn_v_d;
+}
+
+struct cstl_flat_map* cstl_flat_map_new(size_t key_size, size_t value_size,
+                                        cstl_compare fn_c,
+                                        cstl_destroy fn_k_d,
+                                        cstl_destroy fn_v_d)
+{
+    struct cstl_flat_map* m;
+    if (key_size == 0 || fn_c == (cstl_compare)0) {
+        return (struct cstl_flat_map*)0;
+    }
+    m = (struct cstl_flat_map*)malloc(sizeof(struct cstl_flat_map));
+    if (m) {
+        _flat_map_init(m, key_size, value_size, fn_c, fn_k_d, fn_v_d);
+    }
+    return m;
+}
+
+static void _destroy_range(struct cstl_flat_map* m, size_t from, size_t to)
+{
+    size_t i;
+    for (i = from; i < to; ++i) {
+        if (m->fn_k_d) {
+            m->fn_k_d(cstl_flat_key(m, i));
+        }
+        if (m->fn_v_d && m->values) {
+            m->fn_v_d(cstl_flat_value(m, i));
+        }
+    }
+}
+
+void cstl_flat_map_clear(struct cstl_flat_map* map)
+{
+    if (map) {
+        _destroy_range(map, 0, map->count);
+        map->count = 0;
+    }
+}
+
+static void _flat_map_release(struct cstl_flat_map* m)
+{
+    cstl_flat_map_clear(m);
+    free(m->keys);
+    free(m->values);
+}
+
+cstl_error cstl_flat_map_delete(struct cstl_flat_map* map)
+{
+    if (map == (struct cstl_flat_map*)0) {
+        return CSTL_FLAT_MAP_NOT_INITIALIZED;
+    }
+    _flat_map_release(map);
+    free(map);
+    return CSTL_ERROR_SUCCESS;
+}
+
+size_t cstl_flat_map_size(struct cstl_flat_map* map)
+{
+    return map ? map->count : 0;
+}
+
+cstl_error cstl_flat_map_reserve(struct cstl_flat_map* map, size_t n)
+{
+    char* p;
+    if (map == (struct cstl_flat_map*)0) {
+        return CSTL_FLAT_MAP_NOT_INITIALIZED;
+    }
+    if (n <= map->capacity) {
+        return CSTL_ERROR_SUCCESS;
+    }
+    p = (char*)realloc(map->keys, n * map->key_size);
+    if (p == NULL) {
+        return CSTL_ERROR_MEMORY;
+    }
+    map->keys = p;
+    if (map->value_size) {
+        p = (char*)realloc(map->values, n * map->value_size);
+        if (p == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        map->values = p;
+    }
+    map->capacity = n;
+    return CSTL_ERROR_SUCCESS;
+}
+
+static cstl_error _grow(struct cstl_flat_map* m, size_t extra)
+{
+    size_t n;
+    if (m->count + extra <= m->capacity) {
+        return CSTL_ERROR_SUCCESS;
+    }
+    n = m->capacity ? m->capacity * 2 : 8;
+    if (n < m->count + extra) {
+        n = m->count + extra;
+    }
+    return cstl_flat_map_reserve(m, n);
+}
+
+static size_t _lower_bound(struct cstl_flat_map* m, const void* key)
+{
+    size_t base = 0, n = m->count, half;
+    size_t scan = CSTL_FLAT_SCAN_BYTES / m->key_size;
+    /* the step is a select, which compilers turn into a conditional move */
+    while (n > scan && n > 1) {
+        half = n / 2;
+        base = m->fn_c(cstl_flat_key(m, base + half), key) < 0 ? base + half
+                                                               : base;
+        n -= half;
+    }
+    while (n && m->fn_c(cstl_flat_key(m, base), key) < 0) {
+        base++;
+        n--;
+    }
+    return base;
+}
+
+size_t cstl_flat_map_lower_bound(struct cstl_flat_map* map, const void* key)
+{
+    if (map == (struct cstl_flat_map*)0 || key == NULL) {
+        return 0;
+    }
+    return _lower_bound(map, key);
+}
+
+static int _found(struct cstl_flat_map* m, size_t i, const void* key)
+{
+    return i < m->count && m->fn_c(cstl_flat_key(m, i), key) == 0;
+}
+
+void* cstl_flat_map_find(struct cstl_flat_map* map, const void* key)
+{
+    size_t i;
+    if (map == (struct cstl_flat_map*)0 || key == NULL) {
+        return (void*)0;
+    }
+    i = _lower_bound(map, key);
+    if (!_found(map, i, key)) {
+        return (void*)0;
+    }
+    return map->values ? (void*)cstl_flat_value(map, i)
+                       : (void*)cstl_flat_key(map, i);
+}
+
+const void* cstl_flat_map_key_at(struct cstl_flat_map* map, size_t i)
+{
+    if (map == (struct cstl_flat_map*)0 || i >= map->count) {
+        return (void*)0;
+    }
+    return cstl_flat_key(map, i);
+}
+
+void* cstl_flat_map_value_at(struct cstl_flat_map* map, size_t i)
+{
+    if (map == (struct cstl_flat_map*)0 || i >= map->count ||
+        map->values == NULL) {
+        return (void*)0;
+    }
+    return cstl_flat_value(map, i);
+}
+
+cstl_error cstl_flat_map_insert(struct cstl_flat_map* map, const void* key,
+                                const void* value)
+{
+    size_t i;
+    cstl_error rc;
+    if (map == (struct cstl_flat_map*)0) {
+        return CSTL_FLAT_MAP_NOT_INITIALIZED;
+    }
+    if (key == NULL || (map->value_size && value == NULL)) {
+        return CSTL_FLAT_MAP_INVALID_INPUT;
+    }
+    i = _lower_bound(map, key);
+    if (_found(map, i, key)) {
+        return CSTL_RBTREE_KEY_DUPLICATE;
+    }
+    rc = _grow(map, 1);
+    if (rc != CSTL_ERROR_SUCCESS) {
+        return rc;
+    }
+    memmove(cstl_flat_key(map, i + 1), cstl_flat_key(map, i),
+            (map->count - i) * map->key_size);
+    memcpy(cstl_flat_key(map, i), key, map->key_size);
+    if (map->values) {
+        memmove(cstl_flat_value(map, i + 1), cstl_flat_value(map, i),
+                (map->count - i) * map->value_size);
+    }
+    /* a flat set comes through here with no value and value_size 0 */
+    if (map->value_size != 0 && value != NULL) {
+        memcpy(cstl_flat_value(map, i), value, map->value_size);
+    }
+    map->count++;
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_flat_map_remove(struct cstl_flat_map* map, const void* key)
+{
+    size_t i;
+    if (map == (struct cstl_flat_map*)0) {
+        return CSTL_FLAT_MAP_NOT_INITIALIZED;
+    }
+    if (key == NULL) {
+        return CSTL_FLAT_MAP_INVALID_INPUT;
+    }
+    i = _lower_bound(map, key);
+    if (!_found(map, i, key)) {
+        return CSTL_RBTREE_KEY_NOT_FOUND;
+    }
+    _destroy_range(map, i, i + 1);
+    map->count--;
+    memmove(cstl_flat_key(map, i), cstl_flat_key(map, i + 1),
+            (map->count - i) * map->key_size);
+    if (map->values) {
+        memmove(cstl_flat_value(map, i), cstl_flat_value(map, i + 1),
+                (map->count - i) * map->value_size);
+    }
+    return CSTL_ERROR_SUCCESS;
+}
+
+/* stable bottom-up merge sort of idx[0..n) by the keys they index */
+static void _sort_indices(struct cstl_flat_map* m, const char* keys,
+                          size_t* idx, size_t* tmp, size_t n)
+{
+    size_t width, lo, mid, hi, a, b, k;
+    size_t *t, *out = idx;
+    for (width = 1; width < n; width *= 2) {
+        for (lo = 0; lo < n; lo += 2 * width) {
+            mid = lo + width < n ? lo + width : n;
+            hi = lo + 2 * width < n ? lo + 2 * width : n;
+            a = lo;
+            b = mid;
+            k = lo;
+            while (a < mid && b < hi) {
+                if (m->fn_c(keys + idx[b] * m->key_size,
+                            keys + idx[a] * m->key_size) < 0) {
+                    tmp[k++] = idx[b++];
+                }
+                else {
+                    tmp[k++] = idx[a++];
+                }
+            }
+            while (a < mid) {
+                tmp[k++] = idx[a++];
+            }
+            while (b < hi) {
+                tmp[k++] = idx[b++];
+            }
+        }
+        t = idx;
+        idx = tmp;
+        tmp = t;
+    }
+    /* an odd number of passes leaves the result in the scratch half */
+    if (idx != out) {
+        memcpy(out, idx, n * sizeof(size_t));
+    }
+}
+
+cstl_error cstl_flat_map_insert_batch(struct cstl_flat_map* map,
+                                      const void* keys, const void* values,
+                                      size_t n)
+{
+    const char* in_k = (const char*)keys;
+    const char* in_v = (const char*)values;
+    size_t *idx, i, u, added, src, dst;
+    cstl_error rc;
+
+    if (map == (struct cstl_flat_map*)0) {
+        return CSTL_FLAT_MAP_NOT_INITIALIZED;
+    }
+    if (n == 0) {
+        return CSTL_ERROR_SUCCESS;
+    }
+    if (keys == NULL || (map->value_size && values == NULL)) {
+        return CSTL_FLAT_MAP_INVALID_INPUT;
+    }
+    idx = (size_t*)malloc(2 * n * sizeof(size_t));
+    if (idx == NULL) {
+        return CSTL_ERROR_MEMORY;
+    }
+    for (i = 0; i < n; ++i) {
+        idx[i] = i;
+    }
+    _sort_indices(map, in_k, idx, idx + n, n);
+
+    /* keep the first of equal keys, and only keys not stored yet */
+    for (i = 0, u = 0; i < n; ++i) {
+        const char* k = in_k + idx[i] * map->key_size;
+        if (u && map->fn_c(in_k + idx[u - 1] * map->key_size, k) == 0) {
+            continue;
+        }
+        if (_found(map, _lower_bound(map, k), k)) {
+            continue;
+        }
+        idx[u++] = idx[i];
+    }
+
+    rc = _grow(map, u);
+    if (rc != CSTL_ERROR_SUCCESS) {
+        free(idx);
+        return rc;
+    }
+    added = u;
+    /* merge from the back, so nothing is overwritten before it moves */
+    src = map->count;
+    dst = map->count + u;
+    while (u) {
+        const char* k = in_k + idx[u - 1] * map->key_size;
+        --dst;
+        if (src && map->fn_c(cstl_flat_key(map, src - 1), k) > 0) {
+            --src;
+            memcpy(cstl_flat_key(map, dst), cstl_flat_key(map, src),
+                   map->key_size);
+            if (map->values) {
+                memcpy(cstl_flat_value(map, dst), cstl_flat_value(map, src),
+                       map->value_size);
+            }
+        }
+        else {
+            --u;
+            memcpy(cstl_flat_key(map, dst), k, map->key_size);
+            if (map->values) {
+                memcpy(cstl_flat_value(map, dst),
+                       in_v + idx[u] * map->value_size, map->value_size);
+            }
+        }
+    }
+    map->count += added;
+    free(idx);
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_flat_map_build(struct cstl_flat_map* map, const void* keys,
+                               const void* values, size_t n)
+{
+    if (map == (struct cstl_flat_map*)0) {
+        return CSTL_FLAT_MAP_NOT_INITIALIZED;
+    }
+    cstl_flat_map_clear(map);
+    return cstl_flat_map_insert_batch(map, keys, values, n);
+}
+
+struct cstl_flat_set* cstl_flat_set_new(size_t key_size, cstl_compare fn_c,
+                                        cstl_destroy fn_d)
+{
+    struct cstl_flat_set* s;
+    if (key_size == 0 || fn_c == (cstl_compare)0) {
+        return (struct cstl_flat_set*)0;
+    }
+    s = (struct cstl_flat_set*)malloc(sizeof(struct cstl_flat_set));
+    if (s) {
+        _flat_map_init(&s->map, key_size, 0, fn_c, fn_d, (cstl_destroy)0);
+    }
+    return s;
+}
+
+cstl_error cstl_flat_set_delete(struct cstl_flat_set* set)
+{
+    if (set == (struct cstl_flat_set*)0) {
+        return CSTL_FLAT_MAP_NOT_INITIALIZED;
+    }
+    _flat_map_release(&set->map);
+    free(set);
+    return CSTL_ERROR_SUCCESS;
+}
+
+#define cstl_flat_set_map(s) ((s) ? &(s)->map : (struct cstl_flat_map*)0)
+
+void cstl_flat_set_clear(struct cstl_flat_set* set)
+{
+    cstl_flat_map_clear(cstl_flat_set_map(set));
+}
+
+size_t cstl_flat_set_size(struct cstl_flat_set* set)
+{
+    return cstl_flat_map_size(cstl_flat_set_map(set));
+}
+
+cstl_error cstl_flat_set_reserve(struct cstl_flat_set* set, size_t n)
+{
+    return cstl_flat_map_reserve(cstl_flat_set_map(set), n);
+}
+
+cstl_error cstl_flat_set_build(struct cstl_flat_set* set, const void* keys,
+                               size_t n)
+{
+    return cstl_flat_map_build(cstl_flat_set_map(set), keys, NULL, n);
+}
+
+cstl_error cstl_flat_set_insert_batch(struct cstl_flat_set* set,
+                                      const void* keys, size_t n)
+{
+    return cstl_flat_map_insert_batch(cstl_flat_set_map(set), keys, NULL, n);
+}
+
+cstl_error cstl_flat_set_insert(struct cstl_flat_set* set, const void* key)
+{
+    return cstl_flat_map_insert(cstl_flat_set_map(set), key, NULL);
+}
+
+cstl_error cstl_flat_set_remove(struct cstl_flat_set* set, const void* key)
+{
+    return cstl_flat_map_remove(cstl_flat_set_map(set), key);
+}
+
+const void* cstl_flat_set_find(struct cstl_flat_set* set, const void* key)
+{
+    return cstl_flat_map_find(cstl_flat_set_map(set), key);
+}
+
+size_t cstl_flat_set_lower_bound(struct cstl_flat_set* set, const void* key)
+{
+    return cstl_flat_map_lower_bound(cstl_flat_set_map(set), key);
+}
+
+const void* cstl_flat_set_key_at(struct cstl_flat_set* set, size_t i)
+{
+    return cstl_flat_map_key_at(cstl_flat_set_map(set), i);
+}
@@ -22,6 +22,8 @@
  *  THE SOFTWARE.
  ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
 
+#include <assert.h>
+#include <string.h>
 #include "c_stl_lib.h"
 
 struct cstl_list_node {
@@ -235,16 +237,26 @@ static void cstl_list_replace_value(struct cstl_iterator* pIterator, void* elem,
     cstl_object_replace_raw(pObj, elem, elem_size);
 }
 
-struct cstl_iterator* cstl_list_new_iterator(struct cstl_list* pList)
+void cstl_list_iterator_init(struct cstl_iterator* itr,
+                             struct cstl_list* pList)
 {
-    struct cstl_iterator* itr =
-        (struct cstl_iterator*)calloc(1, sizeof(struct cstl_iterator));
+    assert(itr);
+    memset(itr, 0, sizeof(*itr));
     itr->next = cstl_list_get_next;
     itr->current_value = cstl_list_get_value;
     itr->replace_current_value = cstl_list_replace_value;
     itr->pContainer = pList;
     itr->current_element = (void*)0;
     itr->current_index = 0;
+}
+
+struct cstl_iterator* cstl_list_new_iterator(struct cstl_list* pList)
+{
+    struct cstl_iterator* itr =
+        (struct cstl_iterator*)calloc(1, sizeof(struct cstl_iterator));
+    if (itr) {
+        cstl_list_iterator_init(itr, pList);
+    }
     return itr;
 }
 
@@ -0,0 +1,523 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "c_stl_lib.h"
+
+/* the root table is indexed by 16 address bits, every chunk by 8 more */
+#define CSTL_LPM_ROOT_BITS 16
+#define CSTL_LPM_ROOT_SIZE 65536
+#define CSTL_LPM_CHUNK_SIZE 256
+
+/* an entry is a route id (0 for none) or, with this bit, a chunk number */
+#define CSTL_LPM_CHILD 0x80000000u
+
+/* addresses whose root entries are prefetched together */
+#define CSTL_LPM_BATCH 16
+
+#define cstl_lpm_chunk_base(c) \
+    (CSTL_LPM_ROOT_SIZE + (size_t)(c)*CSTL_LPM_CHUNK_SIZE)
+
+struct cstl_lpm_route {
+    void* value;
+    uint32_t next_free; /* while free: the next free id, 0 for none */
+    unsigned char len;
+};
+
+/*
+ * entries[] holds the root table followed by the chunks. depths[] holds,
+ * for every entry that is a route, the length of that route; it is read
+ * only by updates. Free chunks are chained through their first entry.
+ */
+struct cstl_lpm {
+    uint32_t* entries;
+    unsigned char* depths;
+    size_t nchunks;
+    size_t chunk_cap;
+    uint32_t free_chunk; /* first free chunk + 1, 0 for none */
+    struct cstl_lpm_route* routes; /* route id i lives in routes[i - 1] */
+    size_t nroutes;
+    size_t route_cap;
+    uint32_t free_route;
+    struct cstl_art* prefixes; /* length byte + masked address -> id */
+    size_t addr_size;
+    size_t count;
+    cstl_destroy fn_v_d;
+};
+
+/* copies addr with every bit past len cleared */
+static void _mask(const struct cstl_lpm* lpm, const void* addr,
+                  unsigned int len, unsigned char* out)
+{
+    size_t i;
+    memcpy(out, addr, lpm->addr_size);
+    for (i = len / 8; i < lpm->addr_size; ++i) {
+        out[i] = (unsigned char)(i == len / 8 ? out[i] & (0xFF00 >> (len % 8))
+                                              : 0);
+    }
+}
+
+/* a chunk whose entries all repeat the given route; 0 on failure */
+static uint32_t _chunk_new(struct cstl_lpm* lpm, uint32_t entry,
+                           unsigned char depth)
+{
+    size_t c, base, i;
+    if (lpm->free_chunk) {
+        c = lpm->free_chunk - 1;
+        lpm->free_chunk = lpm->entries[cstl_lpm_chunk_base(c)];
+    }
+    else {
+        if (lpm->nchunks == lpm->chunk_cap) {
+            size_t cap = lpm->chunk_cap ? lpm->chunk_cap * 2 : 16;
+            size_t total = cstl_lpm_chunk_base(cap);
+            uint32_t* entries;
+            unsigned char* depths;
+            if (cap >= CSTL_LPM_CHILD) {
+                return 0;
+            }
+            entries = (uint32_t*)realloc(lpm->entries,
+                                         total * sizeof(uint32_t));
+            if (entries == NULL) {
+                return 0;
+            }
+            lpm->entries = entries;
+            depths = (unsigned char*)realloc(lpm->depths, total);
+            if (depths == NULL) {
+                return 0;
+            }
+            lpm->depths = depths;
+            lpm->chunk_cap = cap;
+        }
+        c = lpm->nchunks++;
+    }
+    base = cstl_lpm_chunk_base(c);
+    for (i = 0; i < CSTL_LPM_CHUNK_SIZE; ++i) {
+        lpm->entries[base + i] = entry;
+    }
+    memset(lpm->depths + base, depth, CSTL_LPM_CHUNK_SIZE);
+    return CSTL_LPM_CHILD | (uint32_t)c;
+}
+
+static void _chunk_free(struct cstl_lpm* lpm, uint32_t entry)
+{
+    size_t c = entry & ~CSTL_LPM_CHILD;
+    lpm->entries[cstl_lpm_chunk_base(c)] = lpm->free_chunk;
+    lpm->free_chunk = (uint32_t)(c + 1);
+}
+
+/* a new route id, 0 on failure */
+static uint32_t _route_new(struct cstl_lpm* lpm, const void* value,
+                           size_t value_size, unsigned int len)
+{
+    struct cstl_lpm_route* r;
+    void* copy = malloc(value_size);
+    uint32_t id;
+    if (copy == NULL) {
+        return 0;
+    }
+    memcpy(copy, value, value_size);
+    if (lpm->free_route) {
+        id = lpm->free_route;
+        lpm->free_route = lpm->routes[id - 1].next_free;
+    }
+    else {
+        if (lpm->nroutes == lpm->route_cap) {
+            size_t cap = lpm->route_cap ? lpm->route_cap * 2 : 16;
+            struct cstl_lpm_route* routes;
+            if (cap >= CSTL_LPM_CHILD) {
+                free(copy);
+                return 0;
+            }
+            routes = (struct cstl_lpm_route*)realloc(
+                lpm->routes, cap * sizeof(struct cstl_lpm_route));
+            if (routes == NULL) {
+                free(copy);
+                return 0;
+            }
+            lpm->routes = routes;
+            lpm->route_cap = cap;
+        }
+        id = (uint32_t)++lpm->nroutes;
+    }
+    r = &lpm->routes[id - 1];
+    r->value = copy;
+    r->next_free = 0;
+    r->len = (unsigned char)len;
+    return id;
+}
+
+static void _route_free(struct cstl_lpm* lpm, uint32_t id)
+{
+    struct cstl_lpm_route* r = &lpm->routes[id - 1];
+    if (r->value) {
+        if (lpm->fn_v_d) {
+            lpm->fn_v_d(r->value);
+        }
+        free(r->value);
+        r->value = NULL;
+    }
+    r->next_free = lpm->free_route;
+    lpm->free_route = id;
+}
+
+/*
+ * Finds the entries covered by the masked prefix a/len: count entries from
+ * first. Entries on the way that are routes get chunks of their own, and
+ * path receives the entries pointing at those chunks. Returns the length
+ * of path, or -1 when out of memory.
+ */
+static int _locate(struct cstl_lpm* lpm, const unsigned char* a,
+                   unsigned int len, size_t* path, size_t* first,
+                   size_t* count)
+{
+    size_t slot = ((size_t)a[0] << 8) | a[1];
+    unsigned int bits = CSTL_LPM_ROOT_BITS;
+    int npath = 0;
+
+    while (len > bits) {
+        uint32_t e = lpm->entries[slot];
+        if (!(e & CSTL_LPM_CHILD)) {
+            e = _chunk_new(lpm, e, lpm->depths[slot]);
+            if (e == 0) {
+                return -1;
+            }
+            lpm->entries[slot] = e;
+        }
+        path[npath++] = slot;
+        slot = cstl_lpm_chunk_base(e & ~CSTL_LPM_CHILD) + a[bits / 8];
+        bits += 8;
+    }
+    *first = slot;
+    *count = (size_t)1 << (bits - len);
+    return npath;
+}
+
+/* gives the entry at slot, and every entry below it, the route if longer */
+static void _push_insert(struct cstl_lpm* lpm, size_t slot, uint32_t id,
+                         unsigned char len)
+{
+    uint32_t e = lpm->entries[slot];
+    if (e & CSTL_LPM_CHILD) {
+        size_t base = cstl_lpm_chunk_base(e & ~CSTL_LPM_CHILD), i;
+        for (i = 0; i < CSTL_LPM_CHUNK_SIZE; ++i) {
+            _push_insert(lpm, base + i, id, len);
+        }
+    }
+    else if (e == 0 || lpm->depths[slot] < len) {
+        lpm->entries[slot] = id;
+        lpm->depths[slot] = len;
+    }
+}
+
+/* hands the entries of a removed route over to the one it was inside */
+static void _push_remove(struct cstl_lpm* lpm, size_t slot, uint32_t id,
+                         uint32_t parent, unsigned char parent_len)
+{
+    uint32_t e = lpm->entries[slot];
+    if (e & CSTL_LPM_CHILD) {
+        size_t base = cstl_lpm_chunk_base(e & ~CSTL_LPM_CHILD), i;
+        for (i = 0; i < CSTL_LPM_CHUNK_SIZE; ++i) {
+            _push_remove(lpm, base + i, id, parent, parent_len);
+        }
+    }
+    else if (e == id) {
+        lpm->entries[slot] = parent;
+        lpm->depths[slot] = parent_len;
+    }
+}
+
+/* folds chunks on path, deepest first, back into their parent entry */
+static void _collapse(struct cstl_lpm* lpm, const size_t* path, int npath)
+{
+    while (npath-- > 0) {
+        uint32_t e = lpm->entries[path[npath]];
+        size_t base = cstl_lpm_chunk_base(e & ~CSTL_LPM_CHILD), i;
+        uint32_t first = lpm->entries[base];
+        if (first & CSTL_LPM_CHILD) {
+            return;
+        }
+        for (i = 1; i < CSTL_LPM_CHUNK_SIZE; ++i) {
+            if (lpm->entries[base + i] != first ||
+                lpm->depths[base + i] != lpm->depths[base]) {
+                return;
+            }
+        }
+        lpm->entries[path[npath]] = first;
+        lpm->depths[path[npath]] = lpm->depths[base];
+        _chunk_free(lpm, e);
+    }
+}
+
+struct cstl_lpm* cstl_lpm_new(cstl_lpm_family family, cstl_destroy fn_v_d)
+{
+    struct cstl_lpm* lpm =
+        (struct cstl_lpm*)calloc(1, sizeof(struct cstl_lpm));
+    if (lpm == (struct cstl_lpm*)0) {
+        return lpm;
+    }
+    lpm->addr_size = family == CSTL_LPM_IPV6 ? 16 : 4;
+    lpm->fn_v_d = fn_v_d;
+    lpm->entries = (uint32_t*)calloc(CSTL_LPM_ROOT_SIZE, sizeof(uint32_t));
+    lpm->depths = (unsigned char*)calloc(CSTL_LPM_ROOT_SIZE, 1);
+    lpm->prefixes = cstl_art_new(1 + lpm->addr_size, CSTL_ART_KEY_BYTES, NULL);
+    if (!lpm->entries || !lpm->depths || !lpm->prefixes) {
+        cstl_lpm_delete(lpm);
+        return (struct cstl_lpm*)0;
+    }
+    return lpm;
+}
+
+cstl_error cstl_lpm_delete(struct cstl_lpm* lpm)
+{
+    size_t i;
+    if (lpm == (struct cstl_lpm*)0) {
+        return CSTL_LPM_NOT_INITIALIZED;
+    }
+    for (i = 0; i < lpm->nroutes; ++i) {
+        if (lpm->routes[i].value) {
+            if (lpm->fn_v_d) {
+                lpm->fn_v_d(lpm->routes[i].value);
+            }
+            free(lpm->routes[i].value);
+        }
+    }
+    free(lpm->routes);
+    free(lpm->entries);
+    free(lpm->depths);
+    cstl_art_delete(lpm->prefixes);
+    free(lpm);
+    return CSTL_ERROR_SUCCESS;
+}
+
+size_t cstl_lpm_size(struct cstl_lpm* lpm)
+{
+    return lpm ? lpm->count : 0;
+}
+
+cstl_error cstl_lpm_insert(struct cstl_lpm* lpm, const void* addr,
+                           unsigned int len, const void* value,
+                           size_t value_size)
+{
+    unsigned char key[17];
+    size_t path[16];
+    size_t first, count, i;
+    uint32_t id;
+
+    if (lpm == (struct cstl_lpm*)0) {
+        return CSTL_LPM_NOT_INITIALIZED;
+    }
+    /* a route without a value would read as a miss in find and lookup */
+    if (addr == NULL || len > lpm->addr_size * 8 || value == NULL ||
+        value_size == 0) {
+        return CSTL_LPM_INVALID_INPUT;
+    }
+    key[0] = (unsigned char)len;
+    _mask(lpm, addr, len, key + 1);
+    if (cstl_art_is_key_exists(lpm->prefixes, key)) {
+        return CSTL_RBTREE_KEY_DUPLICATE;
+    }
+    if (_locate(lpm, key + 1, len, path, &first, &count) < 0) {
+        return CSTL_ERROR_MEMORY;
+    }
+    id = _route_new(lpm, value, value_size, len);
+    if (id == 0) {
+        return CSTL_ERROR_MEMORY;
+    }
+    if (cstl_art_insert(lpm->prefixes, key, &id, sizeof(id)) !=
+        CSTL_ERROR_SUCCESS) {
+        _route_free(lpm, id);
+        return CSTL_ERROR_MEMORY;
+    }
+    for (i = 0; i < count; ++i) {
+        _push_insert(lpm, first + i, id, (unsigned char)len);
+    }
+    lpm->count++;
+    return CSTL_ERROR_SUCCESS;
+}
+
+static int _compare_prefix_len(const void* lhs, const void* rhs)
+{
+    const struct cstl_lpm_prefix* const* a =
+        (const struct cstl_lpm_prefix* const*)lhs;
+    const struct cstl_lpm_prefix* const* b =
+        (const struct cstl_lpm_prefix* const*)rhs;
+    return (int)(*a)->len - (int)(*b)->len;
+}
+
+/*
+ * Shorter prefixes go first, so each entry is written once per prefix that
+ * ends up covering it instead of being pushed down into chunks again.
+ */
+cstl_error cstl_lpm_insert_batch(struct cstl_lpm* lpm,
+                                 const struct cstl_lpm_prefix* prefixes,
+                                 size_t n)
+{
+    const struct cstl_lpm_prefix** order;
+    cstl_error rc = CSTL_ERROR_SUCCESS;
+    size_t i;
+
+    if (lpm == (struct cstl_lpm*)0) {
+        return CSTL_LPM_NOT_INITIALIZED;
+    }
+    if (n == 0) {
+        return CSTL_ERROR_SUCCESS;
+    }
+    if (prefixes == NULL) {
+        return CSTL_LPM_INVALID_INPUT;
+    }
+    order = (const struct cstl_lpm_prefix**)malloc(n * sizeof(*order));
+    if (order == NULL) {
+        return CSTL_ERROR_MEMORY;
+    }
+    for (i = 0; i < n; ++i) {
+        order[i] = &prefixes[i];
+    }
+    qsort(order, n, sizeof(*order), _compare_prefix_len);
+    for (i = 0; i < n; ++i) {
+        rc = cstl_lpm_insert(lpm, order[i]->addr, order[i]->len,
+                             order[i]->value, order[i]->value_size);
+        if (rc == CSTL_RBTREE_KEY_DUPLICATE) {
+            rc = CSTL_ERROR_SUCCESS;
+        }
+        else if (rc != CSTL_ERROR_SUCCESS) {
+            break;
+        }
+    }
+    free(order);
+    return rc;
+}
+
+cstl_error cstl_lpm_remove(struct cstl_lpm* lpm, const void* addr,
+                           unsigned int len)
+{
+    unsigned char key[17], up[17];
+    size_t path[16];
+    size_t first, count, i;
+    uint32_t id, parent = 0;
+    unsigned int parent_len = 0, l;
+    const uint32_t* found;
+    int npath;
+
+    if (lpm == (struct cstl_lpm*)0) {
+        return CSTL_LPM_NOT_INITIALIZED;
+    }
+    if (addr == NULL || len > lpm->addr_size * 8) {
+        return CSTL_LPM_INVALID_INPUT;
+    }
+    key[0] = (unsigned char)len;
+    _mask(lpm, addr, len, key + 1);
+    found = (const uint32_t*)cstl_art_find(lpm->prefixes, key);
+    if (found == NULL) {
+        return CSTL_RBTREE_KEY_NOT_FOUND;
+    }
+    id = *found;
+
+    /* the longest remaining prefix that contains this one */
+    memcpy(up, key, sizeof(key));
+    for (l = len; l-- > 0;) {
+        up[1 + l / 8] &= (unsigned char)~(0x80 >> (l % 8));
+        up[0] = (unsigned char)l;
+        found = (const uint32_t*)cstl_art_find(lpm->prefixes, up);
+        if (found) {
+            parent = *found;
+            parent_len = l;
+            break;
+        }
+    }
+
+    /* the chunks on the way exist already, so this cannot fail */
+    npath = _locate(lpm, key + 1, len, path, &first, &count);
+    assert(npath >= 0);
+    for (i = 0; i < count; ++i) {
+        _push_remove(lpm, first + i, id, parent, (unsigned char)parent_len);
+    }
+    _collapse(lpm, path, npath);
+
+    cstl_art_remove(lpm->prefixes, key);
+    _route_free(lpm, id);
+    lpm->count--;
+    return CSTL_ERROR_SUCCESS;
+}
+
+const void* cstl_lpm_find(struct cstl_lpm* lpm, const void* addr,
+                          unsigned int len)
+{
+    unsigned char key[17];
+    const uint32_t* id;
+    if (lpm == (struct cstl_lpm*)0 || addr == NULL ||
+        len > lpm->addr_size * 8) {
+        return NULL;
+    }
+    key[0] = (unsigned char)len;
+    _mask(lpm, addr, len, key + 1);
+    id = (const uint32_t*)cstl_art_find(lpm->prefixes, key);
+    return id ? lpm->routes[*id - 1].value : NULL;
+}
+
+const void* cstl_lpm_lookup(struct cstl_lpm* lpm, const void* addr,
+                            unsigned int* prefix_len)
+{
+    const unsigned char* a = (const unsigned char*)addr;
+    size_t byte = 2;
+    uint32_t e;
+
+    if (lpm == (struct cstl_lpm*)0 || addr == NULL) {
+        return NULL;
+    }
+    e = lpm->entries[((size_t)a[0] << 8) | a[1]];
+    while (e & CSTL_LPM_CHILD) {
+        e = lpm->entries[cstl_lpm_chunk_base(e & ~CSTL_LPM_CHILD) +
+                         a[byte++]];
+    }
+    if (e == 0) {
+        return NULL;
+    }
+    if (prefix_len) {
+        *prefix_len = lpm->routes[e - 1].len;
+    }
+    return lpm->routes[e - 1].value;
+}
+
+size_t cstl_lpm_lookup_batch(struct cstl_lpm* lpm, const void* const addrs[],
+                             size_t n, const void* out_values[])
+{
+    size_t i, j, group, found = 0;
+
+    for (i = 0; i < n; i += group) {
+        group = (n - i < CSTL_LPM_BATCH) ? n - i : CSTL_LPM_BATCH;
+        for (j = 0; lpm && j < group; ++j) {
+            const unsigned char* a = (const unsigned char*)addrs[i + j];
+            cstl_prefetch(&lpm->entries[((size_t)a[0] << 8) | a[1]]);
+        }
+        for (j = 0; j < group; ++j) {
+            out_values[i + j] = cstl_lpm_lookup(lpm, addrs[i + j], NULL);
+            if (out_values[i + j]) {
+                ++found;
+            }
+        }
+    }
+    return found;
+}
@@ -0,0 +1,274 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include <string.h>
+#include "c_stl_lib.h"
+#include "c_ilist.h"
+
+struct cstl_lru_entry {
+    struct cstl_lru_entry* hnext; /* hash chain */
+    struct cstl_ilist_node node;  /* recency list, most recent first */
+    size_t hash;
+    size_t key_size;
+    size_t value_size;
+    /* key, then value, follow at 8-byte aligned offsets */
+};
+
+struct cstl_lru {
+    struct cstl_lru_entry** buckets;
+    size_t bucket_mask;
+    size_t count;
+    size_t usage;
+    size_t capacity;
+    cstl_lru_unit unit;
+    struct cstl_ilist recency;
+    cstl_hash hash_fn;
+    cstl_compare compare_fn;
+    cstl_lru_evict evict_fn;
+    void* evict_arg;
+};
+
+#define CSTL_LRU_ALIGN(n) (((n) + 7) & ~(size_t)7)
+#define CSTL_LRU_KEY_OFF CSTL_LRU_ALIGN(sizeof(struct cstl_lru_entry))
+#define cstl_lru_key(e) ((void*)((char*)(e) + CSTL_LRU_KEY_OFF))
+#define cstl_lru_value(e) \
+    ((void*)((char*)(e) + CSTL_LRU_KEY_OFF + CSTL_LRU_ALIGN((e)->key_size)))
+#define cstl_lru_charge(lru, e) \
+    ((lru)->unit == CSTL_LRU_BYTES ? (e)->key_size + (e)->value_size : 1)
+
+struct cstl_lru* cstl_lru_new(size_t capacity, cstl_lru_unit unit,
+                              cstl_hash fn_h, cstl_compare fn_c,
+                              cstl_lru_evict fn_e, void* p)
+{
+    struct cstl_lru* lru;
+    if (capacity == 0) {
+        return (struct cstl_lru*)0;
+    }
+    lru = (struct cstl_lru*)calloc(1, sizeof(struct cstl_lru));
+    if (lru == (struct cstl_lru*)0) {
+        return (struct cstl_lru*)0;
+    }
+    lru->bucket_mask = 15;
+    lru->buckets = (struct cstl_lru_entry**)calloc(
+        lru->bucket_mask + 1, sizeof(struct cstl_lru_entry*));
+    if (lru->buckets == NULL) {
+        free(lru);
+        return (struct cstl_lru*)0;
+    }
+    lru->capacity = capacity;
+    lru->unit = unit;
+    lru->hash_fn = fn_h ? fn_h : cstl_hash_bytes;
+    lru->compare_fn = fn_c;
+    lru->evict_fn = fn_e;
+    lru->evict_arg = p;
+    cstl_ilist_init(&lru->recency);
+    return lru;
+}
+
+static struct cstl_lru_entry** cstl_lru_lookup(struct cstl_lru* lru,
+                                               const void* key,
+                                               size_t key_size, size_t hash)
+{
+    struct cstl_lru_entry** pe = &lru->buckets[hash & lru->bucket_mask];
+    for (; *pe; pe = &(*pe)->hnext) {
+        struct cstl_lru_entry* e = *pe;
+        if (e->hash == hash && e->key_size == key_size &&
+            (lru->compare_fn
+                 ? lru->compare_fn(key, cstl_lru_key(e)) == 0
+                 : memcmp(key, cstl_lru_key(e), key_size) == 0)) {
+            break;
+        }
+    }
+    return pe;
+}
+
+/* unlinks the entry at *pe from both structures and releases it */
+static void cstl_lru_drop(struct cstl_lru* lru, struct cstl_lru_entry** pe)
+{
+    struct cstl_lru_entry* e = *pe;
+    *pe = e->hnext;
+    cstl_ilist_unlink(&e->node);
+    lru->count--;
+    lru->usage -= cstl_lru_charge(lru, e);
+    if (lru->evict_fn) {
+        lru->evict_fn(cstl_lru_key(e), e->key_size, cstl_lru_value(e),
+                      e->value_size, lru->evict_arg);
+    }
+    free(e);
+}
+
+static void cstl_lru_evict_oldest(struct cstl_lru* lru)
+{
+    struct cstl_ilist_node* node = cstl_ilist_back(&lru->recency);
+    struct cstl_lru_entry* e =
+        cstl_container_of(node, struct cstl_lru_entry, node);
+    struct cstl_lru_entry** pe = &lru->buckets[e->hash & lru->bucket_mask];
+    while (*pe != e) {
+        pe = &(*pe)->hnext;
+    }
+    cstl_lru_drop(lru, pe);
+}
+
+static void cstl_lru_grow(struct cstl_lru* lru)
+{
+    size_t n = (lru->bucket_mask + 1) * 2, i;
+    struct cstl_lru_entry** buckets;
+    buckets = (struct cstl_lru_entry**)calloc(n, sizeof(*buckets));
+    if (buckets == NULL) {
+        return; /* keep the longer chains */
+    }
+    for (i = 0; i <= lru->bucket_mask; i++) {
+        struct cstl_lru_entry* e = lru->buckets[i];
+        while (e) {
+            struct cstl_lru_entry* next = e->hnext;
+            e->hnext = buckets[e->hash & (n - 1)];
+            buckets[e->hash & (n - 1)] = e;
+            e = next;
+        }
+    }
+    free(lru->buckets);
+    lru->buckets = buckets;
+    lru->bucket_mask = n - 1;
+}
+
+cstl_error cstl_lru_put(struct cstl_lru* lru, const void* key,
+                        size_t key_size, const void* value, size_t value_size)
+{
+    struct cstl_lru_entry *e, **pe;
+    size_t hash;
+    if (lru == (struct cstl_lru*)0) {
+        return CSTL_LRU_NOT_INITIALIZED;
+    }
+    if (key == NULL || key_size == 0 || (value == NULL && value_size)) {
+        return CSTL_LRU_INVALID_INPUT;
+    }
+    if (lru->unit == CSTL_LRU_BYTES && key_size + value_size > lru->capacity) {
+        return CSTL_LRU_INVALID_INPUT;
+    }
+    e = (struct cstl_lru_entry*)malloc(
+        CSTL_LRU_KEY_OFF + CSTL_LRU_ALIGN(key_size) + value_size);
+    if (e == NULL) {
+        return CSTL_ERROR_MEMORY;
+    }
+    hash = lru->hash_fn(key, key_size);
+    e->hash = hash;
+    e->key_size = key_size;
+    e->value_size = value_size;
+    memcpy(cstl_lru_key(e), key, key_size);
+    if (value_size) {
+        memcpy(cstl_lru_value(e), value, value_size);
+    }
+
+    pe = cstl_lru_lookup(lru, key, key_size, hash);
+    if (*pe) {
+        cstl_lru_drop(lru, pe);
+    }
+    if (lru->count > lru->bucket_mask) {
+        cstl_lru_grow(lru);
+    }
+    pe = &lru->buckets[hash & lru->bucket_mask];
+    e->hnext = *pe;
+    *pe = e;
+    cstl_ilist_push_front(&lru->recency, &e->node);
+    lru->count++;
+    lru->usage += cstl_lru_charge(lru, e);
+
+    while (lru->usage > lru->capacity) {
+        cstl_lru_evict_oldest(lru);
+    }
+    return CSTL_ERROR_SUCCESS;
+}
+
+void* cstl_lru_peek(struct cstl_lru* lru, const void* key, size_t key_size)
+{
+    struct cstl_lru_entry* e;
+    if (lru == (struct cstl_lru*)0 || key == NULL) {
+        return NULL;
+    }
+    e = *cstl_lru_lookup(lru, key, key_size, lru->hash_fn(key, key_size));
+    return e ? cstl_lru_value(e) : NULL;
+}
+
+void* cstl_lru_get(struct cstl_lru* lru, const void* key, size_t key_size)
+{
+    struct cstl_lru_entry* e;
+    if (lru == (struct cstl_lru*)0 || key == NULL) {
+        return NULL;
+    }
+    e = *cstl_lru_lookup(lru, key, key_size, lru->hash_fn(key, key_size));
+    if (e == NULL) {
+        return NULL;
+    }
+    cstl_ilist_unlink(&e->node);
+    cstl_ilist_push_front(&lru->recency, &e->node);
+    return cstl_lru_value(e);
+}
+
+cstl_error cstl_lru_remove(struct cstl_lru* lru, const void* key,
+                           size_t key_size)
+{
+    struct cstl_lru_entry** pe;
+    if (lru == (struct cstl_lru*)0) {
+        return CSTL_LRU_NOT_INITIALIZED;
+    }
+    if (key == NULL) {
+        return CSTL_LRU_INVALID_INPUT;
+    }
+    pe = cstl_lru_lookup(lru, key, key_size, lru->hash_fn(key, key_size));
+    if (*pe == NULL) {
+        return CSTL_RBTREE_KEY_NOT_FOUND;
+    }
+    cstl_lru_drop(lru, pe);
+    return CSTL_ERROR_SUCCESS;
+}
+
+size_t cstl_lru_size(struct cstl_lru* lru)
+{
+    return lru ? lru->count : 0;
+}
+
+size_t cstl_lru_usage(struct cstl_lru* lru)
+{
+    return lru ? lru->usage : 0;
+}
+
+void cstl_lru_clear(struct cstl_lru* lru)
+{
+    if (lru == (struct cstl_lru*)0) {
+        return;
+    }
+    while (!cstl_ilist_empty(&lru->recency)) {
+        cstl_lru_evict_oldest(lru);
+    }
+}
+
+void cstl_lru_delete(struct cstl_lru* lru)
+{
+    if (lru == (struct cstl_lru*)0) {
+        return;
+    }
+    cstl_lru_clear(lru);
+    free(lru->buckets);
+    free(lru);
+}
@@ -28,18 +28,45 @@
 #include "c_stl_lib.h"
 #include "rb-tree.h"
 
+/*
+ * A map starts out small: its items sit by value in one sorted array and are
+ * found by binary search, so an entry costs only its key and value copies.
+ * Inserting past small_limit moves the items into an rb-tree; removing down
+ * to half the limit moves them back. Only the item structs move, the key
+ * and value buffers they point at never do.
+ */
+
+/*
+ * The key and its first value share one allocation, the value starting at
+ * the next 8-byte boundary; a value set later by replace gets its own.
+ */
+struct cstl_map_item {
+    struct cstl_map* pMap;
+    void* key;
+    void* value;
+    int value_inline;
+};
+
+#define CSTL_MAP_ALIGN(n) (((n) + 7) & ~(size_t)7)
+
+/* the fewest keys a Bloom filter is sized for */
+#define CSTL_MAP_BLOOM_MIN_KEYS 64
+
 struct cstl_map {
-    struct rbt_tree* tree;
+    struct rbt_tree* tree; /* NULL while the map is small */
+    struct cstl_map_item* small;
+    size_t small_capacity;
+    size_t small_limit;
+    size_t count;
     int map_changed;
+    int moving; /* items are changing representation, do not destroy */
     cstl_compare fn_c_k;
     cstl_destroy fn_k_d;
     cstl_destroy fn_v_d;
-};
-
-struct cstl_map_item {
-    struct cstl_map* pMap;
-    void* key;
-    void* value;
+    struct cstl_bloom* bloom; /* NULL unless cstl_map_bloom() added one */
+    cstl_hash fn_h;
+    size_t key_size;
+    unsigned int bits_per_key;
 };
 
 static void __map_item_destruct(struct cstl_map_item* item);
@@ -48,7 +75,9 @@ static void _item_destruct(void* p)
 {
     struct cstl_map_item* item = (struct cstl_map_item*)p;
     assert(item);
-    __map_item_destruct(item);
+    if (item->pMap->moving == 0) {
+        __map_item_destruct(item);
+    }
 }
 
 static int _item_compare(const void* lhs, const void* rhs)
@@ -70,15 +99,10 @@ struct cstl_map* cstl_map_new(cstl_compare fn_c_k, cstl_destroy fn_k_d,
     struct cstl_map* pMap = (struct cstl_map*)calloc(1, sizeof(*pMap));
     if (pMap) {
         pMap->map_changed = 0;
+        pMap->small_limit = CSTL_MAP_SMALL_LIMIT;
         pMap->fn_c_k = fn_c_k;
         pMap->fn_k_d = fn_k_d;
         pMap->fn_v_d = fn_v_d;
-        pMap->tree =
-            rbt_tree_create(malloc, free, 0, _item_compare, _item_destruct);
-        if (pMap->tree == (struct rbt_tree*)NULL) {
-            free(pMap);
-            pMap = NULL;
-        }
     }
     return pMap;
 }
@@ -89,8 +113,11 @@ static void _map_item_value_destroy(struct cstl_map_item* item)
     if (pMap->fn_v_d) {
         pMap->fn_v_d(item->value);
     }
-    free(item->value);
+    if (!item->value_inline) {
+        free(item->value);
+    }
     item->value = NULL;
+    item->value_inline = 0;
 }
 
 static void _map_item_set_value(struct cstl_map_item* item, const void* value,
@@ -112,11 +139,20 @@ static void map_item_init(struct cstl_map* pMap, struct cstl_map_item* item,
 {
     assert(pMap);
     assert(key && key_size);
+    if (!(value && value_size)) {
+        value_size = 0;
+    }
     item->pMap = pMap;
-    item->key = calloc(key_size, sizeof(char));
+    item->key = malloc(CSTL_MAP_ALIGN(key_size) + value_size);
     assert(item->key);
     memcpy(item->key, key, key_size);
-    _map_item_set_value(item, value, value_size);
+    item->value = NULL;
+    item->value_inline = 0;
+    if (value_size) {
+        item->value = (char*)item->key + CSTL_MAP_ALIGN(key_size);
+        item->value_inline = 1;
+        memcpy(item->value, value, value_size);
+    }
 }
 
 static void __map_item_destruct(struct cstl_map_item* item)
@@ -125,14 +161,222 @@ static void __map_item_destruct(struct cstl_map_item* item)
         struct cstl_map* pMap = item->pMap;
         assert(pMap);
 
+        /* the value may live in the key's allocation */
+        _map_item_value_destroy(item);
+
         if (pMap->fn_k_d) {
             pMap->fn_k_d(item->key);
         }
         free(item->key);
         item->key = NULL;
+    }
+}
 
-        _map_item_value_destroy(item);
+/* index of the first small item not less than key */
+static size_t _small_lower_bound(struct cstl_map* pMap, const void* key,
+                                 int* found)
+{
+    size_t lo = 0, hi = pMap->count;
+    *found = 0;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int c = pMap->fn_c_k(pMap->small[mid].key, key);
+        if (c < 0) {
+            lo = mid + 1;
+        }
+        else {
+            *found = (c == 0);
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static int _map_bloom_pass(struct cstl_map* pMap, const void* key)
+{
+    return pMap->bloom == (struct cstl_bloom*)0 ||
+           cstl_bloom_may_contain_hash(pMap->bloom,
+                                       pMap->fn_h(key, pMap->key_size));
+}
+
+static struct cstl_map_item* _map_lookup(struct cstl_map* pMap,
+                                         const void* key)
+{
+    struct rbt_node* node;
+    struct cstl_map_item dummy;
+    int found;
+    size_t i;
+
+    if (!_map_bloom_pass(pMap, key)) {
+        return (struct cstl_map_item*)0;
+    }
+    if (pMap->tree == (struct rbt_tree*)0) {
+        i = _small_lower_bound(pMap, key, &found);
+        return found ? &pMap->small[i] : (struct cstl_map_item*)0;
+    }
+    dummy.pMap = pMap;
+    dummy.key = (void*)key;
+    node = rbt_tree_find(pMap->tree, &dummy);
+    if (!rbt_node_is_valid(node)) {
+        return (struct cstl_map_item*)0;
+    }
+    return (struct cstl_map_item*)rbt_node_get_key(node);
+}
+
+static cstl_error _map_to_tree(struct cstl_map* pMap)
+{
+    struct rbt_tree* tree;
+    size_t i;
+    tree = rbt_tree_create(malloc, free, 0, _item_compare, _item_destruct);
+    if (tree == (struct rbt_tree*)NULL) {
+        return CSTL_ERROR_MEMORY;
+    }
+    for (i = 0; i < pMap->count; ++i) {
+        if (rbt_tree_insert(tree, &pMap->small[i], sizeof(pMap->small[i])) !=
+            rbt_status_success) {
+            pMap->moving = 1;
+            rbt_tree_destroy(tree);
+            pMap->moving = 0;
+            return CSTL_ERROR_MEMORY;
+        }
+    }
+    free(pMap->small);
+    pMap->small = NULL;
+    pMap->small_capacity = 0;
+    pMap->tree = tree;
+    return CSTL_ERROR_SUCCESS;
+}
+
+static void _collect_item(struct rbt_node* x, void* p)
+{
+    struct cstl_map* pMap = (struct cstl_map*)p;
+    memcpy(&pMap->small[pMap->small_capacity++], rbt_node_get_key(x),
+           sizeof(struct cstl_map_item));
+}
+
+/* best effort: a map that cannot get its array simply stays a tree */
+static void _map_to_small(struct cstl_map* pMap)
+{
+    struct cstl_map_item* small = (struct cstl_map_item*)malloc(
+        pMap->small_limit * sizeof(struct cstl_map_item));
+    if (small == NULL) {
+        return;
+    }
+    pMap->small = small;
+    pMap->small_capacity = 0;
+    rbt_inorder_walk(pMap->tree, _collect_item, pMap);
+    assert(pMap->small_capacity == pMap->count);
+    pMap->small_capacity = pMap->small_limit;
+    pMap->moving = 1;
+    rbt_tree_destroy(pMap->tree);
+    pMap->moving = 0;
+    pMap->tree = NULL;
+}
+
+static void _map_maybe_shrink(struct cstl_map* pMap)
+{
+    if (pMap->tree && pMap->small_limit &&
+        pMap->count <= pMap->small_limit / 2) {
+        _map_to_small(pMap);
+    }
+}
+
+cstl_error cstl_map_small_limit(struct cstl_map* pMap, size_t limit)
+{
+    if (pMap == (struct cstl_map*)NULL) {
+        return CSTL_MAP_NOT_INITIALIZED;
+    }
+    pMap->small_limit = limit;
+    if (pMap->tree == (struct rbt_tree*)0 && pMap->count > limit) {
+        return _map_to_tree(pMap);
+    }
+    _map_maybe_shrink(pMap);
+    return CSTL_ERROR_SUCCESS;
+}
+
+/* replaces the filter by one with room for twice the keys, refilled */
+static cstl_error _map_bloom_build(struct cstl_map* pMap)
+{
+    struct cstl_iterator it;
+    struct cstl_bloom* bloom;
+    size_t expected = pMap->count * 2;
+    if (expected < CSTL_MAP_BLOOM_MIN_KEYS) {
+        expected = CSTL_MAP_BLOOM_MIN_KEYS;
     }
+    bloom = cstl_bloom_new(expected, pMap->bits_per_key);
+    if (bloom == (struct cstl_bloom*)0) {
+        return CSTL_ERROR_MEMORY;
+    }
+    cstl_map_iterator_init(&it, pMap);
+    while (it.next(&it)) {
+        cstl_bloom_add_hash(bloom,
+                            pMap->fn_h(it.current_key(&it), pMap->key_size));
+    }
+    if (pMap->bloom) {
+        cstl_bloom_delete(pMap->bloom);
+    }
+    pMap->bloom = bloom;
+    return CSTL_ERROR_SUCCESS;
+}
+
+/* after an insertion; a filter that cannot grow only gets fuller */
+static void _map_bloom_add(struct cstl_map* pMap, const void* key)
+{
+    if (pMap->bloom) {
+        cstl_bloom_add_hash(pMap->bloom, pMap->fn_h(key, pMap->key_size));
+        if (pMap->count > cstl_bloom_capacity(pMap->bloom)) {
+            _map_bloom_build(pMap);
+        }
+    }
+}
+
+cstl_error cstl_map_bloom(struct cstl_map* pMap, size_t key_size,
+                          cstl_hash fn_h, unsigned int bits_per_key)
+{
+    if (pMap == (struct cstl_map*)0) {
+        return CSTL_MAP_NOT_INITIALIZED;
+    }
+    if (pMap->bloom) {
+        cstl_bloom_delete(pMap->bloom);
+        pMap->bloom = (struct cstl_bloom*)0;
+    }
+    if (bits_per_key == 0) {
+        return CSTL_ERROR_SUCCESS;
+    }
+    pMap->fn_h = fn_h ? fn_h : cstl_hash_bytes;
+    pMap->key_size = key_size;
+    pMap->bits_per_key = bits_per_key;
+    return _map_bloom_build(pMap);
+}
+
+cstl_error cstl_map_bloom_rebuild(struct cstl_map* pMap)
+{
+    if (pMap == (struct cstl_map*)0) {
+        return CSTL_MAP_NOT_INITIALIZED;
+    }
+    return pMap->bloom ? _map_bloom_build(pMap) : CSTL_ERROR_SUCCESS;
+}
+
+static cstl_error _small_insert(struct cstl_map* pMap, size_t i,
+                                const void* key, size_t key_size,
+                                const void* value, size_t value_size)
+{
+    if (pMap->count == pMap->small_capacity) {
+        size_t n = pMap->small_limit;
+        struct cstl_map_item* small;
+        small = (struct cstl_map_item*)realloc(
+            pMap->small, n * sizeof(struct cstl_map_item));
+        if (small == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        pMap->small = small;
+        pMap->small_capacity = n;
+    }
+    memmove(&pMap->small[i + 1], &pMap->small[i],
+            (pMap->count - i) * sizeof(struct cstl_map_item));
+    memset(&pMap->small[i], 0, sizeof(struct cstl_map_item));
+    map_item_init(pMap, &pMap->small[i], key, key_size, value, value_size);
+    return CSTL_ERROR_SUCCESS;
 }
 
 cstl_error cstl_map_insert(struct cstl_map* pMap, const void* key,
@@ -142,10 +386,31 @@ cstl_error cstl_map_insert(struct cstl_map* pMap, const void* key,
     cstl_error rc = CSTL_ERROR_SUCCESS;
     rbt_status rcrb;
     struct cstl_map_item dummy;
+    size_t i;
+    int found;
     if (pMap == (struct cstl_map*)NULL) {
         return CSTL_MAP_NOT_INITIALIZED;
     }
-    if (cstl_map_is_key_exists(pMap, key)) {
+    if (pMap->tree == (struct rbt_tree*)0) {
+        i = _small_lower_bound(pMap, key, &found);
+        if (found) {
+            return CSTL_RBTREE_KEY_DUPLICATE;
+        }
+        if (pMap->count < pMap->small_limit) {
+            rc = _small_insert(pMap, i, key, key_size, value, value_size);
+            if (rc == CSTL_ERROR_SUCCESS) {
+                pMap->count++;
+                pMap->map_changed = 1;
+                _map_bloom_add(pMap, key);
+            }
+            return rc;
+        }
+        rc = _map_to_tree(pMap);
+        if (rc != CSTL_ERROR_SUCCESS) {
+            return rc;
+        }
+    }
+    else if (cstl_map_is_key_exists(pMap, key)) {
         return CSTL_RBTREE_KEY_DUPLICATE;
     }
     memset(&dummy, 0, sizeof(dummy));
@@ -153,7 +418,9 @@ cstl_error cstl_map_insert(struct cstl_map* pMap, const void* key,
 
     rcrb = rbt_tree_insert(pMap->tree, &dummy, sizeof(dummy));
     if (rcrb == rbt_status_success) {
+        pMap->count++;
         pMap->map_changed = 1;
+        _map_bloom_add(pMap, key);
     }
     else {
         assert(0);
@@ -163,38 +430,24 @@ cstl_error cstl_map_insert(struct cstl_map* pMap, const void* key,
 
 int cstl_map_is_key_exists(struct cstl_map* pMap, const void* key)
 {
-    struct rbt_node* node;
-
-    struct cstl_map_item dummy;
-    dummy.pMap = pMap;
-    dummy.key = (void*)key;
-
     if (pMap == (struct cstl_map*)0) {
         return 0;
     }
-    node = rbt_tree_find(pMap->tree, &dummy);
-    return rbt_node_is_valid(node);
+    return _map_lookup(pMap, key) != (struct cstl_map_item*)0;
 }
 
 cstl_error cstl_map_replace(struct cstl_map* pMap, const void* key,
                             const void* value, size_t value_size)
 {
-    struct rbt_node* node;
     struct cstl_map_item* data;
 
-    struct cstl_map_item dummy;
-    dummy.pMap = pMap;
-    dummy.key = (void*)key;
-
     if (pMap == (struct cstl_map*)0) {
         return CSTL_MAP_NOT_INITIALIZED;
     }
-    node = rbt_tree_find(pMap->tree, &dummy);
-    if (!rbt_node_is_valid(node)) {
+    data = _map_lookup(pMap, key);
+    if (data == (struct cstl_map_item*)0) {
         return CSTL_RBTREE_KEY_NOT_FOUND;
     }
-
-    data = (struct cstl_map_item*)rbt_node_get_key(node);
     _map_item_set_value(data, value, value_size);
     return CSTL_ERROR_SUCCESS;
 }
@@ -203,6 +456,8 @@ cstl_error cstl_map_remove(struct cstl_map* pMap, const void* key)
 {
     cstl_error rc = CSTL_ERROR_SUCCESS;
     rbt_status rcrb;
+    size_t i;
+    int found;
 
     struct cstl_map_item dummy;
     dummy.pMap = pMap;
@@ -211,38 +466,99 @@ cstl_error cstl_map_remove(struct cstl_map* pMap, const void* key)
     if (pMap == (struct cstl_map*)0) {
         return CSTL_MAP_NOT_INITIALIZED;
     }
+    if (pMap->tree == (struct rbt_tree*)0) {
+        i = _small_lower_bound(pMap, key, &found);
+        if (found) {
+            __map_item_destruct(&pMap->small[i]);
+            memmove(&pMap->small[i], &pMap->small[i + 1],
+                    (pMap->count - i - 1) * sizeof(struct cstl_map_item));
+            pMap->count--;
+            pMap->map_changed = 1;
+        }
+        return rc;
+    }
     rcrb = rbt_tree_remove_node(pMap->tree, &dummy);
     if (rbt_status_success == rcrb) {
+        pMap->count--;
         pMap->map_changed = 1;
+        _map_maybe_shrink(pMap);
     }
     return rc;
 }
 
 const void* cstl_map_find(struct cstl_map* pMap, const void* key)
 {
-    struct rbt_node* node;
     struct cstl_map_item* data;
 
-    struct cstl_map_item dummy;
-    dummy.pMap = pMap;
-    dummy.key = (void*)key;
-
     if (pMap == (struct cstl_map*)0) {
         return (void*)0;
     }
-    node = rbt_tree_find(pMap->tree, (void*)&dummy);
-    if (0 == rbt_node_is_valid(node)) {
-        return (void*)0;
+    data = _map_lookup(pMap, key);
+    return data ? data->value : (void*)0;
+}
+
+/* keys looked up per rbt_tree_find_batch call */
+#define CSTL_MAP_BATCH 32
+
+size_t cstl_map_find_batch(struct cstl_map* pMap, const void* const keys[],
+                           size_t n, const void* out_values[])
+{
+    struct cstl_map_item dummy[CSTL_MAP_BATCH];
+    const void* probe[CSTL_MAP_BATCH];
+    struct rbt_node* nodes[CSTL_MAP_BATCH];
+    size_t slot[CSTL_MAP_BATCH];
+    size_t i, j, m, group, found = 0;
+
+    if (pMap == (struct cstl_map*)0 || pMap->tree == (struct rbt_tree*)0) {
+        for (i = 0; i < n; ++i) {
+            out_values[i] = cstl_map_find(pMap, keys[i]);
+            if (out_values[i]) {
+                ++found;
+            }
+        }
+        return found;
+    }
+    for (i = 0; i < n; i += group) {
+        group = (n - i < CSTL_MAP_BATCH) ? n - i : CSTL_MAP_BATCH;
+        /* only the keys the filter lets through go down the tree */
+        for (j = 0, m = 0; j < group; ++j) {
+            out_values[i + j] = (void*)0;
+            if (_map_bloom_pass(pMap, keys[i + j])) {
+                dummy[m].pMap = pMap;
+                dummy[m].key = (void*)keys[i + j];
+                dummy[m].value = (void*)0;
+                probe[m] = &dummy[m];
+                slot[m++] = i + j;
+            }
+        }
+        rbt_tree_find_batch(pMap->tree, probe, m, nodes);
+        for (j = 0; j < m; ++j) {
+            if (rbt_node_is_valid(nodes[j])) {
+                const struct cstl_map_item* data =
+                    (const struct cstl_map_item*)rbt_node_get_key(nodes[j]);
+                out_values[slot[j]] = data->value;
+                ++found;
+            }
+        }
     }
-    data = (struct cstl_map_item*)rbt_node_get_key(node);
-    return data->value;
+    return found;
 }
 
 cstl_error cstl_map_delete(struct cstl_map* x)
 {
     cstl_error rc = CSTL_ERROR_SUCCESS;
+    size_t i;
     if (x != (struct cstl_map*)0) {
-        rbt_tree_destroy(x->tree);
+        if (x->tree) {
+            rbt_tree_destroy(x->tree);
+        }
+        for (i = 0; x->tree == (struct rbt_tree*)0 && i < x->count; ++i) {
+            __map_item_destruct(&x->small[i]);
+        }
+        if (x->bloom) {
+            cstl_bloom_delete(x->bloom);
+        }
+        free(x->small);
         free(x);
     }
     return rc;
@@ -253,10 +569,24 @@ static struct rbt_node* cstl_map_minimum(struct cstl_map* x)
     return rbt_tree_minimum(x->tree, rbt_tree_get_root(x->tree));
 }
 
+/*
+ * While the map is small, current_element points at the current item and
+ * current_index is its position; otherwise current_element is its node.
+ */
 static const void* cstl_map_iter_get_next(struct cstl_iterator* pIterator)
 {
     struct cstl_map* x = (struct cstl_map*)pIterator->pContainer;
     struct rbt_node* ptr = NULL;
+    if (x->tree == (struct rbt_tree*)0) {
+        if (pIterator->current_element) {
+            pIterator->current_index++;
+        }
+        pIterator->current_element =
+            pIterator->current_index < x->count
+                ? &x->small[pIterator->current_index]
+                : NULL;
+        return pIterator->current_element;
+    }
     if (NULL == pIterator->current_element) {
         pIterator->current_element = cstl_map_minimum(x);
     }
@@ -272,27 +602,44 @@ static const void* cstl_map_iter_get_next(struct cstl_iterator* pIterator)
     return ptr;
 }
 
+static struct cstl_map_item* cstl_map_iter_item(
+    struct cstl_iterator* pIterator)
+{
+    struct cstl_map* x = (struct cstl_map*)pIterator->pContainer;
+    if (x->tree == (struct rbt_tree*)0) {
+        return (struct cstl_map_item*)pIterator->current_element;
+    }
+    return (struct cstl_map_item*)rbt_node_get_key(
+        (struct rbt_node*)pIterator->current_element);
+}
+
 static const void* cstl_map_iter_get_key(struct cstl_iterator* pIterator)
 {
-    struct rbt_node* current = (struct rbt_node*)pIterator->current_element;
-    struct cstl_map_item* d = (struct cstl_map_item*)rbt_node_get_key(current);
-    return d->key;
+    return cstl_map_iter_item(pIterator)->key;
 }
 
 static const void* cstl_map_iter_get_value(struct cstl_iterator* pIterator)
 {
-    struct rbt_node* current = (struct rbt_node*)pIterator->current_element;
-    struct cstl_map_item* d = (struct cstl_map_item*)rbt_node_get_key(current);
-    return d->value;
+    return cstl_map_iter_item(pIterator)->value;
 }
 
 static void cstl_map_iter_replace_value(struct cstl_iterator* pIterator,
                                         void* elem, size_t elem_size)
 {
-    /* struct cstl_map *pMap = (struct cstl_map *)pIterator->pContainer; */
-    struct rbt_node* current = (struct rbt_node*)pIterator->current_element;
-    struct cstl_map_item* d = (struct cstl_map_item*)rbt_node_get_key(current);
-    _map_item_set_value(d, elem, elem_size);
+    _map_item_set_value(cstl_map_iter_item(pIterator), elem, elem_size);
+}
+void cstl_map_iterator_init(struct cstl_iterator* itr, struct cstl_map* pMap)
+{
+    assert(itr);
+    memset(itr, 0, sizeof(*itr));
+    itr->next = cstl_map_iter_get_next;
+    itr->current_key = cstl_map_iter_get_key;
+    itr->current_value = cstl_map_iter_get_value;
+    itr->replace_current_value = cstl_map_iter_replace_value;
+    itr->pContainer = pMap;
+    itr->current_index = 0;
+    itr->current_element = (void*)0;
+    pMap->map_changed = 0;
 }
 
 struct cstl_iterator* cstl_map_new_iterator(struct cstl_map* pMap)
@@ -300,14 +647,7 @@ struct cstl_iterator* cstl_map_new_iterator(struct cstl_map* pMap)
     struct cstl_iterator* itr =
         (struct cstl_iterator*)calloc(1, sizeof(struct cstl_iterator));
     if (itr) {
-        itr->next = cstl_map_iter_get_next;
-        itr->current_key = cstl_map_iter_get_key;
-        itr->current_value = cstl_map_iter_get_value;
-        itr->replace_current_value = cstl_map_iter_replace_value;
-        itr->pContainer = pMap;
-        itr->current_index = 0;
-        itr->current_element = (void*)0;
-        pMap->map_changed = 0;
+        cstl_map_iterator_init(itr, pMap);
     }
     return itr;
 }
@@ -319,44 +659,41 @@ void cstl_map_delete_iterator(struct cstl_iterator* pItr)
 
 void cstl_map_traverse(struct cstl_map* map, map_iter_callback cb, void* p)
 {
-    struct cstl_iterator* iterator;
+    struct cstl_iterator iterator;
     const void* element;
     int stop = 0;
     if (map == NULL || cb == NULL) {
         return;
     }
-    iterator = cstl_map_new_iterator(map);
-    while ((element = iterator->next(iterator))) {
-        const void* key = iterator->current_key(iterator);
-        const void* value = iterator->current_value(iterator);
+    cstl_map_iterator_init(&iterator, map);
+    while ((element = iterator.next(&iterator))) {
+        const void* key = iterator.current_key(&iterator);
+        const void* value = iterator.current_value(&iterator);
         cb(map, key, value, &stop, p);
         if (stop != 0) {
             break;
         }
         if (map->map_changed) {
-            cstl_map_delete_iterator(iterator);
-            iterator = cstl_map_new_iterator(map);
+            cstl_map_iterator_init(&iterator, map);
         }
     }
-    cstl_map_delete_iterator(iterator);
 }
 
 void cstl_map_const_traverse(struct cstl_map* map, fn_map_walker fn, void* p)
 {
-    struct cstl_iterator* iterator;
+    struct cstl_iterator iterator;
     int stop = 0;
     const void* element;
     if (map == NULL || fn == NULL) {
         return;
     }
-    iterator = cstl_map_new_iterator(map);
-    while ((element = iterator->next(iterator))) {
-        const void* key = iterator->current_key(iterator);
-        const void* value = iterator->current_value(iterator);
+    cstl_map_iterator_init(&iterator, map);
+    while ((element = iterator.next(&iterator))) {
+        const void* key = iterator.current_key(&iterator);
+        const void* value = iterator.current_value(&iterator);
         fn(key, value, &stop, p);
         if (stop != 0) {
             break;
         }
     }
-    cstl_map_delete_iterator(iterator);
 }
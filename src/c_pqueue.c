@@ -0,0 +1,363 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include <string.h>
+#include "c_stl_lib.h"
+
+/*
+ * The heap is an array of slots, each holding the element's handle followed
+ * by the element itself, so comparisons during a sift touch only the heap.
+ * pos[handle] is the slot index of a queued element; a free handle has
+ * CSTL_PQ_FREE set and links to the next free handle through the rest.
+ */
+struct cstl_pqueue {
+    char* slots;
+    size_t slot_size;
+    size_t count;
+    size_t capacity;
+    size_t arity;
+    size_t* pos;
+    size_t handle_count; /* handles ever handed out */
+    size_t handle_capacity;
+    size_t free_handle;
+    char* scratch; /* one slot */
+    cstl_compare compare_fn;
+    cstl_destroy destruct_fn;
+};
+
+#define CSTL_PQ_FREE ((size_t)1 << (sizeof(size_t) * 8 - 1))
+#define CSTL_PQ_ELEM_OFF sizeof(size_t)
+
+#define cstl_pq_slot(pq, i) ((pq)->slots + (i) * (pq)->slot_size)
+#define cstl_pq_handle_of(slot) (*(size_t*)(slot))
+#define cstl_pq_elem(slot) ((void*)((char*)(slot) + CSTL_PQ_ELEM_OFF))
+
+struct cstl_pqueue* cstl_pqueue_new(size_t elem_size, size_t arity,
+                                    cstl_compare fn_c, cstl_destroy fn_d)
+{
+    struct cstl_pqueue* pq;
+    if (elem_size == 0 || fn_c == NULL) {
+        return (struct cstl_pqueue*)0;
+    }
+    pq = (struct cstl_pqueue*)calloc(1, sizeof(struct cstl_pqueue));
+    if (pq == (struct cstl_pqueue*)0) {
+        return (struct cstl_pqueue*)0;
+    }
+    pq->slot_size = CSTL_PQ_ELEM_OFF + elem_size;
+    /* keep every slot aligned like its handle */
+    pq->slot_size = (pq->slot_size + sizeof(size_t) - 1) &
+                    ~(sizeof(size_t) - 1);
+    pq->arity = arity < 2 ? CSTL_PQUEUE_DEFAULT_ARITY : arity;
+    pq->free_handle = CSTL_PQUEUE_HANDLE_NONE;
+    pq->compare_fn = fn_c;
+    pq->destruct_fn = fn_d;
+    pq->scratch = (char*)malloc(pq->slot_size);
+    if (pq->scratch == NULL) {
+        free(pq);
+        return (struct cstl_pqueue*)0;
+    }
+    return pq;
+}
+
+void cstl_pqueue_delete(struct cstl_pqueue* pq)
+{
+    size_t i;
+    if (pq == (struct cstl_pqueue*)0) {
+        return;
+    }
+    if (pq->destruct_fn) {
+        for (i = 0; i < pq->count; i++) {
+            pq->destruct_fn(cstl_pq_elem(cstl_pq_slot(pq, i)));
+        }
+    }
+    free(pq->slots);
+    free(pq->pos);
+    free(pq->scratch);
+    free(pq);
+}
+
+size_t cstl_pqueue_size(struct cstl_pqueue* pq)
+{
+    return pq ? pq->count : 0;
+}
+
+int cstl_pqueue_is_empty(struct cstl_pqueue* pq)
+{
+    return cstl_pqueue_size(pq) == 0;
+}
+
+cstl_error cstl_pqueue_reserve(struct cstl_pqueue* pq, size_t n)
+{
+    if (pq == (struct cstl_pqueue*)0) {
+        return CSTL_PQUEUE_NOT_INITIALIZED;
+    }
+    if (n > pq->capacity) {
+        char* slots = (char*)realloc(pq->slots, n * pq->slot_size);
+        if (slots == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        pq->slots = slots;
+        pq->capacity = n;
+    }
+    if (n > pq->handle_capacity) {
+        size_t* pos = (size_t*)realloc(pq->pos, n * sizeof(size_t));
+        if (pos == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        pq->pos = pos;
+        pq->handle_capacity = n;
+    }
+    return CSTL_ERROR_SUCCESS;
+}
+
+/* moves the slot held in scratch upwards from the hole at i */
+static size_t cstl_pq_sift_up(struct cstl_pqueue* pq, size_t i)
+{
+    const void* elem = cstl_pq_elem(pq->scratch);
+    while (i > 0) {
+        size_t parent = (i - 1) / pq->arity;
+        char* p = cstl_pq_slot(pq, parent);
+        if (pq->compare_fn(elem, cstl_pq_elem(p)) >= 0) {
+            break;
+        }
+        memcpy(cstl_pq_slot(pq, i), p, pq->slot_size);
+        pq->pos[cstl_pq_handle_of(p)] = i;
+        i = parent;
+    }
+    return i;
+}
+
+/* moves the slot held in scratch downwards from the hole at i */
+static size_t cstl_pq_sift_down(struct cstl_pqueue* pq, size_t i)
+{
+    const void* elem = cstl_pq_elem(pq->scratch);
+    for (;;) {
+        size_t first = i * pq->arity + 1, last, c, best;
+        char* b;
+        if (first >= pq->count) {
+            break;
+        }
+        last = first + pq->arity;
+        if (last > pq->count) {
+            last = pq->count;
+        }
+        best = first;
+        b = cstl_pq_slot(pq, first);
+        for (c = first + 1; c < last; c++) {
+            char* s = cstl_pq_slot(pq, c);
+            if (pq->compare_fn(cstl_pq_elem(s), cstl_pq_elem(b)) < 0) {
+                best = c;
+                b = s;
+            }
+        }
+        if (pq->compare_fn(cstl_pq_elem(b), elem) >= 0) {
+            break;
+        }
+        memcpy(cstl_pq_slot(pq, i), b, pq->slot_size);
+        pq->pos[cstl_pq_handle_of(b)] = i;
+        i = best;
+    }
+    return i;
+}
+
+static void cstl_pq_place(struct cstl_pqueue* pq, size_t i)
+{
+    memcpy(cstl_pq_slot(pq, i), pq->scratch, pq->slot_size);
+    pq->pos[cstl_pq_handle_of(pq->scratch)] = i;
+}
+
+cstl_error cstl_pqueue_push(struct cstl_pqueue* pq, const void* elem,
+                            cstl_pqueue_handle* handle)
+{
+    size_t h;
+    if (pq == (struct cstl_pqueue*)0) {
+        return CSTL_PQUEUE_NOT_INITIALIZED;
+    }
+    if (elem == NULL) {
+        return CSTL_PQUEUE_INVALID_INPUT;
+    }
+    if (pq->count == pq->capacity ||
+        (pq->free_handle == CSTL_PQUEUE_HANDLE_NONE &&
+         pq->handle_count == pq->handle_capacity)) {
+        size_t n = pq->capacity ? pq->capacity * 2 : 16;
+        cstl_error rc = cstl_pqueue_reserve(pq, n);
+        if (rc != CSTL_ERROR_SUCCESS) {
+            return rc;
+        }
+    }
+    if (pq->free_handle != CSTL_PQUEUE_HANDLE_NONE) {
+        h = pq->free_handle;
+        pq->free_handle = pq->pos[h] & ~CSTL_PQ_FREE;
+        if (pq->free_handle == (CSTL_PQUEUE_HANDLE_NONE & ~CSTL_PQ_FREE)) {
+            pq->free_handle = CSTL_PQUEUE_HANDLE_NONE;
+        }
+    }
+    else {
+        h = pq->handle_count++;
+    }
+    cstl_pq_handle_of(pq->scratch) = h;
+    memcpy(cstl_pq_elem(pq->scratch), elem,
+           pq->slot_size - CSTL_PQ_ELEM_OFF);
+    cstl_pq_place(pq, cstl_pq_sift_up(pq, pq->count++));
+    if (handle) {
+        *handle = h;
+    }
+    return CSTL_ERROR_SUCCESS;
+}
+
+const void* cstl_pqueue_top(struct cstl_pqueue* pq)
+{
+    if (pq == (struct cstl_pqueue*)0 || pq->count == 0) {
+        return NULL;
+    }
+    return cstl_pq_elem(pq->slots);
+}
+
+cstl_pqueue_handle cstl_pqueue_top_handle(struct cstl_pqueue* pq)
+{
+    if (pq == (struct cstl_pqueue*)0 || pq->count == 0) {
+        return CSTL_PQUEUE_HANDLE_NONE;
+    }
+    return cstl_pq_handle_of(pq->slots);
+}
+
+static int cstl_pq_valid(struct cstl_pqueue* pq, cstl_pqueue_handle h)
+{
+    return h < pq->handle_count && (pq->pos[h] & CSTL_PQ_FREE) == 0;
+}
+
+/* removes the element in slot i, which must be queued */
+static void cstl_pq_remove_at(struct cstl_pqueue* pq, size_t i, void* out)
+{
+    char* slot = cstl_pq_slot(pq, i);
+    size_t h = cstl_pq_handle_of(slot);
+    if (out) {
+        memcpy(out, cstl_pq_elem(slot), pq->slot_size - CSTL_PQ_ELEM_OFF);
+    }
+    else if (pq->destruct_fn) {
+        pq->destruct_fn(cstl_pq_elem(slot));
+    }
+    pq->pos[h] = CSTL_PQ_FREE | pq->free_handle;
+    pq->free_handle = h;
+
+    if (i != --pq->count) {
+        /* refill the hole with the last slot and restore the heap order */
+        memcpy(pq->scratch, cstl_pq_slot(pq, pq->count), pq->slot_size);
+        if (i > 0 && pq->compare_fn(cstl_pq_elem(pq->scratch),
+                                    cstl_pq_elem(cstl_pq_slot(
+                                        pq, (i - 1) / pq->arity))) < 0) {
+            cstl_pq_place(pq, cstl_pq_sift_up(pq, i));
+        }
+        else {
+            cstl_pq_place(pq, cstl_pq_sift_down(pq, i));
+        }
+    }
+}
+
+cstl_error cstl_pqueue_pop(struct cstl_pqueue* pq, void* out)
+{
+    if (pq == (struct cstl_pqueue*)0) {
+        return CSTL_PQUEUE_NOT_INITIALIZED;
+    }
+    if (pq->count == 0) {
+        return CSTL_PQUEUE_EMPTY;
+    }
+    cstl_pq_remove_at(pq, 0, out);
+    return CSTL_ERROR_SUCCESS;
+}
+
+const void* cstl_pqueue_get(struct cstl_pqueue* pq, cstl_pqueue_handle handle)
+{
+    if (pq == (struct cstl_pqueue*)0 || !cstl_pq_valid(pq, handle)) {
+        return NULL;
+    }
+    return cstl_pq_elem(cstl_pq_slot(pq, pq->pos[handle]));
+}
+
+/* direction: < 0 decrease only, > 0 increase only, 0 either */
+static cstl_error cstl_pq_rekey(struct cstl_pqueue* pq,
+                                cstl_pqueue_handle handle, const void* elem,
+                                int direction)
+{
+    size_t i;
+    int c;
+    if (pq == (struct cstl_pqueue*)0) {
+        return CSTL_PQUEUE_NOT_INITIALIZED;
+    }
+    if (!cstl_pq_valid(pq, handle)) {
+        return CSTL_PQUEUE_INVALID_HANDLE;
+    }
+    if (elem == NULL) {
+        return CSTL_PQUEUE_INVALID_INPUT;
+    }
+    i = pq->pos[handle];
+    c = pq->compare_fn(elem, cstl_pq_elem(cstl_pq_slot(pq, i)));
+    if ((direction < 0 && c > 0) || (direction > 0 && c < 0)) {
+        return CSTL_PQUEUE_INVALID_INPUT;
+    }
+    cstl_pq_handle_of(pq->scratch) = handle;
+    memcpy(cstl_pq_elem(pq->scratch), elem,
+           pq->slot_size - CSTL_PQ_ELEM_OFF);
+    if (c < 0) {
+        i = cstl_pq_sift_up(pq, i);
+    }
+    else if (c > 0) {
+        i = cstl_pq_sift_down(pq, i);
+    }
+    cstl_pq_place(pq, i);
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_pqueue_update(struct cstl_pqueue* pq, cstl_pqueue_handle handle,
+                              const void* elem)
+{
+    return cstl_pq_rekey(pq, handle, elem, 0);
+}
+
+cstl_error cstl_pqueue_decrease_key(struct cstl_pqueue* pq,
+                                    cstl_pqueue_handle handle,
+                                    const void* elem)
+{
+    return cstl_pq_rekey(pq, handle, elem, -1);
+}
+
+cstl_error cstl_pqueue_increase_key(struct cstl_pqueue* pq,
+                                    cstl_pqueue_handle handle,
+                                    const void* elem)
+{
+    return cstl_pq_rekey(pq, handle, elem, 1);
+}
+
+cstl_error cstl_pqueue_erase(struct cstl_pqueue* pq, cstl_pqueue_handle handle,
+                             void* out)
+{
+    if (pq == (struct cstl_pqueue*)0) {
+        return CSTL_PQUEUE_NOT_INITIALIZED;
+    }
+    if (!cstl_pq_valid(pq, handle)) {
+        return CSTL_PQUEUE_INVALID_HANDLE;
+    }
+    cstl_pq_remove_at(pq, pq->pos[handle], out);
+    return CSTL_ERROR_SUCCESS;
+}
@@ -0,0 +1,632 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include <assert.h>
+#include <string.h>
+#include "c_stl_lib.h"
+
+/*
+ * A node's label is the run of key bytes on the edge into it, stored right
+ * after the struct. Children are kept sorted by the first byte of their
+ * label, and those bytes are copied into `first`, next to the child
+ * pointers, so choosing a child never touches the children themselves.
+ */
+struct cstl_radix_node {
+    struct cstl_radix_node** child;
+    unsigned char* first; /* in the same allocation as child */
+    void* value;
+    size_t label_len;
+    unsigned short nchild;
+    unsigned short cap;
+    unsigned char has_value;
+};
+
+struct cstl_radix_tree {
+    struct cstl_radix_node* root; /* empty label, never removed */
+    size_t count;
+    cstl_radix_order order;
+    cstl_destroy fn_v_d;
+};
+
+#define cstl_radix_label(n) ((unsigned char*)((n) + 1))
+
+/* keys of a reversed tree are flipped into a buffer of this size or more */
+#define CSTL_RADIX_STACK_KEY 256
+
+static struct cstl_radix_node* _node_new(const unsigned char* label,
+                                         size_t len)
+{
+    struct cstl_radix_node* n = (struct cstl_radix_node*)malloc(
+        sizeof(struct cstl_radix_node) + len);
+    if (n) {
+        memset(n, 0, sizeof(*n));
+        n->label_len = len;
+        if (len) {
+            memcpy(cstl_radix_label(n), label, len);
+        }
+    }
+    return n;
+}
+
+static void _value_release(struct cstl_radix_tree* t,
+                           struct cstl_radix_node* n)
+{
+    if (n->has_value) {
+        if (t->fn_v_d) {
+            t->fn_v_d(n->value);
+        }
+        free(n->value);
+        n->value = NULL;
+        n->has_value = 0;
+    }
+}
+
+static void _node_free(struct cstl_radix_tree* t, struct cstl_radix_node* n)
+{
+    unsigned short i;
+    for (i = 0; i < n->nchild; ++i) {
+        _node_free(t, n->child[i]);
+    }
+    _value_release(t, n);
+    free(n->child);
+    free(n);
+}
+
+struct cstl_radix_tree* cstl_radix_tree_new(cstl_radix_order order,
+                                            cstl_destroy fn_v_d)
+{
+    struct cstl_radix_tree* t =
+        (struct cstl_radix_tree*)calloc(1, sizeof(struct cstl_radix_tree));
+    if (t == (struct cstl_radix_tree*)0) {
+        return t;
+    }
+    t->root = _node_new(NULL, 0);
+    if (t->root == (struct cstl_radix_node*)0) {
+        free(t);
+        return (struct cstl_radix_tree*)0;
+    }
+    t->order = order;
+    t->fn_v_d = fn_v_d;
+    return t;
+}
+
+cstl_error cstl_radix_tree_delete(struct cstl_radix_tree* tree)
+{
+    if (tree == (struct cstl_radix_tree*)0) {
+        return CSTL_RADIX_TREE_NOT_INITIALIZED;
+    }
+    _node_free(tree, tree->root);
+    free(tree);
+    return CSTL_ERROR_SUCCESS;
+}
+
+size_t cstl_radix_tree_size(struct cstl_radix_tree* tree)
+{
+    return tree ? tree->count : 0;
+}
+
+/* position of byte b among n's children, *found set if it is there */
+static unsigned short _slot(const struct cstl_radix_node* n, unsigned char b,
+                            int* found)
+{
+    unsigned short lo = 0, hi = n->nchild;
+    while (lo < hi) {
+        unsigned short mid = (unsigned short)((lo + hi) / 2);
+        if (n->first[mid] < b) {
+            lo = (unsigned short)(mid + 1);
+        }
+        else {
+            hi = mid;
+        }
+    }
+    *found = lo < n->nchild && n->first[lo] == b;
+    return lo;
+}
+
+static struct cstl_radix_node* _child(const struct cstl_radix_node* n,
+                                      unsigned char b)
+{
+    int found;
+    unsigned short i = _slot(n, b, &found);
+    return found ? n->child[i] : (struct cstl_radix_node*)0;
+}
+
+static cstl_error _add_child(struct cstl_radix_node* n, unsigned short at,
+                             struct cstl_radix_node* c)
+{
+    if (n->nchild == n->cap) {
+        unsigned short cap = (unsigned short)(n->cap ? n->cap * 2 : 2);
+        struct cstl_radix_node** child;
+        if (cap > 256) {
+            cap = 256;
+        }
+        child = (struct cstl_radix_node**)malloc(
+            cap * (sizeof(struct cstl_radix_node*) + 1));
+        if (child == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        if (n->nchild) {
+            memcpy(child, n->child,
+                   n->nchild * sizeof(struct cstl_radix_node*));
+            memcpy(child + cap, n->first, n->nchild);
+        }
+        free(n->child);
+        n->child = child;
+        n->first = (unsigned char*)(child + cap);
+        n->cap = cap;
+    }
+    memmove(n->child + at + 1, n->child + at,
+            (n->nchild - at) * sizeof(struct cstl_radix_node*));
+    memmove(n->first + at + 1, n->first + at, (size_t)(n->nchild - at));
+    n->child[at] = c;
+    n->first[at] = cstl_radix_label(c)[0];
+    n->nchild++;
+    return CSTL_ERROR_SUCCESS;
+}
+
+static void _drop_child(struct cstl_radix_node* n, unsigned short at)
+{
+    n->nchild--;
+    memmove(n->child + at, n->child + at + 1,
+            (n->nchild - at) * sizeof(struct cstl_radix_node*));
+    memmove(n->first + at, n->first + at + 1, (size_t)(n->nchild - at));
+}
+
+/*
+ * Hands back key in the order the tree stores it: as is, or reversed into
+ * buf (or a heap copy when buf is too small, which the caller frees).
+ */
+static const unsigned char* _internal_key(struct cstl_radix_tree* t,
+                                          const void* key, size_t len,
+                                          unsigned char* buf,
+                                          unsigned char** heap)
+{
+    const unsigned char* k = (const unsigned char*)key;
+    unsigned char* out = buf;
+    size_t i;
+    *heap = NULL;
+    if (t->order == CSTL_RADIX_FORWARD) {
+        return k;
+    }
+    if (len > CSTL_RADIX_STACK_KEY) {
+        out = *heap = (unsigned char*)malloc(len);
+        if (out == NULL) {
+            return NULL;
+        }
+    }
+    for (i = 0; i < len; ++i) {
+        out[i] = k[len - 1 - i];
+    }
+    return out;
+}
+
+static size_t _common(const unsigned char* a, const unsigned char* b,
+                      size_t n)
+{
+    size_t i = 0;
+    while (i < n && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+/*
+ * Splits c so that its first m label bytes move to a new parent, which
+ * takes c's place among parent's children.
+ */
+static struct cstl_radix_node* _split(struct cstl_radix_node* parent,
+                                      unsigned short at,
+                                      struct cstl_radix_node* c, size_t m)
+{
+    struct cstl_radix_node* p = _node_new(cstl_radix_label(c), m);
+    if (p == (struct cstl_radix_node*)0) {
+        return p;
+    }
+    c->label_len -= m;
+    memmove(cstl_radix_label(c), cstl_radix_label(c) + m, c->label_len);
+    if (_add_child(p, 0, c) != CSTL_ERROR_SUCCESS) {
+        memmove(cstl_radix_label(c) + m, cstl_radix_label(c), c->label_len);
+        memcpy(cstl_radix_label(c), cstl_radix_label(p), m);
+        c->label_len += m;
+        free(p);
+        return (struct cstl_radix_node*)0;
+    }
+    parent->child[at] = p;
+    return p;
+}
+
+static cstl_error _insert(struct cstl_radix_tree* t, const unsigned char* k,
+                          size_t len, void* v)
+{
+    struct cstl_radix_node *n = t->root, *c;
+    size_t i = 0, m;
+    unsigned short at;
+    int found;
+
+    while (i < len) {
+        at = _slot(n, k[i], &found);
+        if (!found) {
+            c = _node_new(k + i, len - i);
+            if (c == (struct cstl_radix_node*)0) {
+                return CSTL_ERROR_MEMORY;
+            }
+            if (_add_child(n, at, c) != CSTL_ERROR_SUCCESS) {
+                free(c);
+                return CSTL_ERROR_MEMORY;
+            }
+            n = c;
+            break;
+        }
+        c = n->child[at];
+        m = c->label_len < len - i ? c->label_len : len - i;
+        m = _common(cstl_radix_label(c), k + i, m);
+        if (m < c->label_len) {
+            /* a split node left without a value is still a valid tree */
+            c = _split(n, at, c, m);
+            if (c == (struct cstl_radix_node*)0) {
+                return CSTL_ERROR_MEMORY;
+            }
+        }
+        n = c;
+        i += m;
+    }
+    if (n->has_value) {
+        return CSTL_RBTREE_KEY_DUPLICATE;
+    }
+    n->value = v;
+    n->has_value = 1;
+    t->count++;
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_radix_tree_insert(struct cstl_radix_tree* tree,
+                                  const void* key, size_t key_len,
+                                  const void* value, size_t value_size)
+{
+    unsigned char buf[CSTL_RADIX_STACK_KEY];
+    unsigned char* heap;
+    const unsigned char* k;
+    void* v;
+    cstl_error rc;
+    if (tree == (struct cstl_radix_tree*)0) {
+        return CSTL_RADIX_TREE_NOT_INITIALIZED;
+    }
+    if ((key == NULL && key_len) || (value == NULL && value_size)) {
+        return CSTL_RADIX_TREE_INVALID_INPUT;
+    }
+    k = _internal_key(tree, key, key_len, buf, &heap);
+    if (k == NULL && key_len) {
+        return CSTL_ERROR_MEMORY;
+    }
+    v = malloc(value_size ? value_size : 1);
+    if (v == NULL) {
+        free(heap);
+        return CSTL_ERROR_MEMORY;
+    }
+    if (value_size) {
+        memcpy(v, value, value_size);
+    }
+    rc = _insert(tree, k, key_len, v);
+    if (rc != CSTL_ERROR_SUCCESS) {
+        free(v);
+    }
+    free(heap);
+    return rc;
+}
+
+/* the node whose path spells exactly k, or NULL */
+static struct cstl_radix_node* _lookup(struct cstl_radix_tree* t,
+                                       const unsigned char* k, size_t len)
+{
+    struct cstl_radix_node *n = t->root, *c;
+    size_t i = 0;
+    while (i < len) {
+        c = _child(n, k[i]);
+        if (c == (struct cstl_radix_node*)0 || c->label_len > len - i ||
+            memcmp(cstl_radix_label(c), k + i, c->label_len) != 0) {
+            return (struct cstl_radix_node*)0;
+        }
+        i += c->label_len;
+        n = c;
+    }
+    return n;
+}
+
+void* cstl_radix_tree_find(struct cstl_radix_tree* tree, const void* key,
+                           size_t key_len)
+{
+    unsigned char buf[CSTL_RADIX_STACK_KEY];
+    unsigned char* heap;
+    const unsigned char* k;
+    struct cstl_radix_node* n;
+    if (tree == (struct cstl_radix_tree*)0 || (key == NULL && key_len)) {
+        return NULL;
+    }
+    k = _internal_key(tree, key, key_len, buf, &heap);
+    if (k == NULL && key_len) {
+        return NULL;
+    }
+    n = _lookup(tree, k, key_len);
+    free(heap);
+    return n && n->has_value ? n->value : NULL;
+}
+
+void* cstl_radix_tree_longest_prefix(struct cstl_radix_tree* tree,
+                                     const void* key, size_t key_len,
+                                     size_t* match_len)
+{
+    unsigned char buf[CSTL_RADIX_STACK_KEY];
+    unsigned char* heap;
+    const unsigned char* k;
+    struct cstl_radix_node *n, *c, *best = (struct cstl_radix_node*)0;
+    size_t i = 0, best_len = 0;
+
+    if (match_len) {
+        *match_len = 0;
+    }
+    if (tree == (struct cstl_radix_tree*)0 || (key == NULL && key_len)) {
+        return NULL;
+    }
+    k = _internal_key(tree, key, key_len, buf, &heap);
+    if (k == NULL && key_len) {
+        return NULL;
+    }
+    n = tree->root;
+    for (;;) {
+        if (n->has_value) {
+            best = n;
+            best_len = i;
+        }
+        if (i == key_len) {
+            break;
+        }
+        c = _child(n, k[i]);
+        if (c == (struct cstl_radix_node*)0 || c->label_len > key_len - i ||
+            memcmp(cstl_radix_label(c), k + i, c->label_len) != 0) {
+            break;
+        }
+        i += c->label_len;
+        n = c;
+    }
+    free(heap);
+    if (best == (struct cstl_radix_node*)0) {
+        return NULL;
+    }
+    if (match_len) {
+        *match_len = best_len;
+    }
+    return best->value;
+}
+
+/* merges n with its only child, which replaces it in parent */
+static void _merge(struct cstl_radix_node* parent, unsigned short at,
+                   struct cstl_radix_node* n)
+{
+    struct cstl_radix_node* c = n->child[0];
+    struct cstl_radix_node* m = (struct cstl_radix_node*)realloc(
+        c, sizeof(struct cstl_radix_node) + n->label_len + c->label_len);
+    if (m == (struct cstl_radix_node*)0) {
+        return; /* leaving the chain unmerged is still a valid tree */
+    }
+    memmove(cstl_radix_label(m) + n->label_len, cstl_radix_label(m),
+            m->label_len);
+    memcpy(cstl_radix_label(m), cstl_radix_label(n), n->label_len);
+    m->label_len += n->label_len;
+    parent->child[at] = m;
+    free(n->child);
+    free(n);
+}
+
+/* drops n (a child of parent at `at`) or merges it, if it became useless */
+static void _compact(struct cstl_radix_node* parent, unsigned short at,
+                     struct cstl_radix_node* n)
+{
+    if (n->has_value) {
+        return;
+    }
+    if (n->nchild == 0) {
+        _drop_child(parent, at);
+        free(n->child);
+        free(n);
+    }
+    else if (n->nchild == 1) {
+        _merge(parent, at, n);
+    }
+}
+
+static cstl_error _remove(struct cstl_radix_tree* t,
+                          struct cstl_radix_node* n, const unsigned char* k,
+                          size_t len)
+{
+    struct cstl_radix_node* c;
+    unsigned short at;
+    int found;
+    cstl_error rc;
+
+    if (len == 0) {
+        if (!n->has_value) {
+            return CSTL_RBTREE_KEY_NOT_FOUND;
+        }
+        _value_release(t, n);
+        t->count--;
+        return CSTL_ERROR_SUCCESS;
+    }
+    at = _slot(n, k[0], &found);
+    if (!found) {
+        return CSTL_RBTREE_KEY_NOT_FOUND;
+    }
+    c = n->child[at];
+    if (c->label_len > len ||
+        memcmp(cstl_radix_label(c), k, c->label_len) != 0) {
+        return CSTL_RBTREE_KEY_NOT_FOUND;
+    }
+    rc = _remove(t, c, k + c->label_len, len - c->label_len);
+    if (rc == CSTL_ERROR_SUCCESS) {
+        _compact(n, at, c);
+    }
+    return rc;
+}
+
+cstl_error cstl_radix_tree_remove(struct cstl_radix_tree* tree,
+                                  const void* key, size_t key_len)
+{
+    unsigned char buf[CSTL_RADIX_STACK_KEY];
+    unsigned char* heap;
+    const unsigned char* k;
+    cstl_error rc;
+    if (tree == (struct cstl_radix_tree*)0) {
+        return CSTL_RADIX_TREE_NOT_INITIALIZED;
+    }
+    if (key == NULL && key_len) {
+        return CSTL_RADIX_TREE_INVALID_INPUT;
+    }
+    k = _internal_key(tree, key, key_len, buf, &heap);
+    if (k == NULL && key_len) {
+        return CSTL_ERROR_MEMORY;
+    }
+    rc = _remove(tree, tree->root, k, key_len);
+    free(heap);
+    return rc;
+}
+
+struct cstl_radix_walk {
+    struct cstl_radix_tree* tree;
+    unsigned char* path; /* key bytes from the root, in tree order */
+    size_t len;
+    size_t cap;
+    unsigned char* out; /* path flipped back, for reversed trees */
+    cstl_radix_walker fn;
+    void* p;
+    int stop;
+};
+
+static int _walk_push(struct cstl_radix_walk* w, const unsigned char* b,
+                      size_t n)
+{
+    if (w->len + n > w->cap) {
+        size_t cap = w->cap;
+        unsigned char *path, *out;
+        while (cap < w->len + n) {
+            cap *= 2;
+        }
+        path = (unsigned char*)realloc(w->path, cap);
+        if (path == NULL) {
+            return 0;
+        }
+        w->path = path;
+        out = (unsigned char*)realloc(w->out, cap);
+        if (out == NULL) {
+            return 0;
+        }
+        w->out = out;
+        w->cap = cap;
+    }
+    memcpy(w->path + w->len, b, n);
+    w->len += n;
+    return 1;
+}
+
+static void _walk(struct cstl_radix_walk* w, struct cstl_radix_node* n)
+{
+    unsigned short i;
+    if (n->has_value) {
+        const unsigned char* key = w->path;
+        if (w->tree->order == CSTL_RADIX_REVERSED) {
+            size_t j;
+            for (j = 0; j < w->len; ++j) {
+                w->out[j] = w->path[w->len - 1 - j];
+            }
+            key = w->out;
+        }
+        w->fn(key, w->len, n->value, &w->stop, w->p);
+    }
+    for (i = 0; i < n->nchild && !w->stop; ++i) {
+        struct cstl_radix_node* c = n->child[i];
+        if (!_walk_push(w, cstl_radix_label(c), c->label_len)) {
+            w->stop = 1;
+            break;
+        }
+        _walk(w, c);
+        w->len -= c->label_len;
+    }
+}
+
+void cstl_radix_tree_walk_prefix(struct cstl_radix_tree* tree,
+                                 const void* prefix, size_t prefix_len,
+                                 cstl_radix_walker fn, void* p)
+{
+    unsigned char buf[CSTL_RADIX_STACK_KEY];
+    unsigned char* heap;
+    const unsigned char* k;
+    struct cstl_radix_node *n, *c;
+    struct cstl_radix_walk w;
+    size_t i = 0, m;
+
+    if (tree == (struct cstl_radix_tree*)0 || fn == NULL ||
+        (prefix == NULL && prefix_len)) {
+        return;
+    }
+    k = _internal_key(tree, prefix, prefix_len, buf, &heap);
+    if (k == NULL && prefix_len) {
+        return;
+    }
+    memset(&w, 0, sizeof(w));
+    w.tree = tree;
+    w.fn = fn;
+    w.p = p;
+    /* allocated up front so that even the empty key has a valid pointer */
+    w.cap = 64;
+    w.path = (unsigned char*)malloc(w.cap);
+    w.out = (unsigned char*)malloc(w.cap);
+    if (w.path == NULL || w.out == NULL) {
+        free(w.path);
+        free(w.out);
+        free(heap);
+        return;
+    }
+
+    /* the prefix may end inside an edge; that edge's subtree still counts */
+    n = tree->root;
+    while (i < prefix_len) {
+        c = _child(n, k[i]);
+        if (c == (struct cstl_radix_node*)0) {
+            n = c;
+            break;
+        }
+        m = c->label_len < prefix_len - i ? c->label_len : prefix_len - i;
+        if (memcmp(cstl_radix_label(c), k + i, m) != 0 ||
+            !_walk_push(&w, cstl_radix_label(c), c->label_len)) {
+            n = (struct cstl_radix_node*)0;
+            break;
+        }
+        i += m;
+        n = c;
+    }
+    if (n) {
+        _walk(&w, n);
+    }
+    free(w.path);
+    free(w.out);
+    free(heap);
+}
@@ -0,0 +1,1518 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "c_stl_lib.h"
+
+#define CSTL_ROARING_ARRAY_MAX 4096
+#define CSTL_ROARING_WORDS 1024 /* 64-bit words in a bitmap container */
+#define CSTL_ROARING_BITMAP_BYTES (CSTL_ROARING_WORDS * 8)
+
+/* the cookies of the portable format */
+#define CSTL_ROARING_COOKIE_NO_RUN 12346
+#define CSTL_ROARING_COOKIE 12347
+#define CSTL_ROARING_NO_OFFSET_THRESHOLD 4
+
+/* an array this many times smaller than the other is galloped through it */
+#define CSTL_ROARING_GALLOP_RATIO 32
+
+enum {
+    CSTL_ROARING_ARRAY,
+    CSTL_ROARING_BITMAP,
+    CSTL_ROARING_RUN
+};
+
+enum {
+    CSTL_ROARING_OR,
+    CSTL_ROARING_AND,
+    CSTL_ROARING_ANDNOT,
+    CSTL_ROARING_XOR
+};
+
+/*
+ * data holds sorted uint16_t values (array), CSTL_ROARING_WORDS words
+ * (bitmap) or uint16_t (start, length - 1) pairs (run). n counts values or
+ * runs and capacity the room for them; bitmaps use neither.
+ */
+struct cstl_roaring_container {
+    void* data;
+    int cardinality;
+    int n;
+    int capacity;
+    int type;
+};
+
+struct cstl_roaring {
+    uint16_t* keys; /* high halves, increasing */
+    struct cstl_roaring_container* containers;
+    size_t size;
+    size_t capacity;
+};
+
+#define cstl_rc_values(c) ((uint16_t*)(c)->data)
+#define cstl_rc_words(c) ((uint64_t*)(c)->data)
+#define cstl_rc_start(c, i) (((uint16_t*)(c)->data)[2 * (i)])
+#define cstl_rc_length(c, i) (((uint16_t*)(c)->data)[2 * (i) + 1])
+#define cstl_rc_end(c, i) ((int)cstl_rc_start(c, i) + cstl_rc_length(c, i))
+
+static int _rc_init(struct cstl_roaring_container* c, int type, int capacity)
+{
+    size_t unit = type == CSTL_ROARING_RUN ? 2 * sizeof(uint16_t)
+                                           : sizeof(uint16_t);
+    if (capacity < 1) {
+        capacity = 1;
+    }
+    if (type == CSTL_ROARING_BITMAP) {
+        c->data = calloc(CSTL_ROARING_WORDS, sizeof(uint64_t));
+        capacity = 0;
+    }
+    else {
+        c->data = malloc(capacity * unit);
+    }
+    c->cardinality = 0;
+    c->n = 0;
+    c->capacity = capacity;
+    c->type = type;
+    return c->data ? 0 : -1;
+}
+
+static int _rc_reserve(struct cstl_roaring_container* c, int need)
+{
+    size_t unit = c->type == CSTL_ROARING_RUN ? 2 * sizeof(uint16_t)
+                                              : sizeof(uint16_t);
+    int capacity = c->capacity * 2;
+    void* data;
+    if (need <= c->capacity) {
+        return 0;
+    }
+    if (capacity < need) {
+        capacity = need;
+    }
+    if (c->type == CSTL_ROARING_ARRAY && capacity > CSTL_ROARING_ARRAY_MAX &&
+        need <= CSTL_ROARING_ARRAY_MAX) {
+        capacity = CSTL_ROARING_ARRAY_MAX;
+    }
+    data = realloc(c->data, capacity * unit);
+    if (data == NULL) {
+        return -1;
+    }
+    c->data = data;
+    c->capacity = capacity;
+    return 0;
+}
+
+static int _rc_copy(struct cstl_roaring_container* dst,
+                    const struct cstl_roaring_container* src)
+{
+    size_t bytes;
+    *dst = *src;
+    if (src->type == CSTL_ROARING_BITMAP) {
+        bytes = CSTL_ROARING_BITMAP_BYTES;
+    }
+    else {
+        dst->capacity = src->n ? src->n : 1;
+        bytes = dst->capacity * sizeof(uint16_t) *
+                (src->type == CSTL_ROARING_RUN ? 2 : 1);
+    }
+    dst->data = malloc(bytes);
+    if (dst->data == NULL) {
+        return -1;
+    }
+    memcpy(dst->data, src->data, bytes);
+    return 0;
+}
+
+/* index of the first of n values not less than v */
+static int _lower_bound16(const uint16_t* a, int n, uint16_t v)
+{
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (a[mid] < v) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* _lower_bound16 over a[lo..n), probing 1, 2, 4... ahead first */
+static int _gallop16(const uint16_t* a, int lo, int n, uint16_t v)
+{
+    int step = 1, hi;
+    if (lo >= n || a[lo] >= v) {
+        return lo;
+    }
+    while (lo + step < n && a[lo + step] < v) {
+        lo += step;
+        step <<= 1;
+    }
+    hi = lo + step < n ? lo + step : n;
+    /* a[lo] < v, and a[hi] >= v unless hi is n */
+    return lo + 1 + _lower_bound16(a + lo + 1, hi - lo - 1, v);
+}
+
+/* index of the last run starting at or before v, -1 if none does */
+static int _run_find(const struct cstl_roaring_container* c, uint16_t v)
+{
+    int lo = 0, hi = c->n;
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (cstl_rc_start(c, mid) <= v) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo - 1;
+}
+
+static int _rc_contains(const struct cstl_roaring_container* c, uint16_t v)
+{
+    int i;
+    switch (c->type) {
+    case CSTL_ROARING_ARRAY:
+        i = _lower_bound16(cstl_rc_values(c), c->n, v);
+        return i < c->n && cstl_rc_values(c)[i] == v;
+    case CSTL_ROARING_BITMAP:
+        return (int)((cstl_rc_words(c)[v >> 6] >> (v & 63)) & 1);
+    default:
+        i = _run_find(c, v);
+        return i >= 0 && v <= cstl_rc_end(c, i);
+    }
+}
+
+/* sets, clears or flips bits first to last of a bitmap */
+static void _words_range(uint64_t* w, int first, int last, int op)
+{
+    int i = first >> 6, j = last >> 6, k;
+    for (k = i; k <= j; ++k) {
+        uint64_t m = ~(uint64_t)0;
+        if (k == i) {
+            m &= ~(uint64_t)0 << (first & 63);
+        }
+        if (k == j) {
+            m &= ~(uint64_t)0 >> (63 - (last & 63));
+        }
+        if (op == CSTL_ROARING_OR) {
+            w[k] |= m;
+        }
+        else if (op == CSTL_ROARING_ANDNOT) {
+            w[k] &= ~m;
+        }
+        else {
+            w[k] ^= m;
+        }
+    }
+}
+
+/* sets the bits of c in zeroed words */
+static void _fill_words(uint64_t* w, const struct cstl_roaring_container* c)
+{
+    int i;
+    switch (c->type) {
+    case CSTL_ROARING_ARRAY:
+        for (i = 0; i < c->n; ++i) {
+            uint16_t v = cstl_rc_values(c)[i];
+            w[v >> 6] |= (uint64_t)1 << (v & 63);
+        }
+        break;
+    case CSTL_ROARING_BITMAP:
+        memcpy(w, c->data, CSTL_ROARING_BITMAP_BYTES);
+        break;
+    default:
+        for (i = 0; i < c->n; ++i) {
+            _words_range(w, cstl_rc_start(c, i), cstl_rc_end(c, i),
+                         CSTL_ROARING_OR);
+        }
+        break;
+    }
+}
+
+/* rewrites c as a bitmap, keeping its cardinality */
+static int _rc_to_bitmap(struct cstl_roaring_container* c)
+{
+    uint64_t* w = (uint64_t*)calloc(CSTL_ROARING_WORDS, sizeof(uint64_t));
+    if (w == NULL) {
+        return -1;
+    }
+    _fill_words(w, c);
+    free(c->data);
+    c->data = w;
+    c->n = 0;
+    c->capacity = 0;
+    c->type = CSTL_ROARING_BITMAP;
+    return 0;
+}
+
+/* rewrites c as an array; its cardinality must be at most the maximum */
+static int _rc_to_array(struct cstl_roaring_container* c)
+{
+    uint16_t* a;
+    int i, k = 0;
+    assert(c->cardinality <= CSTL_ROARING_ARRAY_MAX);
+    a = (uint16_t*)malloc((c->cardinality ? c->cardinality : 1) *
+                          sizeof(uint16_t));
+    if (a == NULL) {
+        return -1;
+    }
+    if (c->type == CSTL_ROARING_BITMAP) {
+        const uint64_t* w = cstl_rc_words(c);
+        size_t v = cstl_bitset_words_next_set(w, CSTL_ROARING_WORDS, 0);
+        for (; v != CSTL_BITSET_NPOS;
+             v = cstl_bitset_words_next_set(w, CSTL_ROARING_WORDS, v + 1)) {
+            a[k++] = (uint16_t)v;
+        }
+    }
+    else {
+        for (i = 0; i < c->n; ++i) {
+            int v;
+            for (v = cstl_rc_start(c, i); v <= cstl_rc_end(c, i); ++v) {
+                a[k++] = (uint16_t)v;
+            }
+        }
+    }
+    free(c->data);
+    c->data = a;
+    c->n = k;
+    c->capacity = c->cardinality ? c->cardinality : 1;
+    c->type = CSTL_ROARING_ARRAY;
+    return 0;
+}
+
+/* number of runs of consecutive values in c */
+static int _rc_count_runs(const struct cstl_roaring_container* c)
+{
+    const uint16_t* a;
+    const uint64_t* w;
+    uint64_t carry = 0;
+    int i, runs = 0;
+    switch (c->type) {
+    case CSTL_ROARING_ARRAY:
+        a = cstl_rc_values(c);
+        for (i = 0; i < c->n; ++i) {
+            if (i == 0 || a[i] != a[i - 1] + 1) {
+                ++runs;
+            }
+        }
+        return runs;
+    case CSTL_ROARING_BITMAP:
+        /* a run starts at every set bit whose lower neighbour is clear */
+        w = cstl_rc_words(c);
+        for (i = 0; i < CSTL_ROARING_WORDS; ++i) {
+            uint64_t starts = w[i] & ~((w[i] << 1) | carry);
+            runs += (int)cstl_bitset_words_popcount(&starts, 1);
+            carry = w[i] >> 63;
+        }
+        return runs;
+    default:
+        return c->n;
+    }
+}
+
+/* rewrites c, an array or a bitmap, as its runs */
+static int _rc_to_runs(struct cstl_roaring_container* c, int runs)
+{
+    uint16_t* r = (uint16_t*)malloc((runs ? runs : 1) * 2 * sizeof(uint16_t));
+    int k = -1, last = -2;
+    if (r == NULL) {
+        return -1;
+    }
+    if (c->type == CSTL_ROARING_ARRAY) {
+        int i;
+        for (i = 0; i < c->n; ++i) {
+            int v = cstl_rc_values(c)[i];
+            if (v != last + 1) {
+                r[2 * ++k] = (uint16_t)v;
+            }
+            r[2 * k + 1] = (uint16_t)(v - r[2 * k]);
+            last = v;
+        }
+    }
+    else {
+        const uint64_t* w = cstl_rc_words(c);
+        size_t v = cstl_bitset_words_next_set(w, CSTL_ROARING_WORDS, 0);
+        for (; v != CSTL_BITSET_NPOS;
+             v = cstl_bitset_words_next_set(w, CSTL_ROARING_WORDS, v + 1)) {
+            if ((int)v != last + 1) {
+                r[2 * ++k] = (uint16_t)v;
+            }
+            r[2 * k + 1] = (uint16_t)(v - r[2 * k]);
+            last = (int)v;
+        }
+    }
+    assert(k + 1 == runs);
+    free(c->data);
+    c->data = r;
+    c->n = runs;
+    c->capacity = runs ? runs : 1;
+    c->type = CSTL_ROARING_RUN;
+    return 0;
+}
+
+/* rewrites a run container as an array or a bitmap */
+static int _rc_from_runs(struct cstl_roaring_container* c)
+{
+    if (c->cardinality <= CSTL_ROARING_ARRAY_MAX) {
+        return _rc_to_array(c);
+    }
+    return _rc_to_bitmap(c);
+}
+
+/* 1 if v was added, 0 if it was there, -1 if memory ran out */
+static int _rc_add(struct cstl_roaring_container* c, uint16_t v)
+{
+    int i;
+    if (c->type == CSTL_ROARING_ARRAY) {
+        uint16_t* a = cstl_rc_values(c);
+        i = _lower_bound16(a, c->n, v);
+        if (i < c->n && a[i] == v) {
+            return 0;
+        }
+        if (c->n == CSTL_ROARING_ARRAY_MAX) {
+            if (_rc_to_bitmap(c) != 0) {
+                return -1;
+            }
+            return _rc_add(c, v);
+        }
+        if (_rc_reserve(c, c->n + 1) != 0) {
+            return -1;
+        }
+        a = cstl_rc_values(c);
+        memmove(a + i + 1, a + i, (c->n - i) * sizeof(uint16_t));
+        a[i] = v;
+        ++c->n;
+    }
+    else if (c->type == CSTL_ROARING_BITMAP) {
+        uint64_t* w = cstl_rc_words(c) + (v >> 6);
+        uint64_t bit = (uint64_t)1 << (v & 63);
+        if (*w & bit) {
+            return 0;
+        }
+        *w |= bit;
+    }
+    else {
+        i = _run_find(c, v);
+        if (i >= 0 && v <= cstl_rc_end(c, i)) {
+            return 0;
+        }
+        if (i >= 0 && v == cstl_rc_end(c, i) + 1) {
+            /* extends run i, and may close the gap to the next one */
+            ++cstl_rc_length(c, i);
+            if (i + 1 < c->n && cstl_rc_start(c, i + 1) == v + 1) {
+                cstl_rc_length(c, i) = (uint16_t)(cstl_rc_end(c, i + 1) -
+                                                  cstl_rc_start(c, i));
+                memmove(&cstl_rc_start(c, i + 1), &cstl_rc_start(c, i + 2),
+                        (c->n - i - 2) * 2 * sizeof(uint16_t));
+                --c->n;
+            }
+        }
+        else if (i + 1 < c->n && cstl_rc_start(c, i + 1) == v + 1) {
+            --cstl_rc_start(c, i + 1);
+            ++cstl_rc_length(c, i + 1);
+        }
+        else {
+            if (_rc_reserve(c, c->n + 1) != 0) {
+                return -1;
+            }
+            memmove(&cstl_rc_start(c, i + 2), &cstl_rc_start(c, i + 1),
+                    (c->n - i - 1) * 2 * sizeof(uint16_t));
+            cstl_rc_start(c, i + 1) = v;
+            cstl_rc_length(c, i + 1) = 0;
+            ++c->n;
+        }
+    }
+    ++c->cardinality;
+    return 1;
+}
+
+/* 1 if v was removed, 0 if it was not there, -1 if memory ran out */
+static int _rc_remove(struct cstl_roaring_container* c, uint16_t v)
+{
+    int i;
+    if (c->type == CSTL_ROARING_ARRAY) {
+        uint16_t* a = cstl_rc_values(c);
+        i = _lower_bound16(a, c->n, v);
+        if (i == c->n || a[i] != v) {
+            return 0;
+        }
+        memmove(a + i, a + i + 1, (c->n - i - 1) * sizeof(uint16_t));
+        --c->n;
+        --c->cardinality;
+    }
+    else if (c->type == CSTL_ROARING_BITMAP) {
+        uint64_t* w = cstl_rc_words(c) + (v >> 6);
+        uint64_t bit = (uint64_t)1 << (v & 63);
+        if (!(*w & bit)) {
+            return 0;
+        }
+        *w &= ~bit;
+        /* a bitmap left as is still works; it is only larger */
+        if (--c->cardinality <= CSTL_ROARING_ARRAY_MAX) {
+            _rc_to_array(c);
+        }
+    }
+    else {
+        int start, end;
+        i = _run_find(c, v);
+        if (i < 0 || v > cstl_rc_end(c, i)) {
+            return 0;
+        }
+        start = cstl_rc_start(c, i);
+        end = cstl_rc_end(c, i);
+        if (start == end) {
+            memmove(&cstl_rc_start(c, i), &cstl_rc_start(c, i + 1),
+                    (c->n - i - 1) * 2 * sizeof(uint16_t));
+            --c->n;
+        }
+        else if (v == start) {
+            ++cstl_rc_start(c, i);
+            --cstl_rc_length(c, i);
+        }
+        else if (v == end) {
+            --cstl_rc_length(c, i);
+        }
+        else {
+            if (_rc_reserve(c, c->n + 1) != 0) {
+                return -1;
+            }
+            memmove(&cstl_rc_start(c, i + 2), &cstl_rc_start(c, i + 1),
+                    (c->n - i - 1) * 2 * sizeof(uint16_t));
+            cstl_rc_length(c, i) = (uint16_t)(v - 1 - start);
+            cstl_rc_start(c, i + 1) = (uint16_t)(v + 1);
+            cstl_rc_length(c, i + 1) = (uint16_t)(end - v - 1);
+            ++c->n;
+        }
+        --c->cardinality;
+    }
+    return 1;
+}
+
+/* number of values in c not greater than v */
+static int _rc_rank(const struct cstl_roaring_container* c, uint16_t v)
+{
+    int i, rank = 0;
+    if (c->type == CSTL_ROARING_ARRAY) {
+        i = _lower_bound16(cstl_rc_values(c), c->n, v);
+        return i < c->n && cstl_rc_values(c)[i] == v ? i + 1 : i;
+    }
+    if (c->type == CSTL_ROARING_BITMAP) {
+        uint64_t last = cstl_rc_words(c)[v >> 6] &
+                        (~(uint64_t)0 >> (63 - (v & 63)));
+        return (int)(cstl_bitset_words_popcount(cstl_rc_words(c), v >> 6) +
+                     cstl_bitset_words_popcount(&last, 1));
+    }
+    for (i = 0; i < c->n && cstl_rc_start(c, i) <= v; ++i) {
+        int end = cstl_rc_end(c, i);
+        rank += (end < v ? end : v) - cstl_rc_start(c, i) + 1;
+    }
+    return rank;
+}
+
+/* the k-th smallest value of c, k below its cardinality */
+static uint16_t _rc_select(const struct cstl_roaring_container* c, int k)
+{
+    int i;
+    if (c->type == CSTL_ROARING_ARRAY) {
+        return cstl_rc_values(c)[k];
+    }
+    if (c->type == CSTL_ROARING_BITMAP) {
+        const uint64_t* w = cstl_rc_words(c);
+        size_t v;
+        for (i = 0;; ++i) {
+            int count = (int)cstl_bitset_words_popcount(w + i, 1);
+            if (k < count) {
+                break;
+            }
+            k -= count;
+        }
+        v = cstl_bitset_words_next_set(w, CSTL_ROARING_WORDS, i * 64);
+        while (k--) {
+            v = cstl_bitset_words_next_set(w, CSTL_ROARING_WORDS, v + 1);
+        }
+        return (uint16_t)v;
+    }
+    for (i = 0; k > cstl_rc_length(c, i); ++i) {
+        k -= cstl_rc_length(c, i) + 1;
+    }
+    return (uint16_t)(cstl_rc_start(c, i) + k);
+}
+
+/* the smallest value of c not less than v, or -1 */
+static int _rc_next(const struct cstl_roaring_container* c, uint16_t v)
+{
+    int i;
+    size_t found;
+    switch (c->type) {
+    case CSTL_ROARING_ARRAY:
+        i = _lower_bound16(cstl_rc_values(c), c->n, v);
+        return i < c->n ? cstl_rc_values(c)[i] : -1;
+    case CSTL_ROARING_BITMAP:
+        found = cstl_bitset_words_next_set(cstl_rc_words(c),
+                                           CSTL_ROARING_WORDS, v);
+        return found == CSTL_BITSET_NPOS ? -1 : (int)found;
+    default:
+        i = _run_find(c, v);
+        if (i >= 0 && v <= cstl_rc_end(c, i)) {
+            return v;
+        }
+        return i + 1 < c->n ? cstl_rc_start(c, i + 1) : -1;
+    }
+}
+
+/* calls fn for the values of c, high half hi; 1 if fn asked to stop */
+static int _rc_traverse(const struct cstl_roaring_container* c, uint32_t hi,
+                        cstl_roaring_walker fn, void* p)
+{
+    int i, stop = 0;
+    if (c->type == CSTL_ROARING_ARRAY) {
+        for (i = 0; i < c->n && !stop; ++i) {
+            fn(hi | cstl_rc_values(c)[i], &stop, p);
+        }
+    }
+    else if (c->type == CSTL_ROARING_BITMAP) {
+        const uint64_t* w = cstl_rc_words(c);
+        size_t v = cstl_bitset_words_next_set(w, CSTL_ROARING_WORDS, 0);
+        for (; v != CSTL_BITSET_NPOS && !stop;
+             v = cstl_bitset_words_next_set(w, CSTL_ROARING_WORDS, v + 1)) {
+            fn(hi | (uint32_t)v, &stop, p);
+        }
+    }
+    else {
+        for (i = 0; i < c->n && !stop; ++i) {
+            int v;
+            for (v = cstl_rc_start(c, i); v <= cstl_rc_end(c, i) && !stop;
+                 ++v) {
+                fn(hi | (uint32_t)v, &stop, p);
+            }
+        }
+    }
+    return stop;
+}
+
+/* out = a op b for two arrays; out may come back as a bitmap */
+static int _array_op(struct cstl_roaring_container* out,
+                     const struct cstl_roaring_container* a,
+                     const struct cstl_roaring_container* b, int op)
+{
+    const uint16_t* x = cstl_rc_values(a);
+    const uint16_t* y = cstl_rc_values(b);
+    int na = a->n, nb = b->n, i = 0, j = 0, k = 0;
+    int capacity = na;
+    uint16_t* o;
+    if (op == CSTL_ROARING_OR || op == CSTL_ROARING_XOR) {
+        capacity = na + nb;
+    }
+    else if (op == CSTL_ROARING_AND && nb < na) {
+        capacity = nb;
+    }
+    if (_rc_init(out, CSTL_ROARING_ARRAY, capacity) != 0) {
+        return -1;
+    }
+    o = cstl_rc_values(out);
+    switch (op) {
+    case CSTL_ROARING_AND:
+        if (na * CSTL_ROARING_GALLOP_RATIO < nb) {
+            for (; i < na; ++i) {
+                j = _gallop16(y, j, nb, x[i]);
+                if (j == nb) {
+                    break;
+                }
+                if (y[j] == x[i]) {
+                    o[k++] = x[i];
+                }
+            }
+        }
+        else if (nb * CSTL_ROARING_GALLOP_RATIO < na) {
+            for (; j < nb; ++j) {
+                i = _gallop16(x, i, na, y[j]);
+                if (i == na) {
+                    break;
+                }
+                if (x[i] == y[j]) {
+                    o[k++] = y[j];
+                }
+            }
+        }
+        else {
+            while (i < na && j < nb) {
+                if (x[i] < y[j]) {
+                    ++i;
+                }
+                else if (y[j] < x[i]) {
+                    ++j;
+                }
+                else {
+                    o[k++] = x[i++];
+                    ++j;
+                }
+            }
+        }
+        break;
+    case CSTL_ROARING_ANDNOT:
+        if (na * CSTL_ROARING_GALLOP_RATIO < nb) {
+            for (; i < na; ++i) {
+                j = _gallop16(y, j, nb, x[i]);
+                if (j == nb || y[j] != x[i]) {
+                    o[k++] = x[i];
+                }
+            }
+        }
+        else {
+            while (i < na) {
+                if (j == nb || x[i] < y[j]) {
+                    o[k++] = x[i++];
+                }
+                else if (y[j] < x[i]) {
+                    ++j;
+                }
+                else {
+                    ++i;
+                    ++j;
+                }
+            }
+        }
+        break;
+    default:
+        while (i < na || j < nb) {
+            if (j == nb || (i < na && x[i] < y[j])) {
+                o[k++] = x[i++];
+            }
+            else if (i == na || y[j] < x[i]) {
+                o[k++] = y[j++];
+            }
+            else {
+                if (op == CSTL_ROARING_OR) {
+                    o[k++] = x[i];
+                }
+                ++i;
+                ++j;
+            }
+        }
+        break;
+    }
+    out->n = k;
+    out->cardinality = k;
+    if (k > CSTL_ROARING_ARRAY_MAX && _rc_to_bitmap(out) != 0) {
+        free(out->data);
+        return -1;
+    }
+    return 0;
+}
+
+/* out = the values of a that are (keep) or are not in b */
+static int _array_filter(struct cstl_roaring_container* out,
+                         const struct cstl_roaring_container* a,
+                         const struct cstl_roaring_container* b, int keep)
+{
+    int i, k = 0;
+    if (_rc_init(out, CSTL_ROARING_ARRAY, a->n) != 0) {
+        return -1;
+    }
+    for (i = 0; i < a->n; ++i) {
+        uint16_t v = cstl_rc_values(a)[i];
+        if (_rc_contains(b, v) == keep) {
+            cstl_rc_values(out)[k++] = v;
+        }
+    }
+    out->n = k;
+    out->cardinality = k;
+    return 0;
+}
+
+/* out = a op b, computed on a bitmap and shrunk to an array if small */
+static int _bitmap_op(struct cstl_roaring_container* out,
+                      const struct cstl_roaring_container* a,
+                      const struct cstl_roaring_container* b, int op)
+{
+    uint64_t* w;
+    int i, next = 0;
+    if (_rc_init(out, CSTL_ROARING_BITMAP, 0) != 0) {
+        return -1;
+    }
+    w = cstl_rc_words(out);
+    _fill_words(w, a);
+    if (b->type == CSTL_ROARING_BITMAP) {
+        const uint64_t* s = cstl_rc_words(b);
+        switch (op) {
+        case CSTL_ROARING_OR:
+            cstl_bitset_words_or(w, s, CSTL_ROARING_WORDS);
+            break;
+        case CSTL_ROARING_AND:
+            cstl_bitset_words_and(w, s, CSTL_ROARING_WORDS);
+            break;
+        case CSTL_ROARING_ANDNOT:
+            cstl_bitset_words_andnot(w, s, CSTL_ROARING_WORDS);
+            break;
+        default:
+            cstl_bitset_words_xor(w, s, CSTL_ROARING_WORDS);
+            break;
+        }
+    }
+    else if (b->type == CSTL_ROARING_ARRAY) {
+        /* an array on the right of AND is filtered instead */
+        assert(op != CSTL_ROARING_AND);
+        for (i = 0; i < b->n; ++i) {
+            int v = cstl_rc_values(b)[i];
+            _words_range(w, v, v, op);
+        }
+    }
+    else if (op == CSTL_ROARING_AND) {
+        /* clears the gaps between the runs */
+        for (i = 0; i < b->n; ++i) {
+            if (cstl_rc_start(b, i) > next) {
+                _words_range(w, next, cstl_rc_start(b, i) - 1,
+                             CSTL_ROARING_ANDNOT);
+            }
+            next = cstl_rc_end(b, i) + 1;
+        }
+        if (next <= 0xFFFF) {
+            _words_range(w, next, 0xFFFF, CSTL_ROARING_ANDNOT);
+        }
+    }
+    else {
+        for (i = 0; i < b->n; ++i) {
+            _words_range(w, cstl_rc_start(b, i), cstl_rc_end(b, i), op);
+        }
+    }
+    out->cardinality =
+        (int)cstl_bitset_words_popcount(w, CSTL_ROARING_WORDS);
+    if (out->cardinality <= CSTL_ROARING_ARRAY_MAX) {
+        _rc_to_array(out);
+    }
+    return 0;
+}
+
+/* out = a op b, as an array or a bitmap */
+static int _rc_op(struct cstl_roaring_container* out,
+                  const struct cstl_roaring_container* a,
+                  const struct cstl_roaring_container* b, int op)
+{
+    if (a->type == CSTL_ROARING_ARRAY && b->type == CSTL_ROARING_ARRAY) {
+        return _array_op(out, a, b, op);
+    }
+    if (a->type == CSTL_ROARING_ARRAY &&
+        (op == CSTL_ROARING_AND || op == CSTL_ROARING_ANDNOT)) {
+        return _array_filter(out, a, b, op == CSTL_ROARING_AND);
+    }
+    if (b->type == CSTL_ROARING_ARRAY && op == CSTL_ROARING_AND) {
+        return _array_filter(out, b, a, 1);
+    }
+    return _bitmap_op(out, a, b, op);
+}
+
+/* position of key among the high halves; *found tells if it is there */
+static size_t _index(const struct cstl_roaring* r, uint16_t key, int* found)
+{
+    size_t lo = 0, hi = r->size;
+    /* values often arrive in increasing order */
+    if (r->size && r->keys[r->size - 1] <= key) {
+        *found = r->keys[r->size - 1] == key;
+        return *found ? r->size - 1 : r->size;
+    }
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (r->keys[mid] < key) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    *found = lo < r->size && r->keys[lo] == key;
+    return lo;
+}
+
+static int _reserve(struct cstl_roaring* r, size_t need)
+{
+    size_t capacity = r->capacity ? r->capacity * 2 : 4;
+    uint16_t* keys;
+    struct cstl_roaring_container* containers;
+    if (need <= r->capacity) {
+        return 0;
+    }
+    if (capacity < need) {
+        capacity = need;
+    }
+    keys = (uint16_t*)realloc(r->keys, capacity * sizeof(uint16_t));
+    if (keys == NULL) {
+        return -1;
+    }
+    r->keys = keys;
+    containers = (struct cstl_roaring_container*)realloc(
+        r->containers, capacity * sizeof(struct cstl_roaring_container));
+    if (containers == NULL) {
+        return -1;
+    }
+    r->containers = containers;
+    r->capacity = capacity;
+    return 0;
+}
+
+static int _insert_container(struct cstl_roaring* r, size_t i, uint16_t key,
+                             const struct cstl_roaring_container* c)
+{
+    if (_reserve(r, r->size + 1) != 0) {
+        return -1;
+    }
+    memmove(r->keys + i + 1, r->keys + i, (r->size - i) * sizeof(uint16_t));
+    memmove(r->containers + i + 1, r->containers + i,
+            (r->size - i) * sizeof(struct cstl_roaring_container));
+    r->keys[i] = key;
+    r->containers[i] = *c;
+    ++r->size;
+    return 0;
+}
+
+static void _remove_container(struct cstl_roaring* r, size_t i)
+{
+    free(r->containers[i].data);
+    memmove(r->keys + i, r->keys + i + 1,
+            (r->size - i - 1) * sizeof(uint16_t));
+    memmove(r->containers + i, r->containers + i + 1,
+            (r->size - i - 1) * sizeof(struct cstl_roaring_container));
+    --r->size;
+}
+
+static void _clear(struct cstl_roaring* r)
+{
+    size_t i;
+    for (i = 0; i < r->size; ++i) {
+        free(r->containers[i].data);
+    }
+    r->size = 0;
+}
+
+struct cstl_roaring* cstl_roaring_new(void)
+{
+    return (struct cstl_roaring*)calloc(1, sizeof(struct cstl_roaring));
+}
+
+struct cstl_roaring* cstl_roaring_copy(const struct cstl_roaring* r)
+{
+    struct cstl_roaring* copy;
+    if (r == (const struct cstl_roaring*)0) {
+        return (struct cstl_roaring*)0;
+    }
+    copy = cstl_roaring_new();
+    if (copy == NULL || _reserve(copy, r->size) != 0) {
+        cstl_roaring_delete(copy);
+        return (struct cstl_roaring*)0;
+    }
+    for (; copy->size < r->size; ++copy->size) {
+        if (_rc_copy(copy->containers + copy->size,
+                     r->containers + copy->size) != 0) {
+            cstl_roaring_delete(copy);
+            return (struct cstl_roaring*)0;
+        }
+        copy->keys[copy->size] = r->keys[copy->size];
+    }
+    return copy;
+}
+
+cstl_error cstl_roaring_delete(struct cstl_roaring* r)
+{
+    if (r == (struct cstl_roaring*)0) {
+        return CSTL_ROARING_NOT_INITIALIZED;
+    }
+    _clear(r);
+    free(r->keys);
+    free(r->containers);
+    free(r);
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_roaring_add(struct cstl_roaring* r, uint32_t value)
+{
+    uint16_t key = (uint16_t)(value >> 16);
+    size_t i;
+    int found;
+    if (r == (struct cstl_roaring*)0) {
+        return CSTL_ROARING_NOT_INITIALIZED;
+    }
+    i = _index(r, key, &found);
+    if (!found) {
+        struct cstl_roaring_container c;
+        if (_rc_init(&c, CSTL_ROARING_ARRAY, 4) != 0) {
+            return CSTL_ERROR_MEMORY;
+        }
+        if (_insert_container(r, i, key, &c) != 0) {
+            free(c.data);
+            return CSTL_ERROR_MEMORY;
+        }
+    }
+    if (_rc_add(r->containers + i, (uint16_t)value) < 0) {
+        return CSTL_ERROR_MEMORY;
+    }
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_roaring_add_range(struct cstl_roaring* r, uint32_t first,
+                                  uint32_t last)
+{
+    uint32_t key;
+    if (r == (struct cstl_roaring*)0) {
+        return CSTL_ROARING_NOT_INITIALIZED;
+    }
+    if (first > last) {
+        return CSTL_ERROR_SUCCESS;
+    }
+    for (key = first >> 16; key <= last >> 16; ++key) {
+        uint16_t run[2];
+        struct cstl_roaring_container range, c;
+        size_t i;
+        int found;
+        run[0] = (uint16_t)(key == first >> 16 ? first : 0);
+        run[1] = (uint16_t)((key == last >> 16 ? last & 0xFFFF : 0xFFFF) -
+                            run[0]);
+        range.data = run;
+        range.cardinality = run[1] + 1;
+        range.n = 1;
+        range.capacity = 1;
+        range.type = CSTL_ROARING_RUN;
+        i = _index(r, (uint16_t)key, &found);
+        if (found) {
+            if (_rc_op(&c, r->containers + i, &range, CSTL_ROARING_OR) != 0) {
+                return CSTL_ERROR_MEMORY;
+            }
+            free(r->containers[i].data);
+            r->containers[i] = c;
+        }
+        else {
+            if (_rc_copy(&c, &range) != 0) {
+                return CSTL_ERROR_MEMORY;
+            }
+            if (_insert_container(r, i, (uint16_t)key, &c) != 0) {
+                free(c.data);
+                return CSTL_ERROR_MEMORY;
+            }
+        }
+        if (key == 0xFFFF) {
+            break;
+        }
+    }
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_roaring_remove(struct cstl_roaring* r, uint32_t value)
+{
+    size_t i;
+    int found;
+    if (r == (struct cstl_roaring*)0) {
+        return CSTL_ROARING_NOT_INITIALIZED;
+    }
+    i = _index(r, (uint16_t)(value >> 16), &found);
+    if (found) {
+        if (_rc_remove(r->containers + i, (uint16_t)value) < 0) {
+            return CSTL_ERROR_MEMORY;
+        }
+        if (r->containers[i].cardinality == 0) {
+            _remove_container(r, i);
+        }
+    }
+    return CSTL_ERROR_SUCCESS;
+}
+
+int cstl_roaring_contains(const struct cstl_roaring* r, uint32_t value)
+{
+    size_t i;
+    int found;
+    if (r == (const struct cstl_roaring*)0) {
+        return 0;
+    }
+    i = _index(r, (uint16_t)(value >> 16), &found);
+    return found && _rc_contains(r->containers + i, (uint16_t)value);
+}
+
+uint64_t cstl_roaring_cardinality(const struct cstl_roaring* r)
+{
+    uint64_t total = 0;
+    size_t i;
+    for (i = 0; r && i < r->size; ++i) {
+        total += (uint64_t)r->containers[i].cardinality;
+    }
+    return total;
+}
+
+uint64_t cstl_roaring_rank(const struct cstl_roaring* r, uint32_t value)
+{
+    uint16_t key = (uint16_t)(value >> 16);
+    uint64_t rank = 0;
+    size_t i;
+    for (i = 0; r && i < r->size && r->keys[i] <= key; ++i) {
+        if (r->keys[i] < key) {
+            rank += (uint64_t)r->containers[i].cardinality;
+        }
+        else {
+            rank += (uint64_t)_rc_rank(r->containers + i, (uint16_t)value);
+        }
+    }
+    return rank;
+}
+
+int cstl_roaring_select(const struct cstl_roaring* r, uint64_t k,
+                        uint32_t* value)
+{
+    size_t i;
+    for (i = 0; r && i < r->size; ++i) {
+        uint64_t cardinality = (uint64_t)r->containers[i].cardinality;
+        if (k < cardinality) {
+            *value = (uint32_t)r->keys[i] << 16 |
+                     _rc_select(r->containers + i, (int)k);
+            return 1;
+        }
+        k -= cardinality;
+    }
+    return 0;
+}
+
+int cstl_roaring_next(const struct cstl_roaring* r, uint32_t from,
+                      uint32_t* value)
+{
+    size_t i;
+    int found, v;
+    if (r == (const struct cstl_roaring*)0) {
+        return 0;
+    }
+    i = _index(r, (uint16_t)(from >> 16), &found);
+    if (found) {
+        v = _rc_next(r->containers + i, (uint16_t)from);
+        if (v >= 0) {
+            *value = (from & 0xFFFF0000u) | (uint32_t)v;
+            return 1;
+        }
+        ++i;
+    }
+    if (i == r->size) {
+        return 0;
+    }
+    /* containers are never empty */
+    v = _rc_next(r->containers + i, 0);
+    *value = (uint32_t)r->keys[i] << 16 | (uint32_t)v;
+    return 1;
+}
+
+void cstl_roaring_traverse(const struct cstl_roaring* r,
+                           cstl_roaring_walker fn, void* p)
+{
+    size_t i;
+    if (r == (const struct cstl_roaring*)0 || fn == NULL) {
+        return;
+    }
+    for (i = 0; i < r->size; ++i) {
+        if (_rc_traverse(r->containers + i, (uint32_t)r->keys[i] << 16, fn,
+                         p)) {
+            break;
+        }
+    }
+}
+
+/*
+ * Builds the result in new arrays, so dst is untouched if memory runs out.
+ * Containers of dst that pass through unchanged are moved, not copied.
+ */
+static cstl_error _roaring_op(struct cstl_roaring* dst,
+                              const struct cstl_roaring* src, int op)
+{
+    struct cstl_roaring out;
+    size_t i = 0, j = 0, k;
+    int keep_dst = op != CSTL_ROARING_AND;
+    int keep_src = op == CSTL_ROARING_OR || op == CSTL_ROARING_XOR;
+    if (dst == (struct cstl_roaring*)0 ||
+        src == (const struct cstl_roaring*)0) {
+        return CSTL_ROARING_NOT_INITIALIZED;
+    }
+    if (dst == src) {
+        if (op == CSTL_ROARING_ANDNOT || op == CSTL_ROARING_XOR) {
+            _clear(dst);
+        }
+        return CSTL_ERROR_SUCCESS;
+    }
+    memset(&out, 0, sizeof(out));
+    if (_reserve(&out, dst->size + (keep_src ? src->size : 0)) != 0) {
+        goto fail;
+    }
+    while (i < dst->size || j < src->size) {
+        struct cstl_roaring_container* c = out.containers + out.size;
+        if (j == src->size || (i < dst->size && dst->keys[i] < src->keys[j])) {
+            if (keep_dst) {
+                /* moved; who owns what is sorted out below */
+                *c = dst->containers[i];
+                out.keys[out.size++] = dst->keys[i];
+            }
+            ++i;
+        }
+        else if (i == dst->size || src->keys[j] < dst->keys[i]) {
+            if (keep_src) {
+                if (_rc_copy(c, src->containers + j) != 0) {
+                    goto fail;
+                }
+                out.keys[out.size++] = src->keys[j];
+            }
+            ++j;
+        }
+        else {
+            if (_rc_op(c, dst->containers + i, src->containers + j, op) != 0) {
+                goto fail;
+            }
+            if (c->cardinality) {
+                out.keys[out.size++] = dst->keys[i];
+            }
+            else {
+                free(c->data);
+            }
+            ++i;
+            ++j;
+        }
+    }
+    /* success: release the dst containers that were not moved into out */
+    for (i = 0, k = 0; i < dst->size; ++i) {
+        void* data = dst->containers[i].data;
+        while (k < out.size && out.keys[k] < dst->keys[i]) {
+            ++k;
+        }
+        if (k == out.size || out.containers[k].data != data) {
+            free(data);
+        }
+    }
+    free(dst->keys);
+    free(dst->containers);
+    *dst = out;
+    return CSTL_ERROR_SUCCESS;
+fail:
+    /* free only what out owns, leaving the moved dst containers alone */
+    for (i = 0, k = 0; k < out.size; ++k) {
+        void* data = out.containers[k].data;
+        while (i < dst->size && dst->keys[i] < out.keys[k]) {
+            ++i;
+        }
+        if (i == dst->size || dst->containers[i].data != data) {
+            free(data);
+        }
+    }
+    free(out.keys);
+    free(out.containers);
+    return CSTL_ERROR_MEMORY;
+}
+
+cstl_error cstl_roaring_or(struct cstl_roaring* dst,
+                           const struct cstl_roaring* src)
+{
+    return _roaring_op(dst, src, CSTL_ROARING_OR);
+}
+
+cstl_error cstl_roaring_and(struct cstl_roaring* dst,
+                            const struct cstl_roaring* src)
+{
+    return _roaring_op(dst, src, CSTL_ROARING_AND);
+}
+
+cstl_error cstl_roaring_andnot(struct cstl_roaring* dst,
+                               const struct cstl_roaring* src)
+{
+    return _roaring_op(dst, src, CSTL_ROARING_ANDNOT);
+}
+
+cstl_error cstl_roaring_xor(struct cstl_roaring* dst,
+                            const struct cstl_roaring* src)
+{
+    return _roaring_op(dst, src, CSTL_ROARING_XOR);
+}
+
+/* bytes a container takes in the portable format, without its header */
+static size_t _rc_image_size(const struct cstl_roaring_container* c)
+{
+    if (c->type == CSTL_ROARING_RUN) {
+        return 2 + 4 * (size_t)c->n;
+    }
+    if (c->cardinality > CSTL_ROARING_ARRAY_MAX) {
+        return CSTL_ROARING_BITMAP_BYTES;
+    }
+    return 2 * (size_t)c->cardinality;
+}
+
+cstl_error cstl_roaring_run_optimize(struct cstl_roaring* r)
+{
+    size_t i;
+    if (r == (struct cstl_roaring*)0) {
+        return CSTL_ROARING_NOT_INITIALIZED;
+    }
+    for (i = 0; i < r->size; ++i) {
+        struct cstl_roaring_container* c = r->containers + i;
+        int runs = _rc_count_runs(c);
+        size_t run_size = 2 + 4 * (size_t)runs;
+        size_t plain_size = c->cardinality > CSTL_ROARING_ARRAY_MAX
+                                ? CSTL_ROARING_BITMAP_BYTES
+                                : 2 * (size_t)c->cardinality;
+        int rc = 0;
+        if (c->type == CSTL_ROARING_RUN && run_size >= plain_size) {
+            rc = _rc_from_runs(c);
+        }
+        else if (c->type != CSTL_ROARING_RUN && run_size < plain_size) {
+            rc = _rc_to_runs(c, runs);
+        }
+        if (rc != 0) {
+            return CSTL_ERROR_MEMORY;
+        }
+    }
+    return CSTL_ERROR_SUCCESS;
+}
+
+static unsigned char* _put16(unsigned char* p, unsigned int v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    return p + 2;
+}
+
+static unsigned char* _put32(unsigned char* p, uint32_t v)
+{
+    return _put16(_put16(p, v & 0xFFFF), v >> 16);
+}
+
+static unsigned int _get16(const unsigned char* p)
+{
+    return p[0] | (unsigned int)p[1] << 8;
+}
+
+static uint32_t _get32(const unsigned char* p)
+{
+    return _get16(p) | (uint32_t)_get16(p + 2) << 16;
+}
+
+/*
+ * The portable format: a cookie, the container count and run flags if
+ * there are runs, (key, cardinality - 1) per container, the container
+ * offsets unless there are runs and fewer than four containers, then the
+ * containers, all little-endian. A container is a run container if
+ * flagged, a bitmap if it holds more than 4096 values, an array otherwise.
+ */
+size_t cstl_roaring_save(const struct cstl_roaring* r, void* buf, size_t size)
+{
+    unsigned char* p = (unsigned char*)buf;
+    size_t i, total, header;
+    int has_run = 0, offsets;
+    if (r == (const struct cstl_roaring*)0) {
+        return 0;
+    }
+    for (i = 0; i < r->size; ++i) {
+        has_run |= r->containers[i].type == CSTL_ROARING_RUN;
+    }
+    offsets = !has_run || r->size >= CSTL_ROARING_NO_OFFSET_THRESHOLD;
+    header = has_run ? 4 + (r->size + 7) / 8 : 8;
+    header += 4 * r->size + (offsets ? 4 * r->size : 0);
+    total = header;
+    for (i = 0; i < r->size; ++i) {
+        total += _rc_image_size(r->containers + i);
+    }
+    if (buf == NULL || size < total) {
+        return total;
+    }
+    if (has_run) {
+        p = _put32(p, CSTL_ROARING_COOKIE | (uint32_t)(r->size - 1) << 16);
+        memset(p, 0, (r->size + 7) / 8);
+        for (i = 0; i < r->size; ++i) {
+            if (r->containers[i].type == CSTL_ROARING_RUN) {
+                p[i / 8] |= (unsigned char)(1 << (i % 8));
+            }
+        }
+        p += (r->size + 7) / 8;
+    }
+    else {
+        p = _put32(_put32(p, CSTL_ROARING_COOKIE_NO_RUN), (uint32_t)r->size);
+    }
+    for (i = 0; i < r->size; ++i) {
+        p = _put16(_put16(p, r->keys[i]),
+                   (unsigned int)r->containers[i].cardinality - 1);
+    }
+    if (offsets) {
+        size_t offset = header;
+        for (i = 0; i < r->size; ++i) {
+            p = _put32(p, (uint32_t)offset);
+            offset += _rc_image_size(r->containers + i);
+        }
+    }
+    for (i = 0; i < r->size; ++i) {
+        const struct cstl_roaring_container* c = r->containers + i;
+        int j;
+        if (c->type == CSTL_ROARING_RUN) {
+            p = _put16(p, (unsigned int)c->n);
+            for (j = 0; j < 2 * c->n; ++j) {
+                p = _put16(p, cstl_rc_values(c)[j]);
+            }
+        }
+        else if (c->cardinality > CSTL_ROARING_ARRAY_MAX) {
+            for (j = 0; j < CSTL_ROARING_WORDS; ++j) {
+                uint64_t w = cstl_rc_words(c)[j];
+                p = _put32(_put32(p, (uint32_t)w), (uint32_t)(w >> 32));
+            }
+        }
+        else if (c->type == CSTL_ROARING_ARRAY) {
+            for (j = 0; j < c->n; ++j) {
+                p = _put16(p, cstl_rc_values(c)[j]);
+            }
+        }
+        else {
+            /* a small bitmap that could not be shrunk */
+            const uint64_t* w = cstl_rc_words(c);
+            size_t v = cstl_bitset_words_next_set(w, CSTL_ROARING_WORDS, 0);
+            for (; v != CSTL_BITSET_NPOS;
+                 v = cstl_bitset_words_next_set(w, CSTL_ROARING_WORDS,
+                                                v + 1)) {
+                p = _put16(p, (unsigned int)v);
+            }
+        }
+    }
+    assert((size_t)(p - (unsigned char*)buf) == total);
+    return total;
+}
+
+/* reads one container at *p, checking it against its header */
+static int _rc_load(struct cstl_roaring_container* c, int is_run,
+                    int cardinality, const unsigned char** p,
+                    const unsigned char* end)
+{
+    const unsigned char* q = *p;
+    int i, count = 0;
+    if (is_run) {
+        int n, last = -1;
+        if (end - q < 2) {
+            return -1;
+        }
+        n = (int)_get16(q);
+        q += 2;
+        if (end - q < 4 * n || _rc_init(c, CSTL_ROARING_RUN, n) != 0) {
+            return -1;
+        }
+        for (i = 0; i < n; ++i, q += 4) {
+            int start = (int)_get16(q), length = (int)_get16(q + 2);
+            if (start <= last || start + length > 0xFFFF) {
+                free(c->data);
+                return -1;
+            }
+            cstl_rc_start(c, i) = (uint16_t)start;
+            cstl_rc_length(c, i) = (uint16_t)length;
+            last = start + length + 1;
+            count += length + 1;
+        }
+        c->n = n;
+    }
+    else if (cardinality > CSTL_ROARING_ARRAY_MAX) {
+        if (end - q < CSTL_ROARING_BITMAP_BYTES ||
+            _rc_init(c, CSTL_ROARING_BITMAP, 0) != 0) {
+            return -1;
+        }
+        for (i = 0; i < CSTL_ROARING_WORDS; ++i, q += 8) {
+            cstl_rc_words(c)[i] = _get32(q) | (uint64_t)_get32(q + 4) << 32;
+        }
+        count = (int)cstl_bitset_words_popcount(cstl_rc_words(c),
+                                                CSTL_ROARING_WORDS);
+    }
+    else {
+        if (end - q < 2 * cardinality ||
+            _rc_init(c, CSTL_ROARING_ARRAY, cardinality) != 0) {
+            return -1;
+        }
+        for (i = 0; i < cardinality; ++i, q += 2) {
+            cstl_rc_values(c)[i] = (uint16_t)_get16(q);
+            if (i && cstl_rc_values(c)[i] <= cstl_rc_values(c)[i - 1]) {
+                free(c->data);
+                return -1;
+            }
+        }
+        c->n = count = cardinality;
+    }
+    if (count != cardinality) {
+        free(c->data);
+        return -1;
+    }
+    c->cardinality = cardinality;
+    *p = q;
+    return 0;
+}
+
+struct cstl_roaring* cstl_roaring_load(const void* buf, size_t size)
+{
+    const unsigned char* p = (const unsigned char*)buf;
+    const unsigned char* end = p + size;
+    const unsigned char* flags = NULL;
+    const unsigned char* headers;
+    struct cstl_roaring* r;
+    uint32_t cookie;
+    size_t n, i;
+    if (buf == NULL || size < 4) {
+        return (struct cstl_roaring*)0;
+    }
+    cookie = _get32(p);
+    if ((cookie & 0xFFFF) == CSTL_ROARING_COOKIE) {
+        n = (cookie >> 16) + 1;
+        if (size < 4 + (n + 7) / 8) {
+            return (struct cstl_roaring*)0;
+        }
+        flags = p + 4;
+        p += 4 + (n + 7) / 8;
+    }
+    else if (cookie == CSTL_ROARING_COOKIE_NO_RUN && size >= 8) {
+        n = _get32(p + 4);
+        p += 8;
+    }
+    else {
+        return (struct cstl_roaring*)0;
+    }
+    if (n > 0x10000 || (size_t)(end - p) < 4 * n) {
+        return (struct cstl_roaring*)0;
+    }
+    headers = p;
+    p += 4 * n;
+    if (flags == NULL || n >= CSTL_ROARING_NO_OFFSET_THRESHOLD) {
+        /* the containers follow each other, so the offsets are not needed */
+        if ((size_t)(end - p) < 4 * n) {
+            return (struct cstl_roaring*)0;
+        }
+        p += 4 * n;
+    }
+    r = cstl_roaring_new();
+    if (r == NULL || _reserve(r, n) != 0) {
+        cstl_roaring_delete(r);
+        return (struct cstl_roaring*)0;
+    }
+    for (i = 0; i < n; ++i) {
+        unsigned int key = _get16(headers + 4 * i);
+        int is_run = flags && (flags[i / 8] >> (i % 8)) & 1;
+        if ((i && key <= r->keys[i - 1]) ||
+            _rc_load(r->containers + i, is_run,
+                     (int)_get16(headers + 4 * i + 2) + 1, &p, end) != 0) {
+            cstl_roaring_delete(r);
+            return (struct cstl_roaring*)0;
+        }
+        r->keys[i] = (uint16_t)key;
+        r->size = i + 1;
+    }
+    return r;
+}
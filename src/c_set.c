@@ -25,11 +25,33 @@
 #include "c_set.h"
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 #include "c_stl_lib.h"
 #include "rb-tree.h"
 
+/* keys looked up per rbt_tree_find_batch call */
+#define CSTL_SET_BATCH 32
+
+/* the fewest keys a Bloom filter is sized for */
+#define CSTL_SET_BLOOM_MIN_KEYS 64
+
+/*
+ * A small set holds its keys in unlinked rb-tree nodes, kept in a sorted
+ * array of pointers. Crossing small_limit links the same nodes into a tree,
+ * and shrinking to half the limit takes them back out, so keys never move.
+ */
 struct cstl_set {
-    struct rbt_tree* tree;
+    struct rbt_tree* tree; /* NULL while the set is small */
+    struct rbt_node** small;
+    size_t small_capacity;
+    size_t small_limit;
+    size_t count;
+    cstl_compare fn_c;
+    cstl_destroy fn_d;
+    struct cstl_bloom* bloom; /* NULL unless cstl_set_bloom() added one */
+    cstl_hash fn_h;
+    size_t key_size;
+    unsigned int bits_per_key;
 };
 
 struct cstl_set* cstl_set_new(cstl_compare fn_c, cstl_destroy fn_d)
@@ -38,54 +60,272 @@ struct cstl_set* cstl_set_new(cstl_compare fn_c, cstl_destroy fn_d)
     if (s == (struct cstl_set*)0) {
         return (struct cstl_set*)0;
     }
-    s->tree = rbt_tree_create(malloc, free, 0, fn_c, fn_d);
+    s->small_limit = CSTL_SET_SMALL_LIMIT;
+    s->fn_c = fn_c;
+    s->fn_d = fn_d;
+    return s;
+}
+
+static void _small_node_destroy(struct cstl_set* s, struct rbt_node* node)
+{
+    if (s->fn_d) {
+        s->fn_d((void*)rbt_node_get_key(node));
+    }
+    free(node);
+}
+
+/* index of the first small key not less than key */
+static size_t _small_lower_bound(struct cstl_set* s, const void* key,
+                                 int* found)
+{
+    size_t lo = 0, hi = s->count;
+    *found = 0;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int c = s->fn_c(rbt_node_get_key(s->small[mid]), key);
+        if (c < 0) {
+            lo = mid + 1;
+        }
+        else {
+            *found = (c == 0);
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static cstl_error _set_to_tree(struct cstl_set* s)
+{
+    size_t i;
+    s->tree = rbt_tree_create(malloc, free, 0, s->fn_c, s->fn_d);
     if (s->tree == (struct rbt_tree*)0) {
-        free(s);
-        return (struct cstl_set*)0;
+        return CSTL_ERROR_MEMORY;
     }
-    return s;
+    for (i = 0; i < s->count; ++i) {
+        rbt_tree_insert_node(s->tree, s->small[i]);
+    }
+    free(s->small);
+    s->small = NULL;
+    s->small_capacity = 0;
+    return CSTL_ERROR_SUCCESS;
 }
 
-cstl_error cstl_set_insert(struct cstl_set* pSet, void* key, size_t key_size)
+static void _collect_node(struct rbt_node* x, void* p)
+{
+    struct cstl_set* s = (struct cstl_set*)p;
+    s->small[s->small_capacity++] = x;
+}
+
+/* best effort: a set that cannot get its array simply stays a tree */
+static void _set_to_small(struct cstl_set* s)
+{
+    struct rbt_node** small =
+        (struct rbt_node**)malloc(s->small_limit * sizeof(struct rbt_node*));
+    if (small == NULL) {
+        return;
+    }
+    s->small = small;
+    s->small_capacity = 0;
+    rbt_tree_dissolve(s->tree, _collect_node, s);
+    assert(s->small_capacity == s->count);
+    s->small_capacity = s->small_limit;
+    s->tree = NULL;
+}
+
+static void _set_maybe_shrink(struct cstl_set* s)
+{
+    if (s->tree && s->small_limit && s->count <= s->small_limit / 2) {
+        _set_to_small(s);
+    }
+}
+
+cstl_error cstl_set_small_limit(struct cstl_set* pSet, size_t limit)
 {
-    rbt_status e;
     if (pSet == (struct cstl_set*)0) {
         return CSTL_SET_NOT_INITIALIZED;
     }
-    e = rbt_tree_insert(pSet->tree, key, key_size);
-    return e == rbt_status_success ? CSTL_ERROR_SUCCESS : CSTL_ERROR_ERROR;
+    pSet->small_limit = limit;
+    if (pSet->tree == (struct rbt_tree*)0 && pSet->count > limit) {
+        return _set_to_tree(pSet);
+    }
+    _set_maybe_shrink(pSet);
+    return CSTL_ERROR_SUCCESS;
 }
 
-int cstl_set_is_key_exists(struct cstl_set* pSet, void* key)
+static int _set_bloom_pass(struct cstl_set* s, const void* key)
+{
+    return s->bloom == (struct cstl_bloom*)0 ||
+           cstl_bloom_may_contain_hash(s->bloom, s->fn_h(key, s->key_size));
+}
+
+/* replaces the filter by one with room for twice the keys, refilled */
+static cstl_error _set_bloom_build(struct cstl_set* s)
+{
+    struct cstl_iterator it;
+    struct cstl_bloom* bloom;
+    size_t expected = s->count * 2;
+    if (expected < CSTL_SET_BLOOM_MIN_KEYS) {
+        expected = CSTL_SET_BLOOM_MIN_KEYS;
+    }
+    bloom = cstl_bloom_new(expected, s->bits_per_key);
+    if (bloom == (struct cstl_bloom*)0) {
+        return CSTL_ERROR_MEMORY;
+    }
+    cstl_set_iterator_init(&it, s);
+    while (it.next(&it)) {
+        cstl_bloom_add_hash(bloom, s->fn_h(it.current_key(&it), s->key_size));
+    }
+    if (s->bloom) {
+        cstl_bloom_delete(s->bloom);
+    }
+    s->bloom = bloom;
+    return CSTL_ERROR_SUCCESS;
+}
+
+/* after an insertion; a filter that cannot grow only gets fuller */
+static void _set_bloom_add(struct cstl_set* s, const void* key)
+{
+    if (s->bloom) {
+        cstl_bloom_add_hash(s->bloom, s->fn_h(key, s->key_size));
+        if (s->count > cstl_bloom_capacity(s->bloom)) {
+            _set_bloom_build(s);
+        }
+    }
+}
+
+cstl_error cstl_set_bloom(struct cstl_set* pSet, size_t key_size,
+                          cstl_hash fn_h, unsigned int bits_per_key)
+{
+    if (pSet == (struct cstl_set*)0) {
+        return CSTL_SET_NOT_INITIALIZED;
+    }
+    if (pSet->bloom) {
+        cstl_bloom_delete(pSet->bloom);
+        pSet->bloom = (struct cstl_bloom*)0;
+    }
+    if (bits_per_key == 0) {
+        return CSTL_ERROR_SUCCESS;
+    }
+    pSet->fn_h = fn_h ? fn_h : cstl_hash_bytes;
+    pSet->key_size = key_size;
+    pSet->bits_per_key = bits_per_key;
+    return _set_bloom_build(pSet);
+}
+
+cstl_error cstl_set_bloom_rebuild(struct cstl_set* pSet)
+{
+    if (pSet == (struct cstl_set*)0) {
+        return CSTL_SET_NOT_INITIALIZED;
+    }
+    return pSet->bloom ? _set_bloom_build(pSet) : CSTL_ERROR_SUCCESS;
+}
+
+static cstl_error _small_insert(struct cstl_set* s, size_t i, void* key,
+                                size_t key_size)
 {
-    int found = 0;
     struct rbt_node* node;
+    if (s->count == s->small_capacity) {
+        size_t n = s->small_capacity ? s->small_capacity * 2 : 4;
+        struct rbt_node** small;
+        if (n > s->small_limit) {
+            n = s->small_limit;
+        }
+        small = (struct rbt_node**)realloc(s->small,
+                                           n * sizeof(struct rbt_node*));
+        if (small == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        s->small = small;
+        s->small_capacity = n;
+    }
+    node = rbt_node_create(malloc, key, key_size);
+    if (node == (struct rbt_node*)0) {
+        return CSTL_ERROR_MEMORY;
+    }
+    memmove(&s->small[i + 1], &s->small[i],
+            (s->count - i) * sizeof(struct rbt_node*));
+    s->small[i] = node;
+    return CSTL_ERROR_SUCCESS;
+}
 
+cstl_error cstl_set_insert(struct cstl_set* pSet, void* key, size_t key_size)
+{
+    rbt_status e;
+    size_t i;
+    int found;
     if (pSet == (struct cstl_set*)0) {
-        return 0;
+        return CSTL_SET_NOT_INITIALIZED;
     }
-    node = rbt_tree_find(pSet->tree, key);
-    if (rbt_node_is_valid(node)) {
-        return 1;
+    if (pSet->tree == (struct rbt_tree*)0) {
+        i = _small_lower_bound(pSet, key, &found);
+        if (found) {
+            return CSTL_ERROR_ERROR;
+        }
+        if (pSet->count < pSet->small_limit) {
+            cstl_error rc = _small_insert(pSet, i, key, key_size);
+            if (rc == CSTL_ERROR_SUCCESS) {
+                pSet->count++;
+                _set_bloom_add(pSet, key);
+            }
+            return rc;
+        }
+        if (_set_to_tree(pSet) != CSTL_ERROR_SUCCESS) {
+            return CSTL_ERROR_MEMORY;
+        }
     }
-    return found;
+    e = rbt_tree_insert(pSet->tree, key, key_size);
+    if (e == rbt_status_success) {
+        pSet->count++;
+        _set_bloom_add(pSet, key);
+    }
+    return e == rbt_status_success ? CSTL_ERROR_SUCCESS : CSTL_ERROR_ERROR;
+}
+
+int cstl_set_is_key_exists(struct cstl_set* pSet, void* key)
+{
+    return cstl_set_find(pSet, key) != NULL;
 }
 
 cstl_error cstl_set_remove(struct cstl_set* pSet, void* key)
 {
+    rbt_status e;
+    size_t i;
+    int found;
     if (pSet == (struct cstl_set*)0) {
         return CSTL_SET_NOT_INITIALIZED;
     }
-    return (cstl_error)rbt_tree_remove_node(pSet->tree, key);
+    if (pSet->tree == (struct rbt_tree*)0) {
+        i = _small_lower_bound(pSet, key, &found);
+        if (!found) {
+            return CSTL_RBTREE_KEY_NOT_FOUND;
+        }
+        _small_node_destroy(pSet, pSet->small[i]);
+        memmove(&pSet->small[i], &pSet->small[i + 1],
+                (pSet->count - i - 1) * sizeof(struct rbt_node*));
+        pSet->count--;
+        return CSTL_ERROR_SUCCESS;
+    }
+    e = rbt_tree_remove_node(pSet->tree, key);
+    if (e == rbt_status_success) {
+        pSet->count--;
+        _set_maybe_shrink(pSet);
+    }
+    return (cstl_error)e;
 }
 
 const void* cstl_set_find(struct cstl_set* pSet, const void* key)
 {
     struct rbt_node* node;
+    size_t i;
+    int found;
 
-    if (pSet == (struct cstl_set*)0) {
+    if (pSet == (struct cstl_set*)0 || !_set_bloom_pass(pSet, key)) {
         return NULL;
     }
+    if (pSet->tree == (struct rbt_tree*)0) {
+        i = _small_lower_bound(pSet, key, &found);
+        return found ? rbt_node_get_key(pSet->small[i]) : NULL;
+    }
     node = rbt_tree_find(pSet->tree, key);
     if (node == (struct rbt_node*)0) {
         return NULL;
@@ -93,11 +333,59 @@ const void* cstl_set_find(struct cstl_set* pSet, const void* key)
     return rbt_node_get_key(node);
 }
 
+size_t cstl_set_find_batch(struct cstl_set* pSet, const void* const keys[],
+                           size_t n, const void* out_keys[])
+{
+    struct rbt_node* nodes[CSTL_SET_BATCH];
+    const void* probe[CSTL_SET_BATCH];
+    size_t slot[CSTL_SET_BATCH];
+    size_t i, j, m, group, found = 0;
+
+    for (i = 0; i < n; i += group) {
+        group = (n - i < CSTL_SET_BATCH) ? n - i : CSTL_SET_BATCH;
+        if (pSet == (struct cstl_set*)0 || pSet->tree == (struct rbt_tree*)0) {
+            for (j = 0; j < group; ++j) {
+                out_keys[i + j] = cstl_set_find(pSet, keys[i + j]);
+                if (out_keys[i + j]) {
+                    ++found;
+                }
+            }
+            continue;
+        }
+        /* only the keys the filter lets through go down the tree */
+        for (j = 0, m = 0; j < group; ++j) {
+            out_keys[i + j] = NULL;
+            if (_set_bloom_pass(pSet, keys[i + j])) {
+                probe[m] = keys[i + j];
+                slot[m++] = i + j;
+            }
+        }
+        rbt_tree_find_batch(pSet->tree, probe, m, nodes);
+        for (j = 0; j < m; ++j) {
+            out_keys[slot[j]] = rbt_node_get_key(nodes[j]);
+            if (out_keys[slot[j]]) {
+                ++found;
+            }
+        }
+    }
+    return found;
+}
+
 cstl_error cstl_set_delete(struct cstl_set* x)
 {
     cstl_error rc = CSTL_ERROR_SUCCESS;
+    size_t i;
     if (x != (struct cstl_set*)0) {
-        rc = (cstl_error)rbt_tree_destroy(x->tree);
+        if (x->tree) {
+            rc = (cstl_error)rbt_tree_destroy(x->tree);
+        }
+        for (i = 0; x->tree == (struct rbt_tree*)0 && i < x->count; ++i) {
+            _small_node_destroy(x, x->small[i]);
+        }
+        if (x->bloom) {
+            cstl_bloom_delete(x->bloom);
+        }
+        free(x->small);
         free(x);
     }
     return rc;
@@ -108,10 +396,21 @@ static struct rbt_node* cstl_set_minimum(struct cstl_set* x)
     return rbt_tree_minimum(x->tree, rbt_tree_get_root(x->tree));
 }
 
+/* current_element is always a node; current_index tracks it while small */
 static const void* cstl_set_get_next(struct cstl_iterator* pIterator)
 {
     struct cstl_set* x = (struct cstl_set*)pIterator->pContainer;
     struct rbt_node* ptr = NULL;
+    if (x->tree == (struct rbt_tree*)0) {
+        if (pIterator->current_element) {
+            pIterator->current_index++;
+        }
+        pIterator->current_element =
+            pIterator->current_index < x->count
+                ? x->small[pIterator->current_index]
+                : NULL;
+        return pIterator->current_element;
+    }
     if (NULL == pIterator->current_element) {
         pIterator->current_element = cstl_set_minimum(x);
     }
@@ -138,17 +437,24 @@ static const void* cstl_set_get_value(struct cstl_iterator* pIterator)
     return cstl_set_get_key(pIterator);
 }
 
+void cstl_set_iterator_init(struct cstl_iterator* itr, struct cstl_set* pSet)
+{
+    assert(itr);
+    memset(itr, 0, sizeof(*itr));
+    itr->next = cstl_set_get_next;
+    itr->current_key = cstl_set_get_key;
+    itr->current_value = cstl_set_get_value;
+    itr->pContainer = pSet;
+    itr->current_index = 0;
+    itr->current_element = (void*)0;
+}
+
 struct cstl_iterator* cstl_set_new_iterator(struct cstl_set* pSet)
 {
     struct cstl_iterator* itr =
         (struct cstl_iterator*)calloc(1, sizeof(struct cstl_iterator));
     if (itr) {
-        itr->next = cstl_set_get_next;
-        itr->current_key = cstl_set_get_key;
-        itr->current_value = cstl_set_get_value;
-        itr->pContainer = pSet;
-        itr->current_index = 0;
-        itr->current_element = (void*)0;
+        cstl_set_iterator_init(itr, pSet);
     }
     return itr;
 }
@@ -161,21 +467,20 @@ void cstl_set_delete_iterator(struct cstl_iterator* pItr)
 void cstl_set_container_traverse(struct cstl_set* set, fn_cstl_set_iter fn,
                                  void* p)
 {
-    struct cstl_iterator* iterator;
+    struct cstl_iterator iterator;
     const void* element;
     int stop = 0;
     if (set == NULL || fn == NULL) {
         return;
     }
-    iterator = cstl_set_new_iterator(set);
-    while ((element = iterator->next(iterator))) {
-        const void* obj = *((const void**)iterator->current_value(iterator));
+    cstl_set_iterator_init(&iterator, set);
+    while ((element = iterator.next(&iterator))) {
+        const void* obj = *((const void**)iterator.current_value(&iterator));
         fn(set, obj, &stop, p);
         if (stop != 0) {
             break;
         }
     }
-    cstl_set_delete_iterator(iterator);
 }
 
 void cstl_set_container_add(struct cstl_set* set, void* obj)
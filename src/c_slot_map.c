@@ -0,0 +1,264 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "c_stl_lib.h"
+
+/* slots are numbered with 32 bits, and the last number marks "none" */
+#define CSTL_SLOT_NONE 0xFFFFFFFFu
+#define CSTL_SLOT_MAX 0xFFFFFFFEu
+
+/*
+ * A slot's generation is odd while it holds a value and even while it is
+ * free. dense is then the value's position, or the next free slot. A
+ * retired slot has generation 0 and is on no list.
+ */
+struct cstl_slot {
+    uint32_t dense;
+    uint32_t generation;
+};
+
+struct cstl_slot_map {
+    unsigned char* values; /* size packed values */
+    uint32_t* owners;      /* the slot of each value */
+    struct cstl_slot* slots;
+    size_t size;
+    size_t capacity; /* of values and owners */
+    size_t nslots;
+    size_t slot_capacity;
+    uint32_t free_head; /* a stack of free slots */
+    size_t value_size;
+    cstl_destroy fn_d;
+};
+
+#define cstl_handle_make(slot, gen) \
+    (((cstl_slot_handle)(gen) << 32) | (cstl_slot_handle)(slot))
+#define cstl_handle_slot(h) ((uint32_t)((h)&0xFFFFFFFFu))
+#define cstl_handle_generation(h) ((uint32_t)((h) >> 32))
+#define cstl_value_at(sm, i) ((sm)->values + (i) * (sm)->value_size)
+
+struct cstl_slot_map* cstl_slot_map_new(size_t value_size, cstl_destroy fn_d)
+{
+    struct cstl_slot_map* sm;
+    if (value_size == 0) {
+        return (struct cstl_slot_map*)0;
+    }
+    sm = (struct cstl_slot_map*)calloc(1, sizeof(struct cstl_slot_map));
+    if (sm) {
+        sm->value_size = value_size;
+        sm->fn_d = fn_d;
+        sm->free_head = CSTL_SLOT_NONE;
+    }
+    return sm;
+}
+
+cstl_error cstl_slot_map_delete(struct cstl_slot_map* sm)
+{
+    if (sm == (struct cstl_slot_map*)0) {
+        return CSTL_SLOT_MAP_NOT_INITIALIZED;
+    }
+    cstl_slot_map_clear(sm);
+    free(sm->values);
+    free(sm->owners);
+    free(sm->slots);
+    free(sm);
+    return CSTL_ERROR_SUCCESS;
+}
+
+size_t cstl_slot_map_size(struct cstl_slot_map* sm)
+{
+    return sm ? sm->size : 0;
+}
+
+cstl_error cstl_slot_map_reserve(struct cstl_slot_map* sm, size_t n)
+{
+    if (sm == (struct cstl_slot_map*)0) {
+        return CSTL_SLOT_MAP_NOT_INITIALIZED;
+    }
+    if (n > CSTL_SLOT_MAX) {
+        return CSTL_ERROR_MEMORY;
+    }
+    if (n > sm->capacity) {
+        unsigned char* values =
+            (unsigned char*)realloc(sm->values, n * sm->value_size);
+        uint32_t* owners;
+        if (values == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        sm->values = values;
+        owners = (uint32_t*)realloc(sm->owners, n * sizeof(uint32_t));
+        if (owners == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        sm->owners = owners;
+        sm->capacity = n;
+    }
+    if (n > sm->slot_capacity) {
+        struct cstl_slot* slots =
+            (struct cstl_slot*)realloc(sm->slots, n * sizeof(struct cstl_slot));
+        if (slots == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        sm->slots = slots;
+        sm->slot_capacity = n;
+    }
+    return CSTL_ERROR_SUCCESS;
+}
+
+/*
+ * Puts slot i back on the free list, ending its generation. A slot whose
+ * generation would wrap around to 0 is retired instead: reusing it could
+ * bring back the generation of a handle issued 2^31 values ago.
+ */
+static void _release_slot(struct cstl_slot_map* sm, uint32_t i)
+{
+    struct cstl_slot* slot = sm->slots + i;
+    if (++slot->generation != 0) {
+        slot->dense = sm->free_head;
+        sm->free_head = i;
+    }
+}
+
+/* erases every value; their handles go stale, the slots are kept */
+void cstl_slot_map_clear(struct cstl_slot_map* sm)
+{
+    size_t i;
+    if (sm == (struct cstl_slot_map*)0) {
+        return;
+    }
+    for (i = 0; i < sm->size; ++i) {
+        if (sm->fn_d) {
+            sm->fn_d(cstl_value_at(sm, i));
+        }
+        _release_slot(sm, sm->owners[i]);
+    }
+    sm->size = 0;
+}
+
+/* the slot of handle while its value lives, NULL once it is stale */
+static struct cstl_slot* _live_slot(struct cstl_slot_map* sm,
+                                    cstl_slot_handle handle)
+{
+    uint32_t i = cstl_handle_slot(handle);
+    uint32_t generation = cstl_handle_generation(handle);
+    if (sm == (struct cstl_slot_map*)0 || i >= sm->nslots ||
+        sm->slots[i].generation != generation || !(generation & 1)) {
+        return (struct cstl_slot*)0;
+    }
+    return sm->slots + i;
+}
+
+cstl_error cstl_slot_map_insert(struct cstl_slot_map* sm, const void* value,
+                                cstl_slot_handle* handle)
+{
+    struct cstl_slot* slot;
+    uint32_t i;
+    if (sm == (struct cstl_slot_map*)0) {
+        return CSTL_SLOT_MAP_NOT_INITIALIZED;
+    }
+    if (value == NULL) {
+        return CSTL_SLOT_MAP_INVALID_INPUT;
+    }
+    if (sm->size == sm->capacity ||
+        (sm->free_head == CSTL_SLOT_NONE && sm->nslots == sm->slot_capacity)) {
+        size_t n = sm->capacity ? sm->capacity * 2 : 8;
+        if (n > CSTL_SLOT_MAX) {
+            n = CSTL_SLOT_MAX;
+        }
+        if (n <= sm->nslots || cstl_slot_map_reserve(sm, n) != 0) {
+            return CSTL_ERROR_MEMORY;
+        }
+    }
+    if (sm->free_head != CSTL_SLOT_NONE) {
+        i = sm->free_head;
+        slot = sm->slots + i;
+        sm->free_head = slot->dense;
+    }
+    else {
+        i = (uint32_t)sm->nslots++;
+        slot = sm->slots + i;
+        slot->generation = 0;
+    }
+    ++slot->generation;
+    slot->dense = (uint32_t)sm->size;
+    memcpy(cstl_value_at(sm, sm->size), value, sm->value_size);
+    sm->owners[sm->size++] = i;
+    if (handle) {
+        *handle = cstl_handle_make(i, slot->generation);
+    }
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_slot_map_erase(struct cstl_slot_map* sm,
+                               cstl_slot_handle handle)
+{
+    struct cstl_slot* slot;
+    size_t last;
+    if (sm == (struct cstl_slot_map*)0) {
+        return CSTL_SLOT_MAP_NOT_INITIALIZED;
+    }
+    slot = _live_slot(sm, handle);
+    if (slot == (struct cstl_slot*)0) {
+        return CSTL_SLOT_MAP_STALE_HANDLE;
+    }
+    if (sm->fn_d) {
+        sm->fn_d(cstl_value_at(sm, slot->dense));
+    }
+    last = sm->size - 1;
+    if (slot->dense != last) {
+        memcpy(cstl_value_at(sm, slot->dense), cstl_value_at(sm, last),
+               sm->value_size);
+        sm->owners[slot->dense] = sm->owners[last];
+        sm->slots[sm->owners[last]].dense = slot->dense;
+    }
+    sm->size = last;
+    _release_slot(sm, cstl_handle_slot(handle));
+    return CSTL_ERROR_SUCCESS;
+}
+
+void* cstl_slot_map_get(struct cstl_slot_map* sm, cstl_slot_handle handle)
+{
+    struct cstl_slot* slot = _live_slot(sm, handle);
+    return slot ? cstl_value_at(sm, slot->dense) : NULL;
+}
+
+int cstl_slot_map_contains(struct cstl_slot_map* sm, cstl_slot_handle handle)
+{
+    return _live_slot(sm, handle) != (struct cstl_slot*)0;
+}
+
+void* cstl_slot_map_data(struct cstl_slot_map* sm)
+{
+    return sm ? sm->values : NULL;
+}
+
+cstl_slot_handle cstl_slot_map_handle_at(struct cstl_slot_map* sm, size_t i)
+{
+    if (sm == (struct cstl_slot_map*)0 || i >= sm->size) {
+        return CSTL_SLOT_HANDLE_NULL;
+    }
+    return cstl_handle_make(sm->owners[i], sm->slots[sm->owners[i]].generation);
+}
@@ -0,0 +1,327 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "c_stl_lib.h"
+
+#define CSTL_SPARSE_NONE 0xFFFFFFFFu
+
+/*
+ * A value v is a member when sparse[v] < size and dense[sparse[v]] == v.
+ * Stale sparse entries are harmless, which is what makes clear() O(1).
+ */
+struct cstl_sparse_set {
+    uint32_t* sparse;
+    size_t universe; /* length of sparse */
+    uint32_t* dense;
+    size_t size;
+    size_t capacity; /* of dense */
+};
+
+struct cstl_fd_map {
+    struct cstl_sparse_set set;
+    unsigned char* values; /* values[i] belongs to set.dense[i] */
+    size_t capacity;       /* of values */
+    size_t value_size;
+    cstl_destroy fn_d;
+};
+
+#define cstl_value_at(fm, i) ((fm)->values + (i) * (fm)->value_size)
+
+static size_t _index_of(const struct cstl_sparse_set* ss, uint32_t value)
+{
+    if (value < ss->universe) {
+        uint32_t i = ss->sparse[value];
+        if (i < ss->size && ss->dense[i] == value) {
+            return i;
+        }
+    }
+    return CSTL_SPARSE_NONE;
+}
+
+/* makes room for value in sparse and for one more member in dense */
+static cstl_error _make_room(struct cstl_sparse_set* ss, uint32_t value)
+{
+    if (value == CSTL_SPARSE_NONE) {
+        return CSTL_SPARSE_SET_INVALID_INPUT;
+    }
+    if (value >= ss->universe) {
+        size_t n = ss->universe < 16 ? 16 : ss->universe * 2;
+        uint32_t* sparse;
+        if (n <= value) {
+            n = (size_t)value + 1;
+        }
+        if (n > CSTL_SPARSE_NONE) {
+            n = CSTL_SPARSE_NONE;
+        }
+        sparse = (uint32_t*)realloc(ss->sparse, n * sizeof(uint32_t));
+        if (sparse == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        /* not needed for correctness, but keeps every read defined */
+        memset(sparse + ss->universe, 0,
+               (n - ss->universe) * sizeof(uint32_t));
+        ss->sparse = sparse;
+        ss->universe = n;
+    }
+    if (ss->size == ss->capacity) {
+        size_t n = ss->capacity ? ss->capacity * 2 : 16;
+        uint32_t* dense = (uint32_t*)realloc(ss->dense, n * sizeof(uint32_t));
+        if (dense == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        ss->dense = dense;
+        ss->capacity = n;
+    }
+    return CSTL_ERROR_SUCCESS;
+}
+
+static void _append(struct cstl_sparse_set* ss, uint32_t value)
+{
+    ss->sparse[value] = (uint32_t)ss->size;
+    ss->dense[ss->size++] = value;
+}
+
+/* moves the last member into position i and drops the last position */
+static void _remove_at(struct cstl_sparse_set* ss, size_t i)
+{
+    uint32_t last = ss->dense[--ss->size];
+    ss->dense[i] = last;
+    ss->sparse[last] = (uint32_t)i;
+}
+
+static cstl_error _init(struct cstl_sparse_set* ss, size_t universe)
+{
+    memset(ss, 0, sizeof(*ss));
+    if (universe > CSTL_SPARSE_NONE) {
+        universe = CSTL_SPARSE_NONE;
+    }
+    if (universe) {
+        ss->sparse = (uint32_t*)calloc(universe, sizeof(uint32_t));
+        if (ss->sparse == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        ss->universe = universe;
+    }
+    return CSTL_ERROR_SUCCESS;
+}
+
+struct cstl_sparse_set* cstl_sparse_set_new(size_t universe)
+{
+    struct cstl_sparse_set* ss =
+        (struct cstl_sparse_set*)malloc(sizeof(struct cstl_sparse_set));
+    if (ss && _init(ss, universe) != CSTL_ERROR_SUCCESS) {
+        free(ss);
+        ss = (struct cstl_sparse_set*)0;
+    }
+    return ss;
+}
+
+cstl_error cstl_sparse_set_delete(struct cstl_sparse_set* ss)
+{
+    if (ss == (struct cstl_sparse_set*)0) {
+        return CSTL_SPARSE_SET_NOT_INITIALIZED;
+    }
+    free(ss->sparse);
+    free(ss->dense);
+    free(ss);
+    return CSTL_ERROR_SUCCESS;
+}
+
+size_t cstl_sparse_set_size(struct cstl_sparse_set* ss)
+{
+    return ss ? ss->size : 0;
+}
+
+cstl_error cstl_sparse_set_insert(struct cstl_sparse_set* ss, uint32_t value)
+{
+    cstl_error rc;
+    if (ss == (struct cstl_sparse_set*)0) {
+        return CSTL_SPARSE_SET_NOT_INITIALIZED;
+    }
+    if (_index_of(ss, value) != CSTL_SPARSE_NONE) {
+        return CSTL_SPARSE_SET_KEY_DUPLICATE;
+    }
+    rc = _make_room(ss, value);
+    if (rc == CSTL_ERROR_SUCCESS) {
+        _append(ss, value);
+    }
+    return rc;
+}
+
+cstl_error cstl_sparse_set_erase(struct cstl_sparse_set* ss, uint32_t value)
+{
+    size_t i;
+    if (ss == (struct cstl_sparse_set*)0) {
+        return CSTL_SPARSE_SET_NOT_INITIALIZED;
+    }
+    i = _index_of(ss, value);
+    if (i == CSTL_SPARSE_NONE) {
+        return CSTL_SPARSE_SET_KEY_NOT_FOUND;
+    }
+    _remove_at(ss, i);
+    return CSTL_ERROR_SUCCESS;
+}
+
+int cstl_sparse_set_contains(struct cstl_sparse_set* ss, uint32_t value)
+{
+    return ss && _index_of(ss, value) != CSTL_SPARSE_NONE;
+}
+
+void cstl_sparse_set_clear(struct cstl_sparse_set* ss)
+{
+    if (ss) {
+        ss->size = 0;
+    }
+}
+
+const uint32_t* cstl_sparse_set_data(struct cstl_sparse_set* ss)
+{
+    return ss ? ss->dense : NULL;
+}
+
+struct cstl_fd_map* cstl_fd_map_new(size_t value_size, cstl_destroy fn_d)
+{
+    struct cstl_fd_map* fm;
+    if (value_size == 0) {
+        return (struct cstl_fd_map*)0;
+    }
+    fm = (struct cstl_fd_map*)calloc(1, sizeof(struct cstl_fd_map));
+    if (fm) {
+        _init(&fm->set, 0);
+        fm->value_size = value_size;
+        fm->fn_d = fn_d;
+    }
+    return fm;
+}
+
+cstl_error cstl_fd_map_delete(struct cstl_fd_map* fm)
+{
+    if (fm == (struct cstl_fd_map*)0) {
+        return CSTL_SPARSE_SET_NOT_INITIALIZED;
+    }
+    cstl_fd_map_clear(fm);
+    free(fm->set.sparse);
+    free(fm->set.dense);
+    free(fm->values);
+    free(fm);
+    return CSTL_ERROR_SUCCESS;
+}
+
+size_t cstl_fd_map_size(struct cstl_fd_map* fm)
+{
+    return fm ? fm->set.size : 0;
+}
+
+cstl_error cstl_fd_map_insert(struct cstl_fd_map* fm, int fd,
+                              const void* value)
+{
+    cstl_error rc;
+    if (fm == (struct cstl_fd_map*)0) {
+        return CSTL_SPARSE_SET_NOT_INITIALIZED;
+    }
+    if (fd < 0 || value == NULL) {
+        return CSTL_SPARSE_SET_INVALID_INPUT;
+    }
+    if (_index_of(&fm->set, (uint32_t)fd) != CSTL_SPARSE_NONE) {
+        return CSTL_SPARSE_SET_KEY_DUPLICATE;
+    }
+    rc = _make_room(&fm->set, (uint32_t)fd);
+    if (rc != CSTL_ERROR_SUCCESS) {
+        return rc;
+    }
+    if (fm->capacity < fm->set.capacity) {
+        unsigned char* values = (unsigned char*)realloc(
+            fm->values, fm->set.capacity * fm->value_size);
+        if (values == NULL) {
+            return CSTL_ERROR_MEMORY;
+        }
+        fm->values = values;
+        fm->capacity = fm->set.capacity;
+    }
+    memcpy(cstl_value_at(fm, fm->set.size), value, fm->value_size);
+    _append(&fm->set, (uint32_t)fd);
+    return CSTL_ERROR_SUCCESS;
+}
+
+cstl_error cstl_fd_map_erase(struct cstl_fd_map* fm, int fd)
+{
+    size_t i;
+    size_t last;
+    if (fm == (struct cstl_fd_map*)0) {
+        return CSTL_SPARSE_SET_NOT_INITIALIZED;
+    }
+    i = fd < 0 ? CSTL_SPARSE_NONE : _index_of(&fm->set, (uint32_t)fd);
+    if (i == CSTL_SPARSE_NONE) {
+        return CSTL_SPARSE_SET_KEY_NOT_FOUND;
+    }
+    if (fm->fn_d) {
+        fm->fn_d(cstl_value_at(fm, i));
+    }
+    last = fm->set.size - 1;
+    if (i != last) {
+        memcpy(cstl_value_at(fm, i), cstl_value_at(fm, last), fm->value_size);
+    }
+    _remove_at(&fm->set, i);
+    return CSTL_ERROR_SUCCESS;
+}
+
+void* cstl_fd_map_find(struct cstl_fd_map* fm, int fd)
+{
+    size_t i;
+    if (fm == (struct cstl_fd_map*)0 || fd < 0) {
+        return NULL;
+    }
+    i = _index_of(&fm->set, (uint32_t)fd);
+    return i == CSTL_SPARSE_NONE ? NULL : cstl_value_at(fm, i);
+}
+
+void cstl_fd_map_clear(struct cstl_fd_map* fm)
+{
+    size_t i;
+    if (fm == (struct cstl_fd_map*)0) {
+        return;
+    }
+    if (fm->fn_d) {
+        for (i = 0; i < fm->set.size; ++i) {
+            fm->fn_d(cstl_value_at(fm, i));
+        }
+    }
+    fm->set.size = 0;
+}
+
+void* cstl_fd_map_data(struct cstl_fd_map* fm)
+{
+    return fm ? fm->values : NULL;
+}
+
+int cstl_fd_map_fd_at(struct cstl_fd_map* fm, size_t i)
+{
+    if (fm == (struct cstl_fd_map*)0 || i >= fm->set.size) {
+        return -1;
+    }
+    return (int)fm->set.dense[i];
+}
@@ -0,0 +1,320 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "c_stl_lib.h"
+
+/* slot 0 of the key array starts on a boundary of this many bytes */
+#define CSTL_STATIC_INDEX_ALIGN 64
+
+struct cstl_static_index {
+    char* keys;   /* slots 1..count in Eytzinger order; slot 0 unused */
+    char* values; /* same order, NULL when value_size is 0 */
+    void* block;  /* allocation holding both */
+    size_t count;
+    size_t key_size;
+    size_t value_size;
+    cstl_compare fn_c;
+};
+
+#define cstl_si_key(ix, k) ((ix)->keys + (k) * (ix)->key_size)
+#define cstl_si_value(ix, k) ((ix)->values + (k) * (ix)->value_size)
+
+/* the first slot in key order, 0 if the index is empty */
+static size_t _first(struct cstl_static_index* ix)
+{
+    size_t k = 1;
+    if (ix->count == 0) {
+        return 0;
+    }
+    while (2 * k <= ix->count) {
+        k = 2 * k;
+    }
+    return k;
+}
+
+/* the slot after k in key order, 0 after the last */
+static size_t _next(struct cstl_static_index* ix, size_t k)
+{
+    if (2 * k + 1 <= ix->count) {
+        k = 2 * k + 1;
+        while (2 * k <= ix->count) {
+            k = 2 * k;
+        }
+        return k;
+    }
+    while (k & 1) {
+        k >>= 1;
+    }
+    return k >> 1;
+}
+
+static struct cstl_static_index* _alloc(size_t n, size_t key_size,
+                                        size_t value_size, cstl_compare fn_c)
+{
+    struct cstl_static_index* ix;
+    size_t key_bytes = (n + 1) * key_size;
+    char* p;
+    if (key_size == 0 || fn_c == (cstl_compare)0) {
+        return (struct cstl_static_index*)0;
+    }
+    ix = (struct cstl_static_index*)calloc(1, sizeof(*ix));
+    if (ix == (struct cstl_static_index*)0) {
+        return ix;
+    }
+    key_bytes = (key_bytes + 7) & ~(size_t)7;
+    ix->block = malloc(CSTL_STATIC_INDEX_ALIGN - 1 + key_bytes +
+                       (n + 1) * value_size);
+    if (ix->block == NULL) {
+        free(ix);
+        return (struct cstl_static_index*)0;
+    }
+    p = (char*)ix->block;
+    p += (CSTL_STATIC_INDEX_ALIGN -
+          (size_t)((uintptr_t)p % CSTL_STATIC_INDEX_ALIGN)) %
+         CSTL_STATIC_INDEX_ALIGN;
+    ix->keys = p;
+    ix->values = value_size ? p + key_bytes : NULL;
+    ix->count = n;
+    ix->key_size = key_size;
+    ix->value_size = value_size;
+    ix->fn_c = fn_c;
+    return ix;
+}
+
+struct cstl_static_index* cstl_static_index_from_array(
+    const void* keys, const void* values, size_t n, size_t key_size,
+    size_t value_size, cstl_compare fn_c)
+{
+    struct cstl_static_index* ix;
+    size_t i, k;
+    if (keys == NULL && n) {
+        return (struct cstl_static_index*)0;
+    }
+    ix = _alloc(n, key_size, values ? value_size : 0, fn_c);
+    if (ix == (struct cstl_static_index*)0) {
+        return ix;
+    }
+    /* an in-order walk of the implicit tree visits slots in key order */
+    for (i = 0, k = _first(ix); i < n; ++i, k = _next(ix, k)) {
+        memcpy(cstl_si_key(ix, k), (const char*)keys + i * key_size,
+               key_size);
+        if (ix->values) {
+            memcpy(cstl_si_value(ix, k),
+                   (const char*)values + i * value_size, value_size);
+        }
+    }
+    return ix;
+}
+
+/* copies an ordered container out through its iterator, then indexes it */
+static struct cstl_static_index* _from_iterator(struct cstl_iterator* itr,
+                                                size_t key_size,
+                                                size_t value_size,
+                                                cstl_compare fn_c)
+{
+    struct cstl_static_index* ix;
+    struct cstl_iterator first = *itr;
+    size_t n = 0, k;
+    while (itr->next(itr)) {
+        n++;
+    }
+    ix = _alloc(n, key_size, value_size, fn_c);
+    if (ix == (struct cstl_static_index*)0) {
+        return ix;
+    }
+    *itr = first;
+    for (k = _first(ix); k && itr->next(itr); k = _next(ix, k)) {
+        memcpy(cstl_si_key(ix, k), itr->current_key(itr), key_size);
+        if (ix->values) {
+            const void* v = itr->current_value(itr);
+            if (v) {
+                memcpy(cstl_si_value(ix, k), v, value_size);
+            }
+            else {
+                memset(cstl_si_value(ix, k), 0, value_size);
+            }
+        }
+    }
+    return ix;
+}
+
+struct cstl_static_index* cstl_static_index_from_set(struct cstl_set* set,
+                                                     size_t key_size,
+                                                     cstl_compare fn_c)
+{
+    struct cstl_iterator itr;
+    if (set == (struct cstl_set*)0) {
+        return (struct cstl_static_index*)0;
+    }
+    cstl_set_iterator_init(&itr, set);
+    return _from_iterator(&itr, key_size, 0, fn_c);
+}
+
+struct cstl_static_index* cstl_static_index_from_map(struct cstl_map* map,
+                                                     size_t key_size,
+                                                     size_t value_size,
+                                                     cstl_compare fn_c)
+{
+    struct cstl_iterator itr;
+    if (map == (struct cstl_map*)0) {
+        return (struct cstl_static_index*)0;
+    }
+    cstl_map_iterator_init(&itr, map);
+    return _from_iterator(&itr, key_size, value_size, fn_c);
+}
+
+cstl_error cstl_static_index_delete(struct cstl_static_index* index)
+{
+    if (index == (struct cstl_static_index*)0) {
+        return CSTL_STATIC_INDEX_NOT_INITIALIZED;
+    }
+    free(index->block);
+    free(index);
+    return CSTL_ERROR_SUCCESS;
+}
+
+size_t cstl_static_index_size(struct cstl_static_index* index)
+{
+    return index ? index->count : 0;
+}
+
+/*
+ * Branch-free descent: each step picks a child with arithmetic on the
+ * comparison, while the prefetch fetches the block of 16 great-great-
+ * grandchildren. The slot reached is past the leaves; undoing the trailing
+ * right turns and one more step lands on the lower bound (0 if none).
+ */
+static size_t _lower_bound(struct cstl_static_index* ix, const void* key)
+{
+    size_t k = 1;
+    while (k <= ix->count) {
+        cstl_prefetch(ix->keys + 16 * k * ix->key_size);
+        k = 2 * k + (ix->fn_c(cstl_si_key(ix, k), key) < 0);
+    }
+    while (k & 1) {
+        k >>= 1;
+    }
+    return k >> 1;
+}
+
+const void* cstl_static_index_lower_bound(struct cstl_static_index* index,
+                                          const void* key)
+{
+    size_t k;
+    if (index == (struct cstl_static_index*)0 || key == NULL) {
+        return NULL;
+    }
+    k = _lower_bound(index, key);
+    return k ? cstl_si_key(index, k) : NULL;
+}
+
+const void* cstl_static_index_find(struct cstl_static_index* index,
+                                   const void* key)
+{
+    size_t k;
+    if (index == (struct cstl_static_index*)0 || key == NULL) {
+        return NULL;
+    }
+    k = _lower_bound(index, key);
+    if (k == 0 || index->fn_c(cstl_si_key(index, k), key) != 0) {
+        return NULL;
+    }
+    return index->values ? cstl_si_value(index, k) : cstl_si_key(index, k);
+}
+
+const void* cstl_static_index_value(struct cstl_static_index* index,
+                                    const void* stored_key)
+{
+    size_t k;
+    if (index == (struct cstl_static_index*)0 || index->values == NULL ||
+        stored_key == NULL) {
+        return NULL;
+    }
+    k = (size_t)((const char*)stored_key - index->keys) / index->key_size;
+    assert(k >= 1 && k <= index->count);
+    return cstl_si_value(index, k);
+}
+
+/* current_index is the slot of the current key, 0 before the first */
+static const void* cstl_static_index_get_next(struct cstl_iterator* pItr)
+{
+    struct cstl_static_index* ix =
+        (struct cstl_static_index*)pItr->pContainer;
+    if (pItr->current_element == NULL) {
+        pItr->current_index = _first(ix);
+    }
+    else {
+        pItr->current_index = _next(ix, pItr->current_index);
+    }
+    pItr->current_element =
+        pItr->current_index ? cstl_si_key(ix, pItr->current_index) : NULL;
+    return pItr->current_element;
+}
+
+static const void* cstl_static_index_get_key(struct cstl_iterator* pItr)
+{
+    return pItr->current_element;
+}
+
+static const void* cstl_static_index_get_value(struct cstl_iterator* pItr)
+{
+    struct cstl_static_index* ix =
+        (struct cstl_static_index*)pItr->pContainer;
+    if (ix->values == NULL) {
+        return pItr->current_element;
+    }
+    return cstl_si_value(ix, pItr->current_index);
+}
+
+void cstl_static_index_iterator_init(struct cstl_iterator* itr,
+                                     struct cstl_static_index* index)
+{
+    assert(itr);
+    memset(itr, 0, sizeof(*itr));
+    itr->next = cstl_static_index_get_next;
+    itr->current_key = cstl_static_index_get_key;
+    itr->current_value = cstl_static_index_get_value;
+    itr->pContainer = index;
+    itr->current_index = 0;
+    itr->current_element = (void*)0;
+}
+
+struct cstl_iterator* cstl_static_index_new_iterator(
+    struct cstl_static_index* index)
+{
+    struct cstl_iterator* itr =
+        (struct cstl_iterator*)calloc(1, sizeof(struct cstl_iterator));
+    if (itr) {
+        cstl_static_index_iterator_init(itr, index);
+    }
+    return itr;
+}
+
+void cstl_static_index_delete_iterator(struct cstl_iterator* pItr)
+{
+    free(pItr);
+}
@@ -0,0 +1,249 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "c_stl_lib.h"
+
+/* arena block size; longer strings get a block of their own */
+#define CSTL_STRING_POOL_BLOCK 65536
+#define CSTL_STRING_POOL_MIN_SLOTS 64
+
+/*
+ * A string is stored as its length, then its bytes and a NUL, starting at a
+ * size_t boundary. The index is open-addressed with linear probing and is
+ * kept at most half full.
+ */
+struct cstl_string_pool_block {
+    struct cstl_string_pool_block* next;
+    size_t used;
+    size_t size;
+};
+
+struct cstl_string_pool_slot {
+    const char* s; /* NULL when free */
+    size_t hash;
+};
+
+struct cstl_string_pool {
+    struct cstl_string_pool_block* blocks; /* the one being filled first */
+    struct cstl_string_pool_slot* slots;
+    size_t mask;
+    size_t count;
+    size_t memory;
+};
+
+#define CSTL_STRING_POOL_ALIGN(n) \
+    (((n) + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1))
+#define cstl_block_data(b) ((char*)(b) + sizeof(struct cstl_string_pool_block))
+#define cstl_record_length(s) (((const size_t*)(const void*)(s))[-1])
+
+struct cstl_string_pool* cstl_string_pool_new(void)
+{
+    struct cstl_string_pool* pool =
+        (struct cstl_string_pool*)calloc(1, sizeof(struct cstl_string_pool));
+    if (pool == (struct cstl_string_pool*)0) {
+        return (struct cstl_string_pool*)0;
+    }
+    pool->slots = (struct cstl_string_pool_slot*)calloc(
+        CSTL_STRING_POOL_MIN_SLOTS, sizeof(struct cstl_string_pool_slot));
+    if (pool->slots == NULL) {
+        free(pool);
+        return (struct cstl_string_pool*)0;
+    }
+    pool->mask = CSTL_STRING_POOL_MIN_SLOTS - 1;
+    pool->memory =
+        CSTL_STRING_POOL_MIN_SLOTS * sizeof(struct cstl_string_pool_slot);
+    return pool;
+}
+
+cstl_error cstl_string_pool_delete(struct cstl_string_pool* pool)
+{
+    if (pool == (struct cstl_string_pool*)0) {
+        return CSTL_STRING_POOL_NOT_INITIALIZED;
+    }
+    while (pool->blocks) {
+        struct cstl_string_pool_block* next = pool->blocks->next;
+        free(pool->blocks);
+        pool->blocks = next;
+    }
+    free(pool->slots);
+    free(pool);
+    return CSTL_ERROR_SUCCESS;
+}
+
+size_t cstl_string_pool_size(struct cstl_string_pool* pool)
+{
+    return pool ? pool->count : 0;
+}
+
+size_t cstl_string_pool_memory(struct cstl_string_pool* pool)
+{
+    return pool ? pool->memory : 0;
+}
+
+size_t cstl_string_pool_length(const char* interned)
+{
+    return cstl_record_length(interned);
+}
+
+int cstl_string_pool_compare(const void* left, const void* right)
+{
+    uintptr_t a = (uintptr_t)(*(const char* const*)left);
+    uintptr_t b = (uintptr_t)(*(const char* const*)right);
+    return (a > b) - (a < b);
+}
+
+/* the slot holding s, or the free slot where it would go */
+static struct cstl_string_pool_slot* _lookup(struct cstl_string_pool* pool,
+                                             const char* s, size_t len,
+                                             size_t hash)
+{
+    size_t i = hash & pool->mask;
+    for (;; i = (i + 1) & pool->mask) {
+        struct cstl_string_pool_slot* slot = pool->slots + i;
+        if (slot->s == NULL ||
+            (slot->hash == hash && cstl_record_length(slot->s) == len &&
+             memcmp(slot->s, s, len) == 0)) {
+            return slot;
+        }
+    }
+}
+
+static int _grow_index(struct cstl_string_pool* pool)
+{
+    size_t n = (pool->mask + 1) * 2, i;
+    struct cstl_string_pool_slot* old = pool->slots;
+    struct cstl_string_pool_slot* slots =
+        (struct cstl_string_pool_slot*)calloc(
+            n, sizeof(struct cstl_string_pool_slot));
+    if (slots == NULL) {
+        return -1;
+    }
+    for (i = 0; i <= pool->mask; ++i) {
+        if (old[i].s) {
+            size_t j = old[i].hash & (n - 1);
+            while (slots[j].s) {
+                j = (j + 1) & (n - 1);
+            }
+            slots[j] = old[i];
+        }
+    }
+    pool->memory += (n / 2) * sizeof(struct cstl_string_pool_slot);
+    pool->slots = slots;
+    pool->mask = n - 1;
+    free(old);
+    return 0;
+}
+
+/* copies s into the arena as a record; returns its string */
+static const char* _store(struct cstl_string_pool* pool, const char* s,
+                          size_t len)
+{
+    size_t need = CSTL_STRING_POOL_ALIGN(sizeof(size_t) + len + 1);
+    struct cstl_string_pool_block* b = pool->blocks;
+    char* record;
+    if (b == NULL || b->size - b->used < need) {
+        size_t size = CSTL_STRING_POOL_BLOCK;
+        if (need > size / 4) {
+            size = need;
+        }
+        b = (struct cstl_string_pool_block*)malloc(
+            sizeof(struct cstl_string_pool_block) + size);
+        if (b == NULL) {
+            return NULL;
+        }
+        b->used = 0;
+        b->size = size;
+        pool->memory += sizeof(struct cstl_string_pool_block) + size;
+        if (pool->blocks && size != CSTL_STRING_POOL_BLOCK) {
+            /* a dedicated block goes behind the one still being filled */
+            b->next = pool->blocks->next;
+            pool->blocks->next = b;
+        }
+        else {
+            b->next = pool->blocks;
+            pool->blocks = b;
+        }
+    }
+    record = cstl_block_data(b) + b->used;
+    b->used += need;
+    memcpy(record, &len, sizeof(size_t));
+    memcpy(record + sizeof(size_t), s, len);
+    record[sizeof(size_t) + len] = '\0';
+    return record + sizeof(size_t);
+}
+
+const char* cstl_string_pool_intern_n(struct cstl_string_pool* pool,
+                                      const char* s, size_t len)
+{
+    struct cstl_string_pool_slot* slot;
+    size_t hash;
+    if (pool == (struct cstl_string_pool*)0 || (s == NULL && len)) {
+        return NULL;
+    }
+    if (s == NULL) {
+        s = "";
+    }
+    hash = cstl_hash_bytes(s, len);
+    slot = _lookup(pool, s, len, hash);
+    if (slot->s) {
+        return slot->s;
+    }
+    if (2 * (pool->count + 1) > pool->mask + 1) {
+        if (_grow_index(pool) != 0) {
+            return NULL;
+        }
+        slot = _lookup(pool, s, len, hash);
+    }
+    slot->s = _store(pool, s, len);
+    if (slot->s == NULL) {
+        return NULL;
+    }
+    slot->hash = hash;
+    ++pool->count;
+    return slot->s;
+}
+
+const char* cstl_string_pool_intern(struct cstl_string_pool* pool,
+                                    const char* s)
+{
+    if (s == NULL) {
+        return NULL;
+    }
+    return cstl_string_pool_intern_n(pool, s, strlen(s));
+}
+
+const char* cstl_string_pool_find(struct cstl_string_pool* pool,
+                                  const char* s, size_t len)
+{
+    if (pool == (struct cstl_string_pool*)0 || (s == NULL && len)) {
+        return NULL;
+    }
+    if (s == NULL) {
+        s = "";
+    }
+    return _lookup(pool, s, len, cstl_hash_bytes(s, len))->s;
+}
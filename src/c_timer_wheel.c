@@ -0,0 +1,208 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#define CSTL_TW_BITS 6
+#define CSTL_TW_SLOTS (1 << CSTL_TW_BITS)
+#define CSTL_TW_MASK (CSTL_TW_SLOTS - 1)
+#define CSTL_TW_LEVELS 4
+
+struct cstl_timer_wheel {
+    uint64_t now; /* last tick processed */
+    size_t count;
+    struct cstl_ilist slots[CSTL_TW_LEVELS][CSTL_TW_SLOTS];
+    struct cstl_ilist overflow;
+};
+
+#define cstl_tw_slot(w, level, tick) \
+    (&(w)->slots[level][((tick) >> ((level)*CSTL_TW_BITS)) & CSTL_TW_MASK])
+
+struct cstl_timer_wheel* cstl_timer_wheel_new(uint64_t now)
+{
+    struct cstl_timer_wheel* w;
+    size_t l, s;
+    w = (struct cstl_timer_wheel*)calloc(1, sizeof(struct cstl_timer_wheel));
+    if (w == (struct cstl_timer_wheel*)0) {
+        return (struct cstl_timer_wheel*)0;
+    }
+    for (l = 0; l < CSTL_TW_LEVELS; l++) {
+        for (s = 0; s < CSTL_TW_SLOTS; s++) {
+            cstl_ilist_init(&w->slots[l][s]);
+        }
+    }
+    cstl_ilist_init(&w->overflow);
+    w->now = now;
+    return w;
+}
+
+static void cstl_tw_disarm_all(struct cstl_ilist* list)
+{
+    struct cstl_ilist_node* node;
+    while ((node = cstl_ilist_pop_front(list)) != NULL) {
+        /* pop leaves the node unlinked, so the timer reads as disarmed */
+    }
+}
+
+/* timers still armed are left disarmed, not freed: they belong to callers */
+void cstl_timer_wheel_delete(struct cstl_timer_wheel* w)
+{
+    size_t l, s;
+    if (w == (struct cstl_timer_wheel*)0) {
+        return;
+    }
+    for (l = 0; l < CSTL_TW_LEVELS; l++) {
+        for (s = 0; s < CSTL_TW_SLOTS; s++) {
+            cstl_tw_disarm_all(&w->slots[l][s]);
+        }
+    }
+    cstl_tw_disarm_all(&w->overflow);
+    free(w);
+}
+
+uint64_t cstl_timer_wheel_now(struct cstl_timer_wheel* w)
+{
+    return w->now;
+}
+
+size_t cstl_timer_wheel_count(struct cstl_timer_wheel* w)
+{
+    return w->count;
+}
+
+void cstl_timer_init(struct cstl_timer* timer)
+{
+    cstl_ilist_node_init(&timer->node);
+    timer->expires = 0;
+}
+
+int cstl_timer_is_armed(const struct cstl_timer* timer)
+{
+    return cstl_ilist_node_is_linked(&timer->node);
+}
+
+/*
+ * Files a timer relative to w->now. Level k is used when the expiry falls
+ * within the next 64 level-k slots; that slot is cascaded to a lower level
+ * no later than the expiry tick itself.
+ */
+static void cstl_tw_place(struct cstl_timer_wheel* w, struct cstl_timer* t)
+{
+    uint64_t when = t->expires > w->now ? t->expires : w->now + 1;
+    int level;
+    for (level = 0; level < CSTL_TW_LEVELS; level++) {
+        int shift = level * CSTL_TW_BITS;
+        if ((when >> shift) - (w->now >> shift) <= CSTL_TW_SLOTS) {
+            cstl_ilist_push_back(cstl_tw_slot(w, level, when), &t->node);
+            return;
+        }
+    }
+    cstl_ilist_push_back(&w->overflow, &t->node);
+}
+
+void cstl_timer_wheel_schedule(struct cstl_timer_wheel* w,
+                               struct cstl_timer* timer, uint64_t expires)
+{
+    if (cstl_timer_is_armed(timer)) {
+        cstl_ilist_unlink(&timer->node);
+    }
+    else {
+        w->count++;
+    }
+    timer->expires = expires;
+    cstl_tw_place(w, timer);
+}
+
+void cstl_timer_wheel_cancel(struct cstl_timer_wheel* w,
+                             struct cstl_timer* timer)
+{
+    if (cstl_timer_is_armed(timer)) {
+        cstl_ilist_unlink(&timer->node);
+        w->count--;
+    }
+}
+
+static void cstl_tw_refile(struct cstl_timer_wheel* w, struct cstl_ilist* list)
+{
+    struct cstl_ilist pending;
+    struct cstl_ilist_node* node;
+    cstl_ilist_init(&pending);
+    cstl_ilist_splice_back(&pending, list);
+    while ((node = cstl_ilist_pop_front(&pending)) != NULL) {
+        cstl_tw_place(w, cstl_container_of(node, struct cstl_timer, node));
+    }
+}
+
+/* processes tick w->now + 1 */
+static size_t cstl_tw_tick(struct cstl_timer_wheel* w, cstl_timer_cb cb,
+                           void* p)
+{
+    uint64_t tick = w->now + 1;
+    struct cstl_ilist due;
+    struct cstl_ilist_node* node;
+    size_t fired = 0;
+    int level = 0;
+
+    /*
+     * Find the highest level whose slot turns over at this tick and cascade
+     * from there downwards, so nothing lands in a slot already emptied.
+     */
+    while (level + 1 < CSTL_TW_LEVELS &&
+           (tick & (((uint64_t)1 << ((level + 1) * CSTL_TW_BITS)) - 1)) == 0) {
+        level++;
+    }
+    if (level == CSTL_TW_LEVELS - 1 &&
+        (tick & (((uint64_t)1 << (CSTL_TW_LEVELS * CSTL_TW_BITS)) - 1)) == 0) {
+        cstl_tw_refile(w, &w->overflow);
+    }
+    for (; level > 0; level--) {
+        cstl_tw_refile(w, cstl_tw_slot(w, level, tick));
+    }
+
+    w->now = tick;
+    cstl_ilist_init(&due);
+    cstl_ilist_splice_back(&due, cstl_tw_slot(w, 0, tick));
+    while ((node = cstl_ilist_pop_front(&due)) != NULL) {
+        w->count--;
+        fired++;
+        if (cb) {
+            cb(cstl_container_of(node, struct cstl_timer, node), p);
+        }
+    }
+    return fired;
+}
+
+size_t cstl_timer_wheel_advance(struct cstl_timer_wheel* w, uint64_t now,
+                                cstl_timer_cb cb, void* p)
+{
+    size_t fired = 0;
+    while (w->now < now) {
+        if (w->count == 0) {
+            w->now = now; /* nothing can fire: skip the empty ticks */
+            break;
+        }
+        fired += cstl_tw_tick(w, cb, p);
+    }
+    return fired;
+}
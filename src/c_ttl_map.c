@@ -0,0 +1,319 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include <string.h>
+#include "c_stl_lib.h"
+#include "rb-tree.h"
+
+/*
+ * Every entry sits in two indices: an rb-tree ordered by key, linked through
+ * the rbt_link at the head of the entry, and a min-heap of deadlines whose
+ * elements point back at the entry. The entry remembers its heap handle so
+ * touch and remove can re-prioritize or drop it without a search.
+ */
+
+struct cstl_ttl_entry {
+    struct rbt_link link;
+    uint64_t deadline;
+    cstl_pqueue_handle handle;
+    size_t key_size;
+    size_t value_size;
+    /* key, then value, follow at 8-byte aligned offsets */
+};
+
+struct cstl_ttl_deadline {
+    uint64_t deadline;
+    struct cstl_ttl_entry* entry;
+};
+
+struct cstl_ttl_map {
+    struct rbt_root root;
+    struct rbt_link nil;
+    struct cstl_pqueue* deadlines;
+    size_t count;
+    size_t work_per_op;
+    cstl_compare fn_c_k;
+    cstl_destroy fn_k_d;
+    cstl_destroy fn_v_d;
+    cstl_ttl_map_expired expired_fn;
+    void* expired_arg;
+};
+
+#define CSTL_TTL_MAP_DEFAULT_WORK 4
+
+#define CSTL_TTL_ALIGN(n) (((n) + 7) & ~(size_t)7)
+#define CSTL_TTL_KEY_OFF CSTL_TTL_ALIGN(sizeof(struct cstl_ttl_entry))
+#define cstl_ttl_key(e) ((void*)((char*)(e) + CSTL_TTL_KEY_OFF))
+#define cstl_ttl_value(e) \
+    ((void*)((char*)(e) + CSTL_TTL_KEY_OFF + CSTL_TTL_ALIGN((e)->key_size)))
+
+static int _deadline_compare(const void* lhs, const void* rhs)
+{
+    uint64_t a = ((const struct cstl_ttl_deadline*)lhs)->deadline;
+    uint64_t b = ((const struct cstl_ttl_deadline*)rhs)->deadline;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/* now + ttl, saturating so a huge ttl never wraps into the past */
+static uint64_t _deadline_of(uint64_t now, uint64_t ttl)
+{
+    uint64_t d = now + ttl;
+    return d < now ? ~(uint64_t)0 : d;
+}
+
+struct cstl_ttl_map* cstl_ttl_map_new(cstl_compare fn_c_k,
+                                      cstl_destroy fn_k_d,
+                                      cstl_destroy fn_v_d,
+                                      size_t work_per_op)
+{
+    struct cstl_ttl_map* map;
+    if (fn_c_k == (cstl_compare)0) {
+        return (struct cstl_ttl_map*)0;
+    }
+    map = (struct cstl_ttl_map*)calloc(1, sizeof(struct cstl_ttl_map));
+    if (map == (struct cstl_ttl_map*)0) {
+        return (struct cstl_ttl_map*)0;
+    }
+    map->deadlines = cstl_pqueue_new(sizeof(struct cstl_ttl_deadline), 0,
+                                     _deadline_compare, (cstl_destroy)0);
+    if (map->deadlines == (struct cstl_pqueue*)0) {
+        free(map);
+        return (struct cstl_ttl_map*)0;
+    }
+    rbt_root_init(&map->root, &map->nil);
+    map->work_per_op = work_per_op ? work_per_op : CSTL_TTL_MAP_DEFAULT_WORK;
+    map->fn_c_k = fn_c_k;
+    map->fn_k_d = fn_k_d;
+    map->fn_v_d = fn_v_d;
+    return map;
+}
+
+void cstl_ttl_map_on_expire(struct cstl_ttl_map* map,
+                            cstl_ttl_map_expired fn, void* p)
+{
+    if (map) {
+        map->expired_fn = fn;
+        map->expired_arg = p;
+    }
+}
+
+static void _entry_destroy(struct cstl_ttl_map* map,
+                           struct cstl_ttl_entry* e)
+{
+    if (map->fn_k_d) {
+        map->fn_k_d(cstl_ttl_key(e));
+    }
+    if (map->fn_v_d) {
+        map->fn_v_d(cstl_ttl_value(e));
+    }
+    free(e);
+}
+
+static void _entry_release(struct rbt_link* link, void* p)
+{
+    _entry_destroy((struct cstl_ttl_map*)p, (struct cstl_ttl_entry*)link);
+}
+
+cstl_error cstl_ttl_map_delete(struct cstl_ttl_map* map)
+{
+    if (map == (struct cstl_ttl_map*)0) {
+        return CSTL_TTL_MAP_NOT_INITIALIZED;
+    }
+    rbt_root_clear(&map->root, _entry_release, map);
+    cstl_pqueue_delete(map->deadlines);
+    free(map);
+    return CSTL_ERROR_SUCCESS;
+}
+
+size_t cstl_ttl_map_size(struct cstl_ttl_map* map)
+{
+    return map ? map->count : 0;
+}
+
+static struct cstl_ttl_entry* _lookup(struct cstl_ttl_map* map,
+                                      const void* key)
+{
+    struct rbt_link* x = map->root.root;
+    while (x != map->root.nil) {
+        int c = map->fn_c_k(key, cstl_ttl_key(x));
+        if (c == 0) {
+            return (struct cstl_ttl_entry*)x;
+        }
+        x = c < 0 ? x->left : x->right;
+    }
+    return (struct cstl_ttl_entry*)0;
+}
+
+/* unlinks e from the key index; its heap element must be gone already */
+static void _drop(struct cstl_ttl_map* map, struct cstl_ttl_entry* e,
+                  int expired)
+{
+    rbt_link_erase(&map->root, &e->link);
+    map->count--;
+    if (expired && map->expired_fn) {
+        map->expired_fn(cstl_ttl_key(e), cstl_ttl_value(e), map->expired_arg);
+    }
+    _entry_destroy(map, e);
+}
+
+size_t cstl_ttl_map_expire(struct cstl_ttl_map* map, uint64_t now,
+                           size_t max_work)
+{
+    size_t n = 0;
+    struct cstl_ttl_deadline top;
+    if (map == (struct cstl_ttl_map*)0) {
+        return 0;
+    }
+    while (n < max_work && !cstl_pqueue_is_empty(map->deadlines)) {
+        const struct cstl_ttl_deadline* d =
+            (const struct cstl_ttl_deadline*)cstl_pqueue_top(map->deadlines);
+        if (d->deadline > now) {
+            break;
+        }
+        cstl_pqueue_pop(map->deadlines, &top);
+        _drop(map, top.entry, 1);
+        n++;
+    }
+    return n;
+}
+
+/* finds key, dropping it instead if it is already due */
+static struct cstl_ttl_entry* _find_live(struct cstl_ttl_map* map,
+                                         const void* key, uint64_t now)
+{
+    struct cstl_ttl_entry* e = _lookup(map, key);
+    if (e && e->deadline <= now) {
+        cstl_pqueue_erase(map->deadlines, e->handle, (void*)0);
+        _drop(map, e, 1);
+        e = (struct cstl_ttl_entry*)0;
+    }
+    return e;
+}
+
+cstl_error cstl_ttl_map_insert(struct cstl_ttl_map* map,
+                               const void* key, size_t key_size,
+                               const void* value, size_t value_size,
+                               uint64_t now, uint64_t ttl)
+{
+    struct cstl_ttl_entry* e;
+    struct cstl_ttl_deadline d;
+    struct rbt_link* parent;
+    struct rbt_link** where;
+    cstl_error rc;
+
+    if (map == (struct cstl_ttl_map*)0) {
+        return CSTL_TTL_MAP_NOT_INITIALIZED;
+    }
+    if (key == NULL || key_size == 0 || (value == NULL && value_size)) {
+        return CSTL_TTL_MAP_INVALID_INPUT;
+    }
+    cstl_ttl_map_expire(map, now, map->work_per_op);
+    if (_find_live(map, key, now)) {
+        return CSTL_RBTREE_KEY_DUPLICATE;
+    }
+
+    e = (struct cstl_ttl_entry*)malloc(CSTL_TTL_KEY_OFF +
+                                       CSTL_TTL_ALIGN(key_size) + value_size);
+    if (e == (struct cstl_ttl_entry*)0) {
+        return CSTL_ERROR_MEMORY;
+    }
+    e->deadline = _deadline_of(now, ttl);
+    e->key_size = key_size;
+    e->value_size = value_size;
+    memcpy(cstl_ttl_key(e), key, key_size);
+    if (value_size) {
+        memcpy(cstl_ttl_value(e), value, value_size);
+    }
+
+    d.deadline = e->deadline;
+    d.entry = e;
+    rc = cstl_pqueue_push(map->deadlines, &d, &e->handle);
+    if (rc != CSTL_ERROR_SUCCESS) {
+        free(e);
+        return rc;
+    }
+
+    parent = map->root.nil;
+    where = &map->root.root;
+    while (*where != map->root.nil) {
+        parent = *where;
+        where = map->fn_c_k(key, cstl_ttl_key(parent)) < 0 ? &parent->left
+                                                            : &parent->right;
+    }
+    rbt_link_insert(&map->root, parent, where, &e->link);
+    map->count++;
+    return CSTL_ERROR_SUCCESS;
+}
+
+void* cstl_ttl_map_find(struct cstl_ttl_map* map, const void* key,
+                        uint64_t now)
+{
+    struct cstl_ttl_entry* e;
+    if (map == (struct cstl_ttl_map*)0 || key == NULL) {
+        return (void*)0;
+    }
+    cstl_ttl_map_expire(map, now, map->work_per_op);
+    e = _find_live(map, key, now);
+    return e ? cstl_ttl_value(e) : (void*)0;
+}
+
+cstl_error cstl_ttl_map_touch(struct cstl_ttl_map* map, const void* key,
+                              uint64_t now, uint64_t ttl)
+{
+    struct cstl_ttl_entry* e;
+    struct cstl_ttl_deadline d;
+    if (map == (struct cstl_ttl_map*)0) {
+        return CSTL_TTL_MAP_NOT_INITIALIZED;
+    }
+    if (key == NULL) {
+        return CSTL_TTL_MAP_INVALID_INPUT;
+    }
+    cstl_ttl_map_expire(map, now, map->work_per_op);
+    e = _find_live(map, key, now);
+    if (e == (struct cstl_ttl_entry*)0) {
+        return CSTL_RBTREE_KEY_NOT_FOUND;
+    }
+    e->deadline = _deadline_of(now, ttl);
+    d.deadline = e->deadline;
+    d.entry = e;
+    return cstl_pqueue_update(map->deadlines, e->handle, &d);
+}
+
+cstl_error cstl_ttl_map_remove(struct cstl_ttl_map* map, const void* key)
+{
+    struct cstl_ttl_entry* e;
+    if (map == (struct cstl_ttl_map*)0) {
+        return CSTL_TTL_MAP_NOT_INITIALIZED;
+    }
+    if (key == NULL) {
+        return CSTL_TTL_MAP_INVALID_INPUT;
+    }
+    e = _lookup(map, key);
+    if (e == (struct cstl_ttl_entry*)0) {
+        return CSTL_RBTREE_KEY_NOT_FOUND;
+    }
+    cstl_pqueue_erase(map->deadlines, e->handle, (void*)0);
+    _drop(map, e, 0);
+    return CSTL_ERROR_SUCCESS;
+}
@@ -23,6 +23,7 @@
  ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
 
 #include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include "c_stl_lib.h"
@@ -37,6 +38,21 @@ void cstl_get(void* destination, void* source, size_t size)
     memcpy(destination, (char*)source, size);
 }
 
+/* FNV-1a, folded to size_t */
+size_t cstl_hash_bytes(const void* key, size_t key_size)
+{
+    const unsigned char* p = (const unsigned char*)key;
+    /* the 64-bit FNV constants, spelled so that C90 needs no long long */
+    uint64_t h = ((uint64_t)0xcbf29ce4UL << 32) | 0x84222325UL;
+    const uint64_t prime = ((uint64_t)1 << 40) | 0x1b3;
+    size_t i;
+    for (i = 0; i < key_size; i++) {
+        h ^= p[i];
+        h *= prime;
+    }
+    return (size_t)(h ^ (h >> 32));
+}
+
 struct cstl_object {
     void* raw_data;
     size_t size;
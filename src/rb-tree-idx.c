@@ -0,0 +1,655 @@
+#include "rb-tree-idx.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Every array slot starts with this link. The top bit of parent_color is
+ * the color (set for black), leaving 31 bits of parent index. A free slot
+ * has parent_color == RBT_IDX_FREE and chains to the next free slot
+ * through `left`.
+ */
+struct rbt_idx_link {
+    rbt_idx left;
+    rbt_idx right;
+    uint32_t parent_color;
+};
+
+#define RBT_IDX_BLACK 0x80000000u
+#define RBT_IDX_FREE 0xFFFFFFFFu
+#define RBT_IDX_MAGIC 0x52424931u /* "RBI1" */
+
+struct rbt_idx_tree {
+    char* arena;
+    size_t stride;   /* bytes per slot: link, padding, key */
+    size_t key_off;  /* offset of the key inside a slot */
+    size_t key_size;
+    rbt_idx root;
+    rbt_idx free_head;
+    rbt_idx used;     /* slots handed out so far, including the sentinel */
+    rbt_idx capacity; /* slots allocated */
+    size_t count;
+    rbt_node_compare node_compare;
+    rbt_node_destruct node_destruct;
+};
+
+/* serialized header, followed by `used` slots */
+struct rbt_idx_image {
+    uint32_t magic;
+    uint32_t key_size;
+    uint32_t stride;
+    uint32_t key_off;
+    rbt_idx root;
+    rbt_idx free_head;
+    rbt_idx used;
+    uint32_t count;
+};
+
+#define L(t, i) ((struct rbt_idx_link*)((t)->arena + (size_t)(i) * (t)->stride))
+#define K(t, i) ((void*)((t)->arena + (size_t)(i) * (t)->stride + (t)->key_off))
+
+#define parent_of(t, i) (L(t, i)->parent_color & ~RBT_IDX_BLACK)
+#define is_black(t, i) ((L(t, i)->parent_color & RBT_IDX_BLACK) != 0)
+#define is_red(t, i) (!is_black(t, i))
+#define set_parent(t, i, p)                                        \
+    (L(t, i)->parent_color =                                       \
+         (L(t, i)->parent_color & RBT_IDX_BLACK) | (uint32_t)(p))
+#define set_black(t, i) (L(t, i)->parent_color |= RBT_IDX_BLACK)
+#define set_red(t, i) (L(t, i)->parent_color &= ~RBT_IDX_BLACK)
+#define copy_color(t, dst, src)                                     \
+    (L(t, dst)->parent_color = (L(t, dst)->parent_color &           \
+                                ~RBT_IDX_BLACK) |                   \
+                               (L(t, src)->parent_color & RBT_IDX_BLACK))
+
+#ifndef NDEBUG
+/* returns the black height of x, asserting the red-black properties */
+static int _idx_verify(const struct rbt_idx_tree* t, rbt_idx x)
+{
+    rbt_idx l, r;
+    int hl, hr;
+    if (x == RBT_IDX_NIL) {
+        return 1;
+    }
+    l = L(t, x)->left;
+    r = L(t, x)->right;
+    assert(l == RBT_IDX_NIL || (parent_of(t, l) == x &&
+                                t->node_compare(K(t, l), K(t, x)) < 0));
+    assert(r == RBT_IDX_NIL || (parent_of(t, r) == x &&
+                                t->node_compare(K(t, x), K(t, r)) < 0));
+    assert(is_black(t, x) || (is_black(t, l) && is_black(t, r)));
+    hl = _idx_verify(t, l);
+    hr = _idx_verify(t, r);
+    assert(hl == hr);
+    (void)hr;
+    return hl + (is_black(t, x) ? 1 : 0);
+}
+#define debug_verify(t) \
+    (assert(is_black(t, (t)->root)), (void)_idx_verify((t), (t)->root))
+#else
+#define debug_verify(t) ((void)0)
+#endif
+
+static void _idx_layout(struct rbt_idx_tree* t, size_t key_size)
+{
+    /* align the key to the largest power of two (up to 8) dividing it */
+    size_t align = 1;
+    while (align < 8 && key_size % (align * 2) == 0) {
+        align *= 2;
+    }
+    if (align < 4) {
+        align = 4; /* keeps the links themselves aligned */
+    }
+    t->key_size = key_size;
+    t->key_off = (sizeof(struct rbt_idx_link) + align - 1) & ~(align - 1);
+    t->stride = (t->key_off + key_size + align - 1) & ~(align - 1);
+}
+
+static rbt_status _idx_grow(struct rbt_idx_tree* t, size_t n)
+{
+    char* arena;
+    if (n <= t->capacity) {
+        return rbt_status_success;
+    }
+    if (n > (size_t)RBT_IDX_MAX_NODES + 1) {
+        return rbt_status_memory_out;
+    }
+    arena = (char*)realloc(t->arena, n * t->stride);
+    if (arena == NULL) {
+        return rbt_status_memory_out;
+    }
+    t->arena = arena;
+    t->capacity = (rbt_idx)n;
+    return rbt_status_success;
+}
+
+struct rbt_idx_tree* rbt_idx_tree_create(size_t key_size, rbt_node_compare cmp,
+                                         rbt_node_destruct dest)
+{
+    struct rbt_idx_tree* t;
+    assert(key_size && cmp);
+    t = (struct rbt_idx_tree*)calloc(1, sizeof(*t));
+    if (t == NULL) {
+        return NULL;
+    }
+    _idx_layout(t, key_size);
+    t->node_compare = cmp;
+    t->node_destruct = dest;
+    if (_idx_grow(t, 16) != rbt_status_success) {
+        free(t);
+        return NULL;
+    }
+    /* slot 0 is the black sentinel */
+    memset(L(t, RBT_IDX_NIL), 0, t->stride);
+    L(t, RBT_IDX_NIL)->parent_color = RBT_IDX_BLACK;
+    t->used = 1;
+    t->root = RBT_IDX_NIL;
+    t->free_head = RBT_IDX_NIL;
+    return t;
+}
+
+void rbt_idx_tree_destroy(struct rbt_idx_tree* t)
+{
+    if (t == NULL) {
+        return;
+    }
+    if (t->node_destruct) {
+        rbt_idx i;
+        for (i = 1; i < t->used; i++) {
+            if (L(t, i)->parent_color != RBT_IDX_FREE) {
+                t->node_destruct(K(t, i));
+            }
+        }
+    }
+    free(t->arena);
+    free(t);
+}
+
+rbt_status rbt_idx_tree_reserve(struct rbt_idx_tree* t, size_t n)
+{
+    assert(t);
+    return _idx_grow(t, n + 1);
+}
+
+size_t rbt_idx_tree_size(const struct rbt_idx_tree* t)
+{
+    assert(t);
+    return t->count;
+}
+
+void* rbt_idx_tree_key(const struct rbt_idx_tree* t, rbt_idx i)
+{
+    assert(t && i < t->used);
+    return (i != RBT_IDX_NIL) ? K(t, i) : NULL;
+}
+
+static void _idx_left_rotate(struct rbt_idx_tree* t, rbt_idx x)
+{
+    rbt_idx y = L(t, x)->right;
+    rbt_idx xp = parent_of(t, x);
+    L(t, x)->right = L(t, y)->left;
+    if (L(t, y)->left != RBT_IDX_NIL) {
+        set_parent(t, L(t, y)->left, x);
+    }
+    set_parent(t, y, xp);
+    if (xp == RBT_IDX_NIL) {
+        t->root = y;
+    }
+    else if (x == L(t, xp)->left) {
+        L(t, xp)->left = y;
+    }
+    else {
+        L(t, xp)->right = y;
+    }
+    L(t, y)->left = x;
+    set_parent(t, x, y);
+}
+
+static void _idx_right_rotate(struct rbt_idx_tree* t, rbt_idx x)
+{
+    rbt_idx y = L(t, x)->left;
+    rbt_idx xp = parent_of(t, x);
+    L(t, x)->left = L(t, y)->right;
+    if (L(t, y)->right != RBT_IDX_NIL) {
+        set_parent(t, L(t, y)->right, x);
+    }
+    set_parent(t, y, xp);
+    if (xp == RBT_IDX_NIL) {
+        t->root = y;
+    }
+    else if (x == L(t, xp)->right) {
+        L(t, xp)->right = y;
+    }
+    else {
+        L(t, xp)->left = y;
+    }
+    L(t, y)->right = x;
+    set_parent(t, x, y);
+}
+
+static void _idx_insert_fixup(struct rbt_idx_tree* t, rbt_idx z)
+{
+    rbt_idx zp, zpp, y;
+    while (zp = parent_of(t, z), is_red(t, zp)) {
+        zpp = parent_of(t, zp);
+        if (zp == L(t, zpp)->left) {
+            y = L(t, zpp)->right;
+            if (is_red(t, y)) {
+                set_black(t, zp);
+                set_black(t, y);
+                set_red(t, zpp);
+                z = zpp;
+            }
+            else {
+                if (z == L(t, zp)->right) {
+                    z = zp;
+                    _idx_left_rotate(t, z);
+                    zp = parent_of(t, z);
+                }
+                set_black(t, zp);
+                set_red(t, zpp);
+                _idx_right_rotate(t, zpp);
+            }
+        }
+        else {
+            y = L(t, zpp)->left;
+            if (is_red(t, y)) {
+                set_black(t, zp);
+                set_black(t, y);
+                set_red(t, zpp);
+                z = zpp;
+            }
+            else {
+                if (z == L(t, zp)->left) {
+                    z = zp;
+                    _idx_right_rotate(t, z);
+                    zp = parent_of(t, z);
+                }
+                set_black(t, zp);
+                set_red(t, zpp);
+                _idx_left_rotate(t, zpp);
+            }
+        }
+    }
+    set_black(t, t->root);
+}
+
+static rbt_idx _idx_alloc(struct rbt_idx_tree* t)
+{
+    rbt_idx i = t->free_head;
+    if (i != RBT_IDX_NIL) {
+        t->free_head = L(t, i)->left;
+        return i;
+    }
+    if (t->used == t->capacity) {
+        size_t n = (size_t)t->capacity * 2;
+        if (n > (size_t)RBT_IDX_MAX_NODES + 1) {
+            n = (size_t)RBT_IDX_MAX_NODES + 1;
+        }
+        if (_idx_grow(t, n) != rbt_status_success || t->used == t->capacity) {
+            return RBT_IDX_NIL;
+        }
+    }
+    return t->used++;
+}
+
+rbt_status rbt_idx_tree_insert(struct rbt_idx_tree* t, const void* key)
+{
+    rbt_idx parent = RBT_IDX_NIL, x, z;
+    int c = 0;
+    assert(t && key);
+    x = t->root;
+    while (x != RBT_IDX_NIL) {
+        parent = x;
+        c = t->node_compare(key, K(t, x));
+        if (c == 0) {
+            return rbt_status_key_duplicate;
+        }
+        x = (c < 0) ? L(t, x)->left : L(t, x)->right;
+    }
+    z = _idx_alloc(t);
+    if (z == RBT_IDX_NIL) {
+        return rbt_status_memory_out;
+    }
+    memcpy(K(t, z), key, t->key_size);
+    L(t, z)->left = RBT_IDX_NIL;
+    L(t, z)->right = RBT_IDX_NIL;
+    L(t, z)->parent_color = parent; /* red */
+    if (parent == RBT_IDX_NIL) {
+        t->root = z;
+    }
+    else if (c < 0) {
+        L(t, parent)->left = z;
+    }
+    else {
+        L(t, parent)->right = z;
+    }
+    _idx_insert_fixup(t, z);
+    t->count++;
+    debug_verify(t);
+    return rbt_status_success;
+}
+
+rbt_idx rbt_idx_tree_find(const struct rbt_idx_tree* t, const void* key)
+{
+    rbt_idx x;
+    int c;
+    assert(t && key);
+    x = t->root;
+    while (x != RBT_IDX_NIL && (c = t->node_compare(key, K(t, x))) != 0) {
+        x = (c < 0) ? L(t, x)->left : L(t, x)->right;
+    }
+    return x;
+}
+
+static void _idx_transplant(struct rbt_idx_tree* t, rbt_idx u, rbt_idx v)
+{
+    rbt_idx up = parent_of(t, u);
+    if (up == RBT_IDX_NIL) {
+        t->root = v;
+    }
+    else if (u == L(t, up)->left) {
+        L(t, up)->left = v;
+    }
+    else {
+        L(t, up)->right = v;
+    }
+    set_parent(t, v, up);
+}
+
+static rbt_idx _idx_minimum(const struct rbt_idx_tree* t, rbt_idx x)
+{
+    while (L(t, x)->left != RBT_IDX_NIL) {
+        x = L(t, x)->left;
+    }
+    return x;
+}
+
+static rbt_idx _idx_maximum(const struct rbt_idx_tree* t, rbt_idx x)
+{
+    while (L(t, x)->right != RBT_IDX_NIL) {
+        x = L(t, x)->right;
+    }
+    return x;
+}
+
+static void _idx_delete_fixup(struct rbt_idx_tree* t, rbt_idx x)
+{
+    rbt_idx xp, w;
+    while (x != t->root && is_black(t, x)) {
+        xp = parent_of(t, x);
+        if (x == L(t, xp)->left) {
+            w = L(t, xp)->right;
+            if (is_red(t, w)) {
+                set_black(t, w);
+                set_red(t, xp);
+                _idx_left_rotate(t, xp);
+                w = L(t, xp)->right;
+            }
+            if (is_black(t, L(t, w)->left) && is_black(t, L(t, w)->right)) {
+                set_red(t, w);
+                x = xp;
+            }
+            else {
+                if (is_black(t, L(t, w)->right)) {
+                    set_black(t, L(t, w)->left);
+                    set_red(t, w);
+                    _idx_right_rotate(t, w);
+                    w = L(t, xp)->right;
+                }
+                copy_color(t, w, xp);
+                set_black(t, xp);
+                set_black(t, L(t, w)->right);
+                _idx_left_rotate(t, xp);
+                x = t->root;
+            }
+        }
+        else {
+            w = L(t, xp)->left;
+            if (is_red(t, w)) {
+                set_black(t, w);
+                set_red(t, xp);
+                _idx_right_rotate(t, xp);
+                w = L(t, xp)->left;
+            }
+            if (is_black(t, L(t, w)->right) && is_black(t, L(t, w)->left)) {
+                set_red(t, w);
+                x = xp;
+            }
+            else {
+                if (is_black(t, L(t, w)->left)) {
+                    set_black(t, L(t, w)->right);
+                    set_red(t, w);
+                    _idx_left_rotate(t, w);
+                    w = L(t, xp)->left;
+                }
+                copy_color(t, w, xp);
+                set_black(t, xp);
+                set_black(t, L(t, w)->left);
+                _idx_right_rotate(t, xp);
+                x = t->root;
+            }
+        }
+    }
+    set_black(t, x);
+}
+
+rbt_status rbt_idx_tree_remove(struct rbt_idx_tree* t, const void* key)
+{
+    rbt_idx z, x, y;
+    int y_was_black;
+    assert(t && key);
+    z = rbt_idx_tree_find(t, key);
+    if (z == RBT_IDX_NIL) {
+        return rbt_status_key_not_exist;
+    }
+    y = z;
+    y_was_black = is_black(t, y);
+    if (L(t, z)->left == RBT_IDX_NIL) {
+        x = L(t, z)->right;
+        _idx_transplant(t, z, x);
+    }
+    else if (L(t, z)->right == RBT_IDX_NIL) {
+        x = L(t, z)->left;
+        _idx_transplant(t, z, x);
+    }
+    else {
+        y = _idx_minimum(t, L(t, z)->right);
+        y_was_black = is_black(t, y);
+        x = L(t, y)->right;
+        if (parent_of(t, y) == z) {
+            set_parent(t, x, y);
+        }
+        else {
+            _idx_transplant(t, y, L(t, y)->right);
+            L(t, y)->right = L(t, z)->right;
+            set_parent(t, L(t, y)->right, y);
+        }
+        _idx_transplant(t, z, y);
+        L(t, y)->left = L(t, z)->left;
+        set_parent(t, L(t, y)->left, y);
+        copy_color(t, y, z);
+    }
+    if (y_was_black) {
+        _idx_delete_fixup(t, x);
+    }
+
+    if (t->node_destruct) {
+        t->node_destruct(K(t, z));
+    }
+    L(t, z)->left = t->free_head;
+    L(t, z)->parent_color = RBT_IDX_FREE;
+    t->free_head = z;
+    t->count--;
+    debug_verify(t);
+    return rbt_status_success;
+}
+
+rbt_idx rbt_idx_tree_first(const struct rbt_idx_tree* t)
+{
+    assert(t);
+    return (t->root != RBT_IDX_NIL) ? _idx_minimum(t, t->root) : RBT_IDX_NIL;
+}
+
+rbt_idx rbt_idx_tree_last(const struct rbt_idx_tree* t)
+{
+    assert(t);
+    return (t->root != RBT_IDX_NIL) ? _idx_maximum(t, t->root) : RBT_IDX_NIL;
+}
+
+rbt_idx rbt_idx_tree_next(const struct rbt_idx_tree* t, rbt_idx x)
+{
+    rbt_idx y;
+    assert(t && x != RBT_IDX_NIL);
+    if (L(t, x)->right != RBT_IDX_NIL) {
+        return _idx_minimum(t, L(t, x)->right);
+    }
+    y = parent_of(t, x);
+    while (y != RBT_IDX_NIL && x == L(t, y)->right) {
+        x = y;
+        y = parent_of(t, y);
+    }
+    return y;
+}
+
+rbt_idx rbt_idx_tree_prev(const struct rbt_idx_tree* t, rbt_idx x)
+{
+    rbt_idx y;
+    assert(t && x != RBT_IDX_NIL);
+    if (L(t, x)->left != RBT_IDX_NIL) {
+        return _idx_maximum(t, L(t, x)->left);
+    }
+    y = parent_of(t, x);
+    while (y != RBT_IDX_NIL && x == L(t, y)->left) {
+        x = y;
+        y = parent_of(t, y);
+    }
+    return y;
+}
+
+size_t rbt_idx_tree_save(const struct rbt_idx_tree* t, void* buf, size_t size)
+{
+    struct rbt_idx_image h;
+    size_t bytes;
+    assert(t);
+    bytes = sizeof(h) + (size_t)t->used * t->stride;
+    if (buf == NULL || size < bytes) {
+        return bytes;
+    }
+    h.magic = RBT_IDX_MAGIC;
+    h.key_size = (uint32_t)t->key_size;
+    h.stride = (uint32_t)t->stride;
+    h.key_off = (uint32_t)t->key_off;
+    h.root = t->root;
+    h.free_head = t->free_head;
+    h.used = t->used;
+    h.count = (uint32_t)t->count;
+    memcpy(buf, &h, sizeof(h));
+    memcpy((char*)buf + sizeof(h), t->arena, (size_t)t->used * t->stride);
+    return bytes;
+}
+
+/*
+ * Checks the links of a loaded arena before anything follows them: every
+ * slot must be reached exactly once, either from the root with matching
+ * parent links or from the free list, and the node count must agree.
+ */
+static int _idx_validate(struct rbt_idx_tree* t)
+{
+    unsigned char* seen;
+    rbt_idx* stack;
+    size_t top = 0, nodes = 0, slots = 1;
+    rbt_idx i;
+    int ok = 0;
+    if (t->root >= t->used || t->free_head >= t->used) {
+        return 0;
+    }
+    seen = (unsigned char*)calloc(t->used, 1);
+    stack = (rbt_idx*)malloc((size_t)t->used * sizeof(rbt_idx));
+    if (seen == NULL || stack == NULL) {
+        goto done;
+    }
+    if (t->root != RBT_IDX_NIL) {
+        if (parent_of(t, t->root) != RBT_IDX_NIL) {
+            goto done;
+        }
+        stack[top++] = t->root;
+    }
+    while (top > 0) {
+        rbt_idx x = stack[--top];
+        rbt_idx kids[2];
+        int k;
+        if (seen[x] || L(t, x)->parent_color == RBT_IDX_FREE) {
+            goto done;
+        }
+        seen[x] = 1;
+        nodes++;
+        kids[0] = L(t, x)->left;
+        kids[1] = L(t, x)->right;
+        if (kids[0] == kids[1] && kids[0] != RBT_IDX_NIL) {
+            goto done;
+        }
+        for (k = 0; k < 2; k++) {
+            if (kids[k] == RBT_IDX_NIL) {
+                continue;
+            }
+            if (kids[k] >= t->used || seen[kids[k]] ||
+                parent_of(t, kids[k]) != x) {
+                goto done;
+            }
+            stack[top++] = kids[k];
+        }
+    }
+    for (i = t->free_head; i != RBT_IDX_NIL; i = L(t, i)->left) {
+        if (i >= t->used || seen[i] ||
+            L(t, i)->parent_color != RBT_IDX_FREE) {
+            goto done;
+        }
+        seen[i] = 1;
+        slots++;
+    }
+    ok = nodes == t->count && nodes + slots == t->used;
+done:
+    free(seen);
+    free(stack);
+    return ok;
+}
+
+struct rbt_idx_tree* rbt_idx_tree_load(const void* buf, size_t size,
+                                       rbt_node_compare cmp,
+                                       rbt_node_destruct dest)
+{
+    struct rbt_idx_image h;
+    struct rbt_idx_tree* t;
+    if (buf == NULL || size < sizeof(h)) {
+        return NULL;
+    }
+    memcpy(&h, buf, sizeof(h));
+    if (h.magic != RBT_IDX_MAGIC || h.used == 0 || h.key_size == 0 ||
+        size < sizeof(h) + (size_t)h.used * h.stride) {
+        return NULL;
+    }
+    t = rbt_idx_tree_create(h.key_size, cmp, dest);
+    if (t == NULL) {
+        return NULL;
+    }
+    if (t->stride != h.stride || t->key_off != h.key_off ||
+        _idx_grow(t, h.used) != rbt_status_success) {
+        rbt_idx_tree_destroy(t);
+        return NULL;
+    }
+    memcpy(t->arena, (const char*)buf + sizeof(h), (size_t)h.used * h.stride);
+    t->root = h.root;
+    t->free_head = h.free_head;
+    t->used = h.used;
+    t->count = h.count;
+    /* the sentinel's parent is scratch space during erase; reset it */
+    memset(L(t, RBT_IDX_NIL), 0, sizeof(struct rbt_idx_link));
+    L(t, RBT_IDX_NIL)->parent_color = RBT_IDX_BLACK;
+    if (!_idx_validate(t)) {
+        t->node_destruct = NULL;
+        rbt_idx_tree_destroy(t);
+        return NULL;
+    }
+    return t;
+}
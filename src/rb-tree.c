@@ -6,21 +6,40 @@
 #include <stdlib.h>
 #include <string.h>
 
-struct rbt_tree;
+/* number of searches rbt_tree_find_batch keeps in flight at once */
+#define RBT_BATCH_GROUP 16
 
+/*
+ * A node is its link followed directly by a copy of the key, in a single
+ * allocation. The key offset is rounded up to 8 so that keys holding
+ * doubles or 64-bit integers stay aligned on 32-bit targets as well.
+ */
 struct rbt_node {
-    struct rbt_node* left;
-    struct rbt_node* right;
-    struct rbt_node* parent;
-    rbt_color color;
-    void* key;
-    struct rbt_tree* tree;
+    struct rbt_link link;
 };
 
+#define RBT_KEY_OFFSET ((sizeof(struct rbt_node) + 7) & ~(size_t)7)
+#define rb_node(l) ((struct rbt_node*)(l))
+#define rb_key(n) ((void*)((char*)(n) + RBT_KEY_OFFSET))
+
+#define RBT_COLOR_BIT ((uintptr_t)1)
+#define RBT_NIL_BIT ((uintptr_t)2)
+#define RBT_FLAG_BITS (RBT_COLOR_BIT | RBT_NIL_BIT)
+
+#define rb_parent(x) ((struct rbt_link*)((x)->parent_color & ~RBT_FLAG_BITS))
+#define rb_color(x) ((rbt_color)((x)->parent_color & RBT_COLOR_BIT))
+#define rb_is_red(x) (rb_color(x) == rbt_red)
+#define rb_is_black(x) (rb_color(x) == rbt_black)
+#define rb_is_nil(x) (((x)->parent_color & RBT_NIL_BIT) != 0)
+#define rb_set_parent(x, p) \
+    ((x)->parent_color = (uintptr_t)(p) | ((x)->parent_color & RBT_FLAG_BITS))
+#define rb_set_color(x, c)                                            \
+    ((x)->parent_color = ((x)->parent_color & ~RBT_COLOR_BIT) |       \
+                         (uintptr_t)(c))
+
 struct rbt_tree {
-    struct rbt_node* root;
-    struct rbt_node* nil;
-    struct rbt_node sentinel;
+    struct rbt_root base;
+    struct rbt_link sentinel;
     int allow_dup;
     rbt_node_destruct node_destruct;
     rbt_node_compare node_compare;
@@ -28,114 +47,120 @@ struct rbt_tree {
     rbt_mem_release releaser;
 };
 
-static void debug_verify_properties(struct rbt_tree*);
-static void debug_verify_property_1(struct rbt_tree*, struct rbt_node*);
-static void debug_verify_property_2(struct rbt_tree*, struct rbt_node*);
-static int debug_node_color(struct rbt_tree*, struct rbt_node* n);
-static void debug_verify_property_4(struct rbt_tree*, struct rbt_node*);
-static void debug_verify_property_5(struct rbt_tree*, struct rbt_node*);
-static void debug_verify_property_5_helper(struct rbt_tree*, struct rbt_node*,
+static void debug_verify_properties(struct rbt_root*);
+static void debug_verify_property_1(struct rbt_root*, struct rbt_link*);
+static void debug_verify_property_2(struct rbt_root*, struct rbt_link*);
+static int debug_node_color(struct rbt_root*, struct rbt_link* n);
+static void debug_verify_property_4(struct rbt_root*, struct rbt_link*);
+static void debug_verify_property_5(struct rbt_root*, struct rbt_link*);
+static void debug_verify_property_5_helper(struct rbt_root*, struct rbt_link*,
                                            int, int*);
 
 int rbt_node_is_valid(const struct rbt_node* node)
 {
-    assert(node);
-    assert(node->tree);
-    return node && node != node->tree->nil;
+    return node && !rb_is_nil(&node->link);
 }
 
 rbt_color rbt_node_get_color(const struct rbt_node* node)
 {
     assert(node);
-    return node->color;
+    return rb_color(&node->link);
 }
 
 struct rbt_node* rbt_node_get_left(const struct rbt_node* node)
 {
     assert(node);
-    return node->left;
+    return rb_node(node->link.left);
 }
 
 struct rbt_node* rbt_node_get_right(const struct rbt_node* node)
 {
     assert(node);
-    return node->right;
+    return rb_node(node->link.right);
 }
 
 struct rbt_node* rbt_node_get_parent(const struct rbt_node* node)
 {
     assert(node);
-    return node->parent;
+    return rb_node(rb_parent(&node->link));
 }
 
 const void* rbt_node_get_key(const struct rbt_node* node)
 {
-    struct rbt_tree* tree;
     assert(node);
-    tree = node->tree;
-    assert(tree);
-    return (node != tree->nil) ? node->key : (void*)0;
+    return rb_is_nil(&node->link) ? (void*)0 : rb_key(node);
 }
 
-static void _do_node_destruct(struct rbt_node* node)
+static void _do_node_destruct(struct rbt_tree* tree, struct rbt_node* node)
 {
-    struct rbt_tree* tree;
-    assert(node);
-    tree = node->tree;
-    assert(tree);
-    if (node != tree->nil) {
-        if (tree->node_destruct) {
-            tree->node_destruct(node->key);
-        }
-    }
-    else {
-        assert(0);
+    assert(tree && node);
+    assert(&node->link != tree->base.nil);
+    if (tree->node_destruct) {
+        tree->node_destruct(rb_key(node));
     }
 }
 
-static void __left_rotate(struct rbt_tree* T, struct rbt_node* x)
+static void __left_rotate(struct rbt_root* T, struct rbt_link* x)
 {
-    struct rbt_node* y = x->right;
+    struct rbt_link* y = x->right;
+    struct rbt_link* xp = rb_parent(x);
     x->right = y->left;
     if (y->left != T->nil) {
-        y->left->parent = x;
+        rb_set_parent(y->left, x);
     }
-    y->parent = x->parent;
-    if (x->parent == T->nil) {
+    rb_set_parent(y, xp);
+    if (xp == T->nil) {
         T->root = y;
     }
-    else if (x == x->parent->left) {
-        x->parent->left = y;
+    else if (x == xp->left) {
+        xp->left = y;
     }
     else {
-        x->parent->right = y;
+        xp->right = y;
     }
     y->left = x;
-    x->parent = y;
+    rb_set_parent(x, y);
 }
 
-static void __right_rotate(struct rbt_tree* T, struct rbt_node* x)
+static void __right_rotate(struct rbt_root* T, struct rbt_link* x)
 {
-    struct rbt_node* y = x->left;
+    struct rbt_link* y = x->left;
+    struct rbt_link* xp = rb_parent(x);
     x->left = y->right;
     if (y->right != T->nil) {
-        y->right->parent = x;
+        rb_set_parent(y->right, x);
     }
-    y->parent = x->parent;
-    if (x->parent == T->nil) {
+    rb_set_parent(y, xp);
+    if (xp == T->nil) {
         T->root = y;
     }
-    else if (x == x->parent->right) {
-        x->parent->right = y;
+    else if (x == xp->right) {
+        xp->right = y;
     }
     else {
-        x->parent->left = y;
+        xp->left = y;
     }
     y->right = x;
-    x->parent = y;
+    rb_set_parent(x, y);
 }
 
-#define rb_sentinel(tree) &(tree)->sentinel
+void rbt_root_init(struct rbt_root* T, struct rbt_link* nil)
+{
+    assert(T);
+    assert(nil);
+    assert(((uintptr_t)nil & RBT_FLAG_BITS) == 0);
+    nil->left = nil;
+    nil->right = nil;
+    nil->parent_color = (uintptr_t)nil | RBT_NIL_BIT | (uintptr_t)rbt_black;
+    T->nil = nil;
+    T->root = nil;
+}
+
+int rbt_root_is_empty(const struct rbt_root* T)
+{
+    assert(T);
+    return (T->root == T->nil) ? 1 : 0;
+}
 
 struct rbt_tree* rbt_tree_create(rbt_mem_allocate allocator,
                                  rbt_mem_release releaser, int allow_dup,
@@ -150,17 +175,11 @@ struct rbt_tree* rbt_tree_create(rbt_mem_allocate allocator,
         tree->releaser = releaser;
         tree->node_compare = cmp;
         tree->node_destruct = dest;
-        tree->nil = rb_sentinel(tree);
-        tree->root = tree->nil;
-        tree->sentinel.left = tree->nil;
-        tree->sentinel.right = tree->nil;
-        tree->sentinel.parent = tree->nil;
-        tree->sentinel.tree = tree;
-        tree->sentinel.color = rbt_black;
+        rbt_root_init(&tree->base, &tree->sentinel);
         tree->allow_dup = allow_dup;
 
         /* make code checker happy */
-        debug_verify_properties(tree);
+        debug_verify_properties(&tree->base);
     }
 
     return tree;
@@ -169,85 +188,104 @@ struct rbt_tree* rbt_tree_create(rbt_mem_allocate allocator,
 struct rbt_node* rbt_tree_get_root(struct rbt_tree* tree)
 {
     assert(tree);
-    return tree->root;
+    return rb_node(tree->base.root);
 }
 
-static void __rb_insert_fixup(struct rbt_tree* T, struct rbt_node* z)
+static void __rb_insert_fixup(struct rbt_root* T, struct rbt_link* z)
 {
-    while (z->parent->color == rbt_red) {
-        if (z->parent == z->parent->parent->left) {
-            struct rbt_node* y = z->parent->parent->right;
-            if (y->color == rbt_red) {
-                z->parent->color = rbt_black;
-                y->color = rbt_black;
-                z->parent->parent->color = rbt_red;
-                z = z->parent->parent;
+    struct rbt_link *zp, *zpp, *y;
+    while (zp = rb_parent(z), rb_is_red(zp)) {
+        zpp = rb_parent(zp);
+        if (zp == zpp->left) {
+            y = zpp->right;
+            if (rb_is_red(y)) {
+                rb_set_color(zp, rbt_black);
+                rb_set_color(y, rbt_black);
+                rb_set_color(zpp, rbt_red);
+                z = zpp;
             }
             else {
-                if (z == z->parent->right) {
-                    z = z->parent;
+                if (z == zp->right) {
+                    z = zp;
                     __left_rotate(T, z);
+                    zp = rb_parent(z);
                 }
-                z->parent->color = rbt_black;
-                z->parent->parent->color = rbt_red;
-                __right_rotate(T, z->parent->parent);
+                rb_set_color(zp, rbt_black);
+                rb_set_color(zpp, rbt_red);
+                __right_rotate(T, zpp);
             }
         }
         else {
-            struct rbt_node* y = z->parent->parent->left;
-            if (y->color == rbt_red) {
-                z->parent->color = rbt_black;
-                y->color = rbt_black;
-                z->parent->parent->color = rbt_red;
-                z = z->parent->parent;
+            y = zpp->left;
+            if (rb_is_red(y)) {
+                rb_set_color(zp, rbt_black);
+                rb_set_color(y, rbt_black);
+                rb_set_color(zpp, rbt_red);
+                z = zpp;
             }
             else {
-                if (z == z->parent->left) {
-                    z = z->parent;
+                if (z == zp->left) {
+                    z = zp;
                     __right_rotate(T, z);
+                    zp = rb_parent(z);
                 }
-                z->parent->color = rbt_black;
-                z->parent->parent->color = rbt_red;
-                __left_rotate(T, z->parent->parent);
+                rb_set_color(zp, rbt_black);
+                rb_set_color(zpp, rbt_red);
+                __left_rotate(T, zpp);
             }
         }
     }
-    T->root->color = rbt_black;
+    rb_set_color(T->root, rbt_black);
+}
+
+void rbt_link_insert(struct rbt_root* T, struct rbt_link* parent,
+                     struct rbt_link** where, struct rbt_link* z)
+{
+    assert(T && parent && where && z);
+    assert(*where == T->nil);
+    assert(parent != T->nil || where == &T->root);
+    assert(((uintptr_t)z & RBT_FLAG_BITS) == 0);
+    z->parent_color = (uintptr_t)parent | (uintptr_t)rbt_red;
+    z->left = T->nil;
+    z->right = T->nil;
+    *where = z;
+    __rb_insert_fixup(T, z);
 }
 
 #if 1
 
 struct rbt_node* rbt_tree_find(struct rbt_tree* tree, const void* key)
 {
-    struct rbt_node* x;
+    struct rbt_link* x;
     int c = 0;
     assert(tree);
     assert(key);
-    x = tree->root;
-    while ((x != tree->nil) && (c = tree->node_compare(key, x->key)) != 0) {
+    x = tree->base.root;
+    while ((x != tree->base.nil) &&
+           (c = tree->node_compare(key, rb_key(x))) != 0) {
         x = (c < 0) ? x->left : x->right;
     }
-    return x;
+    return rb_node(x);
 }
 
 #else
 
-static struct rbt_node* __tree_search(struct rbt_node* x, const void* k)
+static struct rbt_link* __tree_search(struct rbt_tree* tree,
+                                      struct rbt_link* x, const void* k)
 {
-    struct rbt_tree* tree;
     int cmp;
     assert(x);
     assert(k);
-    tree = x->tree;
     assert(tree->node_compare);
-    if (x == tree->nil || (cmp = tree->node_compare(k, x->key)) == 0) {
+    if (x == tree->base.nil ||
+        (cmp = tree->node_compare(k, rb_key(x))) == 0) {
         return x;
     }
     if (cmp < 0) {
-        return __tree_search(x->left, k);
+        return __tree_search(tree, x->left, k);
     }
     else {
-        return __tree_search(x->right, k);
+        return __tree_search(tree, x->right, k);
     }
 }
 
@@ -255,88 +293,111 @@ struct rbt_node* rbt_tree_find(struct rbt_tree* tree, const void* key)
 {
     assert(tree);
     assert(key);
-    return __tree_search(tree->root, key);
+    return rb_node(__tree_search(tree, tree->base.root, key));
 }
 
 #endif
 
-static struct rbt_node* _create_node(struct rbt_tree* tree, void* key, size_t s)
+/*
+ * Walks up to RBT_BATCH_GROUP searches down the tree in lockstep: each round
+ * advances every unfinished search by one level and prefetches the node it
+ * moved to, so the cache misses of the different searches overlap instead
+ * of being paid one after the other.
+ */
+static void __tree_find_group(struct rbt_tree* tree, const void* const keys[],
+                              size_t n, struct rbt_node* out[])
+{
+    char done[RBT_BATCH_GROUP];
+    struct rbt_link* nil = tree->base.nil;
+    size_t i, active = n;
+    assert(n <= RBT_BATCH_GROUP);
+    for (i = 0; i < n; ++i) {
+        out[i] = rb_node(tree->base.root);
+        done[i] = 0;
+    }
+    while (active != 0) {
+        for (i = 0; i < n; ++i) {
+            struct rbt_link* x = &out[i]->link;
+            int c;
+            if (done[i]) {
+                continue;
+            }
+            if (x == nil ||
+                (c = tree->node_compare(keys[i], rb_key(x))) == 0) {
+                done[i] = 1;
+                --active;
+                continue;
+            }
+            x = (c < 0) ? x->left : x->right;
+            cstl_prefetch(x);
+            out[i] = rb_node(x);
+        }
+    }
+}
+
+void rbt_tree_find_batch(struct rbt_tree* tree, const void* const keys[],
+                         size_t n, struct rbt_node* out[])
+{
+    size_t i, group;
+    assert(tree);
+    assert(n == 0 || (keys && out));
+    for (i = 0; i < n; i += group) {
+        group = (n - i < RBT_BATCH_GROUP) ? n - i : RBT_BATCH_GROUP;
+        __tree_find_group(tree, keys + i, group, out + i);
+    }
+}
+
+struct rbt_node* rbt_node_create(rbt_mem_allocate allocator, const void* key,
+                                 size_t size)
 {
-    struct rbt_node* node = (struct rbt_node*)tree->allocator(sizeof(*node));
+    struct rbt_node* node;
+    assert(allocator && key && size);
+    node = (struct rbt_node*)allocator(RBT_KEY_OFFSET + size);
     if (node) {
-        node->left = tree->nil;
-        node->right = tree->nil;
-        node->color = rbt_red;
-        node->parent = tree->nil;
-        node->tree = tree;
-
-        assert(key && s);
-        node->key = tree->allocator(s * sizeof(char));
-        if (node->key == NULL) {
-            tree->releaser(node);
-            node = NULL;
-        }
-        else {
-            memcpy(node->key, key, s);
-        }
+        rbt_link_init(&node->link);
+        memcpy(rb_key(node), key, size);
     }
+    return node;
+}
+
+static struct rbt_node* _create_node(struct rbt_tree* tree, void* key, size_t s)
+{
+    struct rbt_node* node = rbt_node_create(tree->allocator, key, s);
     assert(node);
     return node;
 }
 
-static void _node_destroy(struct rbt_node* node)
+static void _node_destroy(struct rbt_tree* tree, struct rbt_node* node)
 {
     assert(node);
     if (node) {
-        struct rbt_tree* tree = node->tree;
-        _do_node_destruct(node);
-        tree->releaser(node->key);
-        node->key = NULL;
+        _do_node_destruct(tree, node);
         tree->releaser(node);
     }
 }
 
-static int _rb_node_compare(struct rbt_node* lhs, struct rbt_node* rhs)
+static void __rb_insert(struct rbt_tree* tree, struct rbt_node* z)
 {
-    struct rbt_tree* tree = lhs->tree;
-    assert(tree == rhs->tree);
-    return tree->node_compare(lhs->key, rhs->key);
-}
-
-static void __rb_insert(struct rbt_tree* T, struct rbt_node* z)
-{
-    struct rbt_node* y = T->nil;
-    struct rbt_node* x = T->root;
-    while (x != T->nil) {
-        y = x;
-        if (_rb_node_compare(z, x) < 0) {
-            x = x->left;
+    struct rbt_root* T = &tree->base;
+    struct rbt_link* y = T->nil;
+    struct rbt_link** where = &T->root;
+    while (*where != T->nil) {
+        y = *where;
+        if (tree->node_compare(rb_key(z), rb_key(y)) < 0) {
+            where = &y->left;
         }
         else {
-            x = x->right;
+            where = &y->right;
         }
     }
-    z->parent = y;
-    if (y == T->nil) {
-        T->root = z;
-    }
-    else if (_rb_node_compare(z, y) < 0) {
-        y->left = z;
-    }
-    else {
-        y->right = z;
-    }
-    z->left = T->nil;
-    z->right = T->nil;
-    z->color = rbt_red;
-    __rb_insert_fixup(T, z);
+    rbt_link_insert(T, y, where, &z->link);
 }
 
 rbt_status rbt_tree_insert(struct rbt_tree* tree, void* key, size_t size)
 {
     struct rbt_node* x;
     if (tree->allow_dup == 0) {
-        if (rbt_tree_find(tree, key) != tree->nil) {
+        if (&rbt_tree_find(tree, key)->link != tree->base.nil) {
             return rbt_status_key_duplicate;
         }
     }
@@ -347,101 +408,118 @@ rbt_status rbt_tree_insert(struct rbt_tree* tree, void* key, size_t size)
     __rb_insert(tree, x);
 
 #ifndef NDEBUG
-    debug_verify_properties(tree);
+    debug_verify_properties(&tree->base);
+#endif
+    return rbt_status_success;
+}
+
+rbt_status rbt_tree_insert_node(struct rbt_tree* tree, struct rbt_node* node)
+{
+    assert(tree && node);
+    if (tree->allow_dup == 0) {
+        if (&rbt_tree_find(tree, rb_key(node))->link != tree->base.nil) {
+            return rbt_status_key_duplicate;
+        }
+    }
+    __rb_insert(tree, node);
+
+#ifndef NDEBUG
+    debug_verify_properties(&tree->base);
 #endif
     return rbt_status_success;
 }
 
-static void __rb_delete_fixup(struct rbt_tree* T, struct rbt_node* x)
+static void __rb_delete_fixup(struct rbt_root* T, struct rbt_link* x)
 {
-    while (x != T->root && x->color == rbt_black) {
-        if (x == x->parent->left) {
-            struct rbt_node* w = x->parent->right;
-            if (w->color == rbt_red) {
-                w->color = rbt_black;
-                x->parent->color = rbt_red;
-                __left_rotate(T, x->parent);
-                w = x->parent->right;
+    struct rbt_link *xp, *w;
+    while (x != T->root && rb_is_black(x)) {
+        xp = rb_parent(x);
+        if (x == xp->left) {
+            w = xp->right;
+            if (rb_is_red(w)) {
+                rb_set_color(w, rbt_black);
+                rb_set_color(xp, rbt_red);
+                __left_rotate(T, xp);
+                w = xp->right;
             }
-            if (w->left->color == rbt_black && w->right->color == rbt_black) {
-                w->color = rbt_red;
-                x = x->parent;
+            if (rb_is_black(w->left) && rb_is_black(w->right)) {
+                rb_set_color(w, rbt_red);
+                x = xp;
             }
             else {
-                if (w->right->color == rbt_black) {
-                    w->left->color = rbt_black;
-                    w->color = rbt_red;
+                if (rb_is_black(w->right)) {
+                    rb_set_color(w->left, rbt_black);
+                    rb_set_color(w, rbt_red);
                     __right_rotate(T, w);
-                    w = x->parent->right;
+                    w = xp->right;
                 }
-                w->color = x->parent->color;
-                x->parent->color = rbt_black;
-                w->right->color = rbt_black;
-                __left_rotate(T, x->parent);
+                rb_set_color(w, rb_color(xp));
+                rb_set_color(xp, rbt_black);
+                rb_set_color(w->right, rbt_black);
+                __left_rotate(T, xp);
                 x = T->root;
             }
         }
         else {
-            struct rbt_node* w = x->parent->left;
-            if (w->color == rbt_red) {
-                w->color = rbt_black;
-                x->parent->color = rbt_red;
-                __right_rotate(T, x->parent);
-                w = x->parent->left;
+            w = xp->left;
+            if (rb_is_red(w)) {
+                rb_set_color(w, rbt_black);
+                rb_set_color(xp, rbt_red);
+                __right_rotate(T, xp);
+                w = xp->left;
             }
-            if (w->right->color == rbt_black && w->left->color == rbt_black) {
-                w->color = rbt_red;
-                x = x->parent;
+            if (rb_is_black(w->right) && rb_is_black(w->left)) {
+                rb_set_color(w, rbt_red);
+                x = xp;
             }
             else {
-                if (w->left->color == rbt_black) {
-                    w->right->color = rbt_black;
-                    w->color = rbt_red;
+                if (rb_is_black(w->left)) {
+                    rb_set_color(w->right, rbt_black);
+                    rb_set_color(w, rbt_red);
                     __left_rotate(T, w);
-                    w = x->parent->left;
+                    w = xp->left;
                 }
-                w->color = x->parent->color;
-                x->parent->color = rbt_black;
-                w->left->color = rbt_black;
-                __right_rotate(T, x->parent);
+                rb_set_color(w, rb_color(xp));
+                rb_set_color(xp, rbt_black);
+                rb_set_color(w->left, rbt_black);
+                __right_rotate(T, xp);
                 x = T->root;
             }
         }
     }
-    x->color = rbt_black;
+    rb_set_color(x, rbt_black);
 }
 
-static void __rb_transplant(struct rbt_tree* T, struct rbt_node* u,
-                            struct rbt_node* v)
+static void __rb_transplant(struct rbt_root* T, struct rbt_link* u,
+                            struct rbt_link* v)
 {
-    if (u->parent == T->nil) {
+    struct rbt_link* up = rb_parent(u);
+    if (up == T->nil) {
         T->root = v;
     }
-    else if (u == u->parent->left) {
-        u->parent->left = v;
+    else if (u == up->left) {
+        up->left = v;
     }
     else {
-        u->parent->right = v;
+        up->right = v;
     }
-    v->parent = u->parent;
+    rb_set_parent(v, up);
 }
 
-struct rbt_node* __tree_minimum(struct rbt_node* x)
+static struct rbt_link* __tree_minimum(struct rbt_root* T, struct rbt_link* x)
 {
-    struct rbt_tree* T;
     assert(x);
-    T = x->tree;
-    assert(T);
     while (x->left != T->nil) {
         x = x->left;
     }
     return x;
 }
 
-static void __rb_delete(struct rbt_tree* T, struct rbt_node* z)
+void rbt_link_erase(struct rbt_root* T, struct rbt_link* z)
 {
-    struct rbt_node *x, *y = z;
-    rbt_color y_original_color = y->color;
+    struct rbt_link *x, *y = z;
+    rbt_color y_original_color = rb_color(y);
+    assert(T && z && z != T->nil);
     if (z->left == T->nil) {
         x = z->right;
         __rb_transplant(T, z, z->right);
@@ -451,21 +529,21 @@ static void __rb_delete(struct rbt_tree* T, struct rbt_node* z)
         __rb_transplant(T, z, z->left);
     }
     else {
-        y = __tree_minimum(z->right);
-        y_original_color = y->color;
+        y = __tree_minimum(T, z->right);
+        y_original_color = rb_color(y);
         x = y->right;
-        if (y->parent == z) {
-            x->parent = y;
+        if (rb_parent(y) == z) {
+            rb_set_parent(x, y);
         }
         else {
             __rb_transplant(T, y, y->right);
             y->right = z->right;
-            y->right->parent = y;
+            rb_set_parent(y->right, y);
         }
         __rb_transplant(T, z, y);
         y->left = z->left;
-        y->left->parent = y;
-        y->color = z->color;
+        rb_set_parent(y->left, y);
+        rb_set_color(y, rb_color(z));
     }
     if (y_original_color == rbt_black) {
         __rb_delete_fixup(T, x);
@@ -475,74 +553,178 @@ static void __rb_delete(struct rbt_tree* T, struct rbt_node* z)
 rbt_status rbt_tree_remove_node(struct rbt_tree* tree, const void* key)
 {
     struct rbt_node* z = rbt_tree_find(tree, key);
-    if (z == tree->nil) {
+    if (&z->link == tree->base.nil) {
         return rbt_status_key_not_exist;
     }
-    __rb_delete(tree, z);
-    _node_destroy(z);
+    rbt_link_erase(&tree->base, &z->link);
+    _node_destroy(tree, z);
 
 #ifndef NDEBUG
-    debug_verify_properties(tree);
+    debug_verify_properties(&tree->base);
 #endif
     return rbt_status_success;
 }
 
-#if 1
-
-rbt_status rbt_tree_destroy(struct rbt_tree* tree)
+/* post-order walk, so a link is released only after both of its subtrees */
+void rbt_root_clear(struct rbt_root* T, rbt_link_release release, void* p)
 {
-    rbt_status rc = rbt_status_success;
-    struct rbt_node* z = tree->root;
-
-    while (z != tree->nil) {
-        if (z->left != tree->nil) {
+    struct rbt_link* z;
+    assert(T);
+    z = T->root;
+    while (z != T->nil) {
+        if (z->left != T->nil) {
             z = z->left;
         }
-        else if (z->right != tree->nil) {
+        else if (z->right != T->nil) {
             z = z->right;
         }
         else {
-            if (z->parent != tree->nil) {
-                z = z->parent;
-                if (z->left != tree->nil) {
-                    _node_destroy(z->left);
-                    z->left = tree->nil;
+            struct rbt_link* parent = rb_parent(z);
+            if (parent != T->nil) {
+                if (parent->left == z) {
+                    parent->left = T->nil;
                 }
-                else if (z->right != tree->nil) {
-                    _node_destroy(z->right);
-                    z->right = tree->nil;
+                else {
+                    parent->right = T->nil;
                 }
             }
-            else {
-                _node_destroy(z);
-                z = tree->nil;
+            if (release) {
+                release(z, p);
             }
+            z = parent;
+        }
+    }
+    T->root = T->nil;
+}
+
+void rbt_link_init(struct rbt_link* link)
+{
+    assert(link);
+    link->left = NULL;
+    link->right = NULL;
+    link->parent_color = 0;
+}
+
+int rbt_link_is_linked(const struct rbt_link* link)
+{
+    assert(link);
+    return link->parent_color != 0;
+}
+
+void rbt_intrusive_init(struct rbt_intrusive_tree* tree, rbt_link_compare cmp,
+                        int allow_dup)
+{
+    assert(tree && cmp);
+    rbt_root_init(&tree->base, &tree->nil);
+    tree->compare = cmp;
+    tree->count = 0;
+    tree->allow_dup = allow_dup;
+}
+
+rbt_status rbt_intrusive_insert(struct rbt_intrusive_tree* tree,
+                                struct rbt_link* link)
+{
+    struct rbt_root* T = &tree->base;
+    struct rbt_link* parent = T->nil;
+    struct rbt_link** where = &T->root;
+    assert(tree && link);
+    assert(!rbt_link_is_linked(link));
+    while (*where != T->nil) {
+        int c = tree->compare(link, *where);
+        if (c == 0 && !tree->allow_dup) {
+            return rbt_status_key_duplicate;
         }
+        parent = *where;
+        where = (c < 0) ? &parent->left : &parent->right;
+    }
+    rbt_link_insert(T, parent, where, link);
+    tree->count++;
+    return rbt_status_success;
+}
+
+void rbt_intrusive_erase(struct rbt_intrusive_tree* tree,
+                         struct rbt_link* link)
+{
+    assert(tree && link);
+    assert(rbt_link_is_linked(link));
+    rbt_link_erase(&tree->base, link);
+    rbt_link_init(link);
+    tree->count--;
+}
+
+struct rbt_link* rbt_intrusive_find(struct rbt_intrusive_tree* tree,
+                                    const struct rbt_link* probe)
+{
+    struct rbt_link* x;
+    int c;
+    assert(tree && probe);
+    x = tree->base.root;
+    while (x != tree->base.nil && (c = tree->compare(probe, x)) != 0) {
+        x = (c < 0) ? x->left : x->right;
     }
+    return (x != tree->base.nil) ? x : NULL;
+}
+
+struct rbt_link* rbt_intrusive_lower_bound(struct rbt_intrusive_tree* tree,
+                                           const struct rbt_link* probe)
+{
+    struct rbt_link *x, *result = NULL;
+    assert(tree && probe);
+    x = tree->base.root;
+    while (x != tree->base.nil) {
+        if (tree->compare(x, probe) >= 0) {
+            result = x;
+            x = x->left;
+        }
+        else {
+            x = x->right;
+        }
+    }
+    return result;
+}
+
+void rbt_intrusive_clear(struct rbt_intrusive_tree* tree,
+                         rbt_link_release release, void* p)
+{
+    assert(tree);
+    rbt_root_clear(&tree->base, release, p);
+    tree->count = 0;
+}
+
+#if 1
+
+static void _node_release(struct rbt_link* link, void* p)
+{
+    _node_destroy((struct rbt_tree*)p, rb_node(link));
+}
+
+rbt_status rbt_tree_destroy(struct rbt_tree* tree)
+{
+    rbt_status rc = rbt_status_success;
+    rbt_root_clear(&tree->base, _node_release, tree);
     tree->releaser(tree);
     return rc;
 }
 
 #else
 
-void _rbt_node_destroy_recurse(struct rbt_node* node)
+void _rbt_node_destroy_recurse(struct rbt_tree* tree, struct rbt_link* node)
 {
-    struct rbt_tree* tree = node->tree;
-    if (node != tree->nil) {
-        if (node->left != tree->nil) {
-            _rbt_node_destroy_recurse(node->left);
+    if (node != tree->base.nil) {
+        if (node->left != tree->base.nil) {
+            _rbt_node_destroy_recurse(tree, node->left);
         }
-        if (node->right != tree->nil) {
-            _rbt_node_destroy_recurse(node->right);
+        if (node->right != tree->base.nil) {
+            _rbt_node_destroy_recurse(tree, node->right);
         }
-        _node_destroy(node);
+        _node_destroy(tree, rb_node(node));
     }
 }
 
 rbt_status rbt_tree_destroy(struct rbt_tree* tree)
 {
     if (tree) {
-        _rbt_node_destroy_recurse(tree->root);
+        _rbt_node_destroy_recurse(tree, tree->base.root);
         tree->releaser(tree);
     }
     return rbt_status_success;
@@ -552,20 +734,17 @@ rbt_status rbt_tree_destroy(struct rbt_tree* tree)
 
 struct rbt_node* rbt_tree_minimum(struct rbt_tree* tree, struct rbt_node* x)
 {
-    (void)tree;
-    return __tree_minimum(x);
+    assert(tree);
+    return rb_node(__tree_minimum(&tree->base, &x->link));
 }
 
-struct rbt_node* __tree_maximum(struct rbt_node* x)
+static struct rbt_link* __tree_maximum(struct rbt_root* T, struct rbt_link* x)
 {
-    struct rbt_tree* tree;
     assert(x);
-    tree = x->tree;
-    assert(tree);
-    if (x == NULL || x == tree->nil) {
+    if (x == NULL || x == T->nil) {
         return x;
     }
-    while (x->right != tree->nil) {
+    while (x->right != T->nil) {
         x = x->right;
     }
     return x;
@@ -573,48 +752,89 @@ struct rbt_node* __tree_maximum(struct rbt_node* x)
 
 struct rbt_node* rbt_tree_maximum(struct rbt_tree* tree, struct rbt_node* x)
 {
-    (void)tree;
-    return __tree_maximum(x);
+    assert(tree);
+    return rb_node(__tree_maximum(&tree->base, &x->link));
 }
 
 int rbt_tree_is_empty(struct rbt_tree* tree)
 {
     assert(tree);
-    return (tree->root == tree->nil) ? 1 : 0;
+    return rbt_root_is_empty(&tree->base);
 }
 
-struct rbt_node* rbt_tree_successor(struct rbt_tree* tree, struct rbt_node* x)
+static struct rbt_link* __tree_successor(struct rbt_root* T,
+                                         struct rbt_link* x)
 {
-    struct rbt_node* y;
-    assert(tree);
-    assert(x);
-    y = tree->nil;
-    if (x->right != tree->nil) {
-        return __tree_minimum(x->right);
+    struct rbt_link* y;
+    if (x->right != T->nil) {
+        return __tree_minimum(T, x->right);
     }
-    if (x == __tree_maximum(tree->root)) {
-        return tree->nil;
+    y = rb_parent(x);
+    while ((y != T->nil) && (x == y->right)) {
+        x = y;
+        y = rb_parent(y);
     }
-    y = x->parent;
-    while ((y != tree->nil) && (x == y->right)) {
+    return y;
+}
+
+static struct rbt_link* __tree_predecessor(struct rbt_root* T,
+                                           struct rbt_link* x)
+{
+    struct rbt_link* y;
+    if (x->left != T->nil) {
+        return __tree_maximum(T, x->left);
+    }
+    y = rb_parent(x);
+    while ((y != T->nil) && (x == y->left)) {
         x = y;
-        y = y->parent;
+        y = rb_parent(y);
     }
     return y;
 }
 
-static void _inorder_tree_walk(struct rbt_node* x, rbt_node_walk_cb cb, void* p)
+struct rbt_node* rbt_tree_successor(struct rbt_tree* tree, struct rbt_node* x)
 {
-    struct rbt_tree* tree;
-    assert(x);
-    tree = x->tree;
     assert(tree);
-    if (x != tree->nil) {
-        _inorder_tree_walk(x->left, cb, p);
+    assert(x);
+    return rb_node(__tree_successor(&tree->base, &x->link));
+}
+
+struct rbt_link* rbt_link_first(struct rbt_root* T)
+{
+    assert(T);
+    return (T->root != T->nil) ? __tree_minimum(T, T->root) : NULL;
+}
+
+struct rbt_link* rbt_link_last(struct rbt_root* T)
+{
+    assert(T);
+    return (T->root != T->nil) ? __tree_maximum(T, T->root) : NULL;
+}
+
+struct rbt_link* rbt_link_next(struct rbt_root* T, struct rbt_link* x)
+{
+    assert(T && x && x != T->nil);
+    x = __tree_successor(T, x);
+    return (x != T->nil) ? x : NULL;
+}
+
+struct rbt_link* rbt_link_prev(struct rbt_root* T, struct rbt_link* x)
+{
+    assert(T && x && x != T->nil);
+    x = __tree_predecessor(T, x);
+    return (x != T->nil) ? x : NULL;
+}
+
+static void _inorder_tree_walk(struct rbt_root* T, struct rbt_link* x,
+                               rbt_node_walk_cb cb, void* p)
+{
+    assert(x);
+    if (x != T->nil) {
+        _inorder_tree_walk(T, x->left, cb, p);
         if (cb) {
-            cb(x, p);
+            cb(rb_node(x), p);
         }
-        _inorder_tree_walk(x->right, cb, p);
+        _inorder_tree_walk(T, x->right, cb, p);
     }
 }
 
@@ -622,7 +842,16 @@ void rbt_inorder_walk(struct rbt_tree* tree, rbt_node_walk_cb cb, void* p)
 {
     assert(tree);
     assert(cb);
-    _inorder_tree_walk(tree->root, cb, p);
+    _inorder_tree_walk(&tree->base, tree->base.root, cb, p);
+}
+
+void rbt_tree_dissolve(struct rbt_tree* tree, rbt_node_walk_cb cb, void* p)
+{
+    assert(tree);
+    if (cb) {
+        _inorder_tree_walk(&tree->base, tree->base.root, cb, p);
+    }
+    tree->releaser(tree);
 }
 
 /*
@@ -655,7 +884,7 @@ cstl_rb_get_next(struct rbt_tree* tree, struct rbt_node**current, struct rbt_nod
     return tree->nil;
 } */
 
-void debug_verify_properties(struct rbt_tree* t)
+void debug_verify_properties(struct rbt_root* t)
 {
     debug_verify_property_1(t, t->root);
     debug_verify_property_2(t, t->root);
@@ -663,36 +892,39 @@ void debug_verify_properties(struct rbt_tree* t)
     debug_verify_property_5(t, t->root);
 }
 
-void debug_verify_property_1(struct rbt_tree* tree, struct rbt_node* n)
+void debug_verify_property_1(struct rbt_root* tree, struct rbt_link* n)
 {
     if (n == tree->nil) {
         return;
     }
     assert(debug_node_color(tree, n) == rbt_red ||
            debug_node_color(tree, n) == rbt_black);
+    assert(!rb_is_nil(n));
+    assert(n->left == tree->nil || rb_parent(n->left) == n);
+    assert(n->right == tree->nil || rb_parent(n->right) == n);
     debug_verify_property_1(tree, n->left);
     debug_verify_property_1(tree, n->right);
 }
 
-void debug_verify_property_2(struct rbt_tree* tree, struct rbt_node* root)
+void debug_verify_property_2(struct rbt_root* tree, struct rbt_link* root)
 {
     (void)tree;
     (void)root;
     assert(debug_node_color(tree, root) == rbt_black);
 }
 
-int debug_node_color(struct rbt_tree* tree, struct rbt_node* n)
+int debug_node_color(struct rbt_root* tree, struct rbt_link* n)
 {
     (void)tree;
-    return (n == tree->nil) ? rbt_black : n->color;
+    return (n == tree->nil) ? rbt_black : rb_color(n);
 }
 
-void debug_verify_property_4(struct rbt_tree* tree, struct rbt_node* n)
+void debug_verify_property_4(struct rbt_root* tree, struct rbt_link* n)
 {
     if (debug_node_color(tree, n) == rbt_red) {
         assert(debug_node_color(tree, n->left) == rbt_black);
         assert(debug_node_color(tree, n->right) == rbt_black);
-        assert(debug_node_color(tree, n->parent) == rbt_black);
+        assert(debug_node_color(tree, rb_parent(n)) == rbt_black);
     }
     if (n == tree->nil) {
         return;
@@ -701,13 +933,13 @@ void debug_verify_property_4(struct rbt_tree* tree, struct rbt_node* n)
     debug_verify_property_4(tree, n->right);
 }
 
-void debug_verify_property_5(struct rbt_tree* tree, struct rbt_node* root)
+void debug_verify_property_5(struct rbt_root* tree, struct rbt_link* root)
 {
     int black_count_path = -1;
     debug_verify_property_5_helper(tree, root, 0, &black_count_path);
 }
 
-void debug_verify_property_5_helper(struct rbt_tree* tree, struct rbt_node* n,
+void debug_verify_property_5_helper(struct rbt_root* tree, struct rbt_link* n,
                                     int black_count, int* _black_count)
 {
     if (debug_node_color(tree, n) == rbt_black) {
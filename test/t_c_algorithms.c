@@ -193,7 +193,62 @@ static void t_cstl_for_each(void)
     cstl_list_delete_iterator(pListIterator);
 }
 
+static void count_elements(const void* value, const void* key, void* p)
+{
+    (void)value;
+    (void)key;
+    ++*(size_t*)p;
+}
+
+static void t_cstl_for_each_stack_iterator(void)
+{
+    struct cstl_array* pArray;
+    struct cstl_deque* pDeq;
+    struct cstl_set* pSet;
+    struct cstl_map* pMap;
+    struct cstl_list* pList;
+    struct cstl_iterator itr;
+    size_t count;
+
+    printf("Performing for_each with caller-owned iterators\n");
+    pArray = create_c_array();
+    count = 0;
+    cstl_array_iterator_init(&itr, pArray);
+    cstl_for_each(&itr, count_elements, &count);
+    assert(count == cstl_array_size(pArray));
+    cstl_array_delete(pArray);
+
+    pDeq = create_deque();
+    count = 0;
+    cstl_deque_iterator_init(&itr, pDeq);
+    cstl_for_each(&itr, count_elements, &count);
+    assert(count == cstl_deque_size(pDeq));
+    cstl_deque_delete(pDeq);
+
+    pSet = create_set();
+    count = 0;
+    cstl_set_iterator_init(&itr, pSet);
+    cstl_for_each(&itr, count_elements, &count);
+    assert(count == 10);
+    cstl_set_delete(pSet);
+
+    pMap = create_map();
+    count = 0;
+    cstl_map_iterator_init(&itr, pMap);
+    cstl_for_each(&itr, count_elements, &count);
+    assert(count == 26);
+    cstl_map_delete(pMap);
+
+    pList = create_slist();
+    count = 0;
+    cstl_list_iterator_init(&itr, pList);
+    cstl_for_each(&itr, count_elements, &count);
+    assert(count == cstl_list_size(pList));
+    cstl_list_destroy(pList);
+}
+
 void test_c_algorithms()
 {
     t_cstl_for_each();
+    t_cstl_for_each_stack_iterator();
 }
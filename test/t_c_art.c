@@ -0,0 +1,355 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CAND_MAX 1024
+#define BYTES_KEY 20
+
+/* every key a test may use, sorted in the tree's order */
+struct candidates {
+    unsigned char key[CAND_MAX][BYTES_KEY];
+    int present[CAND_MAX];
+    size_t n;
+    size_t key_size;
+};
+
+static int destroyed;
+
+static void on_destroy(void* value)
+{
+    (void)value;
+    destroyed++;
+}
+
+static int compare_u64(const void* lhs, const void* rhs)
+{
+    uint64_t a, b;
+    memcpy(&a, lhs, sizeof(a));
+    memcpy(&b, rhs, sizeof(b));
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static int compare_bytes(const void* lhs, const void* rhs)
+{
+    return memcmp(lhs, rhs, BYTES_KEY);
+}
+
+static void sort_unique(struct candidates* c, cstl_compare cmp)
+{
+    size_t i, out = 0;
+    qsort(c->key, c->n, sizeof(c->key[0]), cmp);
+    for (i = 0; i < c->n; i++) {
+        if (out == 0 || cmp(c->key[out - 1], c->key[i]) != 0) {
+            memmove(c->key[out++], c->key[i], sizeof(c->key[0]));
+        }
+    }
+    c->n = out;
+    memset(c->present, 0, sizeof(c->present));
+}
+
+static void add_u64(struct candidates* c, uint64_t v)
+{
+    memcpy(c->key[c->n++], &v, sizeof(v));
+}
+
+static uint64_t random_u64(void)
+{
+    uint64_t v = 0;
+    int i;
+    for (i = 0; i < 4; i++) {
+        v = (v << 16) ^ (uint64_t)(rand() & 0xFFFF);
+    }
+    return v;
+}
+
+/* first present candidate at or after i */
+static const unsigned char* expected_from(struct candidates* c, size_t i)
+{
+    for (; i < c->n; i++) {
+        if (c->present[i]) {
+            return c->key[i];
+        }
+    }
+    return NULL;
+}
+
+static void check_contents(struct cstl_art* art, struct candidates* c)
+{
+    struct cstl_iterator* itr = cstl_art_new_iterator(art);
+    const void* key;
+    size_t i, count = 0;
+
+    for (i = 0; i < c->n; i++) {
+        const int* v = (const int*)cstl_art_find(art, c->key[i]);
+        assert(cstl_art_is_key_exists(art, c->key[i]) == c->present[i]);
+        if (c->present[i]) {
+            assert(v && *v == (int)i);
+            count++;
+        }
+        else {
+            assert(v == NULL);
+        }
+        key = cstl_art_lower_bound(art, c->key[i]);
+        if (expected_from(c, i) == NULL) {
+            assert(key == NULL);
+        }
+        else {
+            assert(key && memcmp(key, expected_from(c, i), c->key_size) == 0);
+            assert(*(const int*)cstl_art_value(art, key) ==
+                   (int)(expected_from(c, i) - c->key[0]) / BYTES_KEY);
+        }
+    }
+    assert(cstl_art_size(art) == count);
+
+    i = 0;
+    while ((key = itr->next(itr)) != NULL) {
+        const unsigned char* want = expected_from(c, i);
+        assert(want && memcmp(key, want, c->key_size) == 0);
+        assert(itr->current_key(itr) == key);
+        i = (size_t)(want - c->key[0]) / BYTES_KEY;
+        assert(*(const int*)itr->current_value(itr) == (int)i);
+        i++;
+    }
+    assert(expected_from(c, i) == NULL);
+    cstl_art_delete_iterator(itr);
+}
+
+/* random inserts, removes and replaces, checked against the candidates */
+static void run_random(struct candidates* c, cstl_art_key_kind kind,
+                       int ops)
+{
+    struct cstl_art* art = cstl_art_new(c->key_size, kind, on_destroy);
+    int op, values = 0;
+
+    destroyed = 0;
+    for (op = 0; op < ops; op++) {
+        size_t i = (size_t)rand() % c->n;
+        int v = (int)i;
+        int r = rand() % 8;
+        if (r < 4) {
+            cstl_error rc = cstl_art_insert(art, c->key[i], &v, sizeof(v));
+            assert(rc == (c->present[i] ? CSTL_RBTREE_KEY_DUPLICATE
+                                        : CSTL_ERROR_SUCCESS));
+            values += !c->present[i];
+            c->present[i] = 1;
+        }
+        else if (r < 7) {
+            cstl_error rc = cstl_art_remove(art, c->key[i]);
+            assert(rc == (c->present[i] ? CSTL_ERROR_SUCCESS
+                                        : CSTL_RBTREE_KEY_NOT_FOUND));
+            c->present[i] = 0;
+        }
+        else {
+            cstl_error rc = cstl_art_replace(art, c->key[i], &v, sizeof(v));
+            assert(rc == (c->present[i] ? CSTL_ERROR_SUCCESS
+                                        : CSTL_RBTREE_KEY_NOT_FOUND));
+            values += c->present[i];
+        }
+        if (op % 997 == 0) {
+            check_contents(art, c);
+        }
+    }
+    check_contents(art, c);
+    cstl_art_delete(art);
+    assert(destroyed == values);
+}
+
+/* dense runs, sparse strides, random values and the extremes */
+static void test_art_u64(void)
+{
+    static struct candidates c;
+    int i;
+    c.n = 0;
+    c.key_size = sizeof(uint64_t);
+    for (i = 0; i < 300; i++) {
+        add_u64(&c, (uint64_t)i);
+    }
+    for (i = 0; i < 60; i++) {
+        add_u64(&c, ((uint64_t)1 << 56) + (uint64_t)i * 0x10000);
+        add_u64(&c, 1000 + (uint64_t)i * 3);
+    }
+    for (i = 0; i < 300; i++) {
+        add_u64(&c, random_u64());
+    }
+    add_u64(&c, ~(uint64_t)0);
+    add_u64(&c, ~(uint64_t)0 - 1);
+    sort_unique(&c, compare_u64);
+    run_random(&c, CSTL_ART_KEY_UINT, 40000);
+}
+
+/* 20-byte keys sharing paths longer than a node stores */
+static void test_art_bytes(void)
+{
+    static struct candidates c;
+    int i;
+    c.n = 0;
+    c.key_size = BYTES_KEY;
+    for (i = 0; i < 600; i++) {
+        unsigned char* k = c.key[c.n++];
+        memset(k, 'a', BYTES_KEY);
+        k[2] = (unsigned char)(rand() % 2);
+        k[13] = (unsigned char)(rand() % 3);
+        k[16] = (unsigned char)(rand() % 4);
+        k[19] = (unsigned char)(rand() % 40);
+    }
+    sort_unique(&c, compare_bytes);
+    run_random(&c, CSTL_ART_KEY_BYTES, 30000);
+}
+
+static void test_art_small_keys(void)
+{
+    struct cstl_art* art = cstl_art_new(sizeof(uint32_t), CSTL_ART_KEY_UINT,
+                                        NULL);
+    struct cstl_iterator itr;
+    uint32_t k, prev = 0;
+    const void* key;
+    int n = 0;
+
+    assert(cstl_art_new(3, CSTL_ART_KEY_UINT, NULL) == NULL);
+    assert(cstl_art_new(0, CSTL_ART_KEY_BYTES, NULL) == NULL);
+    assert(cstl_art_lower_bound(art, &prev) == NULL);
+
+    /* numeric order, not byte order */
+    for (k = 0; k < 70000; k += 7) {
+        assert(cstl_art_insert(art, &k, NULL, 0) == CSTL_ERROR_SUCCESS);
+    }
+    k = 258;
+    key = cstl_art_lower_bound(art, &k);
+    assert(key && *(const uint32_t*)key == 259);
+    assert(cstl_art_value(art, key) == NULL);
+
+    /* range scan from a seek, removing keys ahead of the iterator */
+    cstl_art_iterator_init(&itr, art);
+    k = 65000;
+    cstl_art_iterator_seek(&itr, &k);
+    while ((key = itr.next(&itr)) != NULL) {
+        uint32_t cur = *(const uint32_t*)key;
+        uint32_t ahead = cur + 7;
+        assert(cur >= 65000 && (n == 0 || cur == prev + 14));
+        cstl_art_remove(art, &ahead);
+        prev = cur;
+        n++;
+    }
+    assert(n == (int)((69999 - 65002) / 14 + 1));
+
+    k = 70000;
+    cstl_art_iterator_seek(&itr, &k);
+    assert(itr.next(&itr) == NULL);
+    assert(itr.next(&itr) == NULL);
+    cstl_art_delete(art);
+}
+
+/* nodes shrinking step by step, and paths merging as nodes collapse */
+static void test_art_shrink(void)
+{
+    uint64_t nested[4];
+    struct cstl_art* art = cstl_art_new(sizeof(uint64_t), CSTL_ART_KEY_UINT,
+                                        NULL);
+    const void* lb;
+    uint64_t k;
+    size_t i;
+
+    nested[0] = (uint64_t)1 << 56;
+    nested[1] = nested[0] + 1;
+    nested[2] = nested[0] + 0x100;
+    nested[3] = nested[0] + 0x10000;
+
+    for (k = 0; k < 256; k++) {
+        cstl_art_insert(art, &k, &k, sizeof(k));
+    }
+    for (k = 255; k > 0; k--) {
+        uint64_t probe = k / 2;
+        assert(cstl_art_remove(art, &k) == CSTL_ERROR_SUCCESS);
+        assert(*(const uint64_t*)cstl_art_find(art, &probe) == probe);
+        assert(cstl_art_find(art, &k) == NULL);
+        probe = k;
+        assert(cstl_art_lower_bound(art, &probe) == NULL);
+    }
+    k = 0;
+    assert(cstl_art_remove(art, &k) == CSTL_ERROR_SUCCESS);
+    assert(cstl_art_size(art) == 0 && cstl_art_find(art, &k) == NULL);
+
+    for (i = 0; i < 4; i++) {
+        cstl_art_insert(art, &nested[i], &nested[i], sizeof(uint64_t));
+    }
+    for (i = 4; i-- > 1;) {
+        size_t j;
+        assert(cstl_art_remove(art, &nested[i]) == CSTL_ERROR_SUCCESS);
+        for (j = 0; j < 4; j++) {
+            const void* v = cstl_art_find(art, &nested[j]);
+            assert(j < i ? (v && *(const uint64_t*)v == nested[j])
+                         : v == NULL);
+        }
+        k = nested[0] + 1;
+        lb = cstl_art_lower_bound(art, &k);
+        assert(i > 1 ? (lb && *(const uint64_t*)lb == nested[1]) : !lb);
+    }
+    cstl_art_delete(art);
+}
+
+/* 2-byte keys in numeric order, values replaced through the iterator */
+static void test_art_iterator_replace(void)
+{
+    struct cstl_art* art = cstl_art_new(sizeof(unsigned short),
+                                        CSTL_ART_KEY_UINT, on_destroy);
+    struct cstl_iterator* itr = cstl_art_new_iterator(art);
+    unsigned short k, prev = 0;
+    int v, n = 0;
+
+    destroyed = 0;
+    for (k = 0; k < 600; k += 3) {
+        v = k;
+        cstl_art_insert(art, &k, &v, sizeof(v));
+    }
+    while (itr->next(itr)) {
+        k = *(const unsigned short*)itr->current_key(itr);
+        assert(n == 0 || k == prev + 3);
+        v = -k;
+        itr->replace_current_value(itr, &v, sizeof(v));
+        prev = k;
+        n++;
+    }
+    assert(n == 200 && destroyed == 200);
+    k = 300;
+    assert(*(const int*)cstl_art_find(art, &k) == -300);
+    cstl_art_delete_iterator(itr);
+    cstl_art_delete(art);
+    assert(destroyed == 400);
+}
+
+void test_c_art(void)
+{
+    test_art_u64();
+    test_art_bytes();
+    test_art_small_keys();
+    test_art_shrink();
+    test_art_iterator_replace();
+}
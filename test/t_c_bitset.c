@@ -0,0 +1,188 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REF_BITS 1100
+
+/* the bitset must match ref[0..n) and read as clear past n */
+static void check_against(struct cstl_bitset* bs, const char* ref, size_t n)
+{
+    size_t i, count = 0, next = CSTL_BITSET_NPOS, next_clear = CSTL_BITSET_NPOS;
+
+    assert(cstl_bitset_size(bs) == n);
+    for (i = n; i-- > 0;) {
+        assert(cstl_bitset_test(bs, i) == ref[i]);
+        if (ref[i]) {
+            next = i;
+            count++;
+        }
+        else {
+            next_clear = i;
+        }
+        assert(cstl_bitset_find_next_set(bs, i) == next);
+        assert(cstl_bitset_find_next_clear(bs, i) == next_clear);
+    }
+    assert(cstl_bitset_find_first_set(bs) == next);
+    assert(cstl_bitset_popcount(bs) == count);
+    assert(cstl_bitset_test(bs, n) == 0);
+    assert(cstl_bitset_find_next_set(bs, n) == CSTL_BITSET_NPOS);
+}
+
+static void random_fill(struct cstl_bitset* bs, char* ref, size_t n,
+                        int density)
+{
+    size_t i;
+    cstl_bitset_clear_all(bs);
+    for (i = 0; i < n; i++) {
+        ref[i] = (char)(rand() % 100 < density);
+        if (ref[i]) {
+            cstl_bitset_set(bs, i);
+        }
+    }
+}
+
+/* sizes around word and vector boundaries */
+static const size_t sizes[] = {0, 1, 63, 64, 65, 127, 128, 129, 255, 256,
+                               257, 511, 1000, REF_BITS};
+
+static void test_bitset_single_bits(void)
+{
+    static char ref[REF_BITS];
+    size_t s;
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        struct cstl_bitset* bs = cstl_bitset_new(n);
+        int op;
+        memset(ref, 0, sizeof(ref));
+        check_against(bs, ref, n);
+        for (op = 0; n && op < 3000; op++) {
+            size_t i = (size_t)rand() % n;
+            switch (rand() % 3) {
+            case 0:
+                assert(cstl_bitset_set(bs, i) == CSTL_ERROR_SUCCESS);
+                ref[i] = 1;
+                break;
+            case 1:
+                assert(cstl_bitset_clear(bs, i) == CSTL_ERROR_SUCCESS);
+                ref[i] = 0;
+                break;
+            default:
+                assert(cstl_bitset_flip(bs, i) == CSTL_ERROR_SUCCESS);
+                ref[i] = (char)!ref[i];
+                break;
+            }
+        }
+        check_against(bs, ref, n);
+        assert(cstl_bitset_set(bs, n) == CSTL_BITSET_INDEX_OUT_OF_BOUND);
+        assert(cstl_bitset_flip(bs, n) == CSTL_BITSET_INDEX_OUT_OF_BOUND);
+        cstl_bitset_delete(bs);
+    }
+}
+
+static void test_bitset_bulk(void)
+{
+    static char a[REF_BITS], b[REF_BITS], want[REF_BITS];
+    size_t s, t, i, op;
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (t = 0; t < sizeof(sizes) / sizeof(sizes[0]); t += 3) {
+            size_t na = sizes[s], nb = sizes[t];
+            struct cstl_bitset* x = cstl_bitset_new(na);
+            struct cstl_bitset* y = cstl_bitset_new(nb);
+            for (op = 0; op < 4; op++) {
+                random_fill(x, a, na, 50);
+                random_fill(y, b, nb, 30);
+                for (i = 0; i < na; i++) {
+                    char other = (char)(i < nb ? b[i] : 0);
+                    switch (op) {
+                    case 0:
+                        want[i] = (char)(a[i] & other);
+                        break;
+                    case 1:
+                        want[i] = (char)(a[i] | other);
+                        break;
+                    case 2:
+                        want[i] = (char)(a[i] ^ other);
+                        break;
+                    default:
+                        want[i] = (char)(a[i] & !other);
+                        break;
+                    }
+                }
+                switch (op) {
+                case 0:
+                    assert(cstl_bitset_and(x, y) == CSTL_ERROR_SUCCESS);
+                    break;
+                case 1:
+                    assert(cstl_bitset_or(x, y) == CSTL_ERROR_SUCCESS);
+                    break;
+                case 2:
+                    assert(cstl_bitset_xor(x, y) == CSTL_ERROR_SUCCESS);
+                    break;
+                default:
+                    assert(cstl_bitset_andnot(x, y) == CSTL_ERROR_SUCCESS);
+                    break;
+                }
+                check_against(x, want, na);
+            }
+            cstl_bitset_delete(x);
+            cstl_bitset_delete(y);
+        }
+    }
+}
+
+static void test_bitset_resize(void)
+{
+    static char ref[REF_BITS];
+    struct cstl_bitset* bs = cstl_bitset_new(300);
+    random_fill(bs, ref, 300, 60);
+
+    /* shrinking drops bits for good; growing brings back zeros */
+    assert(cstl_bitset_resize(bs, 70) == CSTL_ERROR_SUCCESS);
+    check_against(bs, ref, 70);
+    assert(cstl_bitset_resize(bs, REF_BITS) == CSTL_ERROR_SUCCESS);
+    memset(ref + 70, 0, REF_BITS - 70);
+    check_against(bs, ref, REF_BITS);
+
+    /* slot allocation: take the lowest free slot */
+    cstl_bitset_clear_all(bs);
+    assert(cstl_bitset_find_first_set(bs) == CSTL_BITSET_NPOS);
+    cstl_bitset_set(bs, 0);
+    cstl_bitset_set(bs, 1);
+    cstl_bitset_set(bs, 3);
+    assert(cstl_bitset_find_next_clear(bs, 0) == 2);
+    assert(cstl_bitset_delete(bs) == CSTL_ERROR_SUCCESS);
+}
+
+void test_c_bitset(void)
+{
+    test_bitset_single_bits();
+    test_bitset_bulk();
+    test_bitset_resize();
+}
@@ -0,0 +1,202 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static size_t compares;
+
+static int compare_ints(const void* a, const void* b)
+{
+    int x = *(const int*)a, y = *(const int*)b;
+    compares++;
+    return x < y ? -1 : x > y;
+}
+
+static void test_bloom_filter(void)
+{
+    struct cstl_bloom* b = cstl_bloom_new(10000, 10);
+    int i, positives = 0;
+
+    for (i = 0; i < 10000; i++) {
+        cstl_bloom_add(b, &i, sizeof(i));
+    }
+    for (i = 0; i < 10000; i++) {
+        assert(cstl_bloom_may_contain(b, &i, sizeof(i)));
+    }
+    for (i = 10000; i < 110000; i++) {
+        positives += cstl_bloom_may_contain(b, &i, sizeof(i));
+    }
+    /* about 1% at 10 bits per key; blocking costs a little on top */
+    assert(positives < 2500);
+    assert(cstl_bloom_capacity(b) == 10000);
+
+    cstl_bloom_clear(b);
+    for (i = 0; i < 10000; i++) {
+        assert(!cstl_bloom_may_contain(b, &i, sizeof(i)));
+    }
+    cstl_bloom_add_hash(b, 42);
+    assert(cstl_bloom_may_contain_hash(b, 42));
+    assert(cstl_bloom_delete(b) == CSTL_ERROR_SUCCESS);
+    assert(cstl_bloom_delete(NULL) == CSTL_BLOOM_NOT_INITIALIZED);
+
+    /* the smallest filter still works */
+    b = cstl_bloom_new(0, 0);
+    cstl_bloom_add_hash(b, 7);
+    assert(cstl_bloom_may_contain_hash(b, 7));
+    cstl_bloom_delete(b);
+}
+
+static void test_bloom_set(void)
+{
+    struct cstl_set* s = cstl_set_new(compare_ints, NULL);
+    const void* keys[300];
+    const void* out[300];
+    int values[300];
+    int i;
+    size_t misses;
+
+    assert(cstl_set_bloom(NULL, sizeof(int), NULL, 10) ==
+           CSTL_SET_NOT_INITIALIZED);
+    /* keys present before the filter are added to it */
+    for (i = 0; i < 5; i++) {
+        cstl_set_insert(s, &i, sizeof(i));
+    }
+    assert(cstl_set_bloom(s, sizeof(int), NULL, 10) == CSTL_ERROR_SUCCESS);
+    /* the filter grows past the size it started with */
+    for (i = 5; i < 20000; i += 2) {
+        assert(cstl_set_insert(s, &i, sizeof(i)) == CSTL_ERROR_SUCCESS);
+    }
+    for (i = 0; i < 20000; i++) {
+        int present = i < 5 || i % 2 == 1;
+        assert(cstl_set_is_key_exists(s, &i) == present);
+    }
+
+    /* misses mostly stop at the filter */
+    compares = 0;
+    for (i = 20000; i < 30000; i++) {
+        assert(cstl_set_find(s, &i) == NULL);
+    }
+    misses = compares;
+    cstl_set_bloom(s, sizeof(int), NULL, 0);
+    compares = 0;
+    for (i = 20000; i < 30000; i++) {
+        assert(cstl_set_find(s, &i) == NULL);
+    }
+    assert(misses * 10 < compares);
+    assert(cstl_set_bloom(s, sizeof(int), NULL, 10) == CSTL_ERROR_SUCCESS);
+
+    for (i = 0; i < 300; i++) {
+        values[i] = i * 97;
+        keys[i] = &values[i];
+    }
+    misses = cstl_set_find_batch(s, keys, 300, out);
+    for (i = 0; i < 300; i++) {
+        int present = values[i] < 5 || (values[i] < 20000 && values[i] % 2);
+        assert((out[i] != NULL) == present);
+        assert(!present || *(const int*)out[i] == values[i]);
+    }
+
+    /* removed keys are gone, with or without a rebuild */
+    for (i = 1; i < 20000; i += 4) {
+        assert(cstl_set_remove(s, &i) == CSTL_ERROR_SUCCESS);
+    }
+    for (i = 1; i < 20000; i += 4) {
+        assert(!cstl_set_is_key_exists(s, &i));
+    }
+    assert(cstl_set_bloom_rebuild(s) == CSTL_ERROR_SUCCESS);
+    for (i = 0; i < 20000; i++) {
+        int present = i < 5 ? i != 1 : i % 4 == 3;
+        assert(cstl_set_is_key_exists(s, &i) == present);
+    }
+    cstl_set_delete(s);
+}
+
+static void test_bloom_map(void)
+{
+    struct cstl_map* m = cstl_map_new(compare_ints, NULL, NULL);
+    const void* keys[64];
+    const void* out[64];
+    int values[64];
+    int i;
+    size_t misses;
+
+    assert(cstl_map_bloom(m, sizeof(int), cstl_hash_bytes, 8) ==
+           CSTL_ERROR_SUCCESS);
+    /* small, then a tree */
+    for (i = 0; i < 3; i++) {
+        int v = -i;
+        cstl_map_insert(m, &i, sizeof(i), &v, sizeof(v));
+        assert(*(const int*)cstl_map_find(m, &i) == -i);
+    }
+    for (i = 3; i < 10000; i++) {
+        int v = -i;
+        assert(cstl_map_insert(m, &i, sizeof(i), &v, sizeof(v)) ==
+               CSTL_ERROR_SUCCESS);
+    }
+    assert(cstl_map_insert(m, &i, sizeof(i), &i, sizeof(i)) ==
+           CSTL_ERROR_SUCCESS);
+    assert(cstl_map_insert(m, &i, sizeof(i), &i, sizeof(i)) ==
+           CSTL_RBTREE_KEY_DUPLICATE);
+    for (i = 0; i < 10000; i++) {
+        assert(*(const int*)cstl_map_find(m, &i) == -i);
+    }
+    compares = 0;
+    for (i = 10001; i < 20000; i++) {
+        assert(cstl_map_find(m, &i) == NULL);
+    }
+    misses = compares;
+    assert(misses < 10000);
+
+    for (i = 0; i < 64; i++) {
+        values[i] = i * 331;
+        keys[i] = &values[i];
+    }
+    assert(cstl_map_find_batch(m, keys, 64, out) == 31);
+    for (i = 0; i < 64; i++) {
+        assert(values[i] < 10000 ? *(const int*)out[i] == -values[i]
+                                 : out[i] == NULL);
+    }
+
+    for (i = 0; i < 10000; i += 2) {
+        cstl_map_remove(m, &i);
+    }
+    assert(cstl_map_bloom_rebuild(m) == CSTL_ERROR_SUCCESS);
+    for (i = 0; i < 10000; i++) {
+        assert((cstl_map_find(m, &i) != NULL) == (i % 2));
+    }
+    assert(cstl_map_bloom_rebuild(NULL) == CSTL_MAP_NOT_INITIALIZED);
+    cstl_map_delete(m);
+}
+
+void test_c_bloom(void)
+{
+    test_bloom_filter();
+    test_bloom_set();
+    test_bloom_map();
+}
@@ -0,0 +1,197 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+static int compare_int(const void* lhs, const void* rhs)
+{
+    int a = *(const int*)lhs;
+    int b = *(const int*)rhs;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static int compare_name(const void* lhs, const void* rhs)
+{
+    return strcmp((const char*)lhs, (const char*)rhs);
+}
+
+struct acl_rule {
+    unsigned int action;
+    unsigned int hits;
+};
+
+static int values_destroyed;
+
+static void rule_destroy(void* p)
+{
+    (void)p;
+    values_destroyed++;
+}
+
+/* checks that m holds exactly the keys flagged in present, in order */
+static void check_map(struct cstl_flat_map* m, const char* present, int n)
+{
+    size_t i = 0;
+    int k;
+    for (k = 0; k < n; k++) {
+        struct acl_rule* r = (struct acl_rule*)cstl_flat_map_find(m, &k);
+        if (!present[k]) {
+            assert(r == NULL);
+            continue;
+        }
+        assert(r && r->action == (unsigned int)k * 2);
+        assert(*(const int*)cstl_flat_map_key_at(m, i) == k);
+        assert(cstl_flat_map_value_at(m, i) == r);
+        assert(cstl_flat_map_lower_bound(m, &k) == i);
+        i++;
+    }
+    assert(i == cstl_flat_map_size(m));
+}
+
+static void test_flat_map(void)
+{
+    enum { N = 3000, RANGE = 5000 };
+    int* keys = (int*)malloc(N * sizeof(int));
+    struct acl_rule* rules =
+        (struct acl_rule*)malloc(N * sizeof(struct acl_rule));
+    char present[RANGE];
+    struct cstl_flat_map* m;
+    struct acl_rule r;
+    int i, k;
+
+    m = cstl_flat_map_new(sizeof(int), sizeof(struct acl_rule), compare_int,
+                          NULL, rule_destroy);
+    memset(present, 0, sizeof(present));
+    for (i = 0; i < N; i++) {
+        keys[i] = rand() % RANGE;
+        rules[i].action = (unsigned int)keys[i] * 2;
+        /* duplicates: only the first one given may be kept */
+        rules[i].hits = present[keys[i]] ? 1 : 0;
+        present[keys[i]] = 1;
+    }
+    assert(cstl_flat_map_build(m, keys, rules, N) == CSTL_ERROR_SUCCESS);
+    check_map(m, present, RANGE);
+    for (i = 0; i < (int)cstl_flat_map_size(m); i++) {
+        assert(((struct acl_rule*)cstl_flat_map_value_at(m, i))->hits == 0);
+    }
+
+    /* a batch merges in, leaving keys already present alone */
+    for (i = 0; i < N; i++) {
+        keys[i] = rand() % (RANGE + 1000);
+        rules[i].action = (unsigned int)keys[i] * 2;
+        rules[i].hits = 0;
+    }
+    for (i = 0; i < N; i++) {
+        if (keys[i] >= RANGE) {
+            keys[i] = RANGE - 1;
+            rules[i].action = (RANGE - 1) * 2;
+        }
+    }
+    assert(cstl_flat_map_insert_batch(m, keys, rules, N) ==
+           CSTL_ERROR_SUCCESS);
+    for (i = 0; i < N; i++) {
+        present[keys[i]] = 1;
+    }
+    check_map(m, present, RANGE);
+
+    /* single-element updates */
+    values_destroyed = 0;
+    for (k = 0; k < RANGE; k += 7) {
+        if (present[k]) {
+            assert(cstl_flat_map_remove(m, &k) == CSTL_ERROR_SUCCESS);
+            present[k] = 0;
+        }
+        else {
+            r.action = (unsigned int)k * 2;
+            r.hits = 0;
+            assert(cstl_flat_map_insert(m, &k, &r) == CSTL_ERROR_SUCCESS);
+            assert(cstl_flat_map_insert(m, &k, &r) ==
+                   CSTL_RBTREE_KEY_DUPLICATE);
+            present[k] = 1;
+        }
+    }
+    check_map(m, present, RANGE);
+    k = -1;
+    assert(cstl_flat_map_remove(m, &k) == CSTL_RBTREE_KEY_NOT_FOUND);
+    assert(cstl_flat_map_lower_bound(m, &k) == 0);
+    k = RANGE;
+    assert(cstl_flat_map_lower_bound(m, &k) == cstl_flat_map_size(m));
+    assert(cstl_flat_map_key_at(m, cstl_flat_map_size(m)) == NULL);
+
+    k = values_destroyed + (int)cstl_flat_map_size(m);
+    cstl_flat_map_delete(m);
+    assert(values_destroyed == k);
+    free(keys);
+    free(rules);
+}
+
+static void test_flat_set(void)
+{
+    static const char* suites[] = { "TLS_CHACHA20_POLY1305_SHA256",
+                                    "TLS_AES_128_GCM_SHA256",
+                                    "TLS_AES_256_GCM_SHA384",
+                                    "TLS_AES_128_GCM_SHA256" };
+    char name[32];
+    struct cstl_flat_set* s =
+        cstl_flat_set_new(sizeof(name), compare_name, NULL);
+    char table[4][32];
+    size_t i;
+
+    for (i = 0; i < 4; i++) {
+        memset(table[i], 0, sizeof(table[i]));
+        strcpy(table[i], suites[i]);
+    }
+    assert(cstl_flat_set_build(s, table, 4) == CSTL_ERROR_SUCCESS);
+    assert(cstl_flat_set_size(s) == 3);
+    assert(strcmp((const char*)cstl_flat_set_key_at(s, 0),
+                  "TLS_AES_128_GCM_SHA256") == 0);
+    assert(strcmp((const char*)cstl_flat_set_key_at(s, 2),
+                  "TLS_CHACHA20_POLY1305_SHA256") == 0);
+
+    memset(name, 0, sizeof(name));
+    strcpy(name, "TLS_AES_256_GCM_SHA384");
+    assert(cstl_flat_set_find(s, name) == cstl_flat_set_key_at(s, 1));
+    assert(cstl_flat_set_remove(s, name) == CSTL_ERROR_SUCCESS);
+    assert(cstl_flat_set_find(s, name) == NULL);
+    assert(cstl_flat_set_insert(s, name) == CSTL_ERROR_SUCCESS);
+    assert(cstl_flat_set_lower_bound(s, name) == 1);
+    assert(cstl_flat_set_insert_batch(s, table, 4) == CSTL_ERROR_SUCCESS);
+    assert(cstl_flat_set_size(s) == 3);
+    cstl_flat_set_clear(s);
+    assert(cstl_flat_set_size(s) == 0);
+    cstl_flat_set_delete(s);
+}
+
+void test_c_flat_map(void)
+{
+    assert(cstl_flat_map_new(0, 4, compare_int, NULL, NULL) == NULL);
+    assert(cstl_flat_map_delete(NULL) == CSTL_FLAT_MAP_NOT_INITIALIZED);
+    test_flat_map();
+    test_flat_set();
+}
@@ -0,0 +1,135 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_ilist.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+struct conn {
+    int fd;
+    struct cstl_ilist_node idle;
+    struct cstl_ilist_node write_queue;
+};
+
+static void check_order(struct cstl_ilist* list, const int* fds, size_t n,
+                        int by_write)
+{
+    struct cstl_ilist_node* node;
+    size_t i = 0;
+    cstl_ilist_for_each(node, list)
+    {
+        struct conn* c = by_write
+                             ? cstl_ilist_entry(node, struct conn, write_queue)
+                             : cstl_ilist_entry(node, struct conn, idle);
+        assert(i < n && c->fd == fds[i]);
+        i++;
+    }
+    assert(i == n && cstl_ilist_size(list) == n);
+    /* and backwards */
+    for (node = cstl_ilist_back(list); node;
+         node = cstl_ilist_prev(list, node)) {
+        i--;
+    }
+    assert(i == 0);
+}
+
+void test_c_ilist(void)
+{
+    struct conn conns[6];
+    struct cstl_ilist idle, writers, other;
+    struct cstl_ilist_node *node, *tmp;
+    int i;
+
+    cstl_ilist_init(&idle);
+    cstl_ilist_init(&writers);
+    cstl_ilist_init(&other);
+    assert(cstl_ilist_empty(&idle) && cstl_ilist_front(&idle) == NULL);
+    assert(cstl_ilist_pop_back(&idle) == NULL);
+
+    for (i = 0; i < 6; i++) {
+        conns[i].fd = i;
+        cstl_ilist_node_init(&conns[i].idle);
+        cstl_ilist_node_init(&conns[i].write_queue);
+        assert(!cstl_ilist_node_is_linked(&conns[i].idle));
+        cstl_ilist_push_back(&idle, &conns[i].idle);
+    }
+    {
+        int fds[] = { 0, 1, 2, 3, 4, 5 };
+        check_order(&idle, fds, 6, 0);
+    }
+
+    /* membership on a second list is independent */
+    cstl_ilist_push_front(&writers, &conns[3].write_queue);
+    cstl_ilist_push_front(&writers, &conns[1].write_queue);
+    cstl_ilist_insert_after(&conns[1].write_queue, &conns[5].write_queue);
+    cstl_ilist_insert_before(&conns[1].write_queue, &conns[0].write_queue);
+    {
+        int fds[] = { 0, 1, 5, 3 };
+        check_order(&writers, fds, 4, 1);
+    }
+
+    /* O(1) unlink of a known element, then unlink again is harmless */
+    cstl_ilist_unlink(&conns[2].idle);
+    cstl_ilist_unlink(&conns[2].idle);
+    assert(!cstl_ilist_node_is_linked(&conns[2].idle));
+    node = cstl_ilist_pop_front(&idle);
+    assert(cstl_ilist_entry(node, struct conn, idle)->fd == 0);
+    node = cstl_ilist_pop_back(&idle);
+    assert(cstl_ilist_entry(node, struct conn, idle)->fd == 5);
+    {
+        int fds[] = { 1, 3, 4 };
+        check_order(&idle, fds, 3, 0);
+    }
+
+    /* splice */
+    cstl_ilist_push_back(&other, &conns[0].idle);
+    cstl_ilist_push_back(&other, &conns[5].idle);
+    cstl_ilist_splice(&conns[3].idle, &other);
+    assert(cstl_ilist_empty(&other));
+    {
+        int fds[] = { 1, 0, 5, 3, 4 };
+        check_order(&idle, fds, 5, 0);
+    }
+    cstl_ilist_push_back(&other, &conns[2].idle);
+    cstl_ilist_splice_front(&idle, &other);
+    cstl_ilist_splice_back(&idle, &other); /* empty: no-op */
+    {
+        int fds[] = { 2, 1, 0, 5, 3, 4 };
+        check_order(&idle, fds, 6, 0);
+    }
+
+    cstl_ilist_for_each_safe(node, tmp, &idle)
+    {
+        if (cstl_ilist_entry(node, struct conn, idle)->fd % 2) {
+            cstl_ilist_unlink(node);
+        }
+    }
+    {
+        int fds[] = { 2, 0, 4 };
+        check_order(&idle, fds, 3, 0);
+    }
+    assert(cstl_ilist_next(&idle, &conns[4].idle) == NULL);
+    assert(cstl_ilist_next(&idle, &conns[2].idle) == &conns[0].idle);
+}
@@ -0,0 +1,305 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PFX_MAX 300
+#define PROBES 400
+
+/* brute-force reference: candidate prefixes, masked, value = index */
+struct reference {
+    struct cstl_lpm_prefix pfx[PFX_MAX];
+    int present[PFX_MAX];
+    int value[PFX_MAX];
+    size_t n;
+    size_t addr_size;
+};
+
+static int destroyed;
+
+static void on_destroy(void* value)
+{
+    (void)value;
+    destroyed++;
+}
+
+static int prefix_contains(const unsigned char* net, unsigned int len,
+                           const unsigned char* addr)
+{
+    unsigned int i;
+    for (i = 0; i < len; i++) {
+        unsigned char bit = (unsigned char)(0x80 >> (i % 8));
+        if ((net[i / 8] & bit) != (addr[i / 8] & bit)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void random_bytes(unsigned char* out, size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i++) {
+        out[i] = (unsigned char)rand();
+    }
+}
+
+/* clears the bits past len */
+static void mask(unsigned char* addr, size_t size, unsigned int len)
+{
+    unsigned int i;
+    for (i = len; i < size * 8; i++) {
+        addr[i / 8] &= (unsigned char)~(0x80 >> (i % 8));
+    }
+}
+
+/* prefixes of all lengths, clustered in a few networks so they nest */
+static void make_reference(struct reference* ref, size_t addr_size)
+{
+    unsigned char nets[6][16];
+    size_t i, j;
+    memset(ref, 0, sizeof(*ref));
+    ref->addr_size = addr_size;
+    for (i = 0; i < 6; i++) {
+        random_bytes(nets[i], addr_size);
+    }
+    while (ref->n < PFX_MAX) {
+        struct cstl_lpm_prefix* p = &ref->pfx[ref->n];
+        unsigned int bits = (unsigned int)addr_size * 8;
+        unsigned int keep = (unsigned int)rand() % (bits + 1);
+        memcpy(p->addr, nets[rand() % 6], addr_size);
+        for (i = keep; i < bits; i++) {
+            if (rand() % 4 == 0) {
+                p->addr[i / 8] ^= (unsigned char)(0x80 >> (i % 8));
+            }
+        }
+        p->len = (unsigned char)(rand() % 3 ? keep : rand() % (bits + 1));
+        mask(p->addr, addr_size, p->len);
+        for (j = 0; j < ref->n; j++) {
+            if (ref->pfx[j].len == p->len &&
+                memcmp(ref->pfx[j].addr, p->addr, addr_size) == 0) {
+                break;
+            }
+        }
+        if (j == ref->n) {
+            ref->value[ref->n] = (int)ref->n;
+            p->value = &ref->value[ref->n];
+            p->value_size = sizeof(int);
+            ref->n++;
+        }
+    }
+}
+
+static int expected_match(struct reference* ref, const unsigned char* addr)
+{
+    int best = -1;
+    size_t i;
+    for (i = 0; i < ref->n; i++) {
+        if (ref->present[i] &&
+            prefix_contains(ref->pfx[i].addr, ref->pfx[i].len, addr) &&
+            (best < 0 || ref->pfx[i].len > ref->pfx[best].len)) {
+            best = (int)i;
+        }
+    }
+    return best;
+}
+
+/* an address inside a random candidate, or anywhere */
+static void random_probe(struct reference* ref, unsigned char* addr)
+{
+    random_bytes(addr, ref->addr_size);
+    if (rand() % 4) {
+        const struct cstl_lpm_prefix* p = &ref->pfx[rand() % ref->n];
+        unsigned int i;
+        for (i = 0; i < p->len; i++) {
+            unsigned char bit = (unsigned char)(0x80 >> (i % 8));
+            addr[i / 8] = (unsigned char)((addr[i / 8] & ~bit) |
+                                          (p->addr[i / 8] & bit));
+        }
+    }
+}
+
+static void check_lookups(struct cstl_lpm* lpm, struct reference* ref)
+{
+    static unsigned char addrs[PROBES][16];
+    const void* ptrs[PROBES];
+    const void* values[PROBES];
+    size_t i, matched = 0, found;
+
+    for (i = 0; i < PROBES; i++) {
+        unsigned int len = 999;
+        const int* v;
+        int want;
+        random_probe(ref, addrs[i]);
+        ptrs[i] = addrs[i];
+        want = expected_match(ref, addrs[i]);
+        v = (const int*)cstl_lpm_lookup(lpm, addrs[i], &len);
+        if (want < 0) {
+            assert(v == NULL && len == 999);
+        }
+        else {
+            assert(v && *v == want && len == ref->pfx[want].len);
+            matched++;
+        }
+    }
+    found = cstl_lpm_lookup_batch(lpm, ptrs, PROBES, values);
+    assert(found == matched);
+    for (i = 0; i < PROBES; i++) {
+        assert(values[i] == cstl_lpm_lookup(lpm, addrs[i], NULL));
+    }
+}
+
+static void run_family(cstl_lpm_family family, size_t addr_size)
+{
+    static struct reference ref;
+    struct cstl_lpm* lpm = cstl_lpm_new(family, on_destroy);
+    struct cstl_lpm* batch;
+    struct cstl_lpm_prefix* list;
+    size_t count = 0, n = 0, i;
+    int op, values = 0;
+
+    make_reference(&ref, addr_size);
+    destroyed = 0;
+    for (op = 0; op < 6000; op++) {
+        size_t k = (size_t)rand() % ref.n;
+        const struct cstl_lpm_prefix* p = &ref.pfx[k];
+        unsigned char noisy[16];
+        const int* v;
+
+        /* bits past the length must not matter */
+        memcpy(noisy, p->addr, addr_size);
+        if (p->len < addr_size * 8) {
+            noisy[addr_size - 1] ^= 1;
+        }
+        if (rand() % 3) {
+            cstl_error rc = cstl_lpm_insert(lpm, noisy, p->len, p->value,
+                                            p->value_size);
+            assert(rc == (ref.present[k] ? CSTL_RBTREE_KEY_DUPLICATE
+                                         : CSTL_ERROR_SUCCESS));
+            values += !ref.present[k];
+            count += !ref.present[k];
+            ref.present[k] = 1;
+        }
+        else {
+            cstl_error rc = cstl_lpm_remove(lpm, noisy, p->len);
+            assert(rc == (ref.present[k] ? CSTL_ERROR_SUCCESS
+                                         : CSTL_RBTREE_KEY_NOT_FOUND));
+            count -= ref.present[k];
+            ref.present[k] = 0;
+        }
+        v = (const int*)cstl_lpm_find(lpm, p->addr, p->len);
+        assert(ref.present[k] ? (v && *v == (int)k) : v == NULL);
+        assert(cstl_lpm_size(lpm) == count);
+        if (op % 250 == 0) {
+            check_lookups(lpm, &ref);
+        }
+    }
+    check_lookups(lpm, &ref);
+
+    /* a batch of the same prefixes, in any order and with repeats */
+    list = (struct cstl_lpm_prefix*)malloc((count + 1) *
+                                           sizeof(struct cstl_lpm_prefix));
+    for (i = ref.n; i-- > 0;) {
+        if (ref.present[i]) {
+            list[n++] = ref.pfx[i];
+        }
+    }
+    if (n) {
+        list[n] = list[0];
+        n++;
+    }
+    batch = cstl_lpm_new(family, NULL);
+    assert(cstl_lpm_insert_batch(batch, list, n) == CSTL_ERROR_SUCCESS);
+    assert(cstl_lpm_size(batch) == count);
+    for (op = 0; op < PROBES * 10; op++) {
+        unsigned char addr[16];
+        const int* v;
+        int want;
+        random_probe(&ref, addr);
+        v = (const int*)cstl_lpm_lookup(batch, addr, NULL);
+        want = expected_match(&ref, addr);
+        assert(want < 0 ? v == NULL : (v && *v == want));
+    }
+    cstl_lpm_delete(batch);
+    free(list);
+
+    assert(cstl_lpm_insert(lpm, ref.pfx[0].addr,
+                           (unsigned int)addr_size * 8 + 1, NULL,
+                           0) == CSTL_LPM_INVALID_INPUT);
+    cstl_lpm_delete(lpm);
+    assert(destroyed == values);
+}
+
+static void test_lpm_ipv4_basics(void)
+{
+    static const unsigned char any[4] = {0, 0, 0, 0};
+    static const unsigned char ten[4] = {10, 0, 0, 0};
+    static const unsigned char ten_one[4] = {10, 1, 0, 0};
+    static const unsigned char host[4] = {10, 1, 2, 3};
+    static const unsigned char other[4] = {10, 2, 0, 1};
+    struct cstl_lpm* lpm = cstl_lpm_new(CSTL_LPM_IPV4, NULL);
+    int route[4] = {0, 1, 2, 3};
+    unsigned int len;
+
+    assert(cstl_lpm_lookup(lpm, host, NULL) == NULL);
+    assert(cstl_lpm_insert(lpm, ten, 8, NULL, 0) == CSTL_LPM_INVALID_INPUT);
+    assert(cstl_lpm_insert(lpm, ten, 8, &route[1], 0) ==
+           CSTL_LPM_INVALID_INPUT);
+    assert(cstl_lpm_insert(lpm, ten, 8, NULL, sizeof(int)) ==
+           CSTL_LPM_INVALID_INPUT);
+    assert(cstl_lpm_size(lpm) == 0);
+    cstl_lpm_insert(lpm, ten, 8, &route[1], sizeof(int));
+    cstl_lpm_insert(lpm, host, 32, &route[3], sizeof(int));
+    cstl_lpm_insert(lpm, ten_one, 16, &route[2], sizeof(int));
+    cstl_lpm_insert(lpm, any, 0, &route[0], sizeof(int));
+
+    assert(*(const int*)cstl_lpm_lookup(lpm, host, &len) == 3 && len == 32);
+    assert(*(const int*)cstl_lpm_lookup(lpm, ten_one, &len) == 2 && len == 16);
+    assert(*(const int*)cstl_lpm_lookup(lpm, other, &len) == 1 && len == 8);
+    assert(*(const int*)cstl_lpm_lookup(lpm, any, &len) == 0 && len == 0);
+
+    assert(cstl_lpm_remove(lpm, ten_one, 16) == CSTL_ERROR_SUCCESS);
+    assert(*(const int*)cstl_lpm_lookup(lpm, ten_one, NULL) == 1);
+    assert(*(const int*)cstl_lpm_lookup(lpm, host, NULL) == 3);
+    assert(cstl_lpm_remove(lpm, host, 32) == CSTL_ERROR_SUCCESS);
+    assert(*(const int*)cstl_lpm_lookup(lpm, host, NULL) == 1);
+    assert(cstl_lpm_remove(lpm, ten, 8) == CSTL_ERROR_SUCCESS);
+    assert(*(const int*)cstl_lpm_lookup(lpm, host, NULL) == 0);
+    assert(cstl_lpm_remove(lpm, any, 0) == CSTL_ERROR_SUCCESS);
+    assert(cstl_lpm_lookup(lpm, host, NULL) == NULL);
+    assert(cstl_lpm_size(lpm) == 0);
+    cstl_lpm_delete(lpm);
+}
+
+void test_c_lpm(void)
+{
+    test_lpm_ipv4_basics();
+    run_family(CSTL_LPM_IPV4, 4);
+    run_family(CSTL_LPM_IPV6, 16);
+}
@@ -0,0 +1,131 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+struct evictions {
+    int count;
+    int last_key;
+    size_t bytes;
+};
+
+static void on_evict(const void* key, size_t key_size, void* value,
+                     size_t value_size, void* p)
+{
+    struct evictions* ev = (struct evictions*)p;
+    (void)value;
+    ev->count++;
+    ev->bytes += key_size + value_size;
+    if (key_size == sizeof(int)) {
+        memcpy(&ev->last_key, key, sizeof(int));
+    }
+}
+
+static void test_lru_entries(void)
+{
+    struct evictions ev;
+    struct cstl_lru* lru;
+    int i, v;
+    int* pv;
+
+    memset(&ev, 0, sizeof(ev));
+    lru = cstl_lru_new(100, CSTL_LRU_ENTRIES, NULL, NULL, on_evict, &ev);
+    for (i = 0; i < 100; i++) {
+        v = i * 10;
+        assert(cstl_lru_put(lru, &i, sizeof(i), &v, sizeof(v)) ==
+               CSTL_ERROR_SUCCESS);
+    }
+    assert(cstl_lru_size(lru) == 100 && ev.count == 0);
+
+    /* touching key 0 protects it; key 1 becomes the oldest */
+    i = 0;
+    pv = (int*)cstl_lru_get(lru, &i, sizeof(i));
+    assert(pv && *pv == 0);
+    i = 100;
+    v = 1000;
+    cstl_lru_put(lru, &i, sizeof(i), &v, sizeof(v));
+    assert(ev.count == 1 && ev.last_key == 1 && cstl_lru_size(lru) == 100);
+    i = 1;
+    assert(cstl_lru_get(lru, &i, sizeof(i)) == NULL);
+
+    /* peek does not promote: key 2 is evicted next */
+    i = 2;
+    assert(*(int*)cstl_lru_peek(lru, &i, sizeof(i)) == 20);
+    i = 101;
+    cstl_lru_put(lru, &i, sizeof(i), &v, sizeof(v));
+    assert(ev.count == 2 && ev.last_key == 2);
+
+    /* replacing a key reports the old entry and keeps the size */
+    i = 50;
+    v = -1;
+    cstl_lru_put(lru, &i, sizeof(i), &v, sizeof(v));
+    assert(ev.count == 3 && ev.last_key == 50 && cstl_lru_size(lru) == 100);
+    assert(*(int*)cstl_lru_get(lru, &i, sizeof(i)) == -1);
+
+    assert(cstl_lru_remove(lru, &i, sizeof(i)) == CSTL_ERROR_SUCCESS);
+    assert(cstl_lru_remove(lru, &i, sizeof(i)) == CSTL_RBTREE_KEY_NOT_FOUND);
+    assert(cstl_lru_size(lru) == 99 && ev.count == 4);
+
+    for (i = 0; i < 102; i++) {
+        pv = (int*)cstl_lru_peek(lru, &i, sizeof(i));
+        assert((pv != NULL) == (i != 1 && i != 2 && i != 50));
+    }
+    cstl_lru_delete(lru);
+    assert(ev.count == 103);
+}
+
+static void test_lru_bytes(void)
+{
+    struct evictions ev;
+    struct cstl_lru* lru;
+    char key[32], value[200];
+    int i;
+
+    memset(&ev, 0, sizeof(ev));
+    memset(value, 'x', sizeof(value));
+    lru = cstl_lru_new(1000, CSTL_LRU_BYTES, NULL, NULL, on_evict, &ev);
+    assert(cstl_lru_put(lru, "big", 3, value, 998) == CSTL_LRU_INVALID_INPUT);
+    for (i = 0; i < 50; i++) {
+        size_t klen = (size_t)sprintf(key, "host-%d.example", i);
+        assert(cstl_lru_put(lru, key, klen, value, (size_t)(i % 7) * 20) ==
+               CSTL_ERROR_SUCCESS);
+        assert(cstl_lru_usage(lru) <= 1000);
+    }
+    assert(ev.count > 0 && cstl_lru_size(lru) < 50);
+    /* the most recent one is always there */
+    assert(cstl_lru_get(lru, key, strlen(key)) != NULL);
+    cstl_lru_clear(lru);
+    assert(cstl_lru_size(lru) == 0 && cstl_lru_usage(lru) == 0);
+    cstl_lru_delete(lru);
+}
+
+void test_c_lru(void)
+{
+    test_lru_entries();
+    test_lru_bytes();
+}
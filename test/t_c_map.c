@@ -166,6 +166,107 @@ void iter_fn(struct cstl_map* map, const void* key, const void* value,
     cstl_map_remove(map, key);
 }
 
+static void test_find_batch(void)
+{
+    char* keys[] = { "A", "Z", "a", "M", "B", "zz" };
+    const void* probes[6];
+    const void* values[6];
+    size_t i, found;
+    struct cstl_map* myMap = cstl_map_new(compare_e, key_destroy, NULL);
+    insert_all(myMap);
+    for (i = 0; i < 6; i++) {
+        probes[i] = &keys[i];
+    }
+    found = cstl_map_find_batch(myMap, probes, 6, values);
+    assert(found == 4);
+    for (i = 0; i < 6; i++) {
+        assert(values[i] == cstl_map_find(myMap, &keys[i]));
+    }
+    assert(*(const int*)values[1] == 26);
+    assert(values[2] == NULL && values[5] == NULL);
+    cstl_map_delete(myMap);
+    (void)found;
+}
+
+static int compare_int(const void* left, const void* right)
+{
+    int l = *(const int*)left;
+    int r = *(const int*)right;
+    return l < r ? -1 : (l > r ? 1 : 0);
+}
+
+static int values_destroyed;
+
+static void value_destroy(void* value)
+{
+    (void)value;
+    values_destroyed++;
+}
+
+/* walks the map in order, checking it holds exactly lo..hi-1 */
+static void check_range(struct cstl_map* m, int lo, int hi)
+{
+    struct cstl_iterator itr;
+    int expect = lo;
+    cstl_map_iterator_init(&itr, m);
+    while (itr.next(&itr)) {
+        assert(*(const int*)itr.current_key(&itr) == expect);
+        assert(*(const int*)itr.current_value(&itr) == expect * 10);
+        expect++;
+    }
+    assert(expect == hi);
+}
+
+static void test_small_mode(void)
+{
+    struct cstl_map* m = cstl_map_new(compare_int, NULL, value_destroy);
+    const void* pinned;
+    int i, v;
+
+    values_destroyed = 0;
+    assert(cstl_map_small_limit(m, 4) == CSTL_ERROR_SUCCESS);
+    for (i = 3; i >= 0; i--) {
+        v = i * 10;
+        assert(cstl_map_insert(m, &i, sizeof(i), &v, sizeof(v)) ==
+               CSTL_ERROR_SUCCESS);
+    }
+    i = 1;
+    assert(cstl_map_insert(m, &i, sizeof(i), &v, sizeof(v)) ==
+           CSTL_RBTREE_KEY_DUPLICATE);
+    pinned = cstl_map_find(m, &i);
+    check_range(m, 0, 4);
+
+    /* the fifth entry moves everything into a tree */
+    for (i = 4; i < 10; i++) {
+        v = i * 10;
+        cstl_map_insert(m, &i, sizeof(i), &v, sizeof(v));
+    }
+    i = 1;
+    assert(cstl_map_find(m, &i) == pinned);
+    check_range(m, 0, 10);
+
+    /* and shrinking to half the limit moves it back */
+    for (i = 9; i >= 2; i--) {
+        assert(cstl_map_remove(m, &i) == CSTL_ERROR_SUCCESS);
+    }
+    i = 1;
+    assert(cstl_map_find(m, &i) == pinned);
+    check_range(m, 0, 2);
+    v = 7;
+    assert(cstl_map_replace(m, &i, &v, sizeof(v)) == CSTL_ERROR_SUCCESS);
+    assert(*(const int*)cstl_map_find(m, &i) == 7);
+    assert(values_destroyed == 9);
+
+    /* a limit of 0 forces the tree */
+    assert(cstl_map_small_limit(m, 0) == CSTL_ERROR_SUCCESS);
+    i = 0;
+    assert(*(const int*)cstl_map_find(m, &i) == 0);
+    cstl_map_traverse(m, iter_fn, NULL);
+    assert(cstl_map_find(m, &i) == NULL);
+    cstl_map_delete(m);
+    assert(values_destroyed == 11);
+}
+
 void test_c_map()
 {
     struct cstl_map* myMap = cstl_map_new(compare_e, key_destroy, NULL);
@@ -176,4 +277,6 @@ void test_c_map()
     cstl_map_traverse(myMap, iter_fn, NULL);
     cstl_map_delete(myMap);
     test_with_iterators();
+    test_find_batch();
+    test_small_mode();
 }
@@ -0,0 +1,159 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+struct deadline {
+    unsigned long when;
+    int conn;
+};
+
+static int compare_deadline(const void* l, const void* r)
+{
+    const struct deadline* a = (const struct deadline*)l;
+    const struct deadline* b = (const struct deadline*)r;
+    return (a->when > b->when) - (a->when < b->when);
+}
+
+static int destroyed;
+
+static void destroy_deadline(void* p)
+{
+    (void)p;
+    destroyed++;
+}
+
+#define PQ_N 1000
+
+static void test_pqueue_arity(size_t arity)
+{
+    struct cstl_pqueue* pq = cstl_pqueue_new(sizeof(struct deadline), arity,
+                                             compare_deadline, NULL);
+    cstl_pqueue_handle handles[PQ_N];
+    unsigned long when[PQ_N];
+    char queued[PQ_N];
+    struct deadline d, out;
+    unsigned long prev = 0;
+    int i, left = PQ_N;
+
+    assert(cstl_pqueue_top(pq) == NULL);
+    assert(cstl_pqueue_pop(pq, NULL) == CSTL_PQUEUE_EMPTY);
+    for (i = 0; i < PQ_N; i++) {
+        d.when = when[i] = (unsigned long)(rand() % 100000) + 1000;
+        d.conn = i;
+        assert(cstl_pqueue_push(pq, &d, &handles[i]) == CSTL_ERROR_SUCCESS);
+        queued[i] = 1;
+    }
+    assert(cstl_pqueue_size(pq) == PQ_N);
+
+    /* re-arm through handles in both directions, erase some */
+    for (i = 0; i < PQ_N; i++) {
+        assert(((const struct deadline*)cstl_pqueue_get(pq, handles[i]))
+                   ->conn == i);
+        d.conn = i;
+        if (i % 5 == 0) {
+            d.when = when[i] = when[i] / 2;
+            assert(cstl_pqueue_decrease_key(pq, handles[i], &d) ==
+                   CSTL_ERROR_SUCCESS);
+        }
+        else if (i % 5 == 1) {
+            d.when = when[i] = when[i] + 50000;
+            assert(cstl_pqueue_increase_key(pq, handles[i], &d) ==
+                   CSTL_ERROR_SUCCESS);
+            d.when = when[i] + 1;
+            assert(cstl_pqueue_decrease_key(pq, handles[i], &d) ==
+                   CSTL_PQUEUE_INVALID_INPUT);
+        }
+        else if (i % 5 == 2) {
+            d.when = when[i] = (unsigned long)(rand() % 200000);
+            assert(cstl_pqueue_update(pq, handles[i], &d) ==
+                   CSTL_ERROR_SUCCESS);
+        }
+        else if (i % 5 == 3) {
+            assert(cstl_pqueue_erase(pq, handles[i], &out) ==
+                   CSTL_ERROR_SUCCESS);
+            assert(out.conn == i && out.when == when[i]);
+            assert(cstl_pqueue_erase(pq, handles[i], NULL) ==
+                   CSTL_PQUEUE_INVALID_HANDLE);
+            assert(cstl_pqueue_get(pq, handles[i]) == NULL);
+            queued[i] = 0;
+            left--;
+        }
+    }
+    assert(cstl_pqueue_size(pq) == (size_t)left);
+
+    while (!cstl_pqueue_is_empty(pq)) {
+        const struct deadline* top =
+            (const struct deadline*)cstl_pqueue_top(pq);
+        assert(cstl_pqueue_top_handle(pq) == handles[top->conn]);
+        assert(cstl_pqueue_pop(pq, &out) == CSTL_ERROR_SUCCESS);
+        assert(out.when >= prev && out.when == when[out.conn]);
+        assert(queued[out.conn]);
+        queued[out.conn] = 0;
+        prev = out.when;
+        left--;
+    }
+    assert(left == 0);
+    assert(cstl_pqueue_top(pq) == NULL);
+    assert(cstl_pqueue_top_handle(pq) == CSTL_PQUEUE_HANDLE_NONE);
+    cstl_pqueue_delete(pq);
+}
+
+static void test_pqueue_destroy(void)
+{
+    struct cstl_pqueue* pq = cstl_pqueue_new(sizeof(struct deadline), 0,
+                                             compare_deadline,
+                                             destroy_deadline);
+    cstl_pqueue_handle h, reused;
+    struct deadline d;
+    int i;
+
+    destroyed = 0;
+    memset(&d, 0, sizeof(d));
+    for (i = 0; i < 10; i++) {
+        d.when = (unsigned long)i;
+        cstl_pqueue_push(pq, &d, i == 3 ? &h : NULL);
+    }
+    assert(cstl_pqueue_pop(pq, NULL) == CSTL_ERROR_SUCCESS);
+    assert(destroyed == 1);
+    assert(cstl_pqueue_erase(pq, h, NULL) == CSTL_ERROR_SUCCESS);
+    assert(destroyed == 2);
+    /* a freed handle is recycled */
+    cstl_pqueue_push(pq, &d, &reused);
+    assert(reused == h);
+    cstl_pqueue_delete(pq);
+    assert(destroyed == 11);
+}
+
+void test_c_pqueue(void)
+{
+    test_pqueue_arity(2);
+    test_pqueue_arity(0); /* default arity */
+    test_pqueue_arity(8);
+    test_pqueue_destroy();
+}
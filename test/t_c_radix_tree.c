@@ -0,0 +1,232 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#define REF_MAX 400
+
+/* brute-force reference: the keys currently stored, value = slot number */
+struct reference {
+    char key[REF_MAX][8];
+    size_t len[REF_MAX];
+    int used[REF_MAX];
+};
+
+static void random_key(char* key, size_t* len)
+{
+    size_t i;
+    *len = (size_t)(rand() % 7);
+    for (i = 0; i < *len; i++) {
+        key[i] = "abc"[rand() % 3];
+    }
+}
+
+static int ref_find(struct reference* ref, const char* key, size_t len)
+{
+    int i;
+    for (i = 0; i < REF_MAX; i++) {
+        if (ref->used[i] && ref->len[i] == len &&
+            memcmp(ref->key[i], key, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* whether key starts with affix, or ends with it when reversed */
+static int has_affix(const char* key, size_t len, const char* affix,
+                     size_t affix_len, int reversed)
+{
+    return len >= affix_len &&
+           memcmp(reversed ? key + len - affix_len : key, affix,
+                  affix_len) == 0;
+}
+
+struct walk_state {
+    struct reference* ref;
+    int reversed;
+    const char* prefix;
+    size_t prefix_len;
+    int count;
+    char last[8];
+    size_t last_len;
+};
+
+static void on_key(const void* key, size_t key_len, void* value, int* stop,
+                   void* p)
+{
+    struct walk_state* ws = (struct walk_state*)p;
+    int slot = *(int*)value;
+    char stored[8];
+    size_t i, n = ws->last_len < key_len ? ws->last_len : key_len;
+    int c;
+    (void)stop;
+    assert(has_affix((const char*)key, key_len, ws->prefix, ws->prefix_len,
+                     ws->reversed));
+    assert(ws->ref->len[slot] == key_len &&
+           memcmp(ws->ref->key[slot], key, key_len) == 0);
+    /* lexicographic order of the keys as stored, back to front if reversed */
+    for (i = 0; i < key_len; i++) {
+        stored[i] = ((const char*)key)[ws->reversed ? key_len - 1 - i : i];
+    }
+    c = memcmp(ws->last, stored, n);
+    assert(ws->count == 0 || c < 0 || (c == 0 && ws->last_len < key_len));
+    memcpy(ws->last, stored, key_len);
+    ws->last_len = key_len;
+    ws->count++;
+}
+
+static void test_radix_random(cstl_radix_order order)
+{
+    struct reference* ref = (struct reference*)calloc(1, sizeof(*ref));
+    struct cstl_radix_tree* t = cstl_radix_tree_new(order, NULL);
+    int reversed = order == CSTL_RADIX_REVERSED;
+    struct walk_state ws;
+    char key[8];
+    size_t len, match, best;
+    int round, i, slot, expect;
+    int* v;
+
+    for (round = 0; round < 20000; round++) {
+        random_key(key, &len);
+        slot = ref_find(ref, key, len);
+        switch (rand() % 4) {
+        case 0:
+        case 1:
+            for (i = 0; slot < 0 && i < REF_MAX && ref->used[i]; i++) {
+            }
+            if (slot < 0 && i == REF_MAX) {
+                break;
+            }
+            assert(cstl_radix_tree_insert(t, key, len, &i, sizeof(i)) ==
+                   (slot < 0 ? CSTL_ERROR_SUCCESS
+                             : CSTL_RBTREE_KEY_DUPLICATE));
+            if (slot < 0) {
+                memcpy(ref->key[i], key, len);
+                ref->len[i] = len;
+                ref->used[i] = 1;
+            }
+            break;
+        case 2:
+            assert(cstl_radix_tree_remove(t, key, len) ==
+                   (slot < 0 ? CSTL_RBTREE_KEY_NOT_FOUND
+                             : CSTL_ERROR_SUCCESS));
+            if (slot >= 0) {
+                ref->used[slot] = 0;
+            }
+            break;
+        default:
+            v = (int*)cstl_radix_tree_find(t, key, len);
+            assert(slot < 0 ? v == NULL : (v && *v == slot));
+            /* longest stored prefix (suffix), by brute force */
+            expect = -1;
+            best = 0;
+            for (i = 0; i < REF_MAX; i++) {
+                if (ref->used[i] &&
+                    has_affix(key, len, ref->key[i], ref->len[i], reversed) &&
+                    (expect < 0 || ref->len[i] > best)) {
+                    expect = i;
+                    best = ref->len[i];
+                }
+            }
+            v = (int*)cstl_radix_tree_longest_prefix(t, key, len, &match);
+            assert(expect < 0 ? v == NULL
+                              : (v && *v == expect && match == best));
+            /* every key starting (ending) with the first half of this one */
+            memset(&ws, 0, sizeof(ws));
+            ws.ref = ref;
+            ws.reversed = reversed;
+            ws.prefix = key;
+            ws.prefix_len = len / 2;
+            cstl_radix_tree_walk_prefix(t, key, len / 2, on_key, &ws);
+            expect = 0;
+            for (i = 0; i < REF_MAX; i++) {
+                if (ref->used[i] && has_affix(ref->key[i], ref->len[i], key,
+                                              len / 2, reversed)) {
+                    expect++;
+                }
+            }
+            assert(ws.count == expect);
+            break;
+        }
+    }
+    expect = 0;
+    for (i = 0; i < REF_MAX; i++) {
+        expect += ref->used[i];
+    }
+    assert(cstl_radix_tree_size(t) == (size_t)expect);
+    cstl_radix_tree_delete(t);
+    free(ref);
+}
+
+static int rules_freed;
+
+static void free_rule(void* p)
+{
+    (void)p;
+    rules_freed++;
+}
+
+static void test_radix_domains(void)
+{
+    static const char* rules[] = { ".example.com", ".com", ".ads.example.com",
+                                   ".example.org" };
+    struct cstl_radix_tree* t = cstl_radix_tree_new(CSTL_RADIX_REVERSED,
+                                                    free_rule);
+    const char* host = ".www.ads.example.com";
+    size_t i, match;
+    int* v;
+
+    rules_freed = 0;
+    for (i = 0; i < 4; i++) {
+        int id = (int)i;
+        assert(cstl_radix_tree_insert(t, rules[i], strlen(rules[i]), &id,
+                                      sizeof(id)) == CSTL_ERROR_SUCCESS);
+    }
+    v = (int*)cstl_radix_tree_longest_prefix(t, host, strlen(host), &match);
+    assert(v && *v == 2 && match == strlen(".ads.example.com"));
+    host = ".badexample.com";
+    v = (int*)cstl_radix_tree_longest_prefix(t, host, strlen(host), &match);
+    assert(v && *v == 1 && match == 4);
+    assert(cstl_radix_tree_remove(t, ".com", 4) == CSTL_ERROR_SUCCESS);
+    assert(cstl_radix_tree_longest_prefix(t, host, strlen(host), NULL) ==
+           NULL);
+    assert(*(int*)cstl_radix_tree_find(t, ".example.org", 12) == 3);
+    assert(rules_freed == 1);
+    cstl_radix_tree_delete(t);
+    assert(rules_freed == 4);
+}
+
+void test_c_radix_tree(void)
+{
+    assert(cstl_radix_tree_delete(NULL) == CSTL_RADIX_TREE_NOT_INITIALIZED);
+    test_radix_random(CSTL_RADIX_FORWARD);
+    test_radix_random(CSTL_RADIX_REVERSED);
+    test_radix_domains();
+}
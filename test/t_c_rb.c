@@ -218,6 +218,147 @@ void test_c_rb2(void)
     rbt_tree_destroy(t);
 }
 
+void test_c_rb_find_batch(void)
+{
+    int keys[100];
+    const void* probes[100];
+    struct rbt_node* nodes[100];
+    int i;
+    struct rbt_tree* t = rbt_tree_create(malloc, free, 0, compare_rb_e, NULL);
+
+    for (i = 0; i < 1000; i += 2) {
+        rbt_tree_insert(t, &i, sizeof(i));
+    }
+    for (i = 0; i < 100; i++) {
+        keys[i] = rand() % 1100;
+        probes[i] = &keys[i];
+    }
+    rbt_tree_find_batch(t, probes, 100, nodes);
+    for (i = 0; i < 100; i++) {
+        assert(nodes[i] == rbt_tree_find(t, &keys[i]));
+        if (keys[i] < 1000 && keys[i] % 2 == 0) {
+            assert(*(int*)rbt_node_get_key(nodes[i]) == keys[i]);
+        }
+        else {
+            assert(rbt_node_is_valid(nodes[i]) == 0);
+        }
+    }
+    rbt_tree_destroy(t);
+}
+
+static int compare_double(const void* l, const void* r)
+{
+    double a = *(const double*)l, b = *(const double*)r;
+    return (a > b) - (a < b);
+}
+
+void test_c_rb_compact_node(void)
+{
+    struct rbt_tree* t = rbt_tree_create(malloc, free, 0, compare_double, NULL);
+    struct rbt_node* node;
+    double d;
+    int i;
+
+    /* color and sentinel flag live in the parent pointer */
+    assert(sizeof(struct rbt_link) == 3 * sizeof(void*));
+    assert(rbt_node_is_valid(rbt_tree_get_root(t)) == 0);
+    assert(rbt_node_get_key(rbt_tree_get_root(t)) == NULL);
+
+    for (i = 0; i < 200; i++) {
+        d = (double)((i * 37) % 200) / 4.0;
+        assert(rbt_tree_insert(t, &d, sizeof(d)) == rbt_status_success);
+    }
+    d = 12.25;
+    node = rbt_tree_find(t, &d);
+    assert(rbt_node_is_valid(node));
+    assert(((size_t)rbt_node_get_key(node) & (sizeof(double) - 1)) == 0);
+    assert(*(const double*)rbt_node_get_key(node) == 12.25);
+    assert(rbt_node_is_valid(rbt_node_get_parent(rbt_tree_get_root(t))) == 0);
+    assert(rbt_node_get_color(rbt_tree_get_root(t)) == rbt_black);
+
+    node = rbt_tree_minimum(t, rbt_tree_get_root(t));
+    for (i = 0; i < 200; i++) {
+        assert(*(const double*)rbt_node_get_key(node) == (double)i / 4.0);
+        node = rbt_tree_successor(t, node);
+    }
+    assert(rbt_node_is_valid(node) == 0);
+
+    for (i = 0; i < 200; i += 3) {
+        d = (double)i / 4.0;
+        assert(rbt_tree_remove_node(t, &d) == rbt_status_success);
+    }
+    assert(rbt_tree_remove_node(t, &d) == rbt_status_key_not_exist);
+    rbt_tree_destroy(t);
+}
+
+struct session {
+    int id;
+    struct rbt_link by_id;
+};
+
+static int compare_session(const struct rbt_link* a, const struct rbt_link* b)
+{
+    int x = cstl_container_of(a, struct session, by_id)->id;
+    int y = cstl_container_of(b, struct session, by_id)->id;
+    return (x > y) - (x < y);
+}
+
+static void release_session(struct rbt_link* link, void* p)
+{
+    ++*(int*)p;
+    rbt_link_init(link);
+}
+
+void test_c_rb_intrusive(void)
+{
+    struct rbt_intrusive_tree tree;
+    struct session sessions[500], probe;
+    struct rbt_link* link;
+    int i, prev = -1, released = 0;
+
+    rbt_intrusive_init(&tree, compare_session, 0);
+    for (i = 0; i < 500; i++) {
+        sessions[i].id = (i * 7) % 500;
+        rbt_link_init(&sessions[i].by_id);
+        assert(!rbt_link_is_linked(&sessions[i].by_id));
+        assert(rbt_intrusive_insert(&tree, &sessions[i].by_id) ==
+               rbt_status_success);
+        assert(rbt_link_is_linked(&sessions[i].by_id));
+    }
+    assert(tree.count == 500);
+
+    probe.id = 7;
+    rbt_link_init(&probe.by_id);
+    assert(rbt_intrusive_insert(&tree, &probe.by_id) ==
+           rbt_status_key_duplicate);
+    link = rbt_intrusive_find(&tree, &probe.by_id);
+    assert(link == &sessions[1].by_id);
+
+    /* erase by handle, no lookup */
+    for (i = 0; i < 500; i += 2) {
+        rbt_intrusive_erase(&tree, &sessions[i].by_id);
+        assert(!rbt_link_is_linked(&sessions[i].by_id));
+    }
+    assert(tree.count == 250);
+    for (link = rbt_link_first(&tree.base); link;
+         link = rbt_link_next(&tree.base, link)) {
+        struct session* s = cstl_container_of(link, struct session, by_id);
+        assert(s->id > prev && (s - sessions) % 2 == 1);
+        prev = s->id;
+    }
+    probe.id = 0;
+    link = rbt_intrusive_lower_bound(&tree, &probe.by_id);
+    assert(link && cstl_container_of(link, struct session, by_id)->id == 1);
+    probe.id = 500;
+    assert(rbt_intrusive_lower_bound(&tree, &probe.by_id) == NULL);
+
+    rbt_intrusive_clear(&tree, release_session, &released);
+    assert(released == 250 && tree.count == 0);
+    assert(rbt_root_is_empty(&tree.base));
+    assert(rbt_intrusive_insert(&tree, &sessions[1].by_id) ==
+           rbt_status_success);
+}
+
 int compare_rb_e_alloc(const void* l, const void* r)
 {
     int left = **(int**)l;
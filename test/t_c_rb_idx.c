@@ -0,0 +1,188 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "rb-tree-idx.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct flow_key {
+    uint32_t src;
+    uint32_t dst;
+    uint16_t sport;
+    uint16_t dport;
+};
+
+static int compare_u64(const void* l, const void* r)
+{
+    uint64_t a = *(const uint64_t*)l, b = *(const uint64_t*)r;
+    return (a > b) - (a < b);
+}
+
+static int compare_flow(const void* l, const void* r)
+{
+    return memcmp(l, r, sizeof(struct flow_key));
+}
+
+static void test_rb_idx_u64(void)
+{
+    struct rbt_idx_tree* t = rbt_idx_tree_create(sizeof(uint64_t), compare_u64,
+                                                 NULL);
+    char present[2000];
+    uint64_t k, prev = 0;
+    rbt_idx i;
+    size_t n = 0;
+    int j;
+
+    memset(present, 0, sizeof(present));
+    for (j = 0; j < 20000; j++) {
+        k = (uint64_t)(rand() % 2000);
+        if (rand() % 3) {
+            rbt_status s = rbt_idx_tree_insert(t, &k);
+            assert(s == (present[k] ? rbt_status_key_duplicate
+                                    : rbt_status_success));
+            n += present[k] ? 0 : 1;
+            present[k] = 1;
+            (void)s;
+        }
+        else {
+            rbt_status s = rbt_idx_tree_remove(t, &k);
+            assert(s == (present[k] ? rbt_status_success
+                                    : rbt_status_key_not_exist));
+            n -= present[k] ? 1 : 0;
+            present[k] = 0;
+            (void)s;
+        }
+    }
+    assert(rbt_idx_tree_size(t) == n);
+    for (k = 0; k < 2000; k++) {
+        i = rbt_idx_tree_find(t, &k);
+        assert((i != RBT_IDX_NIL) == (present[k] != 0));
+        assert(i == RBT_IDX_NIL || *(uint64_t*)rbt_idx_tree_key(t, i) == k);
+    }
+
+    /* in-order walk, both directions */
+    n = 0;
+    for (i = rbt_idx_tree_first(t); i != RBT_IDX_NIL;
+         i = rbt_idx_tree_next(t, i)) {
+        k = *(uint64_t*)rbt_idx_tree_key(t, i);
+        assert(n == 0 || k > prev);
+        assert(((size_t)rbt_idx_tree_key(t, i) & 7) == 0);
+        prev = k;
+        n++;
+    }
+    assert(n == rbt_idx_tree_size(t));
+    for (i = rbt_idx_tree_last(t); i != RBT_IDX_NIL;
+         i = rbt_idx_tree_prev(t, i)) {
+        n--;
+    }
+    assert(n == 0);
+    assert(rbt_idx_tree_key(t, RBT_IDX_NIL) == NULL);
+    rbt_idx_tree_destroy(t);
+}
+
+/* loads a copy of image with the 32-bit word at byte offset `at` replaced */
+static struct rbt_idx_tree* load_patched(const void* image, size_t bytes,
+                                         size_t at, uint32_t word)
+{
+    struct rbt_idx_tree* t;
+    char* copy = (char*)malloc(bytes);
+    memcpy(copy, image, bytes);
+    memcpy(copy + at, &word, sizeof(word));
+    t = rbt_idx_tree_load(copy, bytes, compare_flow, NULL);
+    free(copy);
+    return t;
+}
+
+static void test_rb_idx_save_load(void)
+{
+    struct rbt_idx_tree* t = rbt_idx_tree_create(sizeof(struct flow_key),
+                                                 compare_flow, NULL);
+    struct rbt_idx_tree* copy;
+    struct flow_key f;
+    size_t bytes;
+    void* image;
+    uint32_t hdr[8];
+    size_t link, free_link;
+    uint32_t j;
+
+    assert(rbt_idx_tree_reserve(t, 1000) == rbt_status_success);
+    memset(&f, 0, sizeof(f));
+    for (j = 0; j < 1000; j++) {
+        f.src = j;
+        f.dst = j * 31;
+        f.dport = (uint16_t)(j % 65);
+        assert(rbt_idx_tree_insert(t, &f) == rbt_status_success);
+    }
+    for (j = 0; j < 1000; j += 4) {
+        f.src = j;
+        f.dst = j * 31;
+        f.dport = (uint16_t)(j % 65);
+        assert(rbt_idx_tree_remove(t, &f) == rbt_status_success);
+    }
+
+    bytes = rbt_idx_tree_save(t, NULL, 0);
+    image = malloc(bytes);
+    assert(rbt_idx_tree_save(t, image, bytes) == bytes);
+    assert(rbt_idx_tree_load(image, bytes - 1, compare_flow, NULL) == NULL);
+
+    /* the header is eight words: magic, key_size, stride, key_off, root,
+     * free_head, used, count; a malformed one must not load */
+    memcpy(hdr, image, sizeof(hdr));
+    link = 32 + (size_t)hdr[4] * hdr[2]; /* the root's left link */
+    assert(load_patched(image, bytes, 16, hdr[6]) == NULL);
+    assert(load_patched(image, bytes, 20, hdr[6] + 7) == NULL);
+    assert(load_patched(image, bytes, 28, hdr[7] + 1) == NULL);
+    assert(load_patched(image, bytes, 28, hdr[7] - 1) == NULL);
+    assert(load_patched(image, bytes, link, hdr[6] + 100) == NULL);
+    assert(load_patched(image, bytes, link, hdr[4]) == NULL);
+    assert(load_patched(image, bytes, link, 0) == NULL);
+    /* a free slot pointing past the arena, or back into the tree */
+    free_link = 32 + (size_t)hdr[5] * hdr[2];
+    assert(load_patched(image, bytes, free_link, hdr[6]) == NULL);
+    assert(load_patched(image, bytes, free_link, hdr[4]) == NULL);
+
+    copy = rbt_idx_tree_load(image, bytes, compare_flow, NULL);
+    free(image);
+    assert(copy && rbt_idx_tree_size(copy) == 750);
+    for (j = 0; j < 1000; j++) {
+        f.src = j;
+        f.dst = j * 31;
+        f.dport = (uint16_t)(j % 65);
+        assert((rbt_idx_tree_find(copy, &f) != RBT_IDX_NIL) == (j % 4 != 0));
+    }
+    /* the free list survives the round trip */
+    f.src = 5000;
+    assert(rbt_idx_tree_insert(copy, &f) == rbt_status_success);
+    assert(rbt_idx_tree_find(copy, &f) <= 1000);
+    rbt_idx_tree_destroy(copy);
+    rbt_idx_tree_destroy(t);
+}
+
+void test_c_rb_idx(void)
+{
+    test_rb_idx_u64();
+    test_rb_idx_save_load();
+}
@@ -0,0 +1,462 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * The reference is a flag per value of four chunks, whose high halves are
+ * picked to include the first and the last one.
+ */
+#define CHUNKS 4
+#define REF_SIZE (CHUNKS * 65536)
+
+static const uint32_t chunk_keys[CHUNKS] = {0, 7, 8, 0xFFFF};
+
+static uint32_t value_of(size_t i)
+{
+    return chunk_keys[i >> 16] << 16 | (uint32_t)(i & 0xFFFF);
+}
+
+struct walk_state {
+    const char* ref;
+    size_t next;
+    size_t limit;
+};
+
+static void check_walker(uint32_t value, int* stop, void* p)
+{
+    struct walk_state* w = (struct walk_state*)p;
+    while (!w->ref[w->next]) {
+        w->next++;
+    }
+    assert(value == value_of(w->next));
+    w->next++;
+    if (--w->limit == 0) {
+        *stop = 1;
+    }
+}
+
+static void check_against(const struct cstl_roaring* r, const char* ref)
+{
+    struct walk_state w;
+    uint64_t count = 0;
+    size_t i, next = REF_SIZE;
+    uint32_t v;
+
+    for (i = REF_SIZE; i-- > 0;) {
+        if (ref[i]) {
+            next = i;
+        }
+        assert(cstl_roaring_contains(r, value_of(i)) == ref[i]);
+        if (i % 251 == 0) {
+            int found = cstl_roaring_next(r, value_of(i), &v);
+            assert(found == (next < REF_SIZE));
+            assert(!found || v == value_of(next));
+        }
+    }
+    for (i = 0; i < REF_SIZE; i++) {
+        count += (uint64_t)ref[i];
+        if (i % 97 == 0) {
+            assert(cstl_roaring_rank(r, value_of(i)) == count);
+        }
+        if (ref[i] && count % 89 == 1) {
+            assert(cstl_roaring_select(r, count - 1, &v) && v == value_of(i));
+        }
+    }
+    assert(cstl_roaring_cardinality(r) == count);
+    assert(!cstl_roaring_select(r, count, &v));
+
+    w.ref = ref;
+    w.next = 0;
+    w.limit = (size_t)count + 1;
+    cstl_roaring_traverse(r, check_walker, &w);
+    assert(w.limit == 1);
+    if (count > 1) {
+        /* stopping early */
+        w.next = 0;
+        w.limit = 1;
+        cstl_roaring_traverse(r, check_walker, &w);
+        assert(w.limit == 0);
+    }
+}
+
+/* fills a chunk: 0 empty, 1 sparse, 2 dense, 3 ranges, 4 dense ranges */
+static void fill_chunk(struct cstl_roaring* r, char* ref, int chunk,
+                       int mode)
+{
+    size_t base = (size_t)chunk << 16, i;
+    int k;
+    switch (mode) {
+    case 1:
+    case 2:
+        for (i = 0; i < 65536; i++) {
+            if (rand() % 100 < (mode == 1 ? 2 : 40)) {
+                ref[base + i] = 1;
+                cstl_roaring_add(r, value_of(base + i));
+            }
+        }
+        break;
+    case 3:
+    case 4:
+        for (k = 0; k < (mode == 3 ? 8 : 60); k++) {
+            size_t first = (size_t)rand() % 65536;
+            size_t last = first + (size_t)rand() % (mode == 3 ? 200 : 3000);
+            if (last > 65535) {
+                last = 65535;
+            }
+            assert(cstl_roaring_add_range(r, value_of(base + first),
+                                          value_of(base + last)) ==
+                   CSTL_ERROR_SUCCESS);
+            memset(ref + base + first, 1, last - first + 1);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void test_roaring_single_values(void)
+{
+    static char ref[REF_SIZE];
+    struct cstl_roaring* r = cstl_roaring_new();
+    int chunk, op;
+    uint32_t v;
+
+    memset(ref, 0, sizeof(ref));
+    check_against(r, ref);
+    assert(!cstl_roaring_next(r, 0, &v));
+
+    /* runs, arrays and bitmaps, then single values in and around them */
+    fill_chunk(r, ref, 0, 3);
+    fill_chunk(r, ref, 1, 1);
+    fill_chunk(r, ref, 2, 2);
+    fill_chunk(r, ref, 3, 4);
+    check_against(r, ref);
+    for (op = 0; op < 200000; op++) {
+        size_t i = (size_t)rand() % REF_SIZE;
+        if (rand() % 2) {
+            assert(cstl_roaring_add(r, value_of(i)) == CSTL_ERROR_SUCCESS);
+            ref[i] = 1;
+        }
+        else {
+            assert(cstl_roaring_remove(r, value_of(i)) ==
+                   CSTL_ERROR_SUCCESS);
+            ref[i] = 0;
+        }
+    }
+    check_against(r, ref);
+
+    /* a bitmap shrinks to an array, and empty chunks disappear */
+    for (chunk = 0; chunk < CHUNKS; chunk++) {
+        size_t i, base = (size_t)chunk << 16;
+        for (i = 0; i < 65536; i++) {
+            if (ref[base + i] && (chunk != 2 || i % 64 != 0)) {
+                assert(cstl_roaring_remove(r, value_of(base + i)) ==
+                       CSTL_ERROR_SUCCESS);
+                ref[base + i] = 0;
+            }
+        }
+    }
+    check_against(r, ref);
+
+    /* the whole range, in one call */
+    assert(cstl_roaring_add_range(r, 0, 0xFFFFFFFFu) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_cardinality(r) == (uint64_t)1 << 32);
+    assert(cstl_roaring_rank(r, 0xFFFFFFFFu) == (uint64_t)1 << 32);
+    assert(cstl_roaring_select(r, 0x12345678u, &v) && v == 0x12345678u);
+    assert(cstl_roaring_contains(r, 0xFFFFFFFFu));
+    assert(cstl_roaring_remove(r, 0x80000000u) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_next(r, 0x80000000u, &v) && v == 0x80000001u);
+    assert(cstl_roaring_add_range(r, 5, 4) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_delete(r) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_delete(NULL) == CSTL_ROARING_NOT_INITIALIZED);
+}
+
+static cstl_error apply(int op, struct cstl_roaring* x,
+                        const struct cstl_roaring* y)
+{
+    switch (op) {
+    case 0:
+        return cstl_roaring_and(x, y);
+    case 1:
+        return cstl_roaring_or(x, y);
+    case 2:
+        return cstl_roaring_xor(x, y);
+    default:
+        return cstl_roaring_andnot(x, y);
+    }
+}
+
+static void test_roaring_set_ops(void)
+{
+    static char a[REF_SIZE], b[REF_SIZE], want[REF_SIZE];
+    int op, round, chunk;
+    size_t i;
+    for (round = 0; round < 6; round++) {
+        for (op = 0; op < 4; op++) {
+            struct cstl_roaring* x = cstl_roaring_new();
+            struct cstl_roaring* y = cstl_roaring_new();
+            struct cstl_roaring* z;
+            memset(a, 0, sizeof(a));
+            memset(b, 0, sizeof(b));
+            /* every pairing of container kinds comes up over the rounds */
+            for (chunk = 0; chunk < CHUNKS; chunk++) {
+                fill_chunk(x, a, chunk, (chunk + round) % 5);
+                fill_chunk(y, b, chunk, (chunk * 2 + round + op) % 5);
+            }
+            if (round % 2) {
+                assert(cstl_roaring_run_optimize(x) == CSTL_ERROR_SUCCESS);
+                assert(cstl_roaring_run_optimize(y) == CSTL_ERROR_SUCCESS);
+            }
+            for (i = 0; i < REF_SIZE; i++) {
+                switch (op) {
+                case 0:
+                    want[i] = (char)(a[i] & b[i]);
+                    break;
+                case 1:
+                    want[i] = (char)(a[i] | b[i]);
+                    break;
+                case 2:
+                    want[i] = (char)(a[i] ^ b[i]);
+                    break;
+                default:
+                    want[i] = (char)(a[i] & !b[i]);
+                    break;
+                }
+            }
+            z = cstl_roaring_copy(x);
+            assert(apply(op, x, y) == CSTL_ERROR_SUCCESS);
+            check_against(x, want);
+            check_against(y, b);
+
+            /* with itself */
+            assert(apply(op, z, z) == CSTL_ERROR_SUCCESS);
+            check_against(z, op < 2 ? a : (memset(b, 0, sizeof(b)), b));
+            cstl_roaring_delete(x);
+            cstl_roaring_delete(y);
+            cstl_roaring_delete(z);
+        }
+    }
+}
+
+static void test_roaring_gallop(void)
+{
+    struct cstl_roaring* x = cstl_roaring_new();
+    struct cstl_roaring* y = cstl_roaring_new();
+    struct cstl_roaring* z;
+    uint32_t i, v;
+
+    /* 3000 values against 30: skewed arrays take the galloping path */
+    for (i = 0; i < 3000; i++) {
+        cstl_roaring_add(x, i * 7);
+    }
+    for (i = 0; i < 30; i++) {
+        cstl_roaring_add(y, i * 700 + (i % 2));
+    }
+    z = cstl_roaring_copy(y);
+    assert(cstl_roaring_and(z, x) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_cardinality(z) == 15);
+    assert(cstl_roaring_select(z, 14, &v) && v == 28 * 700);
+    cstl_roaring_delete(z);
+
+    z = cstl_roaring_copy(x);
+    assert(cstl_roaring_and(z, y) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_cardinality(z) == 15);
+    cstl_roaring_delete(z);
+
+    z = cstl_roaring_copy(y);
+    assert(cstl_roaring_andnot(z, x) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_cardinality(z) == 15);
+    assert(cstl_roaring_select(z, 0, &v) && v == 701);
+    cstl_roaring_delete(z);
+
+    cstl_roaring_delete(x);
+    cstl_roaring_delete(y);
+}
+
+static void test_roaring_run_optimize(void)
+{
+    struct cstl_roaring* r = cstl_roaring_new();
+    size_t before, after;
+    uint32_t i, v;
+
+    for (i = 100; i < 60000; i++) {
+        cstl_roaring_add(r, i);
+    }
+    cstl_roaring_add(r, 1 << 16 | 5);
+    before = cstl_roaring_save(r, NULL, 0);
+    assert(cstl_roaring_run_optimize(r) == CSTL_ERROR_SUCCESS);
+    after = cstl_roaring_save(r, NULL, 0);
+    assert(after < before);
+    assert(cstl_roaring_cardinality(r) == 60000 - 100 + 1);
+    assert(cstl_roaring_rank(r, 200) == 101);
+
+    /* punching holes into the run splits it */
+    for (i = 1000; i < 60000; i += 2) {
+        cstl_roaring_remove(r, i);
+    }
+    assert(cstl_roaring_cardinality(r) == 900 + 29500 + 1);
+    assert(cstl_roaring_select(r, 901, &v) && v == 1003);
+    /* then back to a bitmap */
+    assert(cstl_roaring_run_optimize(r) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_save(r, NULL, 0) > after);
+    /* and to runs again once the holes are filled */
+    for (i = 1000; i < 60000; i += 2) {
+        cstl_roaring_add(r, i);
+    }
+    assert(cstl_roaring_run_optimize(r) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_save(r, NULL, 0) == after);
+    /* merging runs value by value */
+    assert(cstl_roaring_remove(r, 500) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_remove(r, 100) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_remove(r, 59999) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_add(r, 500) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_add(r, 99) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_add(r, 59999) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_add(r, 100) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_add(r, 60000) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_cardinality(r) == 60000 - 99 + 1 + 1);
+    assert(cstl_roaring_rank(r, 60000) == 60000 - 99 + 1);
+    cstl_roaring_delete(r);
+
+    /* a run container of single values grows in front of its runs */
+    r = cstl_roaring_new();
+    assert(cstl_roaring_add_range(r, 10, 10) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_add(r, 10) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_add(r, 9) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_add(r, 20) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_remove(r, 20) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_remove(r, 30) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_cardinality(r) == 2);
+    assert(cstl_roaring_rank(r, 9) == 1);
+    cstl_roaring_delete(r);
+
+    /* runs that became too many turn back into an array */
+    r = cstl_roaring_new();
+    cstl_roaring_add_range(r, 0, 99);
+    for (i = 0; i < 100; i += 2) {
+        cstl_roaring_remove(r, i);
+    }
+    before = cstl_roaring_save(r, NULL, 0);
+    assert(cstl_roaring_run_optimize(r) == CSTL_ERROR_SUCCESS);
+    assert(cstl_roaring_save(r, NULL, 0) < before);
+    assert(cstl_roaring_select(r, 49, &v) && v == 99);
+    cstl_roaring_delete(r);
+}
+
+static void test_roaring_serialization(void)
+{
+    /* {1, 5, 65539} without runs, and {10..19} as one run */
+    static const unsigned char plain[] = {
+        0x3A, 0x30, 0, 0, 2, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0,
+        24, 0, 0, 0, 28, 0, 0, 0, 1, 0, 5, 0, 3, 0};
+    static const unsigned char runs[] = {
+        0x3B, 0x30, 0, 0, 1, 0, 0, 9, 0, 1, 0, 10, 0, 9, 0};
+    static char ref[REF_SIZE];
+    unsigned char buf[64];
+    unsigned char* image;
+    struct cstl_roaring* r = cstl_roaring_new();
+    struct cstl_roaring* back;
+    size_t size, i;
+    int round;
+
+    cstl_roaring_add(r, 65539);
+    cstl_roaring_add(r, 5);
+    cstl_roaring_add(r, 1);
+    assert(cstl_roaring_save(r, buf, 0) == sizeof(plain));
+    assert(cstl_roaring_save(r, buf, sizeof(buf)) == sizeof(plain));
+    assert(memcmp(buf, plain, sizeof(plain)) == 0);
+    cstl_roaring_delete(r);
+
+    r = cstl_roaring_new();
+    cstl_roaring_add_range(r, 10, 19);
+    assert(cstl_roaring_save(r, buf, sizeof(buf)) == sizeof(runs));
+    assert(memcmp(buf, runs, sizeof(runs)) == 0);
+    cstl_roaring_delete(r);
+
+    back = cstl_roaring_load(plain, sizeof(plain));
+    assert(cstl_roaring_cardinality(back) == 3);
+    assert(cstl_roaring_contains(back, 65539));
+    cstl_roaring_delete(back);
+    back = cstl_roaring_load(runs, sizeof(runs));
+    assert(cstl_roaring_cardinality(back) == 10);
+    assert(cstl_roaring_contains(back, 19) && !cstl_roaring_contains(back, 20));
+    cstl_roaring_delete(back);
+
+    /* truncated or damaged images */
+    for (i = 0; i < sizeof(plain); i++) {
+        assert(cstl_roaring_load(plain, i) == NULL);
+    }
+    memcpy(buf, plain, sizeof(plain));
+    buf[24] = 9; /* 9 > 5: values out of order */
+    assert(cstl_roaring_load(buf, sizeof(plain)) == NULL);
+    /* each case damages one field of an otherwise valid image */
+    memcpy(buf, runs, sizeof(runs));
+    buf[7] = 10; /* the cardinality does not match the run */
+    assert(cstl_roaring_load(buf, sizeof(runs)) == NULL);
+    memcpy(buf, runs, sizeof(runs));
+    buf[11] = 0xFF; /* ten values from 65535: the run goes past 65535 */
+    buf[12] = 0xFF;
+    assert(cstl_roaring_load(buf, sizeof(runs)) == NULL);
+    memcpy(buf, runs, sizeof(runs));
+    buf[0] = 0; /* unknown cookie */
+    assert(cstl_roaring_load(buf, sizeof(runs)) == NULL);
+
+    /* round trips of every container kind, with and without runs */
+    for (round = 0; round < 4; round++) {
+        int chunk;
+        r = cstl_roaring_new();
+        memset(ref, 0, sizeof(ref));
+        for (chunk = 0; chunk < CHUNKS - round / 2; chunk++) {
+            fill_chunk(r, ref, chunk, (chunk + round) % 5);
+        }
+        if (round % 2) {
+            cstl_roaring_run_optimize(r);
+        }
+        size = cstl_roaring_save(r, NULL, 0);
+        image = (unsigned char*)malloc(size);
+        assert(cstl_roaring_save(r, image, size) == size);
+        back = cstl_roaring_load(image, size);
+        check_against(back, ref);
+        assert(cstl_roaring_save(back, NULL, 0) == size);
+        assert(cstl_roaring_load(image, size - 1) == NULL);
+        free(image);
+        cstl_roaring_delete(back);
+        cstl_roaring_delete(r);
+    }
+}
+
+void test_c_roaring(void)
+{
+    test_roaring_single_values();
+    test_roaring_set_ops();
+    test_roaring_gallop();
+    test_roaring_run_optimize();
+    test_roaring_serialization();
+}
@@ -81,6 +81,93 @@ static void test_with_iterators()
     cstl_set_delete(pSet);
 }
 
+static void test_find_batch(void)
+{
+    int keys[100];
+    const void* probes[100];
+    const void* found_keys[100];
+    size_t found;
+    int i;
+    struct cstl_set* pSet = cstl_set_new(compare_int, NULL);
+
+    for (i = 0; i < 300; i += 3) {
+        cstl_set_insert(pSet, &i, sizeof(int));
+    }
+    for (i = 0; i < 100; i++) {
+        keys[i] = i;
+        probes[i] = &keys[i];
+    }
+    found = cstl_set_find_batch(pSet, probes, 100, found_keys);
+    assert(found == 34);
+    for (i = 0; i < 100; i++) {
+        if (i % 3 == 0) {
+            assert(*(const int*)found_keys[i] == i);
+        }
+        else {
+            assert(found_keys[i] == NULL);
+        }
+    }
+    cstl_set_delete(pSet);
+    (void)found;
+}
+
+static int keys_destroyed;
+
+static void count_key_destroy(void* key)
+{
+    (void)key;
+    keys_destroyed++;
+}
+
+static void test_small_mode(void)
+{
+    struct cstl_set* pSet = cstl_set_new(compare_int, count_key_destroy);
+    struct cstl_iterator itr;
+    const void* pinned;
+    int i, expect;
+
+    keys_destroyed = 0;
+    for (i = 7; i >= 0; i--) {
+        assert(cstl_set_insert(pSet, &i, sizeof(i)) == CSTL_ERROR_SUCCESS);
+    }
+    i = 5;
+    assert(cstl_set_insert(pSet, &i, sizeof(i)) != CSTL_ERROR_SUCCESS);
+    pinned = cstl_set_find(pSet, &i);
+    assert(*(const int*)pinned == 5);
+
+    /* past the default limit the same nodes are linked into a tree */
+    for (i = 8; i < 20; i++) {
+        cstl_set_insert(pSet, &i, sizeof(i));
+    }
+    i = 5;
+    assert(cstl_set_find(pSet, &i) == pinned);
+    for (i = 19; i >= 6; i--) {
+        assert(cstl_set_remove(pSet, &i) == CSTL_ERROR_SUCCESS);
+    }
+    assert(cstl_set_remove(pSet, &i) == CSTL_ERROR_SUCCESS);
+    assert(cstl_set_remove(pSet, &i) == CSTL_RBTREE_KEY_NOT_FOUND);
+    i = 5;
+    assert(cstl_set_find(pSet, &i) == NULL);
+    i = 4;
+    pinned = cstl_set_find(pSet, &i);
+    assert(keys_destroyed == 15);
+
+    expect = 0;
+    cstl_set_iterator_init(&itr, pSet);
+    while (itr.next(&itr)) {
+        assert(*(const int*)itr.current_key(&itr) == expect++);
+    }
+    assert(expect == 5);
+
+    assert(cstl_set_small_limit(pSet, 2) == CSTL_ERROR_SUCCESS);
+    assert(cstl_set_find(pSet, &i) == pinned);
+    assert(cstl_set_small_limit(pSet, 16) == CSTL_ERROR_SUCCESS);
+    assert(cstl_set_find(pSet, &i) == pinned);
+    cstl_set_delete(pSet);
+    assert(keys_destroyed == 20);
+    (void)pinned;
+}
+
 void test_c_set()
 {
     {
@@ -152,4 +239,6 @@ void test_c_set()
         (void)v;
     }
     test_with_iterators();
+    test_find_batch();
+    test_small_mode();
 }
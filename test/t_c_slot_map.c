@@ -0,0 +1,158 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ROUNDS 100000
+#define LIVE 1000
+
+struct conn {
+    int fd;
+    unsigned long bytes;
+};
+
+static int destroyed;
+
+static void count_destroy(void* p)
+{
+    assert(((struct conn*)p)->fd >= 0);
+    ((struct conn*)p)->fd = -1;
+    destroyed++;
+}
+
+static void test_slot_map_basic(void)
+{
+    struct cstl_slot_map* sm = cstl_slot_map_new(sizeof(struct conn), NULL);
+    struct conn c = {3, 0};
+    cstl_slot_handle h;
+    cstl_slot_handle h2;
+
+    assert(cstl_slot_map_new(0, NULL) == NULL);
+    assert(cstl_slot_map_size(sm) == 0);
+    assert(cstl_slot_map_get(sm, CSTL_SLOT_HANDLE_NULL) == NULL);
+    assert(cstl_slot_map_insert(sm, NULL, &h) == CSTL_SLOT_MAP_INVALID_INPUT);
+
+    assert(cstl_slot_map_insert(sm, &c, &h) == CSTL_ERROR_SUCCESS);
+    assert(h != CSTL_SLOT_HANDLE_NULL);
+    assert(cstl_slot_map_contains(sm, h));
+    assert(((struct conn*)cstl_slot_map_get(sm, h))->fd == 3);
+    assert(cstl_slot_map_handle_at(sm, 0) == h);
+    assert(cstl_slot_map_handle_at(sm, 1) == CSTL_SLOT_HANDLE_NULL);
+
+    /* the slot is reused, but the old handle stays stale */
+    assert(cstl_slot_map_erase(sm, h) == CSTL_ERROR_SUCCESS);
+    assert(cstl_slot_map_erase(sm, h) == CSTL_SLOT_MAP_STALE_HANDLE);
+    c.fd = 4;
+    assert(cstl_slot_map_insert(sm, &c, &h2) == CSTL_ERROR_SUCCESS);
+    assert(h2 != h && (h2 & 0xFFFFFFFFu) == (h & 0xFFFFFFFFu));
+    assert(cstl_slot_map_get(sm, h) == NULL);
+    assert(((struct conn*)cstl_slot_map_get(sm, h2))->fd == 4);
+    /* a handle naming a free slot's current generation is not live */
+    assert(cstl_slot_map_erase(sm, h2) == CSTL_ERROR_SUCCESS);
+    assert(!cstl_slot_map_contains(sm, h2 + ((cstl_slot_handle)1 << 32)));
+    assert(!cstl_slot_map_contains(sm, h2 + 1));
+
+    assert(cstl_slot_map_delete(sm) == CSTL_ERROR_SUCCESS);
+    assert(cstl_slot_map_delete(NULL) == CSTL_SLOT_MAP_NOT_INITIALIZED);
+    assert(cstl_slot_map_erase(NULL, h) == CSTL_SLOT_MAP_NOT_INITIALIZED);
+    assert(cstl_slot_map_size(NULL) == 0);
+}
+
+static void test_slot_map_random(void)
+{
+    struct cstl_slot_map* sm =
+        cstl_slot_map_new(sizeof(struct conn), count_destroy);
+    static cstl_slot_handle live[LIVE];
+    static int fds[LIVE];
+    cstl_slot_handle dead[64];
+    int nlive = 0;
+    int ndead = 0;
+    int next_fd = 0;
+    int i;
+    size_t j;
+
+    srand(49);
+    destroyed = 0;
+    assert(cstl_slot_map_reserve(sm, 16) == CSTL_ERROR_SUCCESS);
+    for (i = 0; i < ROUNDS; i++) {
+        int op = rand() % 3;
+        if (nlive == 0 || (op != 0 && nlive < LIVE)) {
+            struct conn c;
+            c.fd = next_fd++;
+            c.bytes = (unsigned long)c.fd * 7;
+            assert(cstl_slot_map_insert(sm, &c, &live[nlive]) == 0);
+            fds[nlive++] = c.fd;
+        }
+        else {
+            int k = rand() % nlive;
+            assert(cstl_slot_map_erase(sm, live[k]) == CSTL_ERROR_SUCCESS);
+            dead[ndead++ % 64] = live[k];
+            live[k] = live[--nlive];
+            fds[k] = fds[nlive];
+        }
+        assert(cstl_slot_map_size(sm) == (size_t)nlive);
+        if (i % 1000 == 0) {
+            struct conn* all = (struct conn*)cstl_slot_map_data(sm);
+            for (j = 0; j < (size_t)nlive; j++) {
+                struct conn* c = (struct conn*)cstl_slot_map_get(sm, live[j]);
+                assert(c != NULL && c->fd == fds[j]);
+                assert(c->bytes == (unsigned long)c->fd * 7);
+            }
+            for (j = 0; j < (size_t)(ndead < 64 ? ndead : 64); j++) {
+                assert(!cstl_slot_map_contains(sm, dead[j]));
+            }
+            /* the packed values and their handles agree */
+            for (j = 0; j < cstl_slot_map_size(sm); j++) {
+                cstl_slot_handle h = cstl_slot_map_handle_at(sm, j);
+                assert(cstl_slot_map_get(sm, h) == &all[j]);
+            }
+        }
+    }
+    assert(destroyed == next_fd - nlive);
+
+    /* clear destroys the rest and leaves every handle stale */
+    cstl_slot_map_clear(sm);
+    assert(destroyed == next_fd);
+    assert(cstl_slot_map_size(sm) == 0);
+    for (j = 0; j < (size_t)nlive; j++) {
+        assert(cstl_slot_map_get(sm, live[j]) == NULL);
+    }
+    for (i = 0; i < 10; i++) {
+        struct conn c = {0, 0};
+        assert(cstl_slot_map_insert(sm, &c, NULL) == CSTL_ERROR_SUCCESS);
+    }
+    assert(cstl_slot_map_delete(sm) == CSTL_ERROR_SUCCESS);
+    assert(destroyed == next_fd + 10);
+}
+
+void test_c_slot_map(void)
+{
+    test_slot_map_basic();
+    test_slot_map_random();
+}
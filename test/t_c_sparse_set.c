@@ -0,0 +1,184 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UNIVERSE 5000
+#define ROUNDS 100000
+
+static int destroyed;
+
+static void count_destroy(void* p)
+{
+    assert(*(int*)p >= 0);
+    *(int*)p = -1;
+    destroyed++;
+}
+
+static void test_sparse_set_model(void)
+{
+    struct cstl_sparse_set* ss = cstl_sparse_set_new(64);
+    static char model[UNIVERSE];
+    size_t count = 0;
+    size_t j;
+    int i;
+
+    assert(cstl_sparse_set_size(ss) == 0);
+    assert(!cstl_sparse_set_contains(ss, 3));
+    assert(!cstl_sparse_set_contains(ss, 100000));
+    assert(cstl_sparse_set_insert(ss, 0xFFFFFFFFu) ==
+           CSTL_SPARSE_SET_INVALID_INPUT);
+
+    srand(50);
+    for (i = 0; i < ROUNDS; i++) {
+        uint32_t v = (uint32_t)(rand() % UNIVERSE);
+        if (rand() % 2) {
+            cstl_error rc = cstl_sparse_set_insert(ss, v);
+            assert(rc == (model[v] ? CSTL_SPARSE_SET_KEY_DUPLICATE
+                                   : CSTL_ERROR_SUCCESS));
+            count += !model[v];
+            model[v] = 1;
+        }
+        else {
+            cstl_error rc = cstl_sparse_set_erase(ss, v);
+            assert(rc == (model[v] ? CSTL_ERROR_SUCCESS
+                                   : CSTL_SPARSE_SET_KEY_NOT_FOUND));
+            count -= model[v];
+            model[v] = 0;
+        }
+        assert(cstl_sparse_set_size(ss) == count);
+        if (i % 5000 == 0) {
+            const uint32_t* members = cstl_sparse_set_data(ss);
+            for (j = 0; j < UNIVERSE; j++) {
+                assert(cstl_sparse_set_contains(ss, (uint32_t)j) == model[j]);
+            }
+            for (j = 0; j < count; j++) {
+                assert(model[members[j]]);
+            }
+        }
+    }
+
+    /* cleared members are gone even though their sparse entries remain */
+    cstl_sparse_set_clear(ss);
+    assert(cstl_sparse_set_size(ss) == 0);
+    for (j = 0; j < UNIVERSE; j++) {
+        assert(!cstl_sparse_set_contains(ss, (uint32_t)j));
+    }
+    assert(cstl_sparse_set_insert(ss, 7) == CSTL_ERROR_SUCCESS);
+    assert(cstl_sparse_set_contains(ss, 7));
+    assert(cstl_sparse_set_data(ss)[0] == 7);
+
+    assert(cstl_sparse_set_delete(ss) == CSTL_ERROR_SUCCESS);
+    assert(cstl_sparse_set_delete(NULL) == CSTL_SPARSE_SET_NOT_INITIALIZED);
+    assert(cstl_sparse_set_insert(NULL, 1) == CSTL_SPARSE_SET_NOT_INITIALIZED);
+    assert(cstl_sparse_set_erase(NULL, 1) == CSTL_SPARSE_SET_NOT_INITIALIZED);
+    assert(!cstl_sparse_set_contains(NULL, 1));
+
+    /* grows from nothing to a far value */
+    ss = cstl_sparse_set_new(0);
+    assert(cstl_sparse_set_insert(ss, 1000000) == CSTL_ERROR_SUCCESS);
+    assert(cstl_sparse_set_contains(ss, 1000000));
+    assert(!cstl_sparse_set_contains(ss, 999999));
+    cstl_sparse_set_delete(ss);
+}
+
+static void test_fd_map(void)
+{
+    struct cstl_fd_map* fm = cstl_fd_map_new(sizeof(int), count_destroy);
+    static int model[UNIVERSE];
+    size_t count = 0;
+    size_t j;
+    int i;
+
+    assert(cstl_fd_map_new(0, NULL) == NULL);
+    assert(cstl_fd_map_find(fm, 0) == NULL);
+    assert(cstl_fd_map_find(fm, -1) == NULL);
+    i = 1;
+    assert(cstl_fd_map_insert(fm, -1, &i) == CSTL_SPARSE_SET_INVALID_INPUT);
+    assert(cstl_fd_map_insert(fm, 1, NULL) == CSTL_SPARSE_SET_INVALID_INPUT);
+    assert(cstl_fd_map_erase(fm, -1) == CSTL_SPARSE_SET_KEY_NOT_FOUND);
+
+    /* model[fd] holds the value stored for fd plus one, 0 when absent */
+    destroyed = 0;
+    srand(51);
+    for (i = 0; i < ROUNDS; i++) {
+        int fd = rand() % UNIVERSE;
+        if (rand() % 2) {
+            int v = rand() % 1000;
+            cstl_error rc = cstl_fd_map_insert(fm, fd, &v);
+            if (model[fd]) {
+                assert(rc == CSTL_SPARSE_SET_KEY_DUPLICATE);
+            }
+            else {
+                assert(rc == CSTL_ERROR_SUCCESS);
+                model[fd] = v + 1;
+                count++;
+            }
+        }
+        else {
+            cstl_error rc = cstl_fd_map_erase(fm, fd);
+            assert(rc == (model[fd] ? CSTL_ERROR_SUCCESS
+                                    : CSTL_SPARSE_SET_KEY_NOT_FOUND));
+            count -= model[fd] != 0;
+            model[fd] = 0;
+        }
+        assert(cstl_fd_map_size(fm) == count);
+        if (i % 5000 == 0) {
+            int* values = (int*)cstl_fd_map_data(fm);
+            for (j = 0; j < UNIVERSE; j++) {
+                int* v = (int*)cstl_fd_map_find(fm, (int)j);
+                assert(model[j] ? v && *v == model[j] - 1 : v == NULL);
+            }
+            for (j = 0; j < count; j++) {
+                assert(model[cstl_fd_map_fd_at(fm, j)] == values[j] + 1);
+            }
+            assert(cstl_fd_map_fd_at(fm, count) == -1);
+        }
+    }
+
+    i = destroyed;
+    cstl_fd_map_clear(fm);
+    assert(destroyed == i + (int)count);
+    assert(cstl_fd_map_size(fm) == 0);
+    for (j = 0; j < UNIVERSE; j++) {
+        assert(cstl_fd_map_find(fm, (int)j) == NULL);
+    }
+    i = 42;
+    assert(cstl_fd_map_insert(fm, 3, &i) == CSTL_ERROR_SUCCESS);
+    assert(*(int*)cstl_fd_map_find(fm, 3) == 42);
+    assert(cstl_fd_map_delete(fm) == CSTL_ERROR_SUCCESS);
+    assert(cstl_fd_map_delete(NULL) == CSTL_SPARSE_SET_NOT_INITIALIZED);
+    assert(cstl_fd_map_size(NULL) == 0);
+}
+
+void test_c_sparse_set(void)
+{
+    test_sparse_set_model();
+    test_fd_map();
+}
@@ -0,0 +1,136 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+static int compare_int(const void* lhs, const void* rhs)
+{
+    int a = *(const int*)lhs;
+    int b = *(const int*)rhs;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/* every size up to a few full levels, probing between and around keys */
+static void test_static_index_sizes(void)
+{
+    int keys[300], values[300];
+    int n, i, probe;
+    for (i = 0; i < 300; i++) {
+        keys[i] = i * 2;
+        values[i] = -i;
+    }
+    for (n = 0; n <= 300; n++) {
+        struct cstl_static_index* ix = cstl_static_index_from_array(
+            keys, values, (size_t)n, sizeof(int), sizeof(int), compare_int);
+        struct cstl_iterator itr;
+        assert(ix && cstl_static_index_size(ix) == (size_t)n);
+        for (probe = -1; probe <= 2 * n; probe++) {
+            const int* lb =
+                (const int*)cstl_static_index_lower_bound(ix, &probe);
+            const int* v = (const int*)cstl_static_index_find(ix, &probe);
+            int expect = probe < 0 ? 0 : (probe + 1) / 2;
+            if (expect >= n) {
+                assert(lb == NULL);
+            }
+            else {
+                assert(lb && *lb == expect * 2);
+                assert(*(const int*)cstl_static_index_value(ix, lb) ==
+                       -expect);
+            }
+            if (probe >= 0 && probe % 2 == 0 && probe / 2 < n) {
+                assert(v && *v == -(probe / 2));
+            }
+            else {
+                assert(v == NULL);
+            }
+        }
+        i = 0;
+        cstl_static_index_iterator_init(&itr, ix);
+        while (itr.next(&itr)) {
+            assert(*(const int*)itr.current_key(&itr) == i * 2);
+            assert(*(const int*)itr.current_value(&itr) == -i);
+            i++;
+        }
+        assert(i == n);
+        cstl_static_index_delete(ix);
+    }
+}
+
+static void test_static_index_sources(void)
+{
+    struct cstl_set* set = cstl_set_new(compare_int, NULL);
+    struct cstl_map* map = cstl_map_new(compare_int, NULL, NULL);
+    struct cstl_static_index* ix;
+    struct cstl_iterator* itr;
+    int i, v, prev;
+
+    for (i = 0; i < 1000; i++) {
+        v = rand() % 5000;
+        cstl_set_insert(set, &v, sizeof(v));
+        cstl_map_insert(map, &v, sizeof(v), &i, sizeof(i));
+    }
+
+    ix = cstl_static_index_from_set(set, sizeof(int), compare_int);
+    for (v = 0; v < 5000; v++) {
+        const void* k = cstl_static_index_find(ix, &v);
+        assert((k != NULL) == (cstl_set_find(set, &v) != NULL));
+        assert(k == NULL || *(const int*)k == v);
+    }
+    prev = -1;
+    itr = cstl_static_index_new_iterator(ix);
+    while (itr->next(itr)) {
+        v = *(const int*)itr->current_key(itr);
+        assert(v > prev && cstl_set_find(set, &v));
+        prev = v;
+    }
+    cstl_static_index_delete_iterator(itr);
+    cstl_static_index_delete(ix);
+
+    ix = cstl_static_index_from_map(map, sizeof(int), sizeof(int),
+                                    compare_int);
+    for (v = 0; v < 5000; v++) {
+        const int* a = (const int*)cstl_static_index_find(ix, &v);
+        const int* b = (const int*)cstl_map_find(map, &v);
+        assert((a == NULL) == (b == NULL));
+        assert(a == NULL || *a == *b);
+    }
+    cstl_static_index_delete(ix);
+    cstl_set_delete(set);
+    cstl_map_delete(map);
+}
+
+void test_c_static_index(void)
+{
+    int k = 1;
+    assert(cstl_static_index_from_array(&k, NULL, 1, 0, 0, compare_int) ==
+           NULL);
+    assert(cstl_static_index_delete(NULL) ==
+           CSTL_STATIC_INDEX_NOT_INITIALIZED);
+    test_static_index_sizes();
+    test_static_index_sources();
+}
@@ -0,0 +1,130 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NAMES 20000
+
+static void make_name(char* buf, int i)
+{
+    sprintf(buf, "host-%d.example.com", i);
+}
+
+static void test_string_pool_intern(void)
+{
+    struct cstl_string_pool* pool = cstl_string_pool_new();
+    static const char* first[NAMES];
+    static char big[100000];
+    const char* a;
+    const char* b;
+    char buf[64];
+    int i;
+
+    /* the same pointer every time, stable while the index grows */
+    for (i = 0; i < NAMES; i++) {
+        make_name(buf, i);
+        first[i] = cstl_string_pool_intern(pool, buf);
+        assert(first[i] != buf && strcmp(first[i], buf) == 0);
+        assert(cstl_string_pool_length(first[i]) == strlen(buf));
+    }
+    assert(cstl_string_pool_size(pool) == NAMES);
+    for (i = 0; i < NAMES; i++) {
+        make_name(buf, i);
+        assert(cstl_string_pool_intern(pool, buf) == first[i]);
+        assert(cstl_string_pool_find(pool, buf, strlen(buf)) == first[i]);
+    }
+    assert(cstl_string_pool_size(pool) == NAMES);
+    assert(cstl_string_pool_find(pool, "absent", 6) == NULL);
+
+    /* lengths count, embedded NULs included */
+    a = cstl_string_pool_intern_n(pool, "ab\0c", 4);
+    b = cstl_string_pool_intern_n(pool, "ab\0d", 4);
+    assert(a != b && cstl_string_pool_length(a) == 4 && a[4] == '\0');
+    assert(cstl_string_pool_intern(pool, "ab") != a);
+    assert(cstl_string_pool_intern_n(pool, "abc", 2) ==
+           cstl_string_pool_intern(pool, "ab"));
+    a = cstl_string_pool_intern(pool, "");
+    assert(a && *a == '\0' && cstl_string_pool_intern_n(pool, NULL, 0) == a);
+    assert(cstl_string_pool_intern(pool, NULL) == NULL);
+
+    /* strings longer than a block */
+    memset(big, 'x', sizeof(big) - 1);
+    a = cstl_string_pool_intern(pool, big);
+    big[0] = 'y';
+    b = cstl_string_pool_intern(pool, big);
+    assert(a != b && a[0] == 'x' && b[0] == 'y');
+    assert(cstl_string_pool_length(b) == sizeof(big) - 1);
+    make_name(buf, NAMES - 1);
+    assert(cstl_string_pool_intern(pool, buf) == first[NAMES - 1]);
+    assert(cstl_string_pool_memory(pool) > 2 * sizeof(big));
+
+    assert(cstl_string_pool_delete(pool) == CSTL_ERROR_SUCCESS);
+    assert(cstl_string_pool_delete(NULL) == CSTL_STRING_POOL_NOT_INITIALIZED);
+}
+
+static void test_string_pool_keys(void)
+{
+    struct cstl_string_pool* pool = cstl_string_pool_new();
+    struct cstl_map* m = cstl_map_new(cstl_string_pool_compare, NULL, NULL);
+    struct cstl_set* s = cstl_set_new(cstl_string_pool_compare, NULL);
+    const char* key;
+    char buf[64];
+    int i, v;
+
+    for (i = 0; i < 1000; i++) {
+        make_name(buf, i);
+        key = cstl_string_pool_intern(pool, buf);
+        assert(cstl_map_insert(m, &key, sizeof(key), &i, sizeof(i)) ==
+               CSTL_ERROR_SUCCESS);
+        cstl_set_insert(s, (void*)&key, sizeof(key));
+        /* a second container shares the same copy of the string */
+        make_name(buf, i);
+        key = cstl_string_pool_intern(pool, buf);
+        assert(cstl_map_insert(m, &key, sizeof(key), &i, sizeof(i)) ==
+               CSTL_RBTREE_KEY_DUPLICATE);
+    }
+    assert(cstl_string_pool_size(pool) == 1000);
+    for (i = 999; i >= 0; i--) {
+        make_name(buf, i);
+        key = cstl_string_pool_find(pool, buf, strlen(buf));
+        v = *(const int*)cstl_map_find(m, &key);
+        assert(v == i && cstl_set_is_key_exists(s, (void*)&key));
+    }
+    key = cstl_string_pool_intern(pool, "not a host");
+    assert(cstl_map_find(m, &key) == NULL);
+    cstl_map_delete(m);
+    cstl_set_delete(s);
+    cstl_string_pool_delete(pool);
+}
+
+void test_c_string_pool(void)
+{
+    test_string_pool_intern();
+    test_string_pool_keys();
+}
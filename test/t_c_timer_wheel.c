@@ -0,0 +1,158 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+#define TW_N 2000
+
+struct conn_timer {
+    struct cstl_timer timer;
+    int id;
+    int fired;
+    uint64_t due; /* tick it must fire at */
+};
+
+struct tw_ctx {
+    struct cstl_timer_wheel* w;
+    struct conn_timer* conns;
+    int rearmed;
+};
+
+static void on_expire(struct cstl_timer* timer, void* p)
+{
+    struct tw_ctx* ctx = (struct tw_ctx*)p;
+    struct conn_timer* c = cstl_container_of(timer, struct conn_timer, timer);
+    uint64_t now = cstl_timer_wheel_now(ctx->w);
+
+    assert(!cstl_timer_is_armed(timer));
+    assert(now == c->due);
+    c->fired++;
+    /* every 7th connection re-arms itself once, at various distances */
+    if (c->id % 7 == 0 && c->fired == 1) {
+        uint64_t delay = (uint64_t)(c->id % 3 == 0 ? 0 : c->id * 37);
+        cstl_timer_wheel_schedule(ctx->w, timer, now + delay);
+        c->due = now + (delay ? delay : 1);
+        ctx->rearmed++;
+    }
+    /* cancel a neighbour that may be due in the same tick */
+    if (c->id % 11 == 0 && c->id + 1 < TW_N) {
+        struct conn_timer* n = &ctx->conns[c->id + 1];
+        if (cstl_timer_is_armed(&n->timer)) {
+            cstl_timer_wheel_cancel(ctx->w, &n->timer);
+            n->due = 0;
+        }
+    }
+}
+
+static void test_timer_wheel_random(void)
+{
+    static struct conn_timer conns[TW_N];
+    struct tw_ctx ctx;
+    uint64_t start = 1000, now;
+    size_t fired = 0;
+    int i;
+
+    ctx.w = cstl_timer_wheel_new(start);
+    ctx.conns = conns;
+    ctx.rearmed = 0;
+    for (i = 0; i < TW_N; i++) {
+        uint64_t delay;
+        switch (i % 4) {
+        case 0:
+            delay = (uint64_t)(rand() % 64);
+            break;
+        case 1:
+            delay = (uint64_t)(rand() % 5000);
+            break;
+        case 2:
+            delay = (uint64_t)(rand() % 300000);
+            break;
+        default:
+            /* beyond the top level: exercises the overflow list */
+            delay = ((uint64_t)1 << 24) + (uint64_t)(rand() % 100000);
+            break;
+        }
+        conns[i].id = i;
+        conns[i].fired = 0;
+        cstl_timer_init(&conns[i].timer);
+        cstl_timer_wheel_schedule(ctx.w, &conns[i].timer, start + delay);
+        conns[i].due = start + (delay ? delay : 1);
+    }
+    assert(cstl_timer_wheel_count(ctx.w) == TW_N);
+
+    /* re-arm some and cancel some before they run */
+    for (i = 0; i < TW_N; i += 10) {
+        cstl_timer_wheel_schedule(ctx.w, &conns[i].timer, start + 77);
+        conns[i].due = start + 77;
+    }
+    for (i = 5; i < TW_N; i += 10) {
+        cstl_timer_wheel_cancel(ctx.w, &conns[i].timer);
+        assert(!cstl_timer_is_armed(&conns[i].timer));
+        conns[i].due = 0;
+    }
+
+    /* advance in uneven steps */
+    for (now = start; cstl_timer_wheel_count(ctx.w) != 0;) {
+        now += (uint64_t)(rand() % 2000) + 1;
+        fired += cstl_timer_wheel_advance(ctx.w, now, on_expire, &ctx);
+        assert(cstl_timer_wheel_now(ctx.w) == now);
+    }
+    for (i = 0; i < TW_N; i++) {
+        if (conns[i].due == 0) {
+            assert(conns[i].fired <= 1);
+        }
+        else {
+            assert(conns[i].fired ==
+                   ((i % 7 == 0 && conns[i].fired) ? 2 : 1));
+        }
+    }
+    assert(fired > 0 && ctx.rearmed > 0);
+    cstl_timer_wheel_delete(ctx.w);
+}
+
+static void test_timer_wheel_past_and_delete(void)
+{
+    struct cstl_timer_wheel* w = cstl_timer_wheel_new(500);
+    struct cstl_timer a, b;
+
+    cstl_timer_init(&a);
+    cstl_timer_init(&b);
+    /* already due: fires on the next tick */
+    cstl_timer_wheel_schedule(w, &a, 10);
+    cstl_timer_wheel_schedule(w, &b, 100000);
+    assert(cstl_timer_wheel_advance(w, 500, NULL, NULL) == 0);
+    assert(cstl_timer_wheel_advance(w, 501, NULL, NULL) == 1);
+    assert(!cstl_timer_is_armed(&a) && cstl_timer_is_armed(&b));
+    cstl_timer_wheel_delete(w);
+    assert(!cstl_timer_is_armed(&b));
+}
+
+void test_c_timer_wheel(void)
+{
+    test_timer_wheel_random();
+    test_timer_wheel_past_and_delete();
+}
@@ -0,0 +1,151 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_stl_lib.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+static int compare_int(const void* lhs, const void* rhs)
+{
+    int a = *(const int*)lhs;
+    int b = *(const int*)rhs;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+struct expiries {
+    int count;
+    int key_sum;
+};
+
+static void on_expire(const void* key, void* value, void* p)
+{
+    struct expiries* ex = (struct expiries*)p;
+    (void)value;
+    ex->count++;
+    ex->key_sum += *(const int*)key;
+}
+
+static void test_ttl_map_lazy(void)
+{
+    struct cstl_ttl_map* m;
+    struct expiries ex;
+    int k, v;
+    int* pv;
+
+    memset(&ex, 0, sizeof(ex));
+    /* one unit of work per call, so we can see lazy expiry happen */
+    m = cstl_ttl_map_new(compare_int, NULL, NULL, 1);
+    cstl_ttl_map_on_expire(m, on_expire, &ex);
+
+    for (k = 0; k < 10; k++) {
+        v = k * 100;
+        assert(cstl_ttl_map_insert(m, &k, sizeof(k), &v, sizeof(v), 0,
+                                   10 + k) == CSTL_ERROR_SUCCESS);
+    }
+    assert(cstl_ttl_map_size(m) == 10);
+    k = 3;
+    v = 1;
+    assert(cstl_ttl_map_insert(m, &k, sizeof(k), &v, sizeof(v), 0, 5) ==
+           CSTL_RBTREE_KEY_DUPLICATE);
+
+    pv = (int*)cstl_ttl_map_find(m, &k, 12);
+    assert(pv && *pv == 300);
+    /* at 12, keys 0..2 are due but only one was dropped by that find */
+    assert(ex.count == 1 && cstl_ttl_map_size(m) == 9);
+
+    /* a due entry is invisible even before the sweep reaches it */
+    k = 2;
+    assert(cstl_ttl_map_find(m, &k, 12) == NULL);
+    assert(ex.count == 3 && ex.key_sum == 0 + 1 + 2);
+    assert(cstl_ttl_map_size(m) == 7);
+
+    /* touching key 3 keeps it alive past its original deadline */
+    k = 3;
+    assert(cstl_ttl_map_touch(m, &k, 12, 100) == CSTL_ERROR_SUCCESS);
+    assert(cstl_ttl_map_expire(m, 50, 100) == 6);
+    assert(cstl_ttl_map_size(m) == 1);
+    pv = (int*)cstl_ttl_map_find(m, &k, 111);
+    assert(pv && *pv == 300);
+    assert(cstl_ttl_map_touch(m, &k, 112, 1) == CSTL_RBTREE_KEY_NOT_FOUND);
+    assert(cstl_ttl_map_size(m) == 0);
+    assert(ex.count == 10);
+
+    /* an expired key can be inserted again */
+    v = 7;
+    assert(cstl_ttl_map_insert(m, &k, sizeof(k), &v, sizeof(v), 200, 1) ==
+           CSTL_ERROR_SUCCESS);
+    assert(cstl_ttl_map_remove(m, &k) == CSTL_ERROR_SUCCESS);
+    assert(cstl_ttl_map_remove(m, &k) == CSTL_RBTREE_KEY_NOT_FOUND);
+    assert(ex.count == 10);
+
+    cstl_ttl_map_delete(m);
+}
+
+static int destroyed;
+
+static void count_destroy(void* p)
+{
+    (void)p;
+    destroyed++;
+}
+
+static void test_ttl_map_bounded_work(void)
+{
+    struct cstl_ttl_map* m;
+    int k;
+    uint64_t huge = ~(uint64_t)0;
+
+    destroyed = 0;
+    m = cstl_ttl_map_new(compare_int, NULL, count_destroy, 0);
+    for (k = 0; k < 1000; k++) {
+        assert(cstl_ttl_map_insert(m, &k, sizeof(k), &k, sizeof(k), 0,
+                                   10 + k) == CSTL_ERROR_SUCCESS);
+    }
+    /* a ttl that would overflow saturates instead of expiring at once */
+    assert(cstl_ttl_map_insert(m, &k, sizeof(k), &k, sizeof(k), 5, huge) ==
+           CSTL_ERROR_SUCCESS);
+    assert(cstl_ttl_map_expire(m, 2000, 100) == 100);
+    assert(cstl_ttl_map_size(m) == 901);
+    assert(cstl_ttl_map_expire(m, 2000, 10000) == 900);
+    assert(destroyed == 1000);
+    assert(cstl_ttl_map_find(m, &k, huge - 1) != NULL);
+    assert(cstl_ttl_map_expire(m, huge, 10) == 1);
+
+    for (k = 0; k < 10; k++) {
+        assert(cstl_ttl_map_insert(m, &k, sizeof(k), &k, sizeof(k), 0,
+                                   1000) == CSTL_ERROR_SUCCESS);
+    }
+    cstl_ttl_map_delete(m);
+    assert(destroyed == 1011);
+}
+
+void test_c_ttl_map(void)
+{
+    assert(cstl_ttl_map_new(NULL, NULL, NULL, 0) == NULL);
+    assert(cstl_ttl_map_delete(NULL) == CSTL_TTL_MAP_NOT_INITIALIZED);
+    test_ttl_map_lazy();
+    test_ttl_map_bounded_work();
+}
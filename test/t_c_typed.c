@@ -0,0 +1,182 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "c_typed.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+struct session {
+    unsigned long id;
+    int port;
+};
+
+#define cmp_ulong(a, b) ((*(a) > *(b)) - (*(a) < *(b)))
+
+CSTL_DEFINE_MAP(sess_map, unsigned long, struct session, cmp_ulong);
+CSTL_DEFINE_ARRAY(int_array, int);
+CSTL_DEFINE_SMALL_VECTOR(int_svec, int, 4);
+CSTL_DEFINE_SMALL_VECTOR(sess_svec, struct session, 2);
+
+struct request {
+    int method;
+    struct int_svec args;
+};
+
+static int compare_int(const void* left, const void* right)
+{
+    return cmp_ulong((const int*)left, (const int*)right);
+}
+
+static void test_typed_map(void)
+{
+    struct sess_map* m = sess_map_new();
+    struct sess_map_node* n;
+    struct session* s;
+    unsigned long i, prev = 0;
+    int inserted;
+
+    for (i = 1; i <= 1000; i++) {
+        struct session v;
+        unsigned long key = (i * 7919) % 1009;
+        v.id = key;
+        v.port = (int)key + 1;
+        assert(sess_map_insert(m, key, v) == CSTL_ERROR_SUCCESS);
+        assert(sess_map_insert(m, key, v) == CSTL_RBTREE_KEY_DUPLICATE);
+    }
+    assert(sess_map_size(m) == 1000);
+    for (i = 0; i < 1009; i++) {
+        s = sess_map_find(m, i);
+        if (s) {
+            assert(s->id == i && s->port == (int)i + 1);
+        }
+    }
+    for (n = sess_map_first(m); n; n = sess_map_next(m, n)) {
+        assert(prev == 0 || n->key > prev);
+        prev = n->key;
+    }
+    for (i = 0; i < 1009; i += 2) {
+        cstl_error e = sess_map_remove(m, i);
+        assert(e == CSTL_ERROR_SUCCESS || e == CSTL_RBTREE_KEY_NOT_FOUND);
+        (void)e;
+        assert(!sess_map_contains(m, i));
+    }
+    s = sess_map_emplace(m, 2, &inserted);
+    assert(inserted && s->port == 0);
+    s = sess_map_emplace(m, 2, &inserted);
+    assert(!inserted);
+    sess_map_delete(m);
+    (void)s;
+    (void)prev;
+}
+
+static void test_typed_array(void)
+{
+    struct int_array a;
+    int i;
+
+    int_array_init(&a);
+    for (i = 0; i < 100; i++) {
+        int_array_push_back(&a, 99 - i);
+    }
+    int_array_insert_at(&a, 0, 1000);
+    assert(*int_array_at(&a, 0) == 1000);
+    int_array_remove_at(&a, 0);
+    int_array_sort(&a, compare_int);
+    for (i = 0; i < 100; i++) {
+        assert(*int_array_at(&a, (size_t)i) == i);
+    }
+    assert(int_array_at(&a, 100) == NULL);
+    int_array_pop_back(&a);
+    assert(int_array_size(&a) == 99);
+    int_array_clear(&a);
+}
+
+static void test_typed_small_vector(void)
+{
+    struct int_svec v;
+    struct request r, copy;
+    struct sess_svec sessions;
+    struct session s;
+    int i, *p, *end;
+
+    /* up to N elements stay inline */
+    int_svec_init(&v);
+    assert(int_svec_pop_back(&v) == CSTL_ARRAY_INDEX_OUT_OF_BOUND);
+    for (i = 0; i < 4; i++) {
+        assert(int_svec_push_back(&v, 10 - i) == CSTL_ERROR_SUCCESS);
+    }
+    assert(int_svec_data(&v) == v.inline_ && int_svec_capacity(&v) == 4);
+    assert(int_svec_insert_at(&v, 5, 0) == CSTL_ARRAY_INDEX_OUT_OF_BOUND);
+
+    /* the fifth spills to the heap, keeping the order */
+    assert(int_svec_insert_at(&v, 2, 100) == CSTL_ERROR_SUCCESS);
+    assert(int_svec_data(&v) != v.inline_ && int_svec_capacity(&v) == 8);
+    assert(*int_svec_at(&v, 0) == 10 && *int_svec_at(&v, 2) == 100);
+    assert(*int_svec_at(&v, 4) == 7 && int_svec_at(&v, 5) == NULL);
+    for (i = 0; i < 100; i++) {
+        int_svec_push_back(&v, i * 37 % 101);
+    }
+    assert(int_svec_remove_at(&v, 2) == CSTL_ERROR_SUCCESS);
+    assert(int_svec_remove_at(&v, 104) == CSTL_ARRAY_INDEX_OUT_OF_BOUND);
+    int_svec_sort(&v, compare_int);
+    p = int_svec_data(&v);
+    for (end = p + int_svec_size(&v) - 1; p < end; p++) {
+        assert(p[0] <= p[1]);
+    }
+    assert(int_svec_size(&v) == 104);
+    int_svec_clear(&v);
+    assert(int_svec_size(&v) == 0 && int_svec_data(&v) == v.inline_);
+
+    /* embedded, and copied by value while inline */
+    r.method = 1;
+    int_svec_init(&r.args);
+    int_svec_push_back(&r.args, 7);
+    int_svec_push_back(&r.args, 8);
+    copy = r;
+    *int_svec_at(&copy.args, 0) = 9;
+    assert(*int_svec_at(&r.args, 0) == 7 && *int_svec_at(&copy.args, 1) == 8);
+    int_svec_pop_back(&r.args);
+    assert(int_svec_size(&r.args) == 1 && int_svec_size(&copy.args) == 2);
+    int_svec_clear(&r.args);
+
+    sess_svec_init(&sessions);
+    for (i = 0; i < 5; i++) {
+        s.id = (unsigned long)i;
+        s.port = 80 + i;
+        sess_svec_insert_at(&sessions, 0, s);
+    }
+    assert(sess_svec_reserve(&sessions, 3) == CSTL_ERROR_SUCCESS);
+    assert(sess_svec_at(&sessions, 0)->port == 84);
+    assert(sess_svec_at(&sessions, 4)->id == 0);
+    sess_svec_clear(&sessions);
+}
+
+void test_c_typed(void)
+{
+    test_typed_map();
+    test_typed_array();
+    test_typed_small_vector();
+}
@@ -30,6 +30,10 @@ extern void test_c_array();
 extern void test_c_deque();
 extern void test_c_rb();
 extern void test_c_rb2(void);
+extern void test_c_rb_find_batch(void);
+extern void test_c_rb_compact_node(void);
+extern void test_c_rb_idx(void);
+extern void test_c_rb_intrusive(void);
 void test_c_rb2_alloc(void);
 void test_rbt_string(void);
 void test_rbt_string2(void);
@@ -37,8 +41,26 @@ void test_rbt_string2(void);
 extern void test_c_set();
 extern void test_c_map();
 extern void test_c_slist();
+extern void test_c_ilist(void);
+extern void test_c_pqueue(void);
+extern void test_c_timer_wheel(void);
+extern void test_c_lru(void);
+extern void test_c_ttl_map(void);
+extern void test_c_flat_map(void);
+extern void test_c_static_index(void);
+extern void test_c_radix_tree(void);
+extern void test_c_art(void);
+extern void test_c_lpm(void);
+extern void test_c_bitset(void);
+extern void test_c_roaring(void);
+extern void test_c_bloom(void);
+extern void test_c_string_pool(void);
+extern void test_c_slot_map(void);
+extern void test_c_sparse_set(void);
 extern void test_c_map();
 extern void test_c_algorithms();
+extern void test_c_typed(void);
+extern void test_cpp_containers(void);
 
 #if defined(_MSC_VER)
 #if !defined(_CRTDBG_MAP_ALLOC)
@@ -88,6 +110,10 @@ int main(int argc, char** argv)
         printf("Performing test for red-black tree\n");
         test_c_rb();
         test_c_rb2();
+        test_c_rb_find_batch();
+        test_c_rb_compact_node();
+        test_c_rb_intrusive();
+        test_c_rb_idx();
         test_c_rb2_alloc();
         test_rbt_string();
         test_rbt_string2();
@@ -102,8 +128,44 @@ int main(int argc, char** argv)
         test_c_map();
         printf("Performing test for slist\n");
         test_c_slist();
+        printf("Performing test for intrusive list\n");
+        test_c_ilist();
+        printf("Performing test for priority queue\n");
+        test_c_pqueue();
+        printf("Performing test for timer wheel\n");
+        test_c_timer_wheel();
+        printf("Performing test for lru cache\n");
+        test_c_lru();
+        printf("Performing test for ttl map\n");
+        test_c_ttl_map();
+        printf("Performing test for flat map and set\n");
+        test_c_flat_map();
+        printf("Performing test for static index\n");
+        test_c_static_index();
+        printf("Performing test for radix tree\n");
+        test_c_radix_tree();
+        printf("Performing test for adaptive radix tree\n");
+        test_c_art();
+        printf("Performing test for longest-prefix match\n");
+        test_c_lpm();
+        printf("Performing test for bitset\n");
+        test_c_bitset();
+        printf("Performing test for roaring bitmap\n");
+        test_c_roaring();
+        printf("Performing test for bloom filter\n");
+        test_c_bloom();
+        printf("Performing test for string pool\n");
+        test_c_string_pool();
+        printf("Performing test for slot map\n");
+        test_c_slot_map();
+        printf("Performing test for sparse set\n");
+        test_c_sparse_set();
         printf("Performing algorithms tests\n");
         test_c_algorithms();
+        printf("Performing test for typed containers\n");
+        test_c_typed();
+        printf("Performing test for C++ containers\n");
+        test_cpp_containers();
     }
     {
         /* in seconds */
@@ -0,0 +1,217 @@
+/** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **
+ *  This file is part of cstl library
+ *  Copyright (C) 2011 Avinash Dongre ( dongre.avinash@gmail.com )
+ *  Copyright (C) 2018 ssrlive ( ssrlivebox@gmail.com )
+ * 
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ * 
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** ** **/
+
+#include "cstl_deque.hpp"
+#include "cstl_map.hpp"
+#include "cstl_set.hpp"
+#include "cstl_vector.hpp"
+
+#include <assert.h>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+static void test_cpp_map(void)
+{
+    cstl::map<int, std::string> m;
+    std::map<int, std::string> ref;
+    int i;
+
+    for (i = 0; i < 2000; i++) {
+        int key = (i * 7919) % 1009;
+        std::string v = std::to_string(key);
+        bool ins = m.insert(std::make_pair(key, v)).second;
+        assert(ins == ref.insert(std::make_pair(key, v)).second);
+        (void)ins;
+    }
+    assert(m.size() == ref.size() && m.size() == 1009);
+    {
+        std::map<int, std::string>::const_iterator r = ref.begin();
+        cstl::map<int, std::string>::const_iterator it;
+        for (it = m.begin(); it != m.end(); ++it, ++r) {
+            assert(it->first == r->first && it->second == r->second);
+        }
+        assert(r == ref.end());
+    }
+    assert(m.find(5000) == m.end() && m.count(5) == 1);
+    assert(m.lower_bound(-1)->first == 0);
+    assert(m.upper_bound(1007)->first == 1008);
+    assert(m.upper_bound(1008) == m.end());
+    assert((--m.end())->first == 1008);
+
+    m[5] = "five";
+    assert(m.at(5) == "five");
+    assert(m[2000].empty() && m.size() == 1010);
+    assert(!m.try_emplace(5, "x").second && m.at(5) == "five");
+    assert(m.emplace(3000, "y").second && m.at(3000) == "y");
+    try {
+        m.at(-1);
+        assert(0);
+    }
+    catch (const std::out_of_range&) {
+    }
+
+    for (i = 0; i < 1009; i += 2) {
+        assert(m.erase(i) == 1);
+    }
+    assert(m.erase(0) == 0);
+    {
+        cstl::map<int, std::string>::iterator it = m.begin();
+        while (it != m.end()) {
+            it = it->first % 3 == 0 ? m.erase(it) : ++it;
+        }
+    }
+    for (cstl::map<int, std::string>::iterator it = m.begin(); it != m.end();
+         ++it) {
+        assert(it->first % 2 == 1 || it->first >= 2000);
+        assert(it->first % 3 != 0);
+    }
+    {
+        cstl::map<int, std::string> copy(m);
+        cstl::map<int, std::string> moved(std::move(copy));
+        assert(copy.empty() && copy.begin() == copy.end());
+        assert(moved.size() == m.size());
+        copy = moved;
+        assert(copy.size() == m.size() && copy.at(1) == m.at(1));
+        copy[-7] = "neg";
+        assert(copy.size() == m.size() + 1 && m.count(-7) == 0);
+    }
+    m.clear();
+    assert(m.empty() && m.begin() == m.end());
+    m[1] = "reuse";
+    assert(m.size() == 1);
+}
+
+struct reverse_order {
+    bool operator()(int a, int b) const
+    {
+        return a > b;
+    }
+};
+
+static void test_cpp_set(void)
+{
+    cstl::set<int, reverse_order> s = { 3, 1, 4, 1, 5, 9, 2, 6 };
+    cstl::set<std::string> names;
+    int prev = 100;
+
+    assert(s.size() == 7);
+    for (cstl::set<int, reverse_order>::iterator it = s.begin(); it != s.end();
+         ++it) {
+        assert(*it < prev);
+        prev = *it;
+    }
+    assert(*s.lower_bound(7) == 6 && *s.upper_bound(6) == 5);
+    assert(s.erase(4) == 1 && s.count(4) == 0 && s.size() == 6);
+
+    assert(names.insert("beta").second);
+    assert(names.emplace("alpha").second);
+    assert(!names.insert("beta").second);
+    assert(*names.begin() == "alpha");
+    names.erase(names.begin());
+    assert(names.size() == 1 && *names.begin() == "beta");
+}
+
+static void test_cpp_vector(void)
+{
+    cstl::vector<std::string> v;
+    cstl::vector<int> n = { 1, 2, 3 };
+    int i;
+
+    for (i = 0; i < 100; i++) {
+        v.push_back(std::to_string(i));
+    }
+    v.push_back(v[0]); /* aliases an element across a reallocation */
+    assert(v.size() == 101 && v.back() == "0" && v.at(99) == "99");
+    v.insert(v.begin(), "head");
+    assert(v.front() == "head" && v[1] == "0" && v.size() == 102);
+    v.erase(v.begin() + 1);
+    assert(v[1] == "1" && v.size() == 101);
+    v.pop_back();
+    v.resize(10);
+    assert(v.size() == 10 && v[9] == "9");
+    v.resize(12);
+    assert(v[11].empty());
+
+    {
+        cstl::vector<std::string> copy(v);
+        assert(copy.size() == 12 && copy[3] == v[3]);
+        cstl::vector<std::string> moved(std::move(copy));
+        assert(copy.empty() && moved.size() == 12);
+    }
+    try {
+        v.at(12);
+        assert(0);
+    }
+    catch (const std::out_of_range&) {
+    }
+    assert(n.size() == 3 && n.data()[2] == 3);
+    for (int* p = n.begin(); p != n.end(); ++p) {
+        *p *= 2;
+    }
+    assert(n[0] == 2 && n[2] == 6);
+}
+
+static void test_cpp_deque(void)
+{
+    cstl::deque<std::string> d;
+    int i;
+
+    for (i = 0; i < 50; i++) {
+        d.push_back(std::to_string(i));
+        d.push_front(std::to_string(-i - 1));
+    }
+    assert(d.size() == 100);
+    assert(d.front() == "-50" && d.back() == "49");
+    for (i = 0; i < 100; i++) {
+        assert(d[i] == std::to_string(i - 50));
+    }
+    assert(d.end() - d.begin() == 100);
+    assert(*(d.begin() + 50) == "0");
+    for (i = 0; i < 30; i++) {
+        d.pop_front();
+        d.pop_back();
+    }
+    assert(d.size() == 40 && d.at(0) == "-20" && d.back() == "19");
+    /* wrap around without growing */
+    for (i = 0; i < 1000; i++) {
+        d.push_back("x");
+        d.pop_front();
+    }
+    assert(d.size() == 40 && d.back() == "x");
+    {
+        cstl::deque<std::string> copy(d);
+        assert(copy.size() == 40 && copy[39] == "x");
+    }
+    d.clear();
+    assert(d.empty() && d.begin() == d.end());
+}
+
+extern "C" void test_cpp_containers(void)
+{
+    test_cpp_map();
+    test_cpp_set();
+    test_cpp_vector();
+    test_cpp_deque();
+}